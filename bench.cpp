@@ -19,6 +19,10 @@
 
 using namespace std;
 
+DEFINE_string(dump_workload, "", "generate the TPCC workload given as the only argument, write it to this binary file and exit");
+DEFINE_string(trace, "", "record a Chrome/Perfetto timeline of the Loom phases and write it to this file when the protocol stops");
+DEFINE_bool(perf_counters, false, "sample hardware counters (cycles, instructions, LLC misses, branch misses, context switches) per Loom phase and Aria/Harmony stage");
+
 namespace loom {
     size_t BLOCK_SIZE = 1000;
 };
@@ -35,6 +39,14 @@ int main(int argc, char** argv) {
 
     /* parse arguments */
     gflags::ParseCommandLineFlags(&argc, &argv, true);
+    // writer mode: bench --dump_workload=<path> TPCC:warehouses:blocksize:blocks:nest[:seed]
+    if (!FLAGS_dump_workload.empty()) {
+        CHECK(argc == 2) << "With --dump_workload we expect only the workload argument.";
+        auto blocks = ParseWorkload(argv[1], warehouse_num, block_size);
+        WorkloadWriter::write(FLAGS_dump_workload, blocks, warehouse_num, block_size, to<bool>(split(argv[1])[4]));
+        cerr << "wrote " << blocks.size() << " blocks to " << FLAGS_dump_workload << endl;
+        return 0;
+    }
     // check if the rest arguments have the correct number
     CHECK(argc == 4) << "Except google logging flags, we expect 3 arguments. " << "But we got " << argc - 1 << " ." << std::endl;
     DLOG(WARNING) << "Debug Mode: don't expect good performance. ";
@@ -44,6 +56,7 @@ int main(int argc, char** argv) {
         2. number of blocks
         3. warehouse number
         4. nest or not
+        (STREAM:capacity:... generates or reads blocks while executing)
       for protocol:
         5. protocol name
         6. thread number
@@ -53,7 +66,7 @@ int main(int argc, char** argv) {
         9. time for running
     */
     auto statistics = Statistics();
-    auto workload = ParseWorkload(argv[2], warehouse_num, block_size);
+    auto workload = ParseBlockSource(argv[2], warehouse_num, block_size);
     auto protocol = ParseProtocol(argv[1], workload, statistics, protocol_name, thread_num);
     auto duration = to<milliseconds>(argv[3]);
     
@@ -74,9 +87,19 @@ int main(int argc, char** argv) {
     // init google logging
     google::InitGoogleLogging(argv[0]);
 
-    protocol->Start();
+    // record the timeline from the first block on, it is written after the protocol stops
+    if (!FLAGS_trace.empty()) Trace::instance().Start(FLAGS_trace);
+    // counters are opened on the threads lazily, a warning is logged if perf_event_open is not permitted
+    if (FLAGS_perf_counters) PerfCounters::instance().Enable();
+
+    // some protocols execute blocks inside Start, run it aside so that a streaming workload can be stopped on time
+    std::thread runner([&] { protocol->Start(); });
     std::this_thread::sleep_for(duration);
+    workload->close();
+    runner.join();
     protocol->Stop();
+    // all blocks are done, write the timeline if tracing is enabled
+    Trace::instance().Flush();
     // print statistics
     cerr << statistics.Print() << endl;
     LOG(INFO) << statistics.Print();
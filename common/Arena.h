@@ -0,0 +1,66 @@
+#pragma once
+
+#include <memory>
+#include <memory_resource>
+#include <utility>
+
+namespace loom {
+
+/// @brief 区块内存池: 单调递增(bump)分配, 区块内的图节点全部从这里分配, 释放时整体归还
+///        只允许单线程填充(一个区块由一个生成线程构建), 释放是无操作因此可以跨线程
+class BlockArena {
+    public:
+        typedef std::shared_ptr<BlockArena> Ptr;
+
+        // 每个事务(超节点+若干子节点+控制块)的预估字节数, 用于预分配首块内存
+        static constexpr size_t BYTES_PER_TX = 4096;
+
+        explicit BlockArena(size_t initialSize) : m_resource(initialSize) {}
+
+        BlockArena(const BlockArena&) = delete;
+        BlockArena& operator=(const BlockArena&) = delete;
+
+        std::pmr::memory_resource* resource() {return &m_resource;}
+
+    private:
+        std::pmr::monotonic_buffer_resource m_resource;
+};
+
+/// @brief 从区块内存池分配的分配器, 每个控制块持有一份拷贝, 最后一个节点析构时内存池随之整体释放
+template <typename T>
+class ArenaAllocator {
+    public:
+        using value_type = T;
+
+        explicit ArenaAllocator(BlockArena::Ptr arena) : m_arena(std::move(arena)) {}
+
+        template <typename U>
+        ArenaAllocator(const ArenaAllocator<U>& other) : m_arena(other.m_arena) {}
+
+        T* allocate(size_t n) {
+            return static_cast<T*>(m_arena->resource()->allocate(n * sizeof(T), alignof(T)));
+        }
+
+        // 单调内存池不单独回收, 内存随内存池析构一次性归还
+        void deallocate(T*, size_t) {}
+
+        template <typename U>
+        bool operator==(const ArenaAllocator<U>& other) const {return m_arena == other.m_arena;}
+        template <typename U>
+        bool operator!=(const ArenaAllocator<U>& other) const {return m_arena != other.m_arena;}
+
+    private:
+        template <typename U> friend class ArenaAllocator;
+        BlockArena::Ptr m_arena;
+};
+
+/// @brief 在内存池中构造共享对象, 对象与控制块一次分配; 内存池为空时退化为 make_shared
+template <typename T, typename... Args>
+std::shared_ptr<T> arenaMakeShared(const BlockArena::Ptr& arena, Args&&... args) {
+    if (!arena) {
+        return std::make_shared<T>(std::forward<Args>(args)...);
+    }
+    return std::allocate_shared<T>(ArenaAllocator<T>(arena), std::forward<Args>(args)...);
+}
+
+}
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <algorithm>
 #include <memory>
+#include <span>
 #include <unordered_map>
 #include <unordered_set>
 #include <set>
@@ -13,17 +15,20 @@ class Block {
     public:
         typedef std::shared_ptr<Block> Ptr;
         
-        // 构造函数
+        // 构造函数, 索引按值传入后直接移动, 不再复制
         Block(size_t blockId, vector<Transaction::Ptr> txs, vector<HyperVertex::Ptr> txInfos,
-        unordered_map<string, loom::RWSets<Vertex::Ptr>> invertedIndex, 
+        unordered_map<Key, loom::RWSets<Vertex::Ptr>> invertedIndex, 
         unordered_map<Vertex::Ptr, unordered_set<Vertex::Ptr, Vertex::VertexHash>, Vertex::VertexHash> RWIndex, 
         unordered_map<Vertex::Ptr, unordered_set<Vertex::Ptr, Vertex::VertexHash>, Vertex::VertexHash> conflictIndex,
-        unordered_map<string, set<Vertex::Ptr, Vertex::VertexCompare>> RBIndex, size_t totalCost)
-         : m_blockId(blockId), m_txs(txs), m_txInfo(txInfos), m_invertedIndex(invertedIndex), m_RWIndex(RWIndex),
-           m_conflictIndex(conflictIndex), m_RBIndex(RBIndex), m_totalCost(totalCost) {}
-         
+        unordered_map<Key, set<Vertex::Ptr, Vertex::VertexCompare>> RBIndex, size_t totalCost)
+         : m_blockId(blockId), m_txs(std::move(txs)), m_txInfo(std::move(txInfos)), m_invertedIndex(std::move(invertedIndex)), m_RWIndex(std::move(RWIndex)),
+           m_conflictIndex(std::move(conflictIndex)), m_RBIndex(std::move(RBIndex)), m_totalCost(totalCost) {
+            freezeVertices();
+            freezeRWEdges();
+        }
 
-        ~Block() = default; // 析构函数
+        // 区块销毁时断开节点间的引用环, 节点内存随内存池整体归还
+        ~Block() {releaseGraph();}
 
         // 获取区块ID
         const size_t getBlockId() const {return m_blockId;}
@@ -38,48 +43,109 @@ class Block {
         std::vector<HyperVertex::Ptr>& getTxList() {return m_txInfo;}
 
         // 设置倒排索引
-        void setInvertedIndex(const std::unordered_map<string, loom::RWSets<Vertex::Ptr>>& invertedIndex) {m_invertedIndex = invertedIndex;} 
+        void setInvertedIndex(std::unordered_map<Key, loom::RWSets<Vertex::Ptr>> invertedIndex) {m_invertedIndex = std::move(invertedIndex);}
 
         // 获取倒排索引
-        const std::unordered_map<string, loom::RWSets<Vertex::Ptr>> getInvertedIndex() const {return m_invertedIndex;}
+        const std::unordered_map<Key, loom::RWSets<Vertex::Ptr>>& getInvertedIndex() const {return m_invertedIndex;}
         
         // 设置rw冲突索引
-        void setRWIndex(const std::unordered_map<Vertex::Ptr, std::unordered_set<Vertex::Ptr, Vertex::VertexHash>, Vertex::VertexHash>& RWIndex) {m_RWIndex = RWIndex;}
+        void setRWIndex(std::unordered_map<Vertex::Ptr, std::unordered_set<Vertex::Ptr, Vertex::VertexHash>, Vertex::VertexHash> RWIndex) {m_RWIndex = std::move(RWIndex); freezeRWEdges();}
         
         // 获取rw冲突索引
         std::unordered_map<Vertex::Ptr, std::unordered_set<Vertex::Ptr, Vertex::VertexHash>, Vertex::VertexHash>& getRWIndex() {return m_RWIndex;}
         
         // 设置冲突索引
-        void setConflictIndex(const std::unordered_map<Vertex::Ptr, std::unordered_set<Vertex::Ptr, Vertex::VertexHash>, Vertex::VertexHash>& conflictIndex) {m_conflictIndex = conflictIndex;}
+        void setConflictIndex(std::unordered_map<Vertex::Ptr, std::unordered_set<Vertex::Ptr, Vertex::VertexHash>, Vertex::VertexHash> conflictIndex) {m_conflictIndex = std::move(conflictIndex);}
         
         // 获取冲突索引
         std::unordered_map<Vertex::Ptr, std::unordered_set<Vertex::Ptr, Vertex::VertexHash>, Vertex::VertexHash>& getConflictIndex() {return m_conflictIndex;}
 
         // 设置回滚索引
-        void setRBIndex(const std::unordered_map<string, std::set<Vertex::Ptr, Vertex::VertexCompare>>& RBIndex) {m_RBIndex = RBIndex;}
+        void setRBIndex(std::unordered_map<Key, std::set<Vertex::Ptr, Vertex::VertexCompare>> RBIndex) {m_RBIndex = std::move(RBIndex);}
 
         // 获取回滚索引
-        const std::unordered_map<string, std::set<Vertex::Ptr, Vertex::VertexCompare>> getRBIndex() const {return m_RBIndex;}
+        const std::unordered_map<Key, std::set<Vertex::Ptr, Vertex::VertexCompare>>& getRBIndex() const {return m_RBIndex;}
+
+        // 获取区块内所有子事务节点, 按事务id与节点id排序连续存放
+        std::span<const Vertex::Ptr> getVertices() const {return m_vertices;}
+
+        // 获取rw冲突索引展开后的 (读事务, 写事务) 边, 连续存放, 构图时无需再遍历哈希表
+        std::span<const std::pair<Vertex::Ptr, Vertex::Ptr>> getRWEdges() const {return m_rwEdges;}
 
         // 获取区块开销
         const size_t getTotalCost() const {return m_totalCost;}
 
+        // 设置区块内存池
+        void setArena(const BlockArena::Ptr& arena) {m_arena = arena;}
+
+        // 重置一次执行在冲突图上留下的状态(超边、回滚标记、调度信息), 区块的事务与索引保持不变, 可以重复执行
+        void resetGraph() {
+            for (auto& hv : m_txInfo) {hv->reset();}
+        }
+
+        // 释放区块的冲突图: 断开节点间的引用环并清空索引, 节点内存在最后一个引用消失时随内存池整体归还
+        void releaseGraph() {
+            for (auto& hv : m_txInfo) {hv->release();}
+            m_txInfo.clear();
+            m_vertices.clear();
+            m_rwEdges.clear();
+            m_invertedIndex.clear();
+            m_RWIndex.clear();
+            m_conflictIndex.clear();
+            m_RBIndex.clear();
+            m_arena = nullptr;
+        }
+
+        // 获取区块访问的不同键数量
+        const size_t getKeyCount() const {return m_invertedIndex.size();}
+
+        // 获取多个区块访问的键数量上界, 用于预分配状态表
+        static size_t countKeys(const vector<Ptr>& blocks) {
+            size_t count = 0;
+            for (auto& block : blocks) {count += block->getKeyCount();}
+            return count;
+        }
+
     private:
+        void freezeVertices() {
+            m_vertices.clear();
+            for (auto& hv : m_txInfo) {
+                m_vertices.insert(m_vertices.end(), hv->m_vertices.begin(), hv->m_vertices.end());
+            }
+            std::sort(m_vertices.begin(), m_vertices.end(), [](const Vertex::Ptr& a, const Vertex::Ptr& b) {
+                return a->m_hyperId != b->m_hyperId ? a->m_hyperId < b->m_hyperId : a->m_id < b->m_id;
+            });
+        }
+
+        void freezeRWEdges() {
+            m_rwEdges.clear();
+            for (auto& [rTx, wTxs] : m_RWIndex) {
+                for (auto& wTx : wTxs) {
+                    m_rwEdges.emplace_back(rTx, wTx);
+                }
+            }
+        }
+
         // 区块ID
         size_t m_blockId; 
         // 区块内事务
         vector<Transaction::Ptr> m_txs;
         vector<HyperVertex::Ptr> m_txInfo;
         // 倒排索引
-        unordered_map<string, loom::RWSets<Vertex::Ptr>> m_invertedIndex;
+        unordered_map<Key, loom::RWSets<Vertex::Ptr>> m_invertedIndex;
         // rw冲突索引
         unordered_map<Vertex::Ptr, unordered_set<Vertex::Ptr, Vertex::VertexHash>, Vertex::VertexHash> m_RWIndex;
         // 冲突索引
         unordered_map<Vertex::Ptr, unordered_set<Vertex::Ptr, Vertex::VertexHash>, Vertex::VertexHash> m_conflictIndex;
         // 回滚索引
-        unordered_map<string, set<Vertex::Ptr, Vertex::VertexCompare>> m_RBIndex;
+        unordered_map<Key, set<Vertex::Ptr, Vertex::VertexCompare>> m_RBIndex;
         // 区块总成本
         size_t m_totalCost;
+        // 区块内存池, 持有所有图节点
+        BlockArena::Ptr m_arena;
+        // 所有子事务节点与展开的rw边, 由事务列表与rw冲突索引生成
+        vector<Vertex::Ptr> m_vertices;
+        vector<std::pair<Vertex::Ptr, Vertex::Ptr>> m_rwEdges;
 };
 
 }
\ No newline at end of file
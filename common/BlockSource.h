@@ -0,0 +1,191 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Block.h"
+
+namespace loom {
+
+/// @brief 区块来源, 协议在准备好执行下一个区块时调用 next() 拉取, 不再要求所有区块预先生成
+class BlockSource {
+    public:
+        typedef std::shared_ptr<BlockSource> Ptr;
+
+        virtual ~BlockSource() = default;
+
+        /// @brief 取下一个区块, 必要时阻塞等待; 区块耗尽或来源已关闭时返回 nullptr
+        virtual Block::Ptr next() = 0;
+
+        /// @brief 执行期间访问的不同键数量估计, 用于预分配状态表
+        virtual size_t keyHint() = 0;
+
+        /// @brief 关闭来源, 之后的 next() 立即返回 nullptr, 可与 next() 并发调用
+        virtual void close() = 0;
+};
+
+/// @brief 预先生成的区块序列
+class VectorBlockSource : public BlockSource {
+    public:
+        explicit VectorBlockSource(std::vector<Block::Ptr> blocks) : m_blocks(std::move(blocks)) {}
+
+        Block::Ptr next() override {
+            if (m_closed.load(std::memory_order_acquire)) return nullptr;
+            auto i = m_cursor.fetch_add(1, std::memory_order_relaxed);
+            return i < m_blocks.size() ? m_blocks[i] : nullptr;
+        }
+
+        size_t keyHint() override {return Block::countKeys(m_blocks);}
+
+        void close() override {m_closed.store(true, std::memory_order_release);}
+
+    private:
+        std::vector<Block::Ptr> m_blocks;
+        std::atomic<size_t> m_cursor{0};
+        std::atomic<bool> m_closed{false};
+};
+
+/// @brief 生产者线程持续产生区块, 经有界环形队列交给协议, 内存中最多同时存在 capacity 个待执行区块
+///        队列为单生产者单消费者无锁环, 两端只在队列满/空时通过 atomic wait 休眠;
+///        消费端需串行调用 next() (协议的驱动线程, 或在 BatchFeed 的锁内)
+class StreamingBlockSource : public BlockSource {
+    public:
+        /// @brief 区块生产函数, 返回 nullptr 表示没有更多区块
+        typedef std::function<Block::Ptr()> Producer;
+
+        StreamingBlockSource(Producer producer, size_t capacity)
+         : m_capacity(std::max<size_t>(capacity, 1)), m_ring(m_capacity), m_producer(std::move(producer)) {
+            m_thread = std::thread([this] {produce();});
+        }
+
+        ~StreamingBlockSource() override {
+            close();
+            m_thread.join();
+        }
+
+        Block::Ptr next() override {
+            auto head = m_head.load(std::memory_order_relaxed);
+            while (true) {
+                auto events = m_events.load(std::memory_order_acquire);
+                if (m_closed.load(std::memory_order_acquire)) return nullptr;
+                if (head != m_tail.load(std::memory_order_acquire)) break;
+                // 生产者先发布最后一个区块再置结束标记, 看到结束标记时队列中的区块均已可见
+                if (m_finished.load(std::memory_order_acquire) && head == m_tail.load(std::memory_order_acquire)) return nullptr;
+                m_events.wait(events, std::memory_order_acquire);
+            }
+            auto block = std::move(m_ring[head % m_capacity]);
+            m_head.store(head + 1, std::memory_order_release);
+            signal();
+            return block;
+        }
+
+        /// @brief 以首个区块的键数量乘以队列容量估计, 在首个区块产生前阻塞
+        size_t keyHint() override {
+            while (true) {
+                auto events = m_events.load(std::memory_order_acquire);
+                if (m_tail.load(std::memory_order_acquire) > 0 || m_finished.load(std::memory_order_acquire) || m_closed.load(std::memory_order_acquire)) break;
+                m_events.wait(events, std::memory_order_acquire);
+            }
+            return m_firstKeys.load(std::memory_order_relaxed) * m_capacity;
+        }
+
+        void close() override {
+            m_closed.store(true, std::memory_order_release);
+            signal();
+        }
+
+    private:
+        void produce() {
+            size_t tail = 0;
+            while (!m_closed.load(std::memory_order_acquire)) {
+                auto block = m_producer();
+                if (!block) break;
+                if (tail == 0) m_firstKeys.store(block->getKeyCount(), std::memory_order_relaxed);
+                // 队列满时等待消费者取走区块
+                while (true) {
+                    auto events = m_events.load(std::memory_order_acquire);
+                    if (m_closed.load(std::memory_order_acquire)) return;
+                    if (tail - m_head.load(std::memory_order_acquire) < m_capacity) break;
+                    m_events.wait(events, std::memory_order_acquire);
+                }
+                m_ring[tail % m_capacity] = std::move(block);
+                m_tail.store(++tail, std::memory_order_release);
+                signal();
+            }
+            m_finished.store(true, std::memory_order_release);
+            signal();
+        }
+
+        // 任何一端状态变化都推进事件计数并唤醒对端
+        void signal() {
+            m_events.fetch_add(1, std::memory_order_release);
+            m_events.notify_all();
+        }
+
+        size_t m_capacity;
+        std::vector<Block::Ptr> m_ring;
+        Producer m_producer;
+        alignas(64) std::atomic<size_t> m_head{0};      // 消费者位置
+        alignas(64) std::atomic<size_t> m_tail{0};      // 生产者位置
+        alignas(64) std::atomic<uint32_t> m_events{0};
+        std::atomic<bool> m_finished{false};
+        std::atomic<bool> m_closed{false};
+        std::atomic<size_t> m_firstKeys{0};
+        std::thread m_thread;
+};
+
+/// @brief 将区块按轮次切分给固定数量的工作线程: 每轮第一个到达的线程从来源拉取区块并切分, 其余线程直接领取自己的一份
+///        各线程按轮次顺序领取, 但不要求同步推进; 所有线程都领取后该轮即释放
+template <typename Tx>
+class BatchFeed {
+    public:
+        /// @brief 切分函数, 返回每个工作线程的事务, batchId 从1开始
+        typedef std::function<std::vector<std::vector<Tx>>(const Block::Ptr&, size_t batchId)> Splitter;
+
+        BatchFeed(BlockSource::Ptr source, size_t workers, Splitter split)
+         : m_source(std::move(source)), m_workers(workers), m_split(std::move(split)) {}
+
+        /// @brief 领取第 round 轮分给 worker 的事务, 来源耗尽时所有线程在同一轮得到 nullptr
+        /// @return 事务所属区块, 区块析构时会释放节点图, 调用方需持有它直到这批事务执行完毕
+        Block::Ptr next(size_t round, size_t worker, std::vector<Tx>& batch) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (round >= m_end) return nullptr;
+            if (round == m_pulled) {
+                auto block = m_source->next();
+                if (!block) {
+                    m_end = round;
+                    return nullptr;
+                }
+                m_rounds.emplace(round, Round{block, m_split(block, round + 1), 0});
+                m_pulled++;
+            }
+            auto it = m_rounds.find(round);
+            auto block = it->second.block;
+            batch = std::move(it->second.batches[worker]);
+            if (++it->second.taken == m_workers) m_rounds.erase(it);
+            return block;
+        }
+
+    private:
+        struct Round {
+            Block::Ptr block;
+            std::vector<std::vector<Tx>> batches;
+            size_t taken;
+        };
+
+        BlockSource::Ptr m_source;
+        size_t m_workers;
+        Splitter m_split;
+        std::mutex m_mutex;
+        std::map<size_t, Round> m_rounds;
+        size_t m_pulled = 0;
+        size_t m_end = SIZE_MAX;
+};
+
+}
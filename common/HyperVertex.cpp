@@ -5,7 +5,7 @@ using namespace std;
 
 namespace loom {
 
-HyperVertex::HyperVertex(int id, bool isNested): m_hyperId(id), m_isNested(isNested) {
+HyperVertex::HyperVertex(int id, bool isNested, BlockArena::Ptr arena): m_hyperId(id), m_isNested(isNested), m_arena(std::move(arena)) {
     m_min_in = INT_MAX;
     m_min_out = INT_MAX;
     m_cost = 0;
@@ -13,22 +13,56 @@ HyperVertex::HyperVertex(int id, bool isNested): m_hyperId(id), m_isNested(isNes
     m_out_cost = 0;
     m_aborted = false;
     m_setted = false;
-
-    m_out_edges.resize(loom::BLOCK_SIZE + 1);
-    m_in_edges.resize(loom::BLOCK_SIZE + 1);
-    m_out_rollback.resize(loom::BLOCK_SIZE + 1);
-    m_in_rollback.resize(loom::BLOCK_SIZE + 1);
-    m_out_weights.resize(loom::BLOCK_SIZE + 1);
-    m_in_weights.resize(loom::BLOCK_SIZE + 1);
-
-    m_out_mapS.resize(loom::BLOCK_SIZE + 1);
-    m_in_mapS.resize(loom::BLOCK_SIZE + 1);
-    m_out_rollbackMS.resize(loom::BLOCK_SIZE + 1);
-    m_in_rollbackMS.resize(loom::BLOCK_SIZE + 1);
 }
 
 HyperVertex::~HyperVertex() {}
 
+const HyperEdge& HyperVertex::outEdge(int hyperId) const {
+    static const HyperEdge empty;
+    auto it = m_out.find(hyperId);
+    return it == m_out.end() ? empty : it->second;
+}
+
+const HyperEdge& HyperVertex::inEdge(int hyperId) const {
+    static const HyperEdge empty;
+    auto it = m_in.find(hyperId);
+    return it == m_in.end() ? empty : it->second;
+}
+
+void HyperVertex::release() {
+    for (auto& vertex : m_vertices) {
+        vertex->releaseLinks();
+    }
+    m_vertices.clear();
+    m_rootVertex = nullptr;
+    m_in_allRB.clear();
+    m_out_allRB.clear();
+    m_out_hv.clear();
+    m_in_hv.clear();
+    m_out.clear();
+    m_in.clear();
+    m_arena = nullptr;
+}
+
+
+void HyperVertex::reset() {
+    for (auto& vertex : m_vertices) {
+        vertex->reset();
+    }
+    m_min_in = INT_MAX;
+    m_min_out = INT_MAX;
+    m_cost = 0;
+    m_in_cost = 0;
+    m_out_cost = 0;
+    m_aborted = false;
+    m_setted = false;
+    m_in_allRB.clear();
+    m_out_allRB.clear();
+    m_out_hv.clear();
+    m_in_hv.clear();
+    m_out.clear();
+    m_in.clear();
+}
 
 void HyperVertex::recognizeCascades(Vertex::Ptr vertex) {
     // 递归识别并更新级联子事务
@@ -44,7 +78,7 @@ void HyperVertex::recognizeCascades(Vertex::Ptr vertex) {
 }
 
 // 构建嵌套事务超节点
-int HyperVertex::buildVertexs(const TPCCTransaction::Ptr& tx, HyperVertex::Ptr& hyperVertex, Vertex::Ptr& vertex, string& txid, std::unordered_map<string, loom::RWSets<Vertex::Ptr>>& invertedIndex) {
+int HyperVertex::buildVertexs(const TPCCTransaction::Ptr& tx, HyperVertex::Ptr& hyperVertex, Vertex::Ptr& vertex, string& txid, std::unordered_map<Key, loom::RWSets<Vertex::Ptr>>& invertedIndex) {
     // 获取执行时间
     int execTime = tx->getExecutionTime();
     vertex->m_self_cost = execTime;
@@ -60,7 +94,7 @@ int HyperVertex::buildVertexs(const TPCCTransaction::Ptr& tx, HyperVertex::Ptr&
         for (int i = 1; i <= children.size(); i++) {
             auto child = children[i - 1];
             string subTxid = txid + "_" + to_string(i);
-            Vertex::Ptr childVertex = make_shared<Vertex>(hyperVertex, this->m_hyperId, subTxid, vertex->m_layer + 1, true);
+            Vertex::Ptr childVertex = arenaMakeShared<Vertex>(m_arena, hyperVertex, this->m_hyperId, subTxid, vertex->m_layer + 1, true);
             // 递归添加级联回滚代价
             execTime += buildVertexs(child.transaction, hyperVertex, childVertex, subTxid, invertedIndex);
             // 若为强依赖，则记录强依赖子节点
@@ -101,7 +135,7 @@ int HyperVertex::buildVertexs(const TPCCTransaction::Ptr& tx, HyperVertex::Ptr&
 }
 
 // 构建普通事务节点
-void HyperVertex::buildVertexs(const TPCCTransaction::Ptr& tx, Vertex::Ptr& vertex, std::unordered_map<string, loom::RWSets<Vertex::Ptr>>& invertedIndex) {
+void HyperVertex::buildVertexs(const TPCCTransaction::Ptr& tx, Vertex::Ptr& vertex, std::unordered_map<Key, loom::RWSets<Vertex::Ptr>>& invertedIndex) {
     // 获取执行时间
     int execTime = tx->getExecutionTime();
     vertex->m_self_cost += execTime;
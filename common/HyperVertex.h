@@ -1,27 +1,79 @@
 #pragma once
 
 #include <memory>
+#include <atomic>
+#include <algorithm>
 #include <tbb/concurrent_unordered_map.h>
 #include "Vertex.h"
+#include "Arena.h"
 #include "workload/tpcc/Transaction.hpp"
 #include "protocol/common.h"
+#include "utils/Ulock.h"
 
 using namespace std;
 
 namespace loom {
 
+/// @brief 超边上的子事务集合: 按地址有序、去重的小数组
+///        构图时多个线程加锁插入, 构图完成后只读, 遍历无需加锁
+class VertexList {
+    public:
+        void insert(const Vertex::Ptr& v) {
+            Guard<SpinLock> guard(m_mu);
+            insertUnlocked(v);
+        }
+
+        template <typename It>
+        void insert(It first, It last) {
+            Guard<SpinLock> guard(m_mu);
+            for (; first != last; ++first) {
+                insertUnlocked(*first);
+            }
+        }
+
+        bool contains(const Vertex::Ptr& v) const {
+            return std::binary_search(m_items.begin(), m_items.end(), v);
+        }
+
+        std::vector<Vertex::Ptr>::const_iterator begin() const {return m_items.begin();}
+        std::vector<Vertex::Ptr>::const_iterator end() const {return m_items.end();}
+        size_t size() const {return m_items.size();}
+        bool empty() const {return m_items.empty();}
+
+    private:
+        void insertUnlocked(const Vertex::Ptr& v) {
+            auto it = std::lower_bound(m_items.begin(), m_items.end(), v);
+            if (it == m_items.end() || *it != v) {
+                m_items.insert(it, v);
+            }
+        }
+
+        SpinLock m_mu;
+        std::vector<Vertex::Ptr> m_items;
+};
+
+/// @brief 超边: 本超节点与某个相邻超节点之间的依赖信息
+///        超节点只与少数超节点冲突, 按相邻超节点id稀疏存储, 避免按区块大小预分配
+struct HyperEdge {
+    VertexList edges;                   // 依赖的子事务
+    VertexList rollback;                // 级联回滚子事务
+    std::atomic<double> weight{0};      // 边权, 构图时并发累加
+};
+
+typedef tbb::concurrent_unordered_map<int, HyperEdge> HyperEdges;
+
 class HyperVertex : public std::enable_shared_from_this<HyperVertex>
 {
     public:
         typedef std::shared_ptr<HyperVertex> Ptr;
 
-        HyperVertex(int id, bool isNested);
+        HyperVertex(int id, bool isNested, BlockArena::Ptr arena = nullptr);
 
         ~HyperVertex();
 
-        int buildVertexs(const TPCCTransaction::Ptr& tx, HyperVertex::Ptr& hyperVertex, Vertex::Ptr& vertex, string& txid, std::unordered_map<string, loom::RWSets<Vertex::Ptr>>& invertedIndex);
+        int buildVertexs(const TPCCTransaction::Ptr& tx, HyperVertex::Ptr& hyperVertex, Vertex::Ptr& vertex, string& txid, std::unordered_map<Key, loom::RWSets<Vertex::Ptr>>& invertedIndex);
 
-        void buildVertexs(const TPCCTransaction::Ptr& tx, Vertex::Ptr& vertex, std::unordered_map<string, loom::RWSets<Vertex::Ptr>>& invertedIndex);
+        void buildVertexs(const TPCCTransaction::Ptr& tx, Vertex::Ptr& vertex, std::unordered_map<Key, loom::RWSets<Vertex::Ptr>>& invertedIndex);
 
         void recognizeCascades(Vertex::Ptr vertex);
 
@@ -30,6 +82,16 @@ class HyperVertex : public std::enable_shared_from_this<HyperVertex>
 
         void setCommitTime(chrono::time_point<chrono::steady_clock> commit_time);
 
+        // 断开超节点与子节点间的引用环, 使节点可以随区块内存池一起释放
+        void release();
+
+        // 清除一次执行产生的图状态, 恢复到刚生成时的样子, 事务结构与读写集不变
+        void reset();
+
+        // 查找到相邻超节点的出边/入边, 不存在时返回空边且不插入
+        const HyperEdge& outEdge(int hyperId) const;
+        const HyperEdge& inEdge(int hyperId) const;
+
         struct HyperVertexHash {
             std::size_t operator()(const HyperVertex::Ptr& v) const {
                 // 使用HyperVertex的地址作为哈希值
@@ -81,31 +143,13 @@ class HyperVertex : public std::enable_shared_from_this<HyperVertex>
         // edit:6.18 -- 替换下面更加高效的数据结构
         tbb::concurrent_unordered_set<HyperVertex::Ptr, HyperVertexHash> m_out_hv;
         tbb::concurrent_unordered_set<HyperVertex::Ptr, HyperVertexHash> m_in_hv;
-        tbb::concurrent_vector<tbb::concurrent_unordered_set<Vertex::Ptr, Vertex::VertexHash>> m_out_edges;    // 记录超节点中所有出边, 格式：hyperVertex => {vi,...,vn}
-        tbb::concurrent_vector<tbb::concurrent_unordered_set<Vertex::Ptr ,Vertex::VertexHash>> m_in_edges;     // 记录超节点中所有入边
-        tbb::concurrent_vector<tbb::concurrent_unordered_set<Vertex::Ptr, Vertex::VertexHash>> m_in_rollback;  // 记录入边的级联回滚子事务
-        tbb::concurrent_vector<tbb::concurrent_unordered_set<Vertex::Ptr, Vertex::VertexHash>> m_out_rollback; // 记录出边的级联回滚子事务
-
-
-
-        // 单线程版本
-        unordered_set<Vertex::Ptr, Vertex::VertexHash> m_in_allRBS;  // 记录超节点中所有入边的级联回滚子事务, 格式：rbVertex => num
-        unordered_map<HyperVertex::Ptr, unordered_set<Vertex::Ptr, Vertex::VertexHash>, HyperVertexHash> m_out_edgesS;
-        unordered_map<HyperVertex::Ptr, unordered_set<Vertex::Ptr ,Vertex::VertexHash>, HyperVertexHash> m_in_edgesS;
-        unordered_set<HyperVertex::Ptr, HyperVertexHash> m_out_hvS;
-        unordered_set<HyperVertex::Ptr, HyperVertexHash> m_in_hvS;
-        vector<unordered_set<Vertex::Ptr, Vertex::VertexHash>> m_out_mapS;
-        vector<unordered_set<Vertex::Ptr ,Vertex::VertexHash>> m_in_mapS;
-        vector<unordered_set<Vertex::Ptr, Vertex::VertexHash>> m_in_rollbackMS;  // 记录入边的级联回滚子事务
-        vector<unordered_set<Vertex::Ptr, Vertex::VertexHash>> m_out_rollbackMS; // 记录出边的级联回滚子事务
-        unordered_map<HyperVertex::Ptr, unordered_set<Vertex::Ptr, Vertex::VertexHash>, HyperVertexHash> m_out_rollbackS; // 记录出边的级联回滚子事务
-
+        HyperEdges m_out;   // 记录超节点所有出边, 格式：hyperId => {edges, rollback, weight}
+        HyperEdges m_in;    // 记录超节点所有入边
 
-        tbb::concurrent_vector<double> m_out_weights; //记录出边边权
-        tbb::concurrent_vector<double> m_in_weights;  //记录入边边权
         loom::EdgeType m_rollback_type; // 边类型
         unordered_set<Vertex::Ptr, Vertex::VertexHash> m_vertices;  // 记录所有节点
         Vertex::Ptr m_rootVertex;                               // 根节点
+        BlockArena::Ptr m_arena;                                // 所属区块的内存池, 子节点从中分配
         
 };
 
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace loom {
+
+/// @brief 稠密整数键: 高 8 位为表标签, 低 56 位为打包后的主键
+///        layout: [tag:8][f0:12][f1:4][f2:24][f3:16]
+using Key = uint64_t;
+
+namespace KeyLayout {
+    static constexpr int TAG_BITS = 8;
+    static constexpr int F0_BITS  = 12;
+    static constexpr int F1_BITS  = 4;
+    static constexpr int F2_BITS  = 24;
+    static constexpr int F3_BITS  = 16;
+
+    static constexpr int F3_SHIFT  = 0;
+    static constexpr int F2_SHIFT  = F3_SHIFT + F3_BITS;
+    static constexpr int F1_SHIFT  = F2_SHIFT + F2_BITS;
+    static constexpr int F0_SHIFT  = F1_SHIFT + F1_BITS;
+    static constexpr int TAG_SHIFT = F0_SHIFT + F0_BITS;
+
+    static_assert(TAG_SHIFT + TAG_BITS == 64, "key layout must fill 64 bits");
+
+    constexpr uint64_t mask(int bits) { return (uint64_t(1) << bits) - 1; }
+}
+
+/// @brief 打包一个键, 各字段超出位宽的部分会被截断
+inline constexpr Key makeKey(uint8_t tag, uint64_t f0 = 0, uint64_t f1 = 0, uint64_t f2 = 0, uint64_t f3 = 0) {
+    using namespace KeyLayout;
+    return (uint64_t(tag) << TAG_SHIFT)
+         | ((f0 & mask(F0_BITS)) << F0_SHIFT)
+         | ((f1 & mask(F1_BITS)) << F1_SHIFT)
+         | ((f2 & mask(F2_BITS)) << F2_SHIFT)
+         | ((f3 & mask(F3_BITS)) << F3_SHIFT);
+}
+
+/// @brief 获取键所属的表标签
+inline constexpr uint8_t keyTag(Key key) {
+    return uint8_t(key >> KeyLayout::TAG_SHIFT);
+}
+
+/// @brief 获取键的第 idx 个主键字段
+inline constexpr uint64_t keyField(Key key, int idx) {
+    using namespace KeyLayout;
+    switch (idx) {
+        case 0: return (key >> F0_SHIFT) & mask(F0_BITS);
+        case 1: return (key >> F1_SHIFT) & mask(F1_BITS);
+        case 2: return (key >> F2_SHIFT) & mask(F2_BITS);
+        default: return (key >> F3_SHIFT) & mask(F3_BITS);
+    }
+}
+
+/// @brief 键的可读形式, 仅用于日志输出
+inline std::string keyToString(Key key) {
+    return std::to_string(keyTag(key)) + ":" + std::to_string(keyField(key, 0)) + "-" + std::to_string(keyField(key, 1))
+         + "-" + std::to_string(keyField(key, 2)) + "-" + std::to_string(keyField(key, 3));
+}
+
+}
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <utility>
+#include <vector>
+#include "Key.h"
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+namespace loom {
+
+/// @brief 标记输入区间已有序去重, 批量插入时跳过排序直接归并
+struct sorted_unique_t { explicit sorted_unique_t() = default; };
+inline constexpr sorted_unique_t sorted_unique{};
+
+/// @brief 有序连续存储的整数键集合, 替代 unordered_set<Key> 作为读写集
+///        插入时保持有序去重, 冲突检测使用合并/跳跃(galloping)求交, 支持 AVX2/SSE4 向量化
+class KeySet {
+    public:
+        using value_type = Key;
+        using const_iterator = std::vector<Key>::const_iterator;
+        using iterator = const_iterator;
+
+        KeySet() = default;
+        KeySet(std::initializer_list<Key> keys) { insert(keys.begin(), keys.end()); }
+        template <typename It>
+        KeySet(It first, It last) { insert(first, last); }
+        template <typename It>
+        KeySet(sorted_unique_t, It first, It last) { insert(sorted_unique, first, last); }
+
+        /// @brief 插入单个键, 读写集一般只有几个到几十个键, 有序插入的搬移代价很小
+        std::pair<const_iterator, bool> insert(Key key) {
+            auto it = std::lower_bound(m_keys.begin(), m_keys.end(), key);
+            if (it != m_keys.end() && *it == key) {
+                return {it, false};
+            }
+            return {m_keys.insert(it, key), true};
+        }
+
+        /// @brief 批量插入任意区间, 追加后排序再归并去重
+        template <typename It>
+        void insert(It first, It last) {
+            if (first == last) return;
+            auto mid = m_keys.size();
+            m_keys.insert(m_keys.end(), first, last);
+            std::sort(m_keys.begin() + mid, m_keys.end());
+            merge(mid);
+        }
+
+        /// @brief 批量插入调用方保证有序去重的区间, 跳过排序只做归并
+        template <typename It>
+        void insert(sorted_unique_t, It first, It last) {
+            if (first == last) return;
+            auto mid = m_keys.size();
+            m_keys.insert(m_keys.end(), first, last);
+            merge(mid);
+        }
+
+        void insert(const KeySet& other) { insert(sorted_unique, other.begin(), other.end()); }
+
+        size_t erase(Key key) {
+            auto it = find(key);
+            if (it == end()) return 0;
+            m_keys.erase(it);
+            return 1;
+        }
+
+        const_iterator find(Key key) const {
+            auto it = std::lower_bound(m_keys.begin(), m_keys.end(), key);
+            return (it != m_keys.end() && *it == key) ? it : m_keys.end();
+        }
+
+        bool contains(Key key) const { return find(key) != end(); }
+        size_t count(Key key) const { return contains(key) ? 1 : 0; }
+
+        const_iterator begin() const { return m_keys.cbegin(); }
+        const_iterator end() const { return m_keys.cend(); }
+        const Key* data() const { return m_keys.data(); }
+        size_t size() const { return m_keys.size(); }
+        bool empty() const { return m_keys.empty(); }
+        void clear() { m_keys.clear(); }
+        void reserve(size_t n) { m_keys.reserve(n); }
+
+        bool operator==(const KeySet& other) const { return m_keys == other.m_keys; }
+
+    private:
+        /// @brief 归并 [0, mid) 与 [mid, end) 两段有序区间并去重
+        void merge(size_t mid) {
+            std::inplace_merge(m_keys.begin(), m_keys.begin() + mid, m_keys.end());
+            m_keys.erase(std::unique(m_keys.begin(), m_keys.end()), m_keys.end());
+        }
+
+        std::vector<Key> m_keys;
+};
+
+namespace detail {
+
+    // 规模相差超过该倍数时改用跳跃查找
+    static constexpr size_t GALLOP_RATIO = 32;
+
+    /// @brief 在 large[pos, n) 中跳跃查找第一个 >= x 的位置
+    inline size_t gallop(const Key* large, size_t n, size_t pos, Key x) {
+        size_t bound = 1;
+        while (pos + bound < n && large[pos + bound] < x) {
+            bound <<= 1;
+        }
+        auto first = large + pos + (bound >> 1);
+        auto last = large + std::min(pos + bound + 1, n);
+        return std::lower_bound(first, last, x) - large;
+    }
+
+    inline bool intersectsGallop(const Key* small, size_t ns, const Key* large, size_t nl) {
+        size_t pos = 0;
+        for (size_t i = 0; i < ns; ++i) {
+            pos = gallop(large, nl, pos, small[i]);
+            if (pos == nl) return false;
+            if (large[pos] == small[i]) return true;
+        }
+        return false;
+    }
+
+    inline bool intersectsMerge(const Key* a, size_t na, const Key* b, size_t nb) {
+        size_t i = 0, j = 0;
+#if defined(__AVX2__)
+        // 4x4 分块比较: 每次将 b 的块循环移位 3 次, 覆盖全部 16 个键对
+        while (i + 4 <= na && j + 4 <= nb) {
+            __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + j));
+            __m256i m = _mm256_cmpeq_epi64(va, vb);
+            vb = _mm256_permute4x64_epi64(vb, 0x39);
+            m = _mm256_or_si256(m, _mm256_cmpeq_epi64(va, vb));
+            vb = _mm256_permute4x64_epi64(vb, 0x39);
+            m = _mm256_or_si256(m, _mm256_cmpeq_epi64(va, vb));
+            vb = _mm256_permute4x64_epi64(vb, 0x39);
+            m = _mm256_or_si256(m, _mm256_cmpeq_epi64(va, vb));
+            if (!_mm256_testz_si256(m, m)) return true;
+            Key amax = a[i + 3], bmax = b[j + 3];
+            if (amax <= bmax) i += 4;
+            if (bmax <= amax) j += 4;
+        }
+#elif defined(__SSE4_1__)
+        // 2x2 分块比较
+        while (i + 2 <= na && j + 2 <= nb) {
+            __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+            __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j));
+            __m128i m = _mm_cmpeq_epi64(va, vb);
+            m = _mm_or_si128(m, _mm_cmpeq_epi64(va, _mm_shuffle_epi32(vb, 0x4E)));
+            if (!_mm_testz_si128(m, m)) return true;
+            Key amax = a[i + 1], bmax = b[j + 1];
+            if (amax <= bmax) i += 2;
+            if (bmax <= amax) j += 2;
+        }
+#endif
+        while (i < na && j < nb) {
+            if (a[i] < b[j]) {
+                ++i;
+            } else if (b[j] < a[i]) {
+                ++j;
+            } else {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// @brief 判断 sub 中所有键都在 super 中
+    inline bool containsMerge(const Key* super, size_t n, const Key* sub, size_t m) {
+        size_t j = 0;
+        for (size_t i = 0; i < m; ++i) {
+            Key x = sub[i];
+#if defined(__AVX2__)
+            // 统计块内小于 x 的键数, 有序所以一定是前缀; 异或符号位以实现无符号比较
+            const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+            __m256i vx = _mm256_xor_si256(_mm256_set1_epi64x(int64_t(x)), sign);
+            while (j + 4 <= n) {
+                __m256i v = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(super + j)), sign);
+                int lt = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(vx, v)));
+                int c = std::popcount(unsigned(lt));
+                j += c;
+                if (c < 4) break;
+            }
+#endif
+            while (j < n && super[j] < x) ++j;
+            if (j == n || super[j] != x) return false;
+            ++j;
+        }
+        return true;
+    }
+
+    inline bool containsGallop(const Key* super, size_t n, const Key* sub, size_t m) {
+        size_t pos = 0;
+        for (size_t i = 0; i < m; ++i) {
+            pos = gallop(super, n, pos, sub[i]);
+            if (pos == n || super[pos] != sub[i]) return false;
+            ++pos;
+        }
+        return true;
+    }
+
+}
+
+/// @brief 判断两个键集合是否有交集(读写集是否冲突)
+inline bool intersects(const KeySet& a, const KeySet& b) {
+    if (a.empty() || b.empty()) return false;
+    // 值域不重叠时直接返回
+    if (*(a.end() - 1) < *b.begin() || *(b.end() - 1) < *a.begin()) return false;
+    const KeySet& small = a.size() <= b.size() ? a : b;
+    const KeySet& large = a.size() <= b.size() ? b : a;
+    if (small.size() * detail::GALLOP_RATIO < large.size()) {
+        return detail::intersectsGallop(small.data(), small.size(), large.data(), large.size());
+    }
+    return detail::intersectsMerge(a.data(), a.size(), b.data(), b.size());
+}
+
+/// @brief 判断 super 是否包含 sub
+inline bool contains(const KeySet& super, const KeySet& sub) {
+    if (sub.size() > super.size()) return false;
+    if (sub.empty()) return true;
+    if (sub.size() * detail::GALLOP_RATIO < super.size()) {
+        return detail::containsGallop(super.data(), super.size(), sub.data(), sub.size());
+    }
+    return detail::containsMerge(super.data(), super.size(), sub.data(), sub.size());
+}
+
+}
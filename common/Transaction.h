@@ -5,14 +5,15 @@
 #include <unordered_set>
 #include <functional>
 #include <memory>
+#include "KeySet.h"
 
 
 namespace loom {
 
 class HyperVertex;
 
-using SetStorage = std::function<void(const std::unordered_set<std::string>& writeSet, const std::string& value)>;
-using GetStorage = std::function<void(const std::unordered_set<std::string>& readSet)>;
+using SetStorage = std::function<void(const KeySet& writeSet, const std::string& value)>;
+using GetStorage = std::function<void(const KeySet& readSet)>;
 
 class Transaction : public std::enable_shared_from_this<Transaction>
 {
@@ -45,6 +45,24 @@ void Vertex::addChild(Vertex::Ptr child, loom::DependencyType dependency) {
     m_children.insert({child, dependency}); 
 }
 
+void Vertex::releaseLinks() {
+    cascadeVertices.clear();
+    m_children.clear();
+    dependencies_in.clear();
+    dependencies_out.clear();
+    m_strongChildren.clear();
+    m_strongParent = nullptr;
+    m_should_wait = nullptr;
+}
+
+void Vertex::reset() {
+    m_degree = 0;
+    scheduledTime = 0;
+    dependencies_in.clear();
+    dependencies_out.clear();
+    m_should_wait = nullptr;
+}
+
 void Vertex::printVertex() {
     cout << "VertexId: " << m_id;
     cout << " Cost: " << m_cost;
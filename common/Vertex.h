@@ -116,6 +116,12 @@ class Vertex : public std::enable_shared_from_this<Vertex>, public Transaction
 
         void printVertex();
 
+        // 清空指向其它节点的引用(子节点, 级联节点, 依赖), 由 HyperVertex::release 调用
+        void releaseLinks();
+
+        // 清除重调度留下的依赖与调度信息
+        void reset();
+
         string DependencyTypeToString(loom::DependencyType type);
 
         int mapToHyperId() const;
@@ -136,10 +142,10 @@ class Vertex : public std::enable_shared_from_this<Vertex>, public Transaction
         // unordered_set<Vertex::Ptr, VertexHash> m_in_edges;                    // 记录节点的入边, 格式：节点指针 => 可抵达最小id
         // unordered_set<Vertex::Ptr, VertexHash> m_out_edges;                   // 记录节点的出边, 格式：节点指针 => 可到达最小id
         set<Vertex::Ptr, VertexCompare2> cascadeVertices;                        // 记录级联回滚节点
-        unordered_set<string> readSet;                                           // 记录读集
-        unordered_set<string> writeSet;                                          // 记录写集
-        unordered_set<string> allReadSet;                                        // 记录所有读集(包括子事务)
-        unordered_set<string> allWriteSet;                                       // 记录所有写集(包括子事务)
+        KeySet readSet;                                                         // 记录读集
+        KeySet writeSet;                                                        // 记录写集
+        KeySet allReadSet;                                                      // 记录所有读集(包括子事务)
+        KeySet allWriteSet;                                                     // 记录所有写集(包括子事务)
         bool isNested;                                                           // 标记节点是否是嵌套节点
         unordered_set<ChildVertex, ChildVertexHash, ChildVertexEqual> m_children;// 记录子节点
         
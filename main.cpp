@@ -3,6 +3,12 @@
 #include <glog/logging.h>
 #include <gflags/gflags.h>
 #include <loom/test/TpccTest.cpp>
+#include <loom/test/KeySetTest.cpp>
+#include <loom/test/TableTest.cpp>
+#include <loom/test/SCCTest.cpp>
+#include <loom/test/ThreadPoolTest.cpp>
+#include <loom/test/HistogramTest.cpp>
+#include <loom/test/TraceTest.cpp>
 #include <loom/test/MinWRollbackTest.cpp>
 #include <loom/test/FabricPPTest.cpp>
 #include <loom/test/CompareTest.cpp>
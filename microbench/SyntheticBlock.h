@@ -0,0 +1,81 @@
+/***************************
+@File: SyntheticBlock.h
+@Desc:
+    1. 按形状参数生成合成区块, 用于单独测量 Loom 各内核
+    2. 形状: 事务数、嵌套深度与扇出、每个子事务读写的键数、冲突密度
+    3. 冲突密度: 每次访问以概率 hot 落在少量热键上, 其余落在大的冷键空间中
+    4. 同一形状与种子生成的区块相同
+***************************/
+#pragma once
+
+#include <loom/utils/Generator/UTxGenerator.h>
+
+namespace loom {
+
+/// @brief 合成区块的形状参数
+struct SyntheticSpec {
+    size_t txs = 1000;          // 区块内事务数
+    size_t depth = 2;           // 嵌套层数, 1 为不嵌套的扁平事务
+    size_t fanout = 2;          // 每个嵌套节点的子事务数
+    size_t reads = 2;           // 每个子事务只读的键数
+    size_t writes = 1;          // 每个子事务读改写的键数
+    size_t hotKeys = 1024;      // 热键数量
+    size_t coldKeys = 1 << 20;  // 冷键空间大小
+    double hot = 0.1;           // 每次访问落在热键上的概率
+    uint64_t seed = 1;
+};
+
+class SyntheticBlock {
+    public:
+        /// @brief 生成一个合成区块, 区块内事务id依次为 [1, spec.txs]
+        static Block::Ptr generate(const SyntheticSpec& spec, size_t blockId = 1) {
+            std::vector<TPCCTransaction::Ptr> txs;
+            txs.reserve(spec.txs);
+            for (size_t i = 0; i < spec.txs; i++) {
+                // 每个事务使用独立的随机流, 与生成顺序无关
+                loom::Random random(spec.seed, i);
+                KeySet used;
+                txs.push_back(makeTransaction(spec, random, 1, used));
+            }
+            return TxGenerator(spec.txs, spec.txs).buildBlock(spec.depth > 1, txs, blockId);
+        }
+
+    private:
+        // 不属于任何 TPCC 表的标签, 合成键不会进入回滚索引
+        static constexpr uint8_t SYNTHETIC_TAG = 0xF0;
+
+        // 同一事务的子事务之间不访问相同的键(与 TPCC 相同), 否则超节点会依赖自身
+        static Key drawKey(const SyntheticSpec& spec, loom::Random& random, KeySet& used) {
+            Key key;
+            do {
+                uint64_t index = random.uniform_dist(1, 1000000) <= spec.hot * 1000000 && used.size() < spec.hotKeys
+                               ? random.uniform_dist(0, spec.hotKeys - 1)
+                               : spec.hotKeys + random.uniform_dist(0, spec.coldKeys - 1);
+                key = makeKey(SYNTHETIC_TAG, 0, 0, index >> KeyLayout::F3_BITS, index);
+            } while (!used.insert(key).second);
+            return key;
+        }
+
+        static TPCCTransaction::Ptr makeTransaction(const SyntheticSpec& spec, loom::Random& random, size_t layer, KeySet& used) {
+            // 只使用事务的读写集与子事务结构, 与 TPCC 状态无关
+            auto tx = std::make_shared<TPCCTransaction>(random);
+            tx->setExecutionTime(random.uniform_dist(1, 10));
+            for (size_t i = 0; i < spec.reads; i++) {
+                tx->addReadRow(drawKey(spec, random, used));
+            }
+            for (size_t i = 0; i < spec.writes; i++) {
+                auto key = drawKey(spec, random, used);
+                tx->addReadRow(key);
+                tx->addUpdateRow(key);
+            }
+            if (layer < spec.depth) {
+                for (size_t i = 0; i < spec.fanout; i++) {
+                    auto dependency = random.uniform_dist(0, 1) ? loom::DependencyType::STRONG : loom::DependencyType::WEAK;
+                    tx->addChild(makeTransaction(spec, random, layer + 1, used), dependency);
+                }
+            }
+            return tx;
+        }
+};
+
+}
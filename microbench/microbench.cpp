@@ -0,0 +1,274 @@
+/***************************
+@File: microbench.cpp
+@Desc:
+    1. 单独测量 Loom 的热点内核: 构图(onRWCNoEdge)、强连通分量识别(onWarm2SCC)、
+       回滚选择(GreedySelectVertexNoEdge)、重调度(buildAndReSchedule 及其并行版本)、预留写(LoomTable::ReservePut)与冲突判断(hasConflict)
+    2. 参数: txs 区块事务数, depth 嵌套深度, hot 热键访问百分比, threads 线程池线程数
+    3. 每次迭代前在计时外重置并重建内核的输入, 只计时内核本身
+    4. 未指定 --benchmark_out 时结果同时以 JSON 写入 microbench.json, 可用 Google Benchmark 的 compare.py 对比两次结果
+***************************/
+#include <benchmark/benchmark.h>
+#include <glog/logging.h>
+#include <algorithm>
+#include <map>
+#include <string_view>
+#include <tuple>
+#include <loom/microbench/SyntheticBlock.h>
+#include <loom/protocol/loom/MinWRollback.h>
+#include <loom/protocol/loom/DeterReExecute.h>
+#include <loom/protocol/loom/Loom.h>
+
+namespace loom {
+    size_t BLOCK_SIZE = 1000;
+};
+
+namespace TPCC {
+    size_t N_WAREHOUSES = 1;
+};
+
+using namespace loom;
+
+namespace {
+
+/// @brief 按 (txs, depth, hot) 缓存合成区块, 各线程数的测量共用同一区块
+Block::Ptr blockFor(const benchmark::State& state) {
+    static std::map<std::tuple<int64_t, int64_t, int64_t>, Block::Ptr> blocks;
+    auto& block = blocks[{state.range(0), state.range(1), state.range(2)}];
+    if (!block) {
+        SyntheticSpec spec;
+        spec.txs = state.range(0);
+        spec.depth = state.range(1);
+        spec.hot = state.range(2) / 100.0;
+        block = SyntheticBlock::generate(spec);
+    }
+    block->resetGraph();
+    return block;
+}
+
+/// @brief 在区块上构建冲突图
+void buildGraph(const Block::Ptr& block, MinWRollback& minw, ThreadPool::Ptr& pool) {
+    std::vector<std::future<void>> futures;
+    minw.setRWEdges(block->getRWEdges());
+    minw.buildGraphNoEdgeC(pool, futures);
+}
+
+/// @brief 构图、识别scc并逐个回滚, 得到重执行的输入
+void rollbackBlock(const Block::Ptr& block, ThreadPool::Ptr& pool, size_t threads, vector<Vertex::Ptr>& rbList, vector<vector<int>>& serialOrders) {
+    MinWRollback minw(block->getTxList(), block->getRWIndex(), threads);
+    buildGraph(block, minw, pool);
+    minw.onWarm2SCC(pool);
+    unordered_set<Vertex::Ptr, Vertex::VertexHash> added;
+    for (auto& scc : minw.m_sccs) {
+        auto reExecuteInfo = minw.rollbackNoEdge(scc, true);
+        MinWRollback::appendRollback(reExecuteInfo, rbList, serialOrders, added);
+    }
+    for (auto& tx : rbList) {
+        tx->m_hyperVertex->m_aborted = true;
+    }
+}
+
+void BM_onRWCNoEdge(benchmark::State& state) {
+    auto block = blockFor(state);
+    size_t threads = state.range(3);
+    auto pool = std::make_shared<ThreadPool>(threads);
+    for (auto _ : state) {
+        state.PauseTiming();
+        block->resetGraph();
+        MinWRollback minw(block->getTxList(), block->getRWIndex(), threads);
+        state.ResumeTiming();
+        buildGraph(block, minw, pool);
+    }
+    state.counters["edges"] = block->getRWEdges().size();
+    state.SetItemsProcessed(state.iterations() * block->getRWEdges().size());
+}
+
+void BM_onWarm2SCC(benchmark::State& state) {
+    auto block = blockFor(state);
+    size_t threads = state.range(3);
+    auto pool = std::make_shared<ThreadPool>(threads);
+    // 识别scc不修改冲突图, 只需构图一次
+    MinWRollback graph(block->getTxList(), block->getRWIndex(), threads);
+    buildGraph(block, graph, pool);
+    size_t sccs = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        MinWRollback minw(block->getTxList(), block->getRWIndex(), threads);
+        state.ResumeTiming();
+        minw.onWarm2SCC(pool);
+        sccs = minw.m_sccs.size();
+    }
+    state.counters["sccs"] = sccs;
+    state.SetItemsProcessed(state.iterations() * block->getTxList().size());
+}
+
+void BM_GreedySelectVertexNoEdge(benchmark::State& state) {
+    auto block = blockFor(state);
+    size_t threads = state.range(3);
+    auto pool = std::make_shared<ThreadPool>(threads);
+    size_t rollbacks = 0;
+    for (auto _ : state) {
+        // 回滚选择会修改图与scc, 每次迭代重建; 与 Loom 相同地按scc并行选择
+        state.PauseTiming();
+        block->resetGraph();
+        MinWRollback minw(block->getTxList(), block->getRWIndex(), threads);
+        buildGraph(block, minw, pool);
+        minw.onWarm2SCC(pool);
+        std::vector<set<HyperVertex::Ptr, loom::cmp>> pqs(minw.m_sccs.size());
+        std::vector<unordered_set<Vertex::Ptr, Vertex::VertexHash>> results(minw.m_sccs.size());
+        for (size_t i = 0; i < minw.m_sccs.size(); i++) {
+            minw.calculateHyperVertexWeightNoEdge(minw.m_sccs[i], pqs[i]);
+        }
+        state.ResumeTiming();
+        pool->parallelFor(0, minw.m_sccs.size(), 1, [&](size_t lo, size_t hi) {
+            for (size_t i = lo; i < hi; i++) {
+                vector<int> queueOrder;
+                stack<int> stackOrder;
+                minw.GreedySelectVertexNoEdge(minw.m_sccs[i], pqs[i], results[i], queueOrder, stackOrder, true);
+            }
+        });
+        state.PauseTiming();
+        rollbacks = 0;
+        for (auto& result : results) {rollbacks += result.size();}
+        state.ResumeTiming();
+    }
+    state.counters["rollbacks"] = rollbacks;
+    state.SetItemsProcessed(state.iterations() * block->getTxList().size());
+}
+
+void BM_buildAndReSchedule(benchmark::State& state) {
+    auto block = blockFor(state);
+    size_t threads = state.range(3);
+    auto pool = std::make_shared<ThreadPool>(threads);
+    size_t rollbacks = 0;
+    for (auto _ : state) {
+        // 重调度修改节点的调度时间, 每次迭代重新回滚得到输入
+        state.PauseTiming();
+        block->resetGraph();
+        vector<Vertex::Ptr> rbList;
+        vector<vector<int>> serialOrders;
+        rollbackBlock(block, pool, threads, rbList, serialOrders);
+        rollbacks = rbList.size();
+        state.ResumeTiming();
+        DeterReExecute reExecute(rbList, serialOrders, block->getConflictIndex());
+        reExecute.buildAndReSchedule();
+    }
+    state.counters["rollbacks"] = rollbacks;
+    state.SetItemsProcessed(state.iterations() * rollbacks);
+}
+
+void BM_buildAndReScheduleParallel(benchmark::State& state) {
+    auto block = blockFor(state);
+    size_t threads = state.range(3);
+    auto pool = std::make_shared<ThreadPool>(threads);
+    size_t rollbacks = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        block->resetGraph();
+        vector<Vertex::Ptr> rbList;
+        vector<vector<int>> serialOrders;
+        rollbackBlock(block, pool, threads, rbList, serialOrders);
+        rollbacks = rbList.size();
+        state.ResumeTiming();
+        DeterReExecute reExecute(rbList, serialOrders, block->getConflictIndex());
+        reExecute.buildAndReScheduleParallel(true, pool);
+    }
+    state.counters["rollbacks"] = rollbacks;
+    state.SetItemsProcessed(state.iterations() * rollbacks);
+}
+
+void BM_ReservePut(benchmark::State& state) {
+    auto block = blockFor(state);
+    size_t threads = state.range(3);
+    auto pool = std::make_shared<ThreadPool>(threads);
+    std::unique_ptr<LoomTable> table;
+    vector<shared_ptr<LoomTransaction>> batch;
+    size_t puts = 0;
+    for (auto& tx : block->getTxs()) {
+        batch.emplace_back(make_shared<LoomTransaction>(Transaction(*tx), batch.size() + 1, block->getBlockId()));
+        puts += tx->GetTx()->m_rootVertex->allWriteSet.size();
+    }
+    for (auto _ : state) {
+        // 每次迭代从空表开始, 否则之后的迭代只是覆盖已有的预留
+        state.PauseTiming();
+        table.reset();
+        table = std::make_unique<LoomTable>(9973);
+        state.ResumeTiming();
+        pool->parallelFor(0, batch.size(), 0, [&](size_t lo, size_t hi) {
+            for (size_t i = lo; i < hi; i++) {
+                for (auto& key : batch[i]->GetTx()->m_rootVertex->allWriteSet) {
+                    table->ReservePut(batch[i], key);
+                }
+            }
+        });
+    }
+    state.counters["puts"] = puts;
+    state.SetItemsProcessed(state.iterations() * puts);
+}
+
+void BM_hasConflict(benchmark::State& state) {
+    auto block = blockFor(state);
+    size_t threads = state.range(3);
+    auto pool = std::make_shared<ThreadPool>(threads);
+    // 每个事务与其后 WINDOW 个事务比较写集与读集
+    static constexpr size_t WINDOW = 16;
+    auto& txList = block->getTxList();
+    std::atomic<size_t> conflicts{0};
+    for (auto _ : state) {
+        conflicts.store(0, std::memory_order_relaxed);
+        pool->parallelFor(0, txList.size(), 0, [&](size_t lo, size_t hi) {
+            size_t count = 0;
+            for (size_t i = lo; i < hi; i++) {
+                auto& writeSet = txList[i]->m_rootVertex->allWriteSet;
+                for (size_t j = i + 1; j < std::min(txList.size(), i + 1 + WINDOW); j++) {
+                    count += loom::hasConflict(writeSet, txList[j]->m_rootVertex->allReadSet);
+                }
+            }
+            conflicts.fetch_add(count, std::memory_order_relaxed);
+        });
+        benchmark::DoNotOptimize(conflicts);
+    }
+    state.counters["conflicts"] = conflicts.load();
+    state.SetItemsProcessed(state.iterations() * txList.size() * WINDOW);
+}
+
+/// @brief 区块形状 × 线程数
+void shapes(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"txs", "depth", "hot", "threads"})
+     ->ArgsProduct({{1000, 4000}, {1, 3}, {2, 20}, {1, 4, 16}})
+     ->UseRealTime()
+     ->Unit(benchmark::kMicrosecond);
+}
+
+/// @brief 串行内核只测区块形状, 线程池只用于准备输入
+void serialShapes(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"txs", "depth", "hot", "threads"})
+     ->ArgsProduct({{1000, 4000}, {1, 3}, {2, 20}, {4}})
+     ->Unit(benchmark::kMicrosecond);
+}
+
+}
+
+BENCHMARK(BM_onRWCNoEdge)->Apply(shapes);
+BENCHMARK(BM_onWarm2SCC)->Apply(shapes);
+BENCHMARK(BM_GreedySelectVertexNoEdge)->Apply(shapes);
+BENCHMARK(BM_buildAndReSchedule)->Apply(serialShapes);
+BENCHMARK(BM_buildAndReScheduleParallel)->Apply(shapes);
+BENCHMARK(BM_ReservePut)->Apply(shapes);
+BENCHMARK(BM_hasConflict)->Apply(shapes);
+
+int main(int argc, char** argv) {
+    google::InitGoogleLogging(argv[0]);
+    // 默认把结果同时写成 JSON, 便于逐次对比
+    std::vector<char*> args(argv, argv + argc);
+    std::string out = "--benchmark_out=microbench.json", format = "--benchmark_out_format=json";
+    if (std::none_of(args.begin(), args.end(), [](char* arg) {return std::string_view(arg).starts_with("--benchmark_out=");})) {
+        args.push_back(out.data());
+        args.push_back(format.data());
+    }
+    int count = args.size();
+    benchmark::Initialize(&count, args.data());
+    if (benchmark::ReportUnrecognizedArguments(count, args.data())) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -6,69 +6,77 @@
 
 
 #define T loom::AriaTransaction
-#define K std::string
+#define K loom::Key
 
 using namespace std::chrono;
 
 /// @brief initialize aria protocol
-/// @param blocks the blocks to be executed
+/// @param source the source to pull blocks from
 /// @param num_threads the number of threads in thread pool
 /// @param enable_reordering the flag of reordering
 /// @param table_partitions the number of partitions in table
 Aria::Aria(
-    vector<Block::Ptr> blocks, Statistics& statistics, 
+    BlockSource::Ptr source, Statistics& statistics, 
     size_t num_threads, size_t table_partitions, bool enable_reordering
 ):
-    blocks(blocks),
     statistics(statistics),
+    source(std::move(source)),
+    feed(this->source, num_threads, [this](auto& block, auto batch_id) { return SplitBlock(block, batch_id); }),
     barrier(num_threads, []{ LOG(INFO) << "batch complete" << std::endl; }),
     table{table_partitions},
     lock_table{table_partitions},
     enable_reordering{enable_reordering},
     num_threads{num_threads}
 {
+    auto keys = this->source->keyHint();
+    this->table.Reserve(keys);
+    this->lock_table.Reserve(keys);
     LOG(INFO) << fmt::format("Aria(num_threads={}, table_partitions={}, enable_reordering={})", num_threads, table_partitions, enable_reordering) << std::endl;
 }
 
-/// @brief start aria protocol
-void Aria::Start() {
-    LOG(INFO) << "aria start";
-    
-    // split blocks into batches
-    vector<vector<vector<T>>> batches;
-    for (size_t i = 0; i < blocks.size(); ++i) {
-        auto& block = blocks[i];
-        auto& txs = block->getTxs();
-        // calculate the number of transactions per thread
-        // auto tx_per_thread = (txs.size() + num_threads - 1) / num_threads;
-        auto tx_per_thread = 1;
-        size_t index = 0;
-        vector<vector<T>> batch;
-        size_t batch_id = i + 1;
-        batch.resize(num_threads);
-        // get all batch of one block
-        for (size_t j = 0; j < txs.size(); j += tx_per_thread) {
-            size_t batch_idx = index % num_threads;
-            for (size_t k = 0; k < tx_per_thread && j + k < txs.size(); ++k) {
-                auto tx = txs[j + k];
-                size_t txid = tx->GetTx()->m_hyperId;
-                Transaction tx_inner = *tx;
-                batch[batch_idx].emplace_back(std::move(tx_inner), txid, batch_id);
-            }
-            index++;
+/// @brief initialize aria protocol with pre-generated blocks
+/// @param blocks the blocks to be executed
+Aria::Aria(
+    vector<Block::Ptr> blocks, Statistics& statistics, 
+    size_t num_threads, size_t table_partitions, bool enable_reordering
+):
+    Aria(make_shared<VectorBlockSource>(std::move(blocks)), statistics, num_threads, table_partitions, enable_reordering)
+{}
+
+/// @brief split one block into per-thread batches
+/// @param block the block pulled from source
+/// @param batch_id the batch id of this block, starts from 1
+/// @return transactions of each thread
+vector<vector<T>> Aria::SplitBlock(const Block::Ptr& block, size_t batch_id) {
+    auto& txs = block->getTxs();
+    // calculate the number of transactions per thread
+    // auto tx_per_thread = (txs.size() + num_threads - 1) / num_threads;
+    auto tx_per_thread = 1;
+    size_t index = 0;
+    vector<vector<T>> batch;
+    batch.resize(num_threads);
+    // get all batch of one block
+    for (size_t j = 0; j < txs.size(); j += tx_per_thread) {
+        size_t batch_idx = index % num_threads;
+        for (size_t k = 0; k < tx_per_thread && j + k < txs.size(); ++k) {
+            auto tx = txs[j + k];
+            size_t txid = tx->GetTx()->m_hyperId;
+            Transaction tx_inner = *tx;
+            batch[batch_idx].emplace_back(std::move(tx_inner), txid, batch_id);
         }
-        // store block batch
-        batches.push_back(std::move(batch));
-        statistics.JournalBlock();
+        index++;
     }
+    statistics.JournalBlock();
+    return batch;
+}
 
+/// @brief start aria protocol
+void Aria::Start() {
+    LOG(INFO) << "aria start";
+    // workers pull blocks from source round by round
     for (size_t i = 0; i < num_threads; ++i) {
-        vector<vector<T>> thread_batches;
-        for (size_t j = 0; j < blocks.size(); ++j) {
-            thread_batches.push_back(std::move(batches[j][i]));
-        }
-        workers.push_back(std::thread([this, i, thread_batches]() {
-            AriaExecutor(*this, i, std::move(thread_batches)).Run();
+        workers.push_back(std::thread([this, i]() {
+            AriaExecutor(*this, i).Run();
         }));
         ThreadPool::PinRoundRobin(workers[i], i);
     }
@@ -77,6 +85,7 @@ void Aria::Start() {
 /// @brief stop aria protocol
 void Aria::Stop() {
     stop_flag.store(true);
+    source->close();
     for (size_t i = 0; i < num_threads; ++i) {
         workers[i].join();
     }
@@ -92,8 +101,8 @@ AriaTransaction::AriaTransaction(
     batch_id{batch_id}
 {
     // initial readSet and writeSet empty
-    local_get = std::unordered_map<string, string>();
-    local_put = std::unordered_map<string, string>();
+    local_get = std::unordered_map<Key, string>();
+    local_put = std::unordered_map<Key, string>();
 }
 
 /// @brief move constructor for AriaTransaction
@@ -188,9 +197,9 @@ AriaLockTable::AriaLockTable(size_t partitions):
 
 /// @brief initialize an aria executor
 /// @param aria the aria configuration object
-AriaExecutor::AriaExecutor(Aria& aria, size_t worker_id, vector<vector<T>> batchTxs):
-    batchTxs(std::move(batchTxs)),
+AriaExecutor::AriaExecutor(Aria& aria, size_t worker_id):
     statistics{aria.statistics},
+    feed{aria.feed},
     table{aria.table},
     lock_table{aria.lock_table},
     enable_reordering{aria.enable_reordering},
@@ -205,16 +214,21 @@ AriaExecutor::AriaExecutor(Aria& aria, size_t worker_id, vector<vector<T>> batch
 
 /// @brief run transactions
 void AriaExecutor::Run() {
-    for (auto& batch : batchTxs) {
+    // hardware counters of this worker, barrier waits are excluded
+    PerfSampler perf(statistics, PerfSampler::Scope::THREAD);
+    for (size_t round = 0; ; ++round) {
         #define LATENCY duration_cast<microseconds>(steady_clock::now() - tx.start_time).count()
         #define PHASE_TIME duration_cast<microseconds>(steady_clock::now() - begin_time).count()
         // stage 1: execute
+        vector<T> batch;
+        auto block = feed.next(round, worker_id, batch);
         auto _stop = confirm_exit.load() == num_threads;
         barrier.arrive_and_wait();
-        if (_stop) {return;}
+        if (_stop || !block) {return;}
         if (stop_flag.load()) { confirm_exit.compare_exchange_weak(worker_id, worker_id + 1);}
         has_conflict.store(false);
         DLOG(INFO) << "worker " << worker_id << " executing" << std::endl;
+        perf.Restart();
         for (auto& tx : batch) {
             // record start time
             tx.start_time = steady_clock::now();
@@ -225,11 +239,13 @@ void AriaExecutor::Run() {
             statistics.JournalExecute();
             statistics.JournalOverheads(tx.CountOverheads());
         }
+        perf.Journal("aria execute");
         // stage 2: verify + commit
         barrier.arrive_and_wait();
         DLOG(INFO) << "worker " << worker_id << " verifying" << std::endl;
         time_point<steady_clock> begin_time;
         if (worker_id == 0) begin_time = steady_clock::now();
+        perf.Restart();
         for (auto& tx : batch) {
             this->Verify(&tx);
             if (tx.flag_conflict) {
@@ -240,6 +256,7 @@ void AriaExecutor::Run() {
                 statistics.JournalCommit(LATENCY);
             }
         }
+        perf.Journal("aria verify");
         // stage 3: fallback
         barrier.arrive_and_wait();
         if (worker_id == 0) statistics.JournalRollbackExecution(PHASE_TIME);
@@ -248,6 +265,7 @@ void AriaExecutor::Run() {
         if (!has_conflict.load()) {
             continue;
         }
+        perf.Restart();
         for (auto& tx : batch) {
             if (tx.flag_conflict) {
                 this->Fallback(&tx);
@@ -256,13 +274,16 @@ void AriaExecutor::Run() {
                 statistics.JournalRollback(tx.CountOverheads());
             }
         }
+        perf.Journal("aria fallback");
         // stage 4: clean up
         barrier.arrive_and_wait();
         if (worker_id == 0) statistics.JournalReExecution(PHASE_TIME);
         DLOG(INFO) << "worker " << worker_id << " cleaning up" << std::endl;
+        perf.Restart();
         for (auto& tx : batch) {
             this->CleanLockTable(&tx);
         }
+        perf.Journal("aria clean up");
         #undef LATENCY
         #undef PHASE_TIME
     }
@@ -274,11 +295,11 @@ void AriaExecutor::Run() {
 void AriaExecutor::Execute(T* tx) {
     // read from the public table
     tx->InstallGetStorageHandler([&](
-        const std::unordered_set<string>& readSet
+        const KeySet& readSet
     ) {
         string keys;
         for (auto& key : readSet) {
-            keys += key + " ";
+            keys += keyToString(key) + " ";
             string value;
             table.Put(key, [&](auto& entry){
                 value = entry.value;
@@ -289,12 +310,12 @@ void AriaExecutor::Execute(T* tx) {
     });
     // write locally to local storage
     tx->InstallSetStorageHandler([&](
-        const std::unordered_set<string>& writeSet,
+        const KeySet& writeSet,
         const std::string& value
     ) {
         string keys;
         for (auto& key : writeSet) {
-            keys += key + " ";
+            keys += keyToString(key) + " ";
             tx->local_put[key] = value;
         }
         DLOG(INFO) << "tx " << tx->id << " write: " << keys << std::endl;
@@ -380,11 +401,11 @@ void AriaExecutor::PrepareLockTable(T* tx) {
 void AriaExecutor::Fallback(T* tx) {
     // read from the public table
     tx->InstallGetStorageHandler([&](
-        const std::unordered_set<string>& readSet
+        const KeySet& readSet
     ) {
         string keys;
         for (auto& key : readSet) {
-            keys += key + " ";
+            keys += keyToString(key) + " ";
             string value;
             table.Get(key, [&](auto& entry){
                 value = entry.value;
@@ -395,12 +416,12 @@ void AriaExecutor::Fallback(T* tx) {
     });
     // write directly into the public table
     tx->InstallSetStorageHandler([&](
-        const std::unordered_set<string>& writeSet,
+        const KeySet& writeSet,
         const std::string& value
     ) {
         string keys;
         for (auto& key : writeSet) {
-            keys += key + " ";
+            keys += keyToString(key) + " ";
             table.Put(key, [&](auto& entry){
                 entry.value = value;
             });
@@ -7,6 +7,7 @@
 #include <loom/utils/Ulock.h>
 #include <loom/protocol/common.h>
 #include <loom/common/Block.h>
+#include <loom/common/BlockSource.h>
 #include <loom/common/Transaction.h>
 #include <loom/utils/Statistic/Statistics.h>
 
@@ -14,7 +15,7 @@ using namespace std;
 
 namespace loom {
 
-#define K std::string
+#define K loom::Key
 #define T AriaTransaction
 
 /// @brief aria tranaction with local read and write set.
@@ -24,13 +25,17 @@ struct AriaTransaction: public Transaction {
     bool        flag_conflict{false};
     std::atomic<bool>   committed{false};
     std::chrono::time_point<std::chrono::steady_clock> start_time;
-    std::unordered_map<string, string> local_get;
-    std::unordered_map<string, string> local_put;
+    std::unordered_map<Key, string> local_get;
+    std::unordered_map<Key, string> local_put;
     AriaTransaction(Transaction&& inner, size_t id, size_t batch_id);
     AriaTransaction(AriaTransaction&& tx) noexcept; // move constructor
     AriaTransaction(const AriaTransaction& other); // copy constructor
 };
 
+#ifndef ARIA_TABLE_KIND
+#define ARIA_TABLE_KIND TableKind::FLAT
+#endif
+
 /// @brief aria table entry for first round execution
 struct AriaEntry {
     string  value           = "";
@@ -41,7 +46,7 @@ struct AriaEntry {
 };
 
 /// @brief aria table for first round execution
-struct AriaTable: public Table<K, AriaEntry, KeyHasher> {
+struct AriaTable: public Table<K, AriaEntry, KeyHasher, ARIA_TABLE_KIND> {
     void ReserveGet(T* tx, const K& k);
     void ReservePut(T* tx, const K& k);
     bool CompareReservedGet(T* tx, const K& k);
@@ -55,7 +60,7 @@ struct AriaLockEntry {
 };
 
 /// @brief aria table for fallback pessimistic execution
-struct AriaLockTable: public Table<K, AriaLockEntry, KeyHasher> {
+struct AriaLockTable: public Table<K, AriaLockEntry, KeyHasher, ARIA_TABLE_KIND> {
     AriaLockTable(size_t partitions);
 };
 
@@ -63,13 +68,17 @@ struct AriaLockTable: public Table<K, AriaLockEntry, KeyHasher> {
 class Aria: public Protocol {
 
 public:
+    Aria(BlockSource::Ptr source, Statistics& statistics, size_t num_threads, size_t table_partitions = 1, bool enable_reordering = true);
     Aria(vector<Block::Ptr> blocks, Statistics& statistics, size_t num_threads, size_t table_partitions = 1, bool enable_reordering = true);
     void Start() override;
     void Stop() override;
 
 private:
+    vector<vector<T>> SplitBlock(const Block::Ptr& block, size_t batch_id);
+
     Statistics&                             statistics;
-    vector<Block::Ptr>                      blocks;
+    BlockSource::Ptr                        source;
+    BatchFeed<T>                            feed;
     AriaTable                               table;
     AriaLockTable                           lock_table;
     bool                                    enable_reordering;
@@ -87,7 +96,7 @@ private:
 class AriaExecutor {
 
 public:
-    AriaExecutor(Aria& aria, size_t worker_id, vector<vector<T>> batchTxs);
+    AriaExecutor(Aria& aria, size_t worker_id);
     void Run();
     void Execute(T* tx);
     void Reserve(T* tx);
@@ -99,7 +108,7 @@ public:
 
 private:
     Statistics&                             statistics;
-    vector<vector<T>>                       batchTxs;
+    BatchFeed<T>&                           feed;
     AriaTable&                              table;
     AriaLockTable&                          lock_table;
     bool                                    enable_reordering;
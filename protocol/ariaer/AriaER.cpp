@@ -6,7 +6,7 @@
 
 
 #define T loom::AriaERTransaction
-#define K std::string
+#define K loom::Key
 
 using namespace std::chrono;
 
@@ -27,6 +27,8 @@ AriaER::AriaER(
     enable_reordering{enable_reordering},
     num_threads{num_threads}
 {
+    this->table.Reserve(Block::countKeys(this->blocks));
+    this->lock_table.Reserve(Block::countKeys(this->blocks));
     LOG(INFO) << fmt::format("AriaER(num_threads={}, table_partitions={}, enable_reordering={})", num_threads, table_partitions, enable_reordering) << std::endl;
 }
 
@@ -93,8 +95,8 @@ AriaERTransaction::AriaERTransaction(
     batch_id{batch_id}
 {
     // initial readSet and writeSet empty
-    local_get = std::unordered_map<string, string>();
-    local_put = std::unordered_map<string, string>();
+    local_get = std::unordered_map<Key, string>();
+    local_put = std::unordered_map<Key, string>();
 }
 
 /// @brief move constructor for AriaERTransaction
@@ -317,11 +319,11 @@ void AriaERExecutor::Run() {
 void AriaERExecutor::Execute(T* tx) {
     // read from the public table
     tx->InstallGetStorageHandler([&](
-        const std::unordered_set<string>& readSet
+        const KeySet& readSet
     ) {
         string keys;
         for (auto& key : readSet) {
-            keys += key + " ";
+            keys += keyToString(key) + " ";
             string value;
             table.Put(key, [&](auto& entry){
                 value = entry.value;
@@ -332,12 +334,12 @@ void AriaERExecutor::Execute(T* tx) {
     });
     // write locally to local storage
     tx->InstallSetStorageHandler([&](
-        const std::unordered_set<string>& writeSet,
+        const KeySet& writeSet,
         const std::string& value
     ) {
         string keys;
         for (auto& key : writeSet) {
-            keys += key + " ";
+            keys += keyToString(key) + " ";
             tx->local_put[key] = value;
         }
         DLOG(INFO) << "tx " << tx->id << " write: " << keys << std::endl;
@@ -448,11 +450,11 @@ void AriaERExecutor::PrepareLockTable(T* tx) {
 void AriaERExecutor::Fallback(T* tx) {
     // read from the public table
     tx->InstallGetStorageHandler([&](
-        const std::unordered_set<string>& readSet
+        const KeySet& readSet
     ) {
         string keys;
         for (auto& key : readSet) {
-            keys += key + " ";
+            keys += keyToString(key) + " ";
             string value;
             table.Get(key, [&](auto& entry){
                 value = entry.value;
@@ -463,12 +465,12 @@ void AriaERExecutor::Fallback(T* tx) {
     });
     // write directly into the public table
     tx->InstallSetStorageHandler([&](
-        const std::unordered_set<string>& writeSet,
+        const KeySet& writeSet,
         const std::string& value
     ) {
         string keys;
         for (auto& key : writeSet) {
-            keys += key + " ";
+            keys += keyToString(key) + " ";
             table.Put(key, [&](auto& entry){
                 entry.value = value;
             });
@@ -14,7 +14,7 @@ using namespace std;
 
 namespace loom {
 
-#define K std::string
+#define K loom::Key
 #define T AriaERTransaction
 
 /// @brief ariaER tranaction with local read and write set.
@@ -24,13 +24,17 @@ struct AriaERTransaction: public Transaction {
     bool        flag_conflict{false};
     std::atomic<bool>   committed{false};
     std::chrono::time_point<std::chrono::steady_clock> start_time;
-    std::unordered_map<string, string> local_get;
-    std::unordered_map<string, string> local_put;
+    std::unordered_map<Key, string> local_get;
+    std::unordered_map<Key, string> local_put;
     AriaERTransaction(Transaction&& inner, size_t id, size_t batch_id);
     AriaERTransaction(AriaERTransaction&& tx) noexcept; // move constructor
     AriaERTransaction(const AriaERTransaction& other); // copy constructor
 };
 
+#ifndef ARIAER_TABLE_KIND
+#define ARIAER_TABLE_KIND TableKind::FLAT
+#endif
+
 /// @brief ariaER table entry for first round execution
 struct AriaEREntry {
     string  value           = "";
@@ -41,7 +45,7 @@ struct AriaEREntry {
 };
 
 /// @brief ariaER table for first round execution
-struct AriaERTable: public Table<K, AriaEREntry, KeyHasher> {
+struct AriaERTable: public Table<K, AriaEREntry, KeyHasher, ARIAER_TABLE_KIND> {
     void ReserveGet(T* tx, const K& k);
     void ReservePut(T* tx, const K& k);
     void ReservePutAgain(T* tx, const K& k, const std::vector<bool>& abortList);
@@ -56,7 +60,7 @@ struct AriaERLockEntry {
 };
 
 /// @brief ariaER table for fallback pessimistic execution
-struct AriaERLockTable: public Table<K, AriaERLockEntry, KeyHasher> {
+struct AriaERLockTable: public Table<K, AriaERLockEntry, KeyHasher, ARIAER_TABLE_KIND> {
     AriaERLockTable(size_t partitions);
 };
 
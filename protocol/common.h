@@ -4,6 +4,7 @@
 #include <atomic>
 #include <unordered_set>
 #include <chrono>
+#include <loom/common/KeySet.h>
 
 namespace loom {
     class Protocol {
@@ -13,39 +14,44 @@ namespace loom {
         virtual ~Protocol() = default;
     };
 
+    // 整数键哈希(splitmix64 finalizer), 保证高位的表标签也参与分区
     struct KeyHasher {
-        size_t operator()(const std::string& key) const {
-            size_t h = 0;
-            for (char c : key) {
-                h ^= std::hash<char>{}(c) + 0x9e3779b9 + (h << 6) + (h >> 2);
-            }
+        size_t operator()(const Key& key) const {
+            uint64_t h = key;
+            h ^= h >> 30; h *= 0xbf58476d1ce4e5b9ULL;
+            h ^= h >> 27; h *= 0x94d049bb133111ebULL;
+            h ^= h >> 31;
             return h;
         }
     };
 
-    // 判断两个set是否有交集
+    // 判断两个set是否有交集, 遍历较小的集合并在较大的集合中查找
     template <typename T, typename Hash>
     bool hasIntersection(const tbb::concurrent_unordered_set<T, Hash>& set1, const tbb::concurrent_unordered_set<T, Hash>& set2) {
-        // for (const auto& item : set1) {
-        //     if (set2.find(item) != set2.end()) {
-        //         return true;
-        //     }
-        // }
-        // return false;
-
-        std::atomic<bool> found(false);
-
-        tbb::parallel_for(tbb::blocked_range<size_t>(0, set2.size()), [&](const tbb::blocked_range<size_t>& r) {
-            for (size_t i = r.begin(); i != r.end() && !found; ++i) {
-                auto it = set2.begin();
-                std::advance(it, i);
-                if (set1.find(*it) != set1.end()) {
-                    found = true;
-                }
+        const auto& small = set1.size() <= set2.size() ? set1 : set2;
+        const auto& large = set1.size() <= set2.size() ? set2 : set1;
+        for (const auto& item : small) {
+            if (large.find(item) != large.end()) {
+                return true;
             }
-        });
+        }
+        return false;
+    }
+
+    // 判断有序集合(如超边的子事务集合)与set是否有交集
+    template <typename Range, typename T, typename Hash>
+    bool hasIntersection(const Range& range, const tbb::concurrent_unordered_set<T, Hash>& set) {
+        for (const auto& item : range) {
+            if (set.find(item) != set.end()) {
+                return true;
+            }
+        }
+        return false;
+    }
 
-        return found;
+    // 判断两个读写集是否冲突
+    inline bool hasConflict(const KeySet& set1, const KeySet& set2) {
+        return loom::intersects(set1, set2);
     }
 
     // 判断两个set是否有交集-无hash版（读写集是否冲突）
@@ -86,6 +92,10 @@ namespace loom {
     }
 
     // 判断set1是否包含set2
+    inline bool hasContain(const KeySet& set1, const KeySet& set2) {
+        return loom::contains(set1, set2);
+    }
+
     template <typename T, typename Hash>
     bool hasContain(const tbb::concurrent_unordered_set<T, Hash>& set1, const tbb::concurrent_unordered_set<T, Hash>& set2) {
         if (set1.size() < set2.size()) {
@@ -157,8 +167,8 @@ namespace loom {
         return true;
     }
 
-    template <typename T>
-    bool hasContain(const std::unordered_map<T, T>& map, const std::unordered_set<T>& set) {
+    template <typename T, typename U>
+    bool hasContain(const std::unordered_map<T, U>& map, const std::unordered_set<T>& set) {
         for (const auto& pair : map) {
             if (set.find(pair.first) != set.end()) {
                 return true;
@@ -168,24 +178,22 @@ namespace loom {
     }
 
     // 比较两个set是否相等
+    inline bool areEqual(const KeySet& set1, const KeySet& set2) {
+        return set1 == set2;
+    }
+
     template <typename T, typename Hash>
     bool areEqual(const tbb::concurrent_unordered_set<T, Hash>& set1,
                 const tbb::concurrent_unordered_set<T, Hash>& set2) {
         if (set1.size() != set2.size()) {
             return false;
         }
-
-        tbb::atomic<bool> result = true;
-
-        tbb::parallel_for_each(set1.begin(), set1.end(),
-            [&](const T& vertex) {
-                if (set2.find(vertex) == set2.end()) {
-                    result = false;
-                }
+        for (const auto& item : set1) {
+            if (set2.find(item) == set2.end()) {
+                return false;
             }
-        );
-
-        return result;
+        }
+        return true;
     }
 
     // 计算两个集合的差集
@@ -51,5 +51,5 @@ class FabricPP {
         vector<set<Vertex::Ptr, Vertex::VertexCompare>> m_cycles;   
         int testCounter = 0; 
         // 建立倒排索引
-        std::unordered_map<string, loom::RWSets<Vertex::Ptr>> m_invertedIndex;
+        std::unordered_map<Key, loom::RWSets<Vertex::Ptr>> m_invertedIndex;
 };
\ No newline at end of file
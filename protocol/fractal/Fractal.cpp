@@ -5,7 +5,7 @@
 
 using namespace std::chrono;
 
-#define K std::string
+#define K loom::Key
 #define V FractalEntry
 #define T FractalTransaction
 
@@ -24,6 +24,7 @@ Fractal::Fractal(
     table(table_partitions),
     pool(std::make_shared<ThreadPool>(num_threads))
 {
+    this->table.Reserve(Block::countKeys(this->blocks));
     LOG(INFO) << fmt::format("Fractal(num_threads={}, table_partitions={})", num_threads, table_partitions) << std::endl;
 }
 
@@ -32,12 +33,12 @@ void Fractal::Start() {
     // transform Transaction to FractalTransaction
     vector<vector<T>> m_blocks;
     for (size_t i = 0; i < blocks.size(); i++) {
-        auto txs = blocks[i]->getTxs();
+        auto& txs = blocks[i]->getTxs();
         vector<T> m_txs;
         for (size_t j = 0; j < txs.size(); j++) {
             auto tx = txs[j];
             auto txid = tx->GetTx()->m_hyperId;
-            m_txs.emplace_back(std::move(*tx), txid);
+            m_txs.emplace_back(Transaction(*tx), txid);
         }
         m_blocks.push_back(m_txs);
     }
@@ -87,13 +88,13 @@ void Fractal::Execute(T* tx) {
     // execute the transaction
     tx->start_time = steady_clock::now();
     tx->InstallGetStorageHandler([this, tx](
-        const std::unordered_set<string>& readSet
+        const KeySet& readSet
     ) {
         string keys;
         // no multi-version
         for (auto& key : readSet) {
             DLOG(INFO) << "tx " << tx->id << " read " << key << std::endl;
-            keys += key + " ";
+            keys += keyToString(key) + " ";
             string value;
             table.Get(tx, key, value);
             if (tx->flag_conflict.load()) { return; }
@@ -103,13 +104,13 @@ void Fractal::Execute(T* tx) {
     });
 
     tx->InstallSetStorageHandler([this, tx](
-        const std::unordered_set<string>& writeSet,
+        const KeySet& writeSet,
         const std::string& value
     ) {
         string keys;
         for (auto& key : writeSet) {
             DLOG(INFO) << "tx " << tx->id << " write " << key << std::endl;
-            keys += key + " ";
+            keys += keyToString(key) + " ";
             table.Put(tx, key, value);
             if (tx->flag_conflict.load()) { return; }
             tx->local_put[key] = value;
@@ -156,8 +157,8 @@ FractalTransaction::FractalTransaction(
     flag_conflict(false)
 {
     // initial readSet and writeSet empty
-    local_get = std::unordered_map<string, string>();
-    local_put = std::unordered_map<string, string>();
+    local_get = std::unordered_map<Key, string>();
+    local_put = std::unordered_map<Key, string>();
 }
 
 /// @brief move constructor for FractalTransaction
@@ -15,7 +15,7 @@ using namespace std;
 
 namespace loom {
 
-#define K std::string
+#define K loom::Key
 #define V FractalEntry
 #define T FractalTransaction
 
@@ -32,6 +32,10 @@ struct FractalTransaction: public Transaction {
     FractalTransaction(const FractalTransaction& other); // copy constructor
 };
 
+#ifndef FRACTAL_TABLE_KIND
+#define FRACTAL_TABLE_KIND TableKind::FLAT
+#endif
+
 /// @brief fractal table entry for execution
 struct FractalEntry {
     string value;
@@ -42,8 +46,9 @@ struct FractalEntry {
 };
 
 /// @brief fractal table for execution
-struct FractalTable: private Table<K, FractalEntry, KeyHasher> {
+struct FractalTable: private Table<K, FractalEntry, KeyHasher, FRACTAL_TABLE_KIND> {
     FractalTable(size_t partitions);
+    using Table::Reserve;
     void Get(T* tx, const K& k, std::string& v);
     void Put(T* tx, const K& k, const std::string& v);
     void RegretGet(T* tx, const K& k, size_t version);
@@ -6,69 +6,76 @@
 
 
 #define T loom::HarmonyTransaction
-#define K std::string
+#define K loom::Key
 
 using namespace std::chrono;
 
 /// @brief initialize harmony protocol
-/// @param workload an evm transaction workload
-/// @param batch_size batch size
+/// @param source the source to pull blocks from
 /// @param num_threads the number of threads in thread pool
 /// @param table_partitions the number of partitions in table
 Harmony::Harmony(
-    vector<Block::Ptr> blocks, Statistics& statistics,
+    BlockSource::Ptr source, Statistics& statistics,
     size_t num_threads, size_t table_partitions, bool enable_inter_block
 ):
-    blocks(blocks),
     statistics(statistics),
+    source(std::move(source)),
+    feed(this->source, num_threads, [this](auto& block, auto batch_id) { return SplitBlock(block, batch_id); }),
     barrier(num_threads, []{ LOG(INFO) << "batch complete" << std::endl; }),
     table{table_partitions},
     lock_table{table_partitions},
     enable_inter_block{enable_inter_block},
     num_threads{num_threads}
 {
+    auto keys = this->source->keyHint();
+    this->table.Reserve(keys);
+    this->lock_table.Reserve(keys);
     LOG(INFO) << fmt::format("Harmony(num_threads={}, table_partitions={}, enable_inter_block={})", num_threads, table_partitions, enable_inter_block) << std::endl;
 }
 
-/// @brief start harmony protocol
-void Harmony::Start() {
-    LOG(INFO) << "harmony start";
-    
-    // split blocks into batches
-    vector<vector<vector<T>>> batches;
-    for (size_t i = 0; i < blocks.size(); ++i) {
-        auto& block = blocks[i];
-        auto& txs = block->getTxs();
-        // calculate the number of transactions per thread
-        // auto tx_per_thread = (txs.size() + num_threads - 1) / num_threads;
-        auto tx_per_thread = 1;
-        size_t index = 0;
-        vector<vector<T>> batch;
-        size_t batch_id = i + 1;
-        batch.resize(num_threads);
-        // get all batch of one block
-        for (size_t j = 0; j < txs.size(); j += tx_per_thread) {
-            size_t batch_idx = index % num_threads;
-            for (size_t k = 0; k < tx_per_thread && j + k < txs.size(); ++k) {
-                auto tx = txs[j + k];
-                size_t txid = tx->GetTx()->m_hyperId;
-                Transaction tx_inner = *tx;
-                batch[batch_idx].emplace_back(std::move(tx_inner), txid, batch_id);
-            }
-            index++;
+/// @brief initialize harmony protocol with pre-generated blocks
+/// @param blocks the blocks to be executed
+Harmony::Harmony(
+    vector<Block::Ptr> blocks, Statistics& statistics,
+    size_t num_threads, size_t table_partitions, bool enable_inter_block
+):
+    Harmony(make_shared<VectorBlockSource>(std::move(blocks)), statistics, num_threads, table_partitions, enable_inter_block)
+{}
+
+/// @brief split one block into per-thread batches
+/// @param block the block pulled from source
+/// @param batch_id the batch id of this block, starts from 1
+/// @return transactions of each thread
+vector<vector<T>> Harmony::SplitBlock(const Block::Ptr& block, size_t batch_id) {
+    auto& txs = block->getTxs();
+    // calculate the number of transactions per thread
+    // auto tx_per_thread = (txs.size() + num_threads - 1) / num_threads;
+    auto tx_per_thread = 1;
+    size_t index = 0;
+    vector<vector<T>> batch;
+    batch.resize(num_threads);
+    // get all batch of one block
+    for (size_t j = 0; j < txs.size(); j += tx_per_thread) {
+        size_t batch_idx = index % num_threads;
+        for (size_t k = 0; k < tx_per_thread && j + k < txs.size(); ++k) {
+            auto tx = txs[j + k];
+            size_t txid = tx->GetTx()->m_hyperId;
+            Transaction tx_inner = *tx;
+            batch[batch_idx].emplace_back(std::move(tx_inner), txid, batch_id);
         }
-        // store block batch
-        batches.push_back(std::move(batch));
-        statistics.JournalBlock();
+        index++;
     }
+    statistics.JournalBlock();
+    return batch;
+}
 
+/// @brief start harmony protocol
+void Harmony::Start() {
+    LOG(INFO) << "harmony start";
+    // workers pull blocks from source round by round
     for (size_t i = 0; i < num_threads; ++i) {
-        vector<vector<T>> thread_batches;
-        for (size_t j = 0; j < blocks.size(); ++j) {
-            thread_batches.push_back(std::move(batches[j][i]));
-        }
-        workers.push_back(std::thread([this, i, thread_batches]() {
-            HarmonyExecutor(*this, i, std::move(thread_batches)).Run();
+        workers.push_back(std::thread([this, i]() {
+            HarmonyExecutor(*this, i).Run();
         }));
         ThreadPool::PinRoundRobin(workers[i], i);
     }
@@ -78,6 +85,7 @@ void Harmony::Start() {
 /// @return statistics of current execution
 void Harmony::Stop() {
     stop_flag.store(true);
+    source->close();
     for (size_t i = 0; i < num_threads; ++i) {
         workers[i].join();
     }
@@ -97,8 +105,8 @@ HarmonyTransaction::HarmonyTransaction(
     in_batch_id{batch_id}
 {
     // initial readSet and writeSet empty
-    local_get = std::unordered_map<string, string>();
-    local_put = std::unordered_map<string, string>();
+    local_get = std::unordered_map<Key, string>();
+    local_put = std::unordered_map<Key, string>();
 }
 
 HarmonyTransaction::HarmonyTransaction(HarmonyTransaction&& tx) noexcept:
@@ -152,9 +160,9 @@ HarmonyLockTable::HarmonyLockTable(size_t partitions):
 
 /// @brief initialize an harmony executor
 /// @param harmony the harmony configuration object
-HarmonyExecutor::HarmonyExecutor(Harmony& harmony, size_t worker_id, vector<vector<T>> batchTxs):
-    batchTxs(std::move(batchTxs)),
+HarmonyExecutor::HarmonyExecutor(Harmony& harmony, size_t worker_id):
     statistics(harmony.statistics),
+    feed{harmony.feed},
     table{harmony.table},
     lock_table{harmony.lock_table},
     enable_inter_block{harmony.enable_inter_block},
@@ -170,21 +178,26 @@ HarmonyExecutor::HarmonyExecutor(Harmony& harmony, size_t worker_id, vector<vect
 /// @brief run transactions
 void HarmonyExecutor::Run() {
     if (enable_inter_block) {
-        DLOG(INFO) << "worker " << worker_id << " size of batchTxs " << batchTxs.size() << std::endl;
         // Processing Block Streamly
         barrier.arrive_and_wait();
-        InterBlockExecute(NextBatch());
+        if (!NextBatch()) {return;}
+        while (InterBlockExecute(batchTxs.back())) {}
     } else {
         // Processing Block One by One
-        for (auto& batch : batchTxs) {
+        // hardware counters of this worker, barrier waits are excluded
+        PerfSampler perf(statistics, PerfSampler::Scope::THREAD);
+        while (true) {
             #define LATENCY duration_cast<microseconds>(steady_clock::now() - tx.start_time).count()
             #define PHASE_TIME duration_cast<microseconds>(steady_clock::now() - begin_time).count()
             // stage 1: execute
+            auto _more = NextBatch();
             auto _stop = confirm_exit.load() == num_threads;
             barrier.arrive_and_wait();
-            if (_stop) {return;}
+            if (_stop || !_more) {return;}
+            auto& batch = batchTxs.back();
             if (stop_flag.load()) { confirm_exit.compare_exchange_weak(worker_id, worker_id + 1);}
             DLOG(INFO) << "worker " << worker_id << " executing" << std::endl;
+            perf.Restart();
             for (auto& tx : batch) {
                 // record start time
                 tx.start_time = steady_clock::now();
@@ -193,11 +206,13 @@ void HarmonyExecutor::Run() {
                 statistics.JournalExecute();
                 statistics.JournalOverheads(tx.CountOverheads());
             }
+            perf.Journal("harmony execute");
             // stage 2: verify + commit
             barrier.arrive_and_wait();
             DLOG(INFO) << "worker " << worker_id << " verifying" << std::endl;
             time_point<steady_clock> begin_time;
             if (worker_id == 0) begin_time = steady_clock::now();
+            perf.Restart();
             for (auto& tx : batch) {
                 this->Verify(&tx);
                 if (tx.flag_conflict) {
@@ -207,11 +222,13 @@ void HarmonyExecutor::Run() {
                     statistics.JournalCommit(LATENCY);
                 }
             }
+            perf.Journal("harmony verify");
             // stage 3: fallback
             barrier.arrive_and_wait();
             if (worker_id == 0) statistics.JournalRollbackExecution(PHASE_TIME);
             DLOG(INFO) << "worker " << worker_id << " fallbacking" << std::endl;
             if (worker_id == 0) begin_time = steady_clock::now();
+            perf.Restart();
             for (auto& tx : batch) {
                 if (tx.flag_conflict) {
                     this->Fallback(&tx);
@@ -220,38 +237,48 @@ void HarmonyExecutor::Run() {
                     statistics.JournalRollback(tx.CountOverheads());
                 }
             }
+            perf.Journal("harmony fallback");
             // stage 4: clean up
             barrier.arrive_and_wait();
             if (worker_id == 0) statistics.JournalReExecution(PHASE_TIME);
             DLOG(INFO) << "worker " << worker_id << " cleaning up" << std::endl;
+            perf.Restart();
             for (auto& tx : batch) {
                 this->CleanLockTable(&tx);
             }
+            perf.Journal("harmony clean up");
             #undef LATENCY
             #undef PHASE_TIME
         }
     }
 }
 
-/// @brief get next batch txs of executor
-vector<T> HarmonyExecutor::NextBatch() {
-    // if (batchIdx >= batchTxs.size()) {
-    //     DLOG(INFO) << "worker " << worker_id << " no more batch" << std::endl;
-    //     return {};
-    // }
-    return batchTxs[batchIdx++];
+/// @brief pull next batch txs of executor into batchTxs
+/// @return false if the source is exhausted or closed, same for all workers in one round
+bool HarmonyExecutor::NextBatch() {
+    vector<T> batch;
+    block = feed.next(batchIdx, worker_id, batch);
+    if (!block) {
+        DLOG(INFO) << "worker " << worker_id << " no more batch" << std::endl;
+        return false;
+    }
+    batchTxs.push_back(std::move(batch));
+    batchIdx++;
+    return true;
 }
 
 /// @brief execute transactions in inter-block mode
 /// @param batch the batch of transactions
-void HarmonyExecutor::InterBlockExecute(vector<T> batch) {
+/// @return true if next batch is pulled and should be executed streamly
+bool HarmonyExecutor::InterBlockExecute(vector<T>& batch) {
     #define LATENCY duration_cast<microseconds>(steady_clock::now() - tx.start_time).count()
     #define PHASE_TIME duration_cast<microseconds>(steady_clock::now() - begin_time).count()
     // stage 1: execute
     auto _stop = confirm_exit.load() == num_threads;
-    if (_stop) {return;}
+    if (_stop) {return false;}
     if (stop_flag.load()) { confirm_exit.compare_exchange_weak(worker_id, worker_id + 1);}
     DLOG(INFO) << "worker " << worker_id << " executing batch " << batchIdx << " size " << batch.size() << std::endl;
+    PerfSampler perf(statistics, PerfSampler::Scope::THREAD);
     for (auto& tx : batch) {
         // execute transaction and handle r-w dependency
         tx.start_time = steady_clock::now();
@@ -259,11 +286,13 @@ void HarmonyExecutor::InterBlockExecute(vector<T> batch) {
         statistics.JournalExecute();
         statistics.JournalOverheads(tx.CountOverheads());
     }
+    perf.Journal("harmony execute");
     // stage 2: verify + commit
     barrier.arrive_and_wait();
     DLOG(INFO) << "worker " << worker_id << " verifying batch " << batchIdx;
     time_point<steady_clock> begin_time;
     if (worker_id == 0) begin_time = steady_clock::now();
+    perf.Restart();
     for (auto& tx : batch) {
         this->Verify(&tx);
         if (tx.flag_conflict) {
@@ -273,11 +302,13 @@ void HarmonyExecutor::InterBlockExecute(vector<T> batch) {
             statistics.JournalCommit(LATENCY);
         }
     }
+    perf.Journal("harmony verify");
     // stage 3: fallback
     barrier.arrive_and_wait();
     if (worker_id == 0) statistics.JournalRollbackExecution(PHASE_TIME);
     DLOG(INFO) << "worker " << worker_id << " fallbacking batch " << batchIdx;
     begin_time = steady_clock::now();
+    perf.Restart();
     for (auto& tx : batch) {
         if (tx.flag_conflict) {
             this->Fallback(&tx);
@@ -286,26 +317,30 @@ void HarmonyExecutor::InterBlockExecute(vector<T> batch) {
             statistics.JournalRollback(tx.CountOverheads());
         }
     }
+    perf.Journal("harmony fallback");
     // stage 4: streamly execute next block
-    if (batchIdx < batchTxs.size()) {
+    if (NextBatch()) {
         counter.fetch_add(1, std::memory_order_relaxed);
         if (counter.load() == num_threads) {
             statistics.JournalReExecution(PHASE_TIME);
             counter.store(0);
         }
         DLOG(INFO) << "worker " << worker_id << " streamly next block" << std::endl;
-        InterBlockExecute(NextBatch());
+        return true;
     } else {
     // stage 5: clean up
         barrier.arrive_and_wait();
         if (worker_id == 0) statistics.JournalReExecution(PHASE_TIME);
         DLOG(INFO) << "worker " << worker_id << " cleaning up batch " << batchIdx << std::endl;
+        perf.Restart();
         for (auto& tx : batch) {
             this->CleanLockTable(&tx);
         }
+        perf.Journal("harmony clean up");
     }
     #undef LATENCY
     #undef PHASE_TIME
+    return false;
 }
 
 /// @brief execute a transaction and journal write operations locally
@@ -313,11 +348,11 @@ void HarmonyExecutor::InterBlockExecute(vector<T> batch) {
 void HarmonyExecutor::Execute(T* tx) {
     // read from the public table
     tx->InstallGetStorageHandler([&](
-        const std::unordered_set<string>& readSet
+        const KeySet& readSet
     ) {
         string keys;
         for (auto& key : readSet) {
-            keys += key + " ";
+            keys += keyToString(key) + " ";
             string value;
             table.Put(key, [&](auto& entry){
                 value = entry.value;
@@ -334,12 +369,12 @@ void HarmonyExecutor::Execute(T* tx) {
     });
     // write locally to local storage
     tx->InstallSetStorageHandler([&](
-        const std::unordered_set<string>& writeSet,
+        const KeySet& writeSet,
         const std::string& value
     ) {
         string keys;
         for (auto& key : writeSet) {
-            keys += key + " ";
+            keys += keyToString(key) + " ";
             tx->local_put[key] = value;
             table.Put(key, [&](auto& entry){
                 // update get_txs' min_out and tx's max_in
@@ -413,11 +448,11 @@ void HarmonyExecutor::PrepareLockTable(T* tx) {
 void HarmonyExecutor::Fallback(T* tx) {
     // read from the public table
     tx->InstallGetStorageHandler([&](
-        const std::unordered_set<string>& readSet
+        const KeySet& readSet
     ) {
         string keys;
         for (auto& key : readSet) {
-            keys += key + " ";
+            keys += keyToString(key) + " ";
             string value;
             table.Get(key, [&](auto& entry){
                 value = entry.value;
@@ -428,12 +463,12 @@ void HarmonyExecutor::Fallback(T* tx) {
     });
     // write directly into the public table
     tx->InstallSetStorageHandler([&](
-        const std::unordered_set<string>& writeSet,
+        const KeySet& writeSet,
         const std::string& value
     ) {
         string keys;
         for (auto& key : writeSet) {
-            keys += key + " ";
+            keys += keyToString(key) + " ";
             table.Put(key, [&](auto& entry){
                 entry.value = value;
             });
@@ -1,12 +1,14 @@
 #pragma once
 
 #include <chrono>
+#include <deque>
 #include <barrier>
 #include <thread>
 #include <glog/logging.h>
 #include <loom/utils/Ulock.h>
 #include <loom/protocol/common.h>
 #include <loom/common/Block.h>
+#include <loom/common/BlockSource.h>
 #include <loom/common/Transaction.h>
 #include <loom/utils/Statistic/Statistics.h>
 
@@ -14,7 +16,7 @@ using namespace std;
 
 namespace loom {
 
-#define K std::string
+#define K loom::Key
 #define T HarmonyTransaction
 
 /// @brief harmony tranaction with local read and write set.
@@ -24,8 +26,8 @@ struct HarmonyTransaction: public Transaction {
     bool        flag_conflict{false};
     std::atomic<bool>   committed{false};
     std::chrono::time_point<std::chrono::steady_clock> start_time;
-    std::unordered_map<string, string> local_get;
-    std::unordered_map<string, string> local_put;
+    std::unordered_map<Key, string> local_get;
+    std::unordered_map<Key, string> local_put;
     size_t      min_out;
     size_t      max_in;
     size_t      out_batch_id;
@@ -35,6 +37,10 @@ struct HarmonyTransaction: public Transaction {
     HarmonyTransaction(const HarmonyTransaction& other); // copy constructor
 };
 
+#ifndef HARMONY_TABLE_KIND
+#define HARMONY_TABLE_KIND TableKind::FLAT
+#endif
+
 /// @brief harmony table entry for first round execution
 struct HarmonyEntry {
     string value                = "";
@@ -43,7 +49,7 @@ struct HarmonyEntry {
 };
 
 /// @brief harmony table for first round execution
-struct HarmonyTable: public Table<K, HarmonyEntry, KeyHasher> {
+struct HarmonyTable: public Table<K, HarmonyEntry, KeyHasher, HARMONY_TABLE_KIND> {
     void on_seeing_rw_dependency(T* Ti, T* Tj);
 };
 
@@ -54,7 +60,7 @@ struct HarmonyLockEntry {
 };
 
 /// @brief harmony table for fallback pessimistic execution
-struct HarmonyLockTable: public Table<K, HarmonyLockEntry, KeyHasher> {
+struct HarmonyLockTable: public Table<K, HarmonyLockEntry, KeyHasher, HARMONY_TABLE_KIND> {
     HarmonyLockTable(size_t partitions);
 };
 
@@ -62,13 +68,17 @@ struct HarmonyLockTable: public Table<K, HarmonyLockEntry, KeyHasher> {
 class Harmony: public Protocol {
 
 public:
+    Harmony(BlockSource::Ptr source, Statistics& statistics, size_t num_threads, size_t table_partitions = 1, bool enable_inter_block = true);
     Harmony(vector<Block::Ptr> blocks, Statistics& statistics, size_t num_threads, size_t table_partitions = 1, bool enable_inter_block = true);
     void Start() override;
     void Stop() override;
 
 private:
+    vector<vector<T>> SplitBlock(const Block::Ptr& block, size_t batch_id);
+
     Statistics&                             statistics;
-    vector<Block::Ptr>                      blocks;
+    BlockSource::Ptr                        source;
+    BatchFeed<T>                            feed;
     HarmonyTable                            table;
     HarmonyLockTable                        lock_table;
     bool                                    enable_inter_block;
@@ -85,10 +95,10 @@ private:
 class HarmonyExecutor {
 
 public:
-    HarmonyExecutor(Harmony& harmony, size_t worker_id, vector<vector<T>> batchTxs);
+    HarmonyExecutor(Harmony& harmony, size_t worker_id);
     void Run();
-    vector<T> NextBatch();
-    void InterBlockExecute(vector<T> batch);
+    bool NextBatch();
+    bool InterBlockExecute(vector<T>& batch);
     void Execute(T* tx);
     void Reserve(T* tx);
     void Verify(T* tx);
@@ -99,7 +109,9 @@ public:
 
 private:
     Statistics&                             statistics;
-    vector<vector<T>>                       batchTxs;
+    BatchFeed<T>&                           feed;
+    std::deque<vector<T>>                   batchTxs;   // 表项仍引用并更新历史批次的事务, 已执行批次需保留
+    Block::Ptr                              block;      // 当前批次所属区块, 执行期间需保持节点图存活
     HarmonyTable&                           table;
     HarmonyLockTable&                       lock_table;
     bool                                    enable_inter_block;
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace loom {
+
+/// @brief 区块间流水线: 固定的阶段序列, 每个阶段一个线程, 相邻阶段之间以 FIFO 队列衔接
+///        1. 同时在流水线中的区块不超过 depth 个, 流水线满时 Push 阻塞(背压)
+///        2. 每个阶段按 Push 的顺序逐个处理区块, 因此最后一个阶段按区块顺序完成(有序提交)
+///        3. Drain 关闭入口, 等待已进入的区块走完所有阶段后结束阶段线程
+template <typename Item>
+class BlockPipeline {
+    public:
+        typedef std::function<void(Item&)> Stage;
+
+        /// @param depth 同时在流水线中的最大区块数, 至少为 1
+        /// @param stages 依次执行的阶段
+        BlockPipeline(size_t depth, std::vector<Stage> stages)
+         : m_depth(std::max<size_t>(depth, 1)), m_stages(std::move(stages)), m_queues(m_stages.size()) {
+            for (size_t i = 0; i < m_stages.size(); i++) {
+                m_threads.emplace_back([this, i] {run(i);});
+            }
+        }
+
+        ~BlockPipeline() {Drain();}
+
+        BlockPipeline(const BlockPipeline&) = delete;
+        BlockPipeline& operator=(const BlockPipeline&) = delete;
+
+        /// @brief 放入一个区块, 流水线满时等待最早的区块完成
+        /// @return 流水线已关闭时返回 false, 区块不会被执行
+        bool Push(Item item) {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_slot.wait(lock, [this] {return m_closed || m_inFlight < m_depth;});
+                if (m_closed) return false;
+                m_inFlight++;
+            }
+            push(0, std::move(item));
+            return true;
+        }
+
+        /// @brief 关闭入口并等待流水线排空, 可重复调用, 也可与 Push 并发调用
+        void Drain() {
+            std::lock_guard<std::mutex> drain(m_drainMutex);
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_closed = true;
+            }
+            m_slot.notify_all();
+            if (m_threads.empty()) return;
+            // 关闭第一个阶段的队列, 各阶段处理完剩余区块后依次关闭下一阶段
+            close(0);
+            for (auto& thread : m_threads) {
+                thread.join();
+            }
+            m_threads.clear();
+        }
+
+        /// @brief 当前在流水线中的区块数
+        size_t InFlight() {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_inFlight;
+        }
+
+    private:
+        struct Queue {
+            std::mutex mutex;
+            std::condition_variable ready;
+            std::deque<Item> items;
+            bool closed = false;
+        };
+
+        void push(size_t stage, Item item) {
+            auto& queue = m_queues[stage];
+            {
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                queue.items.push_back(std::move(item));
+            }
+            queue.ready.notify_one();
+        }
+
+        void close(size_t stage) {
+            auto& queue = m_queues[stage];
+            {
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                queue.closed = true;
+            }
+            queue.ready.notify_one();
+        }
+
+        void run(size_t stage) {
+            auto& queue = m_queues[stage];
+            while (true) {
+                Item item;
+                {
+                    std::unique_lock<std::mutex> lock(queue.mutex);
+                    queue.ready.wait(lock, [&queue] {return queue.closed || !queue.items.empty();});
+                    if (queue.items.empty()) break;
+                    item = std::move(queue.items.front());
+                    queue.items.pop_front();
+                }
+                m_stages[stage](item);
+                if (stage + 1 < m_stages.size()) {
+                    push(stage + 1, std::move(item));
+                    continue;
+                }
+                // 区块离开流水线, 释放一个位置
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_inFlight--;
+                }
+                m_slot.notify_all();
+            }
+            if (stage + 1 < m_stages.size()) close(stage + 1);
+        }
+
+        size_t m_depth;
+        std::vector<Stage> m_stages;
+        std::vector<Queue> m_queues;
+        std::vector<std::thread> m_threads;
+        std::mutex m_mutex;                 // 保护 m_inFlight 与 m_closed
+        std::condition_variable m_slot;
+        size_t m_inFlight = 0;
+        bool m_closed = false;
+        std::mutex m_drainMutex;            // 串行化并发的 Drain
+};
+
+}
@@ -1,11 +1,13 @@
 #include "DeterReExecute.h"
+#include <loom/protocol/loom/TimeSpaceGraph.h>
 #include <assert.h>
+#include <numeric>
 
 using namespace std;
 using namespace Util;
 
 /* 构造函数 */
-DeterReExecute::DeterReExecute(std::vector<Vertex::Ptr>& rbList, vector<vector<int>>& serialOrders, std::unordered_map<Vertex::Ptr, unordered_set<Vertex::Ptr, Vertex::VertexHash>, Vertex::VertexHash>& conflictIndex) : m_rbList(rbList), m_serialOrders(serialOrders), m_conflictIndex(conflictIndex), m_normalList(dummyNormalList) {
+DeterReExecute::DeterReExecute(std::vector<Vertex::Ptr>& rbList, vector<vector<int>>& serialOrders, const std::unordered_map<Vertex::Ptr, unordered_set<Vertex::Ptr, Vertex::VertexHash>, Vertex::VertexHash>& conflictIndex) : m_rbList(rbList), m_serialOrders(serialOrders), m_conflictIndex(conflictIndex), m_normalList(dummyNormalList) {
     // 构建串行化序索引
     for (int i = 0; i < m_serialOrders.size(); i++) {
         for (auto txId : m_serialOrders[i]) {
@@ -20,6 +22,7 @@ DeterReExecute::DeterReExecute(std::vector<Vertex::Ptr>& rbList, vector<vector<i
         m_txOrder[tx] = counter++;
         // m_unConflictTxMap[tx->m_id] = rbSet;
     }
+    m_dagTxs = m_rbList;
 
     // 重排序轮次定义为事务数的20%
     this->N = rbList.size() * 0.2;
@@ -27,7 +30,7 @@ DeterReExecute::DeterReExecute(std::vector<Vertex::Ptr>& rbList, vector<vector<i
 } 
 
 
-DeterReExecute::DeterReExecute(std::vector<HyperVertex::Ptr>& normalList, vector<vector<int>>& serialOrders, std::unordered_map<Vertex::Ptr, unordered_set<Vertex::Ptr, Vertex::VertexHash>, Vertex::VertexHash>& conflictIndex, std::vector<Vertex::Ptr>& rbList) 
+DeterReExecute::DeterReExecute(std::vector<HyperVertex::Ptr>& normalList, vector<vector<int>>& serialOrders, const std::unordered_map<Vertex::Ptr, unordered_set<Vertex::Ptr, Vertex::VertexHash>, Vertex::VertexHash>& conflictIndex, std::vector<Vertex::Ptr>& rbList) 
     : m_normalList(normalList), m_serialOrders(serialOrders), m_conflictIndex(conflictIndex), m_rbList(rbList) {
     // 构建串行化序索引
     for (int i = 0; i < serialOrders.size(); i++) {
@@ -40,9 +43,17 @@ DeterReExecute::DeterReExecute(std::vector<HyperVertex::Ptr>& normalList, vector
     for (auto& tx : m_rbList) {
         m_txOrder[tx] = counter++;
     }
+    m_dagTxs = m_rbList;
     m_totalExecTime = 0;
 }
 
+/* 获取与事务冲突的事务集合, 冲突索引只读, 不存在时返回空集合 */
+const unordered_set<Vertex::Ptr, Vertex::VertexHash>& DeterReExecute::getConflictTxs(const Vertex::Ptr& tx) const {
+    static const unordered_set<Vertex::Ptr, Vertex::VertexHash> empty;
+    auto it = m_conflictIndex.find(tx);
+    return it == m_conflictIndex.end() ? empty : it->second;
+}
+
 
 /* 时空图模块 */
 
@@ -120,7 +131,7 @@ void DeterReExecute::buildGraphOriginByIndex() {
     for (int j = 0; j < m_rbList.size(); j++) {
         auto Tj = m_rbList[j];
         auto& unflictTxs = m_unConflictTxMap[m_rbList[j]->m_id];
-        auto& conflictTxs = m_conflictIndex[Tj];
+        auto& conflictTxs = getConflictTxs(Tj);
         
         if (Tj->m_cost > 500) {
             for (int i = 0; i < m_rbList.size(); i++) {
@@ -176,7 +187,7 @@ void DeterReExecute::buildGraph() {
     for (int j = 0; j < m_rbList.size(); j++) {
         auto Tj = m_rbList[j];
         auto& unflictTxs = m_unConflictTxMap[m_rbList[j]->m_id];
-        auto& conflictTxs = m_conflictIndex[Tj];
+        auto& conflictTxs = getConflictTxs(Tj);
 
         // 判断本事务与前序事务间冲突
         for (int i = 0; i < m_rbList.size(); i++) {
@@ -233,7 +244,7 @@ void DeterReExecute::buildGraphByIndex() {
     for (int j = 0; j < m_rbList.size(); j++) {
         auto Tj = m_rbList[j];
         auto& unflictTxs = m_unConflictTxMap[m_rbList[j]->m_id];
-        auto& conflictTxs = m_conflictIndex[Tj];
+        auto& conflictTxs = getConflictTxs(Tj);
         
         // 遍历本事务的所有冲突事务
         for (auto& Ti : conflictTxs) {
@@ -288,7 +299,7 @@ void DeterReExecute::buildGraphConcurrent(UThreadPoolPtr& Pool, std::vector<std:
                 // 遍历队列事务
                 auto Tj = m_rbList[j];
                 auto& unflictTxs = m_unConflictTxMap[Tj->m_id];
-                auto& conflictTxs = m_conflictIndex[Tj];
+                auto& conflictTxs = getConflictTxs(Tj);
                 
                 // 遍历本事务的所有冲突事务
                 for (auto& Ti : conflictTxs) {
@@ -335,132 +346,333 @@ void DeterReExecute::buildGraphConcurrent(UThreadPoolPtr& Pool, std::vector<std:
 
 /* 根据读写集构建时空图 */
 void DeterReExecute::buildAndReScheduleFlat() {
-    // int counter = 0;
+    resetDependencies();
+    auto& graph = TimeSpaceGraph::local();
     // 按队列顺序，依次遍历事务
-    for (auto& Ti : m_rbList) {
-        // auto& Ti = rb->m_rootVertex;
-        // DLOG(INFO) << "Ti: " << Ti->m_id << " counter: " << counter;
-        std::unordered_set<string> processedKeys;
+    for (int i = 0; i < m_rbList.size(); i++) {
+        auto& Ti = m_rbList[i];
 
         // write set first
         for (auto& wKey: Ti->writeSet) {
-            auto& entry = m_tsGraph[wKey];
-            if (!entry.deps_get.empty()) {
-                auto& Tj = entry.deps_get.back();
-                // Ti->scheduledTime = std::max(Ti->scheduledTime, Tj->scheduledTime + Tj->m_self_cost);
-                auto newScheduledTime = Tj->scheduledTime + Tj->m_self_cost;
-                if (newScheduledTime > Ti->scheduledTime) {
-                    Ti->scheduledTime = newScheduledTime;
-                    Ti->m_should_wait = Tj;
-                }
-            }
-            if (!entry.deps_put.empty()) {
-                auto& Tj = entry.deps_put.back();
-                // Ti->scheduledTime = std::max(Ti->scheduledTime, Tj->scheduledTime + Tj->m_self_cost);
-                auto newScheduledTime = Tj->scheduledTime + Tj->m_self_cost;
-                if (newScheduledTime > Ti->scheduledTime) {
-                    Ti->scheduledTime = newScheduledTime;
-                    Ti->m_should_wait = Tj;
-                }
-            }
-            entry.deps_put.push_back(Ti);
+            auto& entry = graph[wKey];
+            if (entry.lastGet >= 0) waitFor(Ti, m_rbList[entry.lastGet]);
+            if (entry.lastPut >= 0) waitFor(Ti, m_rbList[entry.lastPut]);
+            // 等待上一个写事务, 以及其后读到该写入的所有读事务
+            if (entry.lastPut >= 0) addDependency(i, entry.lastPut);
+            graph.forEachReader(entry, [this, i](int j) {addDependency(i, j);});
+            entry.lastPut = i;
+            entry.readers = -1;
             entry.total_time = std::max(Ti->scheduledTime + Ti->m_self_cost, entry.total_time);
-            processedKeys.insert(wKey);
-            // counter++;
         }
         // then read set
         for (auto& rKey : Ti->readSet) {
-            if (processedKeys.find(rKey) != processedKeys.end()) {
+            if (Ti->writeSet.contains(rKey)) {
                 continue;
             }
-            auto& entry = m_tsGraph[rKey];
-            if (!entry.deps_put.empty()) {
-                auto& Tj = entry.deps_put.back();
-                // Ti->scheduledTime = std::max(Ti->scheduledTime, Tj->scheduledTime + Tj->m_self_cost);
-                auto newScheduledTime = Tj->scheduledTime + Tj->m_self_cost;
-                if (newScheduledTime > Ti->scheduledTime) {
-                    Ti->scheduledTime = newScheduledTime;
-                    Ti->m_should_wait = Tj;
-                }
+            auto& entry = graph[rKey];
+            if (entry.lastPut >= 0) {
+                waitFor(Ti, m_rbList[entry.lastPut]);
+                addDependency(i, entry.lastPut);
             }
-            entry.deps_get.push_back(Ti);
+            entry.lastGet = i;
+            graph.addReader(entry, i);
             entry.total_time = std::max(Ti->scheduledTime + Ti->m_self_cost, entry.total_time);
-            // counter++;
         }
-
-        // Ti->committed = std::make_shared<std::atomic<bool>>(false);
     }
-    // cout << "counter in buildByWRSet: " << counter << endl;
+    m_totalExecTime = std::max(m_totalExecTime, graph.totalTime());
 }
 
 /* 根据读写集构建时空图:考虑嵌套结构 */
 void DeterReExecute::buildAndReSchedule() {
+    resetDependencies();
+    auto& graph = TimeSpaceGraph::local();
     // 按队列顺序，依次遍历事务
-    for (auto& Ti : m_rbList) {
-        std::unordered_set<string> processedKeys;
+    for (int i = 0; i < m_rbList.size(); i++) {
+        auto& Ti = m_rbList[i];
 
         // write set first
         for (auto& wKey: Ti->writeSet) {
-            auto& entry = m_tsGraph[wKey];
-            if (!entry.deps_get.empty()) {
-                auto& Tj = entry.deps_get.back();
-                // Ti->scheduledTime = std::max(Ti->scheduledTime, Tj->scheduledTime + Tj->m_self_cost);
-                auto newScheduledTime = Tj->scheduledTime + Tj->m_self_cost;
-                if (newScheduledTime > Ti->scheduledTime) {
-                    Ti->scheduledTime = newScheduledTime;
-                    Ti->m_should_wait = Tj;
-                }
-            }
-            if (!entry.deps_put.empty()) {
-                auto& Tj = entry.deps_put.back();
-                // Ti->scheduledTime = std::max(Ti->scheduledTime, Tj->scheduledTime + Tj->m_self_cost);
-                auto newScheduledTime = Tj->scheduledTime + Tj->m_self_cost;
-                if (newScheduledTime > Ti->scheduledTime) {
-                    Ti->scheduledTime = newScheduledTime;
-                    Ti->m_should_wait = Tj;
-                }
-            }
+            auto& entry = graph[wKey];
+            if (entry.lastGet >= 0) waitFor(Ti, m_rbList[entry.lastGet]);
+            if (entry.lastPut >= 0) waitFor(Ti, m_rbList[entry.lastPut]);
             entry.total_time = std::max(Ti->scheduledTime + Ti->m_self_cost, entry.total_time);
-            entry.deps_put.push_back(Ti);
-            processedKeys.insert(wKey);
+            // 等待上一个写事务, 以及其后读到该写入的所有读事务
+            if (entry.lastPut >= 0) addDependency(i, entry.lastPut);
+            graph.forEachReader(entry, [this, i](int j) {addDependency(i, j);});
+            entry.lastPut = i;
+            entry.readers = -1;
         }
         // then read set
         for (auto& rKey : Ti->readSet) {
-            if (processedKeys.find(rKey) != processedKeys.end()) {
+            if (Ti->writeSet.contains(rKey)) {
                 continue;
             }
-            auto& entry = m_tsGraph[rKey];
-            if (!entry.deps_put.empty()) {
-                auto& Tj = entry.deps_put.back();
-                // Ti->scheduledTime = std::max(Ti->scheduledTime, Tj->scheduledTime + Tj->m_self_cost);
-                auto newScheduledTime = Tj->scheduledTime + Tj->m_self_cost;
-                if (newScheduledTime > Ti->scheduledTime) {
-                    Ti->scheduledTime = newScheduledTime;
-                    Ti->m_should_wait = Tj;
-                }
+            auto& entry = graph[rKey];
+            if (entry.lastPut >= 0) {
+                waitFor(Ti, m_rbList[entry.lastPut]);
+                addDependency(i, entry.lastPut);
             }
             entry.total_time = std::max(Ti->scheduledTime + Ti->m_self_cost, entry.total_time);
-            entry.deps_get.push_back(Ti);
+            entry.lastGet = i;
+            graph.addReader(entry, i);
         }
 
         // 考虑嵌套结构：若存在强依赖子节点，则将其添加至依赖关系
         if (Ti->hasStrong) {
-            for (auto Tj : Ti->m_strongChildren) {
+            for (auto& Tj : Ti->m_strongChildren) {
                 // 父事务调度时间为前序事务结束时间
-                // Ti->scheduledTime = std::max(Ti->scheduledTime, Tj->scheduledTime + Tj->m_self_cost);
-                auto newScheduledTime = Tj->scheduledTime + Tj->m_self_cost;
+                waitFor(Ti, Tj);
+                addDependency(i, Tj);
+            }
+        }
+    }
+    m_totalExecTime = std::max(m_totalExecTime, graph.totalTime());
+}
+
+/* Ti 在 Tj 结束后开始; 调度时间推迟时记录 Tj 为应等待的事务 */
+void DeterReExecute::waitFor(const Vertex::Ptr& Ti, const Vertex::Ptr& Tj) {
+    auto newScheduledTime = Tj->scheduledTime + Tj->m_self_cost;
+    if (newScheduledTime > Ti->scheduledTime) {
+        Ti->scheduledTime = newScheduledTime;
+        Ti->m_should_wait = Tj;
+    }
+}
+
+
+namespace {
+
+/// @brief 并行构建时空图时的一次键访问
+struct Access {
+    Key key;
+    int tx;
+    bool write;
+    int lastGet = -1;       // 写访问: 之前最后一个读事务
+    int lastPut = -1;       // 之前最后一个写事务
+    int readsBegin = 0;     // 写访问: 上一次写之后的读访问在 order 中的区间
+    int readsEnd = 0;
+};
+
+/// @brief 在线程池上排序: 分块并行排序, 再逐轮两两并行归并
+template <typename It, typename Cmp>
+void parallelSort(ThreadPool& pool, It first, It last, Cmp cmp) {
+    size_t n = last - first;
+    size_t parts = pool.getThreadNum() + 1;
+    size_t block = std::max<size_t>(4096, (n + parts - 1) / parts);
+    pool.parallelFor(0, n, block, [&](size_t lo, size_t hi) {
+        std::sort(first + lo, first + hi, cmp);
+    });
+    for (size_t width = block; width < n; width *= 2) {
+        pool.parallelFor(0, (n + 2 * width - 1) / (2 * width), 1, [&](size_t lo, size_t hi) {
+            for (size_t k = lo; k < hi; k++) {
+                size_t begin = k * 2 * width;
+                std::inplace_merge(first + begin, first + std::min(n, begin + width), first + std::min(n, begin + 2 * width), cmp);
+            }
+        });
+    }
+}
+
+/// @brief 并行构建使用的缓冲区, 每个调用线程一份, 在区块之间复用
+struct ParallelBuildBuffers {
+    std::vector<int> offsets;           // 每个事务的访问在 accesses 中的区间
+    std::vector<Access> accesses;
+    std::vector<int> order;             // 按 (键, 位置) 排序的访问
+    std::vector<int> segments;          // 每个键在 order 中的起点
+    std::vector<int> predOffsets;       // 每个事务的前驱在 preds 中的区间, 去重后实际结束于 predEnds
+    std::vector<int> predEnds;
+    std::vector<int> preds;
+    std::vector<int> initialTime;
+    std::vector<int> accessEnd;
+};
+
+}
+
+/* 并行构建时空图, 调度时间、等待事务与依赖图都与串行构建完全相同
+   1. 每个事务的访问按串行的遍历顺序(先写集后读集)连续排列
+   2. 访问按 (键, 位置) 排序后同一个键的访问按事务顺序相邻, 各键并行求出每次访问之前的读写事务
+   3. 沿依赖图并行求最长路径: 事务在所有前驱之后计算, 并按串行的顺序比较候选的前序事务
+   构建不填充 m_tsGraph, calculateTotalNormalExecutionTime 使用构建时得到的总时间
+   所有并行计算都在调用方的线程池上进行, 不超过其线程数 */
+void DeterReExecute::buildAndReScheduleParallel(bool nested, ThreadPool::Ptr& pool) {
+    int n = m_rbList.size();
+    if (n < PARALLEL_BUILD_MIN_TXS) {
+        nested ? buildAndReSchedule() : buildAndReScheduleFlat();
+        return;
+    }
+    resetDependencies();
+    thread_local ParallelBuildBuffers buffers;
+    auto& offsets = buffers.offsets;
+    auto& accesses = buffers.accesses;
+    auto& order = buffers.order;
+    auto& segments = buffers.segments;
+
+    // 1. 排列访问
+    offsets.assign(n + 1, 0);
+    pool->parallelFor(0, n, 0, [&](size_t lo, size_t hi) {
+        for (int i = lo; i < hi; i++) {
+            auto& Ti = m_rbList[i];
+            int count = Ti->writeSet.size();
+            for (auto& rKey : Ti->readSet) {
+                if (!Ti->writeSet.contains(rKey)) count++;
+            }
+            offsets[i + 1] = count;
+        }
+    });
+    for (int i = 0; i < n; i++) {
+        offsets[i + 1] += offsets[i];
+    }
+    accesses.resize(offsets[n]);
+    pool->parallelFor(0, n, 0, [&](size_t lo, size_t hi) {
+        for (int i = lo; i < hi; i++) {
+            auto& Ti = m_rbList[i];
+            int pos = offsets[i];
+            for (auto& wKey : Ti->writeSet) {
+                accesses[pos++] = Access{wKey, i, true};
+            }
+            for (auto& rKey : Ti->readSet) {
+                if (!Ti->writeSet.contains(rKey)) accesses[pos++] = Access{rKey, i, false};
+            }
+        }
+    });
+
+    // 2. 按键划分, 访问在 accesses 中的位置即事务顺序
+    order.resize(accesses.size());
+    std::iota(order.begin(), order.end(), 0);
+    parallelSort(*pool, order.begin(), order.end(), [&accesses](int a, int b) {
+        return accesses[a].key != accesses[b].key ? accesses[a].key < accesses[b].key : a < b;
+    });
+    segments.clear();
+    for (int p = 0; p < order.size(); p++) {
+        if (p == 0 || accesses[order[p]].key != accesses[order[p - 1]].key) segments.push_back(p);
+    }
+    segments.push_back(order.size());
+    pool->parallelFor(0, segments.size() - 1, 0, [&](size_t lo, size_t hi) {
+        for (int k = lo; k < hi; k++) {
+            int lastGet = -1, lastPut = -1, putReads = segments[k];
+            for (int p = segments[k]; p < segments[k + 1]; p++) {
+                auto& access = accesses[order[p]];
+                access.lastPut = lastPut;
+                if (access.write) {
+                    access.lastGet = lastGet;
+                    access.readsBegin = putReads;
+                    access.readsEnd = p;
+                    lastPut = access.tx;
+                    putReads = p + 1;
+                } else {
+                    lastGet = access.tx;
+                }
+            }
+        }
+    });
+
+    // 依赖图: 上一个写事务、写之前读到上一次写入的读事务, 以及排在前面的强依赖子事务
+    auto& predOffsets = buffers.predOffsets;
+    auto& predEnds = buffers.predEnds;
+    auto& preds = buffers.preds;
+    predOffsets.assign(n + 1, 0);
+    predEnds.resize(n);
+    pool->parallelFor(0, n, 0, [&](size_t lo, size_t hi) {
+        for (int i = lo; i < hi; i++) {
+            int count = nested ? m_rbList[i]->m_strongChildren.size() : 0;
+            for (int pos = offsets[i]; pos < offsets[i + 1]; pos++) {
+                count += 1 + accesses[pos].readsEnd - accesses[pos].readsBegin;
+            }
+            predOffsets[i + 1] = count;
+        }
+    });
+    for (int i = 0; i < n; i++) {
+        predOffsets[i + 1] += predOffsets[i];
+    }
+    preds.resize(predOffsets[n]);
+    pool->parallelFor(0, n, 0, [&](size_t lo, size_t hi) {
+        for (int i = lo; i < hi; i++) {
+            int end = predOffsets[i];
+            for (int pos = offsets[i]; pos < offsets[i + 1]; pos++) {
+                auto& access = accesses[pos];
+                if (access.lastPut >= 0) preds[end++] = access.lastPut;
+                for (int p = access.readsBegin; p < access.readsEnd; p++) {
+                    preds[end++] = accesses[order[p]].tx;
+                }
+            }
+            if (nested && m_rbList[i]->hasStrong) {
+                for (auto& Tj : m_rbList[i]->m_strongChildren) {
+                    auto it = m_txOrder.find(Tj);
+                    if (it != m_txOrder.end() && it->second < i) preds[end++] = it->second;
+                }
+            }
+            std::sort(preds.begin() + predOffsets[i], preds.begin() + end);
+            predEnds[i] = std::unique(preds.begin() + predOffsets[i], preds.begin() + end) - preds.begin();
+            m_inDegree[i] = predEnds[i] - predOffsets[i];
+        }
+    });
+    for (int i = 0; i < n; i++) {
+        for (int p = predOffsets[i]; p < predEnds[i]; p++) {
+            m_successors[preds[p]].push_back(i);
+        }
+    }
+
+    // 3. 最长路径: 排在后面的强依赖子事务还未调度, 与串行相同地使用其原有的调度时间
+    auto& initialTime = buffers.initialTime;
+    auto& accessEnd = buffers.accessEnd;
+    initialTime.resize(n);
+    accessEnd.assign(n, 0);
+    for (int i = 0; i < n; i++) {
+        initialTime[i] = m_rbList[i]->scheduledTime;
+    }
+    auto schedule = [&](int i) {
+        auto& Ti = m_rbList[i];
+        for (int pos = offsets[i]; pos < offsets[i + 1]; pos++) {
+            auto& access = accesses[pos];
+            if (access.write && access.lastGet >= 0) waitFor(Ti, m_rbList[access.lastGet]);
+            if (access.lastPut >= 0) waitFor(Ti, m_rbList[access.lastPut]);
+        }
+        // 与串行构建中各键的 total_time 相同, 只计入访问时的调度时间
+        if (offsets[i + 1] > offsets[i]) accessEnd[i] = Ti->scheduledTime + Ti->m_self_cost;
+        if (nested && Ti->hasStrong) {
+            for (auto& Tj : Ti->m_strongChildren) {
+                auto it = m_txOrder.find(Tj);
+                if (it == m_txOrder.end() || it->second < i) {
+                    waitFor(Ti, Tj);
+                    continue;
+                }
+                auto newScheduledTime = initialTime[it->second] + Tj->m_self_cost;
                 if (newScheduledTime > Ti->scheduledTime) {
                     Ti->scheduledTime = newScheduledTime;
                     Ti->m_should_wait = Tj;
                 }
             }
         }
-
-        // Ti->committed = std::make_shared<std::atomic<bool>>(false);
+    };
+    std::unique_ptr<std::atomic<int>[]> pending(new std::atomic<int>[n]);
+    for (int i = 0; i < n; i++) {
+        pending[i].store(m_inDegree[i], std::memory_order_relaxed);
+    }
+    // 任务持有 group, 等待者返回后仍在收尾的任务不会访问已释放的计数
+    auto group = std::make_shared<TaskGroup>();
+    group->add(n);
+    std::function<void(int)> visit = [&, group](int i) {
+        // 第一个就绪的后继由本任务接着计算, 其余交给新任务
+        while (i >= 0) {
+            schedule(i);
+            int next = -1;
+            for (auto successor : m_successors[i]) {
+                if (pending[successor].fetch_sub(1, std::memory_order_acq_rel) != 1) continue;
+                if (next < 0) {
+                    next = successor;
+                } else {
+                    pool->execute([&visit, successor, group] {visit(successor);});
+                }
+            }
+            group->done();
+            i = next;
+        }
+    };
+    for (int i = 0; i < n; i++) {
+        if (m_inDegree[i] == 0) pool->execute([&visit, i, group] {visit(i);});
     }
+    pool->wait(*group);
+    m_totalExecTime = std::max(m_totalExecTime, *std::max_element(accessEnd.begin(), accessEnd.end()));
 }
 
-
 void DeterReExecute::buildByWRSetNested(vector<Vertex::Ptr>& txList) {
     tbb::parallel_for(tbb::blocked_range<size_t>(0, txList.size()),
                       [&](const tbb::blocked_range<size_t>& range) {
@@ -788,6 +1000,19 @@ int DeterReExecute::calculateSerialTime(){
     return totalTime;
 }
 
+/* 计算 bottom level: 事务自身代价加上其后继中最大的 bottom level; 边总是从前往后, 逆序遍历即可 */
+void DeterReExecute::calculateBottomLevels() {
+    if (m_successors.size() != m_rbList.size()) resetDependencies();
+    m_bottomLevel.assign(m_dagTxs.size(), 0);
+    for (int i = (int)m_dagTxs.size() - 1; i >= 0; i--) {
+        int longest = 0;
+        for (auto successor : m_successors[i]) {
+            longest = std::max(longest, m_bottomLevel[successor]);
+        }
+        m_bottomLevel[i] = m_dagTxs[i]->m_self_cost + longest;
+    }
+}
+
 /* 定义一个处理两个方向遍历的函数 */
 void DeterReExecute::updateDependenciesAndScheduleTime(Vertex::Ptr& Tj, const Vertex::Ptr& Ti, std::unordered_set<Vertex::Ptr, Vertex::VertexHash>& unflictTxs, bool forward) {
     int start = forward ? 0 : m_rbList.size() - 1;
@@ -810,95 +1035,145 @@ void DeterReExecute::updateDependenciesAndScheduleTime(Vertex::Ptr& Tj, const Ve
 
 /* 确定性重执行模块 */
 void DeterReExecute::reExcution(UThreadPoolPtr& Pool, std::vector<std::future<void>>& futures, Statistics& statistics) {
-    
-    for (auto& tx : m_rbList) {
-        if (tx->m_should_wait) {
-            dependencyGraph[tx->m_should_wait].push_back(tx);
-        }
+    if (m_successors.size() != m_rbList.size()) resetDependencies();
+    m_pending.reset(new std::atomic<int>[m_dagTxs.size()]);
+    for (int i = 0; i < m_dagTxs.size(); i++) {
+        m_pending[i].store(m_inDegree[i], std::memory_order_relaxed);
     }
-
+    // 任务持有 group, 等待者返回后仍在收尾的任务不会访问已释放的计数
+    auto group = std::make_shared<TaskGroup>();
+    group->add(m_dagTxs.size());
+    // 按优先级调度时任务不绑定事务, 执行时取出优先级最高的就绪事务
+    std::function<void(int)> publish = [this, &Pool, &statistics, &publish, group](int index) {
+        Pool->commit([this, index, &statistics, &publish, group] {
+            this->executeTransaction(index >= 0 ? index : popReady(), statistics, publish, *group);
+        });
+    };
+    if (m_criticalPathFirst) calculateBottomLevels();
     // 在依赖关系完整建立后，提交无依赖的任务
-    for (auto& tx : m_rbList) {
-        if (!tx->m_should_wait) {
-            futures.emplace_back(Pool->commit([this, tx, &statistics] {
-                this->executeTransaction(tx, statistics);
-            }));
+    int roots = 0;
+    for (int i = 0; i < m_dagTxs.size(); i++) {
+        if (m_inDegree[i] != 0) continue;
+        if (m_criticalPathFirst) {
+            m_ready.push({m_bottomLevel[i], -i});
+            roots++;
+        } else {
+            publish(i);
         }
     }
-
-    for (auto &future : futures) {
-        future.get();
+    // 全部放入后再提交, 先执行的任务即可取到优先级最高的根
+    for (int k = 0; k < roots; k++) {
+        publish(-1);
     }
+    group->wait();
 }
 
 void DeterReExecute::reExcution(ThreadPool::Ptr& Pool, std::vector<std::future<void>>& futures, Statistics& statistics) {
-    // build dependency graph
-    for (auto& tx : m_rbList) {
-        if (tx->m_should_wait) {
-            dependencyGraph[tx->m_should_wait].push_back(tx);
-        }
+    if (m_successors.size() != m_rbList.size()) resetDependencies();
+    m_pending.reset(new std::atomic<int>[m_dagTxs.size()]);
+    for (int i = 0; i < m_dagTxs.size(); i++) {
+        m_pending[i].store(m_inDegree[i], std::memory_order_relaxed);
     }
-
+    // 任务持有 group, 等待者返回后仍在收尾的任务不会访问已释放的计数
+    auto group = std::make_shared<TaskGroup>();
+    group->add(m_dagTxs.size());
+    // 按优先级调度时任务不绑定事务, 执行时取出优先级最高的就绪事务
+    std::function<void(int)> publish = [this, &Pool, &statistics, &publish, group](int index) {
+        Pool->execute([this, index, &statistics, &publish, group] {
+            this->executeTransaction(index >= 0 ? index : popReady(), statistics, publish, *group);
+        });
+    };
+    if (m_criticalPathFirst) calculateBottomLevels();
     // 在依赖关系完整建立后，提交无依赖的任务
-    std::atomic<int> taskCounter(0);
-    std::vector<std::tuple<std::function<void()>>> taskList;
-    for (auto& tx : m_rbList) {
-        if (!tx->m_should_wait) {
-            // futures.emplace_back(Pool->enqueue([this, tx, &statistics] {
-            //     this->executeTransaction(tx, statistics);
-            // }));
-            // batch version
-            taskList.emplace_back(std::make_tuple([this, tx, &statistics] {
-                this->executeTransaction(tx, statistics);
-            }));
-            // taskCounter.fetch_add(1, std::memory_order_relaxed);
-            // taskList.emplace_back(std::make_tuple([this, tx, &statistics, &Pool, &taskCounter] {
-            //     this->executeTransactionWithPool(tx, statistics, Pool, taskCounter);
-            // }));
-        }
-    }
-    futures = Pool->enqueueBatch(taskList);
-    for (auto &future : futures) {
-        future.get();
+    int roots = 0;
+    for (int i = 0; i < m_dagTxs.size(); i++) {
+        if (m_inDegree[i] != 0) continue;
+        if (m_criticalPathFirst) {
+            m_ready.push({m_bottomLevel[i], -i});
+            roots++;
+        } else {
+            publish(i);
+        }
     }
-    // while (taskCounter.load(std::memory_order_relaxed) > 0) {
-    //     std::this_thread::yield();
-    // }
+    // 全部放入后再提交, 先执行的任务即可取到优先级最高的根
+    for (int k = 0; k < roots; k++) {
+        publish(-1);
+    }
+    Pool->wait(*group);
 }
 
-void DeterReExecute::executeTransaction(const Vertex::Ptr& tx, Statistics& statistics) {
-    tx->Execute();
-    // record the last commit time
-    // tx->m_hyperVertex->m_commit_time = chrono::steady_clock::now();
-    tx->m_hyperVertex->setCommitTime(chrono::steady_clock::now());
-    statistics.JournalRollback(tx->CountOverheads());
-    auto it = dependencyGraph.find(tx);
-    if (it != dependencyGraph.end()) {
-        auto& dependents = it->second;
-        // 递归地执行所有依赖此交易的后续交易
-        for (auto& dependent : dependents) {
-            executeTransaction(dependent, statistics);
+/* 执行事务, 完成后唤醒后继: 第一个就绪的后继(按优先级调度时为优先级最高的就绪事务)由本线程接着执行, 其余提交到线程池 */
+void DeterReExecute::executeTransaction(int index, Statistics& statistics, const std::function<void(int)>& publish, TaskGroup& group) {
+    while (index >= 0) {
+        auto& tx = m_dagTxs[index];
+        {
+            TraceScope trace("reExecute", m_blockId, -1, tx->m_hyperId);
+            tx->Execute();
+        }
+        // record the last commit time
+        tx->m_hyperVertex->setCommitTime(chrono::steady_clock::now());
+        statistics.JournalRollback(tx->CountOverheads());
+        int next = -1, ready = 0;
+        for (auto successor : m_successors[index]) {
+            if (m_pending[successor].fetch_sub(1, std::memory_order_acq_rel) != 1) continue;
+            if (m_criticalPathFirst) {
+                m_ready.push({m_bottomLevel[successor], -successor});
+                ready++;
+            } else if (next < 0) {
+                next = successor;
+            } else {
+                publish(successor);
+            }
         }
+        // 按优先级调度时每个就绪事务对应一次取出: 本线程取一个, 其余由新任务取出
+        if (ready > 0) {
+            for (int k = 1; k < ready; k++) {
+                publish(-1);
+            }
+            next = popReady();
+        }
+        // 本事务完成后不再访问依赖图, 最后一个事务完成时等待者可能已经返回
+        group.done();
+        index = next;
+    }
+}
+
+/* 取出优先级最高的就绪事务; 每次取出之前都有对应的放入, 队列只会短暂为空 */
+int DeterReExecute::popReady() {
+    std::pair<int, int> item;
+    while (!m_ready.try_pop(item)) {
+        std::this_thread::yield();
     }
+    return -item.second;
 }
 
-void DeterReExecute::executeTransactionWithPool(const Vertex::Ptr& tx, Statistics& statistics, ThreadPool::Ptr& Pool, std::atomic<int>& taskCounter) {
-    tx->Execute();
-    // tx->m_hyperVertex->m_commit_time = chrono::steady_clock::now();
-    tx->m_hyperVertex->setCommitTime(chrono::steady_clock::now());
-    statistics.JournalRollback(tx->CountOverheads());
-    auto it = dependencyGraph.find(tx);
-    if (it != dependencyGraph.end()) {
-        auto& dependents = it->second;
-        // 对于每个依赖项，提交任务到线程池，并将它们的 future 添加到 futures 中
-        for (auto& dependent : dependents) {
-            taskCounter.fetch_add(1, std::memory_order_relaxed);
-            Pool->enqueue([this, dependent, &statistics, &Pool, &taskCounter] {
-                executeTransactionWithPool(dependent, statistics, Pool, taskCounter);
-            });
+/* 清空依赖图, 节点为此时 m_rbList 中的下标; m_rbList 被重排过时同时更新事务顺序 */
+void DeterReExecute::resetDependencies() {
+    if (m_dagTxs != m_rbList) {
+        m_dagTxs = m_rbList;
+        for (int i = 0; i < m_dagTxs.size(); i++) {
+            m_txOrder[m_dagTxs[i]] = i;
         }
     }
-    taskCounter.fetch_sub(1, std::memory_order_relaxed);
+    m_successors.assign(m_rbList.size(), {});
+    m_inDegree.assign(m_rbList.size(), 0);
+    m_lastSuccessor.assign(m_rbList.size(), -1);
+}
+
+/* 记录 m_rbList[i] 依赖 Tj; 依赖图按 m_rbList 顺序构建, 排在 i 之后或不在 m_rbList 中的 Tj 不构成依赖 */
+void DeterReExecute::addDependency(int i, const Vertex::Ptr& Tj) {
+    auto it = m_txOrder.find(Tj);
+    if (it != m_txOrder.end()) addDependency(i, it->second);
+}
+
+/* 记录 m_rbList[i] 依赖 m_rbList[j] */
+void DeterReExecute::addDependency(int i, int j) {
+    if (j >= i) return;
+    // 依次处理每个 i, 因此只需记住 j 最近加入的后继即可去重
+    if (m_lastSuccessor[j] == i) return;
+    m_lastSuccessor[j] = i;
+    m_successors[j].push_back(i);
+    m_inDegree[i]++;
 }
 
 /* 获取事务列表 */
@@ -915,8 +1190,8 @@ void DeterReExecute::setNormalList(const vector<Vertex::Ptr>& rbList, vector<Ver
     for (auto& rb : rbList) {
         int hyperId = rb->m_hyperId;
         if (hyperId2Flag.find(hyperId) == hyperId2Flag.end()) {
-            // 形成一个新的vertex对象
-            auto tx = std::make_shared<Vertex>(std::move(*rb));
+            // 形成一个新的vertex对象, 复制而不移动区块中的回滚事务, 区块可再次执行
+            auto tx = std::make_shared<Vertex>(*rb);
             hyperId2Flag[tx->m_hyperId] = true;
             hyperId2Tx[tx->m_hyperId] = tx;
             normalList.push_back(tx);
@@ -924,27 +1199,29 @@ void DeterReExecute::setNormalList(const vector<Vertex::Ptr>& rbList, vector<Ver
             auto& tx = hyperId2Tx[hyperId];
             // 合并事务
             tx->m_self_cost += rb->m_self_cost;
-            tx->readSet.insert(rb->readSet.begin(), rb->readSet.end());
-            tx->writeSet.insert(rb->writeSet.begin(), rb->writeSet.end());
+            tx->readSet.insert(rb->readSet);
+            tx->writeSet.insert(rb->writeSet);
         }
     }
 }
 
 void DeterReExecute::setNormalList(const vector<Vertex::Ptr>& rbList, vector<HyperVertex::Ptr>& normalList) {
-    unordered_map<int, bool> hyperId2Flag;
+    unordered_map<int, HyperVertex::Ptr> hyperId2Tx;
     for (auto& rb : rbList) {
-        int& hyperId = rb->m_hyperId;
-        auto& hvTx = rb->m_tx;
-        if (hyperId2Flag.find(hyperId) == hyperId2Flag.end()) {
-            // 形成一个新的vertex对象
-            hvTx->m_rootVertex = rb;
-            hyperId2Flag[hyperId] = true;
+        int hyperId = rb->m_hyperId;
+        auto it = hyperId2Tx.find(hyperId);
+        if (it == hyperId2Tx.end()) {
+            // 形成新的超节点与vertex对象, 不修改区块中的超节点
+            auto hvTx = std::make_shared<HyperVertex>(hyperId, rb->m_tx && rb->m_tx->m_isNested);
+            hvTx->m_rootVertex = std::make_shared<Vertex>(*rb);
+            hyperId2Tx[hyperId] = hvTx;
             normalList.push_back(hvTx);
         } else {
+            auto& hvTx = it->second;
             // 合并事务
             hvTx->m_rootVertex->m_self_cost += rb->m_self_cost;
-            hvTx->m_rootVertex->readSet.insert(rb->readSet.begin(), rb->readSet.end());
-            hvTx->m_rootVertex->writeSet.insert(rb->writeSet.begin(), rb->writeSet.end());
+            hvTx->m_rootVertex->readSet.insert(rb->readSet);
+            hvTx->m_rootVertex->writeSet.insert(rb->writeSet);
         }
     }
 }
@@ -2,12 +2,17 @@
 
 #include <vector>
 #include <mutex>
+#include <atomic>
+#include <functional>
+#include <memory>
 #include <tbb/concurrent_unordered_map.h>
+#include <tbb/concurrent_priority_queue.h>
 #include <loom/utils/ThreadPool/UThreadPool.h>
 #include <loom/utils/thread/ThreadPool.h>
 #include <loom/protocol/loom/common.h>
 #include <tbb/tbb.h>
 #include <loom/utils/Statistic/Statistics.h>
+#include <loom/utils/Statistic/Trace.h>
 
 using namespace loom;
 
@@ -15,9 +20,9 @@ class DeterReExecute {
     // 定义公有函数
     public:
         
-        DeterReExecute(std::vector<Vertex::Ptr>& rbList, vector<vector<int>>& serialOrders, std::unordered_map<Vertex::Ptr, unordered_set<Vertex::Ptr, Vertex::VertexHash>, Vertex::VertexHash>& conflictIndex); // 构造函数
+        DeterReExecute(std::vector<Vertex::Ptr>& rbList, vector<vector<int>>& serialOrders, const std::unordered_map<Vertex::Ptr, unordered_set<Vertex::Ptr, Vertex::VertexHash>, Vertex::VertexHash>& conflictIndex); // 构造函数
         
-        DeterReExecute(std::vector<HyperVertex::Ptr>& normalList, vector<vector<int>>& serialOrders, std::unordered_map<Vertex::Ptr, unordered_set<Vertex::Ptr, Vertex::VertexHash>, Vertex::VertexHash>& conflictIndex, std::vector<Vertex::Ptr>& rbList); // 构造函数
+        DeterReExecute(std::vector<HyperVertex::Ptr>& normalList, vector<vector<int>>& serialOrders, const std::unordered_map<Vertex::Ptr, unordered_set<Vertex::Ptr, Vertex::VertexHash>, Vertex::VertexHash>& conflictIndex, std::vector<Vertex::Ptr>& rbList); // 构造函数
 
         ~DeterReExecute(){}; // 析构函数
 
@@ -30,12 +35,17 @@ class DeterReExecute {
         void buildGraphConcurrent(Util::UThreadPoolPtr& Pool, std::vector<std::future<void>>& futures); // 并发构建时空图
         void buildAndReScheduleFlat();
         void buildAndReSchedule();
+        void buildAndReScheduleParallel(bool nested, ThreadPool::Ptr& pool); // 在线程池上并行构建时空图, 结果与 buildAndReSchedule(nested)/buildAndReScheduleFlat 相同
         void buildByWRSetNested(vector<Vertex::Ptr>& txList);
         void rescheduleTransactions(); // 重调度事务
         void getCandidateTxSet(const Vertex::Ptr& Tx, std::set<Vertex::Ptr, loom::lessScheduledTime>& Ts); // 获取候选重调度事务集
         void reschedule(Vertex::Ptr& Tx, int startTime); // 重调度事务，移动至时空图目标位置
         void recursiveRescheduleTxs(const Vertex::Ptr& Ti, const Vertex::Ptr& Tx, std::set<string>& movedTxIds, const std::set<Vertex::Ptr>& originalDependencies); // 递归重调度事务
         void clearGraph(); // 清空时空图
+        void resetDependencies(); // 清空依赖图, 节点为此时 m_rbList 中的下标
+        void addDependency(int i, const Vertex::Ptr& Tj); // 记录 m_rbList[i] 依赖 Tj, 只接受排在 i 之前的 Tj
+        void addDependency(int i, int j); // 记录 m_rbList[i] 依赖 m_rbList[j], 只接受 j < i
+        static void waitFor(const Vertex::Ptr& Ti, const Vertex::Ptr& Tj); // Ti 的调度时间不早于 Tj 结束
 
         // 时间计算模块
         int calculateTotalExecutionTime();      // 计算事务总执行时间
@@ -44,6 +54,8 @@ class DeterReExecute {
         int calculateExecutionTime(Vertex::Ptr& Tx); // 计算事务执行时间
         int calculateNormalExecutionTime(Vertex::Ptr& Tx);
         int calculateSerialTime(); // 计算事务串行执行时间
+        void calculateBottomLevels(); // 计算依赖图中每个事务到终点的最长路径(含自身代价)
+        const std::vector<int>& getBottomLevels() const {return m_bottomLevel;}
 
         // 功能函数模块
         std::vector<Vertex::Ptr>& getRbList(); // 获取事务列表
@@ -51,20 +63,26 @@ class DeterReExecute {
         bool canReorder(const Vertex::Ptr& Tx1, const Vertex::Ptr& Tx2); // 判断两个事务是否可调序
         static void setNormalList(const vector<Vertex::Ptr>& rbList, vector<Vertex::Ptr>& normalList);
         static void setNormalList(const vector<Vertex::Ptr>& rbList, vector<HyperVertex::Ptr>& normalList);
+        /// @brief 可选的调度策略: 就绪事务按 bottom level 从高到低执行, 关键路径上的事务优先
+        void setCriticalPathFirst(bool enable) {m_criticalPathFirst = enable;}
+        /// @brief 重执行所属的区块, 记录在 trace 的重执行区间上
+        void setBlockId(int64_t blockId) {m_blockId = blockId;}
+        /// @brief 按 buildAndReSchedule(Flat) 建立的依赖图并发重执行 m_rbList, 返回时全部执行完成
+        ///        事务的所有前驱(写写、读写、强依赖子事务)执行完后才会执行; 未构图时所有事务互不等待
+        ///        futures 不再使用, 保留参数以兼容调用方
         void reExcution(Util::UThreadPoolPtr& Pool, std::vector<std::future<void>>& futures, Statistics& statistics);
         void reExcution(ThreadPool::Ptr& Pool, std::vector<std::future<void>>& futures, Statistics& statistics);
-        void executeTransaction(const Vertex::Ptr& tx, Statistics& statistics);
-        void executeTransactionWithPool(const Vertex::Ptr& tx, Statistics& statistics, ThreadPool::Ptr& Pool, std::atomic<int>& taskCounter);
 
     // 定义私有变量
     private:
         // 时空图模块
-        tbb::concurrent_unordered_map<string, LoomLockEntry<Vertex::Ptr>> m_tsGraph; // 时空图
-        // std::unordered_map<string, LoomLockEntry<Vertex::Ptr>> m_tsGraph; // 时空图
+        tbb::concurrent_unordered_map<Key, LoomLockEntry<Vertex::Ptr>> m_tsGraph; // 时空图, 供 buildGraph 系列使用; buildAndReSchedule 系列使用 TimeSpaceGraph
+        // std::unordered_map<Key, LoomLockEntry<Vertex::Ptr>> m_tsGraph; // 时空图
         std::vector<Vertex::Ptr>& m_rbList;                         // 事务列表
         std::vector<HyperVertex::Ptr>& m_normalList;                // 普通事务列表
         std::unordered_map<int, int> m_orderIndex;                  // 事务顺序索引,用于判断两个事务是否在一个集合中.在一个集合代表无法调序,不在一个集合代表可以调序
-        std::unordered_map<Vertex::Ptr, unordered_set<Vertex::Ptr, Vertex::VertexHash>, Vertex::VertexHash>& m_conflictIndex; // 读写冲突索引
+        const std::unordered_map<Vertex::Ptr, unordered_set<Vertex::Ptr, Vertex::VertexHash>, Vertex::VertexHash>& m_conflictIndex; // 读写冲突索引, 只读
+        const unordered_set<Vertex::Ptr, Vertex::VertexHash>& getConflictTxs(const Vertex::Ptr& tx) const; // 获取与事务冲突的事务集合
         std::vector<vector<int>>& m_serialOrders;                    // 事务串行化顺序
         std::unordered_map<Vertex::Ptr, int> m_txOrder;             // 事务到顺序的映射
         // tbb::concurrent_unordered_map<string, std::unordered_set<Vertex::Ptr, Vertex::VertexHash>> m_unConflictTxMap;  // 无冲突事务映射，记录与每个事务不冲突的事务集合
@@ -77,7 +95,19 @@ class DeterReExecute {
         int m_threadsNum;                                           // 线程数
         int m_totalExecTime;                                        // 总执行时间
         std::mutex mtx;                                             // 用于并发访问 m_tsGraph
-        std::unordered_map<Vertex::Ptr, std::vector<Vertex::Ptr>> dependencyGraph; // 记录依赖关系
+        // 依赖图: 以事务在构图时 m_rbList 中的下标为节点, 边总是从前往后, 因此无环
+        std::vector<Vertex::Ptr> m_dagTxs;                          // 构图时 m_rbList 的副本, 之后重排 m_rbList(如 calculateTotalExecutionTime)不影响依赖图
+        std::vector<std::vector<int>> m_successors;                 // 每个事务的后继
+        std::vector<int> m_inDegree;                                // 每个事务的前驱数
+        std::vector<int> m_lastSuccessor;                           // 最近一次加入的后继, 用于去重
+        std::unique_ptr<std::atomic<int>[]> m_pending;              // 重执行时尚未完成的前驱数
+        static constexpr int PARALLEL_BUILD_MIN_TXS = 512;         // 事务数少于该值时串行构建更快
+        bool m_criticalPathFirst = false;                           // 是否按 bottom level 调度就绪事务
+        int64_t m_blockId = -1;                                     // 所属区块, 未知时为 -1
+        std::vector<int> m_bottomLevel;                             // 每个事务的 bottom level
+        tbb::concurrent_priority_queue<std::pair<int, int>> m_ready; // 就绪事务 (bottom level, -下标), 相同时排在前面的优先
+        int popReady(); // 取出优先级最高的就绪事务
+        void executeTransaction(int index, Statistics& statistics, const std::function<void(int)>& publish, TaskGroup& group); // 执行事务及其就绪的后继
 
         // others
         static std::vector<HyperVertex::Ptr> dummyNormalList;
@@ -0,0 +1,125 @@
+#include <loom/protocol/loom/IndexBuilder.h>
+#include <loom/workload/tpcc/Keys.hpp>
+#include <glog/logging.h>
+
+using namespace std;
+
+namespace loom {
+
+IndexBuilder::IndexBuilder(ThreadPool::Ptr pool) : m_pool(pool), m_partitionNum(max(pool->getThreadNum(), 0) + 1) {}
+
+/// @brief build all indexes of a block from the observed read/write sets
+/// @param batch the pre-executed transactions of the block
+/// @param block the block to store the indexes
+void IndexBuilder::build(const vector<shared_ptr<LoomTransaction>>& batch, Block::Ptr block) {
+    size_t P = m_partitionNum;
+
+    // 1. 按事务并行, 将访问按键分区, 节点按分片登记; 每块写自己的桶, 无需加锁
+    size_t grain = max<size_t>(1, batch.size() / (P * 8));
+    size_t chunks = (batch.size() + grain - 1) / grain;
+    vector<vector<vector<Access>>> accesses(chunks, vector<vector<Access>>(P));
+    vector<vector<vector<const Vertex::Ptr*>>> vertices(chunks, vector<vector<const Vertex::Ptr*>>(P));
+    m_pool->parallelFor(0, batch.size(), grain, [&](size_t lo, size_t hi) {
+        auto& access = accesses[lo / grain];
+        auto& vertex = vertices[lo / grain];
+        for (size_t i = lo; i < hi; ++i) {
+            auto& tx = batch[i];
+            for (auto& v : tx->GetTx()->m_vertices) {
+                vertex[vertexShard(v)].push_back(&v);
+                // 只登记预执行实际观察到的键, 并归属到声明该键的子事务
+                for (auto& key : v->readSet) {
+                    if (tx->local_get.count(key)) access[keyPartition(key)].push_back({key, &v, false});
+                }
+                for (auto& key : v->writeSet) {
+                    if (tx->local_put.count(key)) access[keyPartition(key)].push_back({key, &v, true});
+                }
+            }
+        }
+    });
+
+    // 2. 按键分区并行, 构建倒排索引与回滚索引, 并生成按源节点分片的 rw边/冲突边
+    vector<InvertedIndex> inverted(P);
+    vector<RollbackIndex> rollback(P);
+    vector<vector<vector<Edge>>> rwEdges(P, vector<vector<Edge>>(P));
+    vector<vector<vector<Edge>>> conflictEdges(P, vector<vector<Edge>>(P));
+    m_pool->parallelFor(0, P, 1, [&](size_t p, size_t) {
+        auto& index = inverted[p];
+        for (auto& chunk : accesses) {
+            for (auto& a : chunk[p]) {
+                auto& sets = index[a.key];
+                (a.write ? sets.writeSet : sets.readSet).insert(*a.vertex);
+            }
+        }
+        // 以下边的端点指向倒排索引集合中的元素, 节点式容器中元素地址在拼接前后都不变
+        auto& rw = rwEdges[p];
+        auto& conflict = conflictEdges[p];
+        for (auto& [key, sets] : index) {
+            auto& readers = sets.readSet;
+            auto& writers = sets.writeSet;
+            if (writers.empty()) continue;
+            // 写者与所有读者、写者冲突, 读者与所有写者冲突
+            for (auto& w : writers) {
+                auto& edges = conflict[vertexShard(w)];
+                for (auto& x : readers) if (x != w) edges.emplace_back(&w, &x);
+                for (auto& x : writers) if (x != w) edges.emplace_back(&w, &x);
+            }
+            for (auto& r : readers) {
+                auto& edges = conflict[vertexShard(r)];
+                for (auto& w : writers) if (w != r) edges.emplace_back(&r, &w);
+            }
+            // 回滚索引覆盖的键: 同时读写该键的事务多于一个时登记, 不再生成 rw边
+            if (TPCC::isRollbackIndexed(key)) {
+                set<Vertex::Ptr, Vertex::VertexCompare> intersectTxs;
+                for (auto& rTx : readers) {
+                    if (writers.count(rTx)) intersectTxs.insert(rTx);
+                }
+                if (intersectTxs.size() > 1) {
+                    rollback[p][key] = std::move(intersectTxs);
+                }
+                continue;
+            }
+            for (auto& r : readers) {
+                auto& edges = rw[vertexShard(r)];
+                // 读者即使只与自己冲突也登记空集合, 与预先构建的索引保持一致
+                edges.emplace_back(&r, nullptr);
+                for (auto& w : writers) if (w != r) edges.emplace_back(&r, &w);
+            }
+        }
+    });
+
+    // 3. 按节点分片并行汇总两个节点索引; 每个节点都在冲突索引中有条目, 重执行时只读访问
+    vector<VertexIndex> rwIndex(P), conflictIndex(P);
+    m_pool->parallelFor(0, P, 1, [&](size_t s, size_t) {
+        for (auto& chunk : vertices) {
+            for (auto v : chunk[s]) conflictIndex[s][*v];
+        }
+        for (size_t p = 0; p < P; ++p) {
+            for (auto& [from, to] : rwEdges[p][s]) {
+                auto& targets = rwIndex[s][*from];
+                if (to) targets.insert(*to);
+            }
+            for (auto& [from, to] : conflictEdges[p][s]) {
+                conflictIndex[s][*from].insert(*to);
+            }
+        }
+    });
+
+    // 4. 拼接各分区结果, merge 只转移节点, 不复制其中的集合
+    InvertedIndex invertedIndex;
+    RollbackIndex RBIndex;
+    VertexIndex RWIndex, conflictIdx;
+    for (size_t p = 0; p < P; ++p) {
+        invertedIndex.merge(inverted[p]);
+        RBIndex.merge(rollback[p]);
+        RWIndex.merge(rwIndex[p]);
+        conflictIdx.merge(conflictIndex[p]);
+    }
+    DLOG(INFO) << "online index of block " << block->getBlockId() << ": " << invertedIndex.size() << " keys, "
+               << RWIndex.size() << " rw vertices, " << RBIndex.size() << " rollback keys";
+    block->setInvertedIndex(std::move(invertedIndex));
+    block->setRWIndex(std::move(RWIndex));
+    block->setConflictIndex(std::move(conflictIdx));
+    block->setRBIndex(std::move(RBIndex));
+}
+
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <set>
+#include <loom/common/Block.h>
+#include <loom/protocol/loom/Loom.h>
+#include <loom/utils/thread/ThreadPool.h>
+
+namespace loom {
+
+/// @brief 根据预执行时记录的读写集(local_get/local_put)在线构建区块的倒排索引、rw冲突索引、冲突索引和回滚索引
+///        1. 按事务并行: 将每个子事务的读写访问按键分区写入各自的桶
+///        2. 按键分区并行: 构建分区内的倒排索引, 生成回滚索引与 rw/冲突边, 边再按源节点分片
+///        3. 按节点分片并行: 汇总 rw冲突索引与冲突索引, 最后整体拼接(只移动节点, 不复制集合)
+class IndexBuilder {
+    public:
+        typedef std::unordered_map<Vertex::Ptr, std::unordered_set<Vertex::Ptr, Vertex::VertexHash>, Vertex::VertexHash> VertexIndex;
+        typedef std::unordered_map<Key, loom::RWSets<Vertex::Ptr>> InvertedIndex;
+        typedef std::unordered_map<Key, std::set<Vertex::Ptr, Vertex::VertexCompare>> RollbackIndex;
+
+        /// @param pool 执行构建的线程池, 分区数取线程数 + 1(调用线程同样参与)
+        explicit IndexBuilder(ThreadPool::Ptr pool);
+
+        /// @brief 构建 batch 对应的全部索引并写回 block, 覆盖其原有索引
+        void build(const std::vector<std::shared_ptr<LoomTransaction>>& batch, Block::Ptr block);
+
+    private:
+        // 一次读或写访问; 节点指针指向超节点 m_vertices 中的元素, 构建期间地址不变
+        struct Access {
+            Key key;
+            const Vertex::Ptr* vertex;
+            bool write;
+        };
+        typedef std::pair<const Vertex::Ptr*, const Vertex::Ptr*> Edge;
+
+        size_t keyPartition(Key key) const {return KeyHasher()(key) % m_partitionNum;}
+        size_t vertexShard(const Vertex::Ptr& vertex) const {return KeyHasher()(reinterpret_cast<uintptr_t>(vertex.get())) % m_partitionNum;}
+
+        ThreadPool::Ptr m_pool;
+        size_t m_partitionNum;
+};
+
+}
@@ -1,221 +1,204 @@
 #include <loom/protocol/loom/Loom.h>
 #include <loom/protocol/loom/MinWRollback.h>
 #include <loom/protocol/loom/DeterReExecute.h>
+#include <loom/protocol/loom/IndexBuilder.h>
 #include <glog/logging.h>
 #include <fmt/core.h>
+#include <algorithm>
 
 using namespace std;
 using namespace loom;
 
 #define T shared_ptr<LoomTransaction>
-#define K string
+#define K loom::Key
 
 using namespace std::chrono;
 
 /// @brief initialize loom protocol
-/// @param blocks the blocks to be executed
+/// @param source the source to pull blocks from
 /// @param num_threads the number of threads
 /// @param table_partitions the number of partitions for the table
+/// @param pipeline_depth the number of blocks in flight in inter-block mode
+/// @param critical_path_first re-execute ready transactions with the longest remaining path first
 Loom::Loom(
-    vector<Block::Ptr>& blocks,
+    BlockSource::Ptr source,
     Statistics& statistics,
     size_t num_threads, 
     size_t table_partitions,
     bool enable_nested_reExecution,
-    bool enable_inter_block
+    bool enable_inter_block,
+    bool enable_online_index,
+    size_t pipeline_depth,
+    bool critical_path_first
 ):
-    blocks(blocks),
+    source(std::move(source)),
     statistics(statistics),
-    batches(), // empty
     enable_inter_block(enable_inter_block),
     enable_nested_reExecution(enable_nested_reExecution),
+    enable_online_index(enable_online_index),
+    pipeline_depth(pipeline_depth),
+    critical_path_first(critical_path_first),
     table(table_partitions),
     num_threads(num_threads),
     pool1(make_shared<ThreadPool>(num_threads)),
-    block_idx(0),
-    committed_block(0),
-    canRetry(false)
+    block_idx(0)
 {
+    this->table.Reserve(this->source->keyHint());
     // pool2 = make_shared<ThreadPool>(num_threads, num_threads);
-    LOG(INFO) << fmt::format("Loom(num_threads={}, table_partitions={}, enable_inter_block={}, enable_nested_reExecution={})", num_threads, table_partitions, enable_inter_block, enable_nested_reExecution) << endl;
+    if (enable_inter_block) {
+        // pre-execute -> rollback -> re-execute -> finalize, each stage handles one block at a time in block order
+        pipeline = make_unique<Pipeline>(pipeline_depth, vector<Pipeline::Stage>{
+            [this](shared_ptr<PipelineBlock>& ctx) {
+                ctx->block_begin = chrono::steady_clock::now();
+                ctx->batch = MakeBatch(ctx->block, ctx->batch_id);
+                PreExecuteInterBlock(ctx->batch, ctx->block->getBlockId());
+            },
+            [this](shared_ptr<PipelineBlock>& ctx) {
+                ctx->finalize_time = MinWRollBack(ctx->batch, ctx->block, ctx->rbList, ctx->serialOrders, pool1);
+            },
+            [this](shared_ptr<PipelineBlock>& ctx) {
+                ReExecute(ctx->block, ctx->rbList, ctx->serialOrders, pool1);
+            },
+            [this](shared_ptr<PipelineBlock>& ctx) {
+                FinalizeBlock(ctx->block, ctx->batch, ctx->finalize_time, ctx->block_begin);
+                // the block leaves the pipeline, release its transactions
+                ctx.reset();
+            }
+        });
+    }
+    LOG(INFO) << fmt::format("Loom(num_threads={}, table_partitions={}, enable_inter_block={}, enable_nested_reExecution={}, enable_online_index={}, pipeline_depth={}, critical_path_first={})", num_threads, table_partitions, enable_inter_block, enable_nested_reExecution, enable_online_index, pipeline_depth, critical_path_first) << endl;
+}
+
+/// @brief initialize loom protocol with pre-generated blocks
+/// @param blocks the blocks to be executed
+Loom::Loom(
+    vector<Block::Ptr>& blocks,
+    Statistics& statistics,
+    size_t num_threads, 
+    size_t table_partitions,
+    bool enable_nested_reExecution,
+    bool enable_inter_block,
+    bool enable_online_index,
+    size_t pipeline_depth,
+    bool critical_path_first
+):
+    Loom(make_shared<VectorBlockSource>(blocks), statistics, num_threads, table_partitions, enable_nested_reExecution, enable_inter_block, enable_online_index, pipeline_depth, critical_path_first)
+{}
+
+/// @brief drain the pipeline before the members are destroyed, its stages still use the thread pool and the table
+Loom::~Loom() {
+    if (pipeline) pipeline->Drain();
 }
 
 /// @brief start loom protocol
 void Loom::Start() {
     LOG(INFO) << "Loom started";
-    
-    // split blocks into batches
-    for (size_t i = 0; i < blocks.size(); ++i) {
-        auto& block = blocks[i];
-        auto& txs = block->getTxs();
-        vector<T> batch;
-        batch.reserve(txs.size());
-        size_t batch_id = i + 1;
-        // get all batch of one block
-        for (size_t j = 0; j < txs.size(); j++) {
-            auto& tx = txs[j];
-            size_t txid = tx->GetTx()->m_hyperId;
-            batch.emplace_back(make_shared<LoomTransaction>(std::move(*tx), txid, batch_id));
-        }
-        // store block batch
-        batches.push_back(std::move(batch));
-    }
 
-    // execute each batch
     if (enable_inter_block) {
-        InterBlockMode(blocks[block_idx], std::move(batches[block_idx]));
-    } else {
-        for (auto& block : blocks) {
-            NormalMode(block, batches[block_idx++]);
-        }
+        InterBlockMode();
+        return;
+    }
+    // pull blocks one by one, each block is split into a batch right before its execution
+    while (auto block = source->next()) {
+        auto batch = MakeBatch(block, ++block_idx);
+        NormalMode(block, batch);
     }
-
-    // // wait for all blocks to be committed
-    // while (committed_block.load() < blocks.size()) {
-    //     this_thread::sleep_for(chrono::milliseconds(100));
-    // }
 }
 
 /// @brief stop loom protocol
 void Loom::Stop() {
+    source->close();
+    // wait for the blocks in the pipeline, they still use the thread pool
+    if (pipeline) pipeline->Drain();
     pool1->shutdown();
     LOG(INFO) << "Loom stopped";
 }
 
+/// @brief wrap the transactions of a block into loom transactions
+/// @param block the block to be executed
+/// @param batch_id the id of the batch
+/// @return the batch of the block
+vector<T> Loom::MakeBatch(const Block::Ptr& block, size_t batch_id) {
+    auto& txs = block->getTxs();
+    vector<T> batch;
+    batch.reserve(txs.size());
+    for (auto& tx : txs) {
+        size_t txid = tx->GetTx()->m_hyperId;
+        batch.emplace_back(make_shared<LoomTransaction>(Transaction(*tx), txid, batch_id));
+    }
+    return batch;
+}
+
 /// @brief execute transactions in normal mode
 /// @param block the block to be executed
 /// @param batch the transactions to be executed
 void Loom::NormalMode(Block::Ptr block, vector<T>& batch) {
-    #define LATENCY duration_cast<microseconds>(tx->GetTx()->m_commit_time - tx->start_time).count()
-    #define COMMIT_TIME tx->GetTx()->m_commit_time
-
+    auto block_begin = chrono::steady_clock::now();
     vector<Vertex::Ptr> rbList;
     vector<vector<int>> serialOrders;
-    vector<future<void>> finalFutures;
     // pre-execute
     PreExecute(batch, block->getBlockId());
 
     // minW-rollback
-    MinWRollBack(batch, block, rbList, serialOrders, pool1);
+    auto finalize_time = MinWRollBack(batch, block, rbList, serialOrders, pool1);
 
     // re-execute
     ReExecute(block, rbList, serialOrders, pool1);
 
     // finalize
-    std::vector<std::tuple<std::function<void()>>> finalizeTasks;
-    for (auto tx : batch) {
-        if (!tx->committed.load()) {
-            statistics.JournalCommit(LATENCY, COMMIT_TIME);
-            // finalFutures.push_back(pool->enqueue([this, tx] {
-            //     ClearTable(tx);
-            // }));
-            finalizeTasks.emplace_back(std::make_tuple([this, tx] {
-                ClearTable(tx);
-            }));
-        }
-    }
-    finalFutures = pool1->enqueueBatch(finalizeTasks);
-    for (auto& future : finalFutures) {
-        future.get();
-    }
-
-    // mark block as committed
-    // committed_block.fetch_add(1, memory_order_relaxed);
-    statistics.JournalBlock();
-    LOG(INFO) << "Block " << block->getBlockId() << " finalize done";
-    #undef LATENCY
-    #undef COMMIT_TIME
-}
-
-/* old version */
-/// @brief execute transactions in inter-block mode
-/// @param block the block to be executed
-/// @param batch the transactions to be executed
-void Loom::InterBlockMode(Block::Ptr block, vector<T> batch) {
-    DLOG(INFO) << "InterBlockMode block " << block->getBlockId();
-    // pre-execute
-    PreExecuteInterBlock(batch, block->getBlockId());
-
-    // Start post-execution in a separate thread
-    thread postExecThread(&Loom::PostExecuteBlock, this, block, std::move(batch), pool1);
-    // Allow post-execution to run independently
-    postExecThread.detach();
-    
-    // concurrent next block
-    if (++block_idx < blocks.size()) {
-        InterBlockMode(blocks[block_idx], std::move(batches[block_idx]));
-    }
+    FinalizeBlock(block, batch, finalize_time, block_begin);
 }
 
-/*
-/// @brief execute transactions in inter-block mode
-/// @param block the block to be executed
-/// @param batch the transactions to be executed
-void Loom::InterBlockMode(Block::Ptr block, vector<T> batch) {
-    DLOG(INFO) << "InterBlockMode block " << block->getBlockId();
-    // pre-execute
-    PreExecute(batch, block->getBlockId());
-
-    // concurrent next block
-    if (++block_idx < blocks.size()) {
-        // Start post-execution in a separate thread
-        thread nextExecThread(&Loom::ExecuteNextBlock, this, blocks[block_idx], std::move(batches[block_idx]));
-        // Allow post-execution to run independently
-        nextExecThread.detach();
+/// @brief execute transactions in inter-block mode: pull blocks into the pipeline until the source is exhausted or closed
+///        at most pipeline_depth blocks are in flight, the pre-execution of a block overlaps with the later stages of the previous ones
+void Loom::InterBlockMode() {
+    while (auto block = source->next()) {
+        auto ctx = make_shared<PipelineBlock>();
+        ctx->block = block;
+        ctx->batch_id = ++block_idx;
+        DLOG(INFO) << "InterBlockMode block " << block->getBlockId();
+        // wait for a free slot, the pipeline is only closed by Stop
+        if (!pipeline->Push(std::move(ctx))) break;
     }
-
-    // Start post-execution in a separate thread
-    PostExecuteBlock(block, batch, pool1);
+    // all blocks pushed are committed in order when this returns
+    pipeline->Drain();
 }
 
-void Loom::ExecuteNextBlock(Block::Ptr block, vector<T> batch) {
-    DLOG(INFO) << "ExecuteNextBlock block " << block->getBlockId();
-    PreExecuteInterBlock(batch, block->getBlockId());
-    PostExecuteBlock(block, batch, pool2);
-}
-*/
-
-/// @brief run rest phrase of loom protocol
-/// @param block the block to be executed
-/// @param batch the transactions to be executed
-void Loom::PostExecuteBlock(Block::Ptr block, vector<T> batch, ThreadPool::Ptr pool) {
+/// @brief commit the remaining transactions of a block and release its reservations
+/// @param block the block to be finalized
+/// @param batch the transactions of the block
+/// @param finalize_time the time spent finalizing transactions during minW-rollback in us
+/// @param block_begin the time the pre-execution of the block began
+void Loom::FinalizeBlock(Block::Ptr block, vector<T>& batch, size_t finalize_time, chrono::steady_clock::time_point block_begin) {
     #define LATENCY duration_cast<microseconds>(tx->GetTx()->m_commit_time - tx->start_time).count()
     #define COMMIT_TIME tx->GetTx()->m_commit_time
+    #define PHASE_TIME(X) duration_cast<microseconds>(chrono::steady_clock::now() - X).count()
 
-    DLOG(INFO) << "PostExecute block " << block->getBlockId();
-    vector<future<void>> finalFutures;
-    vector<Vertex::Ptr> rbList;
-    vector<vector<int>> serialOrders;
-
-    // minW-rollback
-    MinWRollBack(batch, block, rbList, serialOrders, pool);
-    // re-execute
-    ReExecute(block, rbList, serialOrders, pool);
-    // finalize
-    std::vector<std::tuple<std::function<void()>>> finalizeTasks;
+    auto finalize_begin = chrono::steady_clock::now();
+    PerfSampler perf(statistics, PerfSampler::Scope::PROCESS);
+    vector<T> finalizeTxs;
+    finalizeTxs.reserve(batch.size());
     for (auto tx : batch) {
         if (!tx->committed.load()) {
             statistics.JournalCommit(LATENCY, COMMIT_TIME);
-            // finalFutures.push_back(pool->enqueue([this, tx] {
-            //     ClearTable(tx);
-            // }));
-            finalizeTasks.emplace_back(std::make_tuple([this, tx] {
-                ClearTable(tx);
-            }));
+            finalizeTxs.push_back(tx);
         }
     }
-    finalFutures = pool->enqueueBatch(finalizeTasks);
-    for (auto& future : finalFutures) {
-        future.get();
-    }
-    // notify retry
-    notifyRetry();
-    // mark block as committed
-    // committed_block.fetch_add(1, memory_order_relaxed);
-    statistics.JournalBlock();
-    LOG(INFO) << "InterBlockMode block " << block->getBlockId() << " finalize done";
+    TaskGroup finalGroup;
+    pool1->enqueueBulk(finalGroup, finalizeTxs.begin(), finalizeTxs.end(), [this](T& tx) {
+        ClearTable(tx);
+    });
+    pool1->wait(finalGroup);
+    // clear the graph state of this run, the block itself stays intact and can be executed again
+    block->resetGraph();
+    Trace::instance().Record("clearTable", finalize_begin, chrono::steady_clock::now(), block->getBlockId());
+    statistics.JournalPhase(Phase::FINALIZE, finalize_time + PHASE_TIME(finalize_begin));
+    perf.Journal(Phase::FINALIZE);
+    statistics.JournalBlock(PHASE_TIME(block_begin));
+    LOG(INFO) << "Block " << block->getBlockId() << " finalize done";
     #undef LATENCY
     #undef COMMIT_TIME
+    #undef PHASE_TIME
 }
 
 /// @brief pre-execute transactions
@@ -223,16 +206,21 @@ void Loom::PostExecuteBlock(Block::Ptr block, vector<T> batch, ThreadPool::Ptr p
 /// @param block_id the block id
 void Loom::PreExecute(vector<T>& batch, const size_t& block_id) {
     LOG(INFO) << "PreExecute block " << block_id;
-    vector<future<void>> preExecFutures;
-    for (T tx : batch) {
-        preExecFutures.push_back(pool1->enqueue([this, tx, &block_id] {
+    TraceScope trace("PreExecute", block_id);
+    PerfSampler perf(statistics, PerfSampler::Scope::PROCESS);
+    auto begin_time = chrono::steady_clock::now();
+    // 每个事务一块, 由线程池动态领取, 调用线程同样参与, 返回时全部执行完毕
+    pool1->parallelFor(0, batch.size(), 1, [this, &batch, block_id](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; ++i) {
+            T tx = batch[i];
+            TraceScope trace("execute", block_id, -1, tx->id);
             // read locally from local storage
             tx->InstallGetStorageHandler([&](
-                const unordered_set<string>& readSet
+                const KeySet& readSet
             ) {
                 string keys;
                 for (auto& key : readSet) {
-                    keys += key + " ";
+                    keys += keyToString(key) + " ";
                     string value = "";
                     table.ReserveGet(tx, key);
                     if (tx->aborted.load()) return;
@@ -241,13 +229,13 @@ void Loom::PreExecute(vector<T>& batch, const size_t& block_id) {
             });
             // write locally to local storage
             tx->InstallSetStorageHandler([&](
-                const unordered_set<string>& writeSet,
+                const KeySet& writeSet,
                 const string& value
             ) {
                 if (tx->aborted.load()) return;
                 string keys;
                 for (auto& key : writeSet) {
-                    keys += key + " ";
+                    keys += keyToString(key) + " ";
                     table.ReservePut(tx, key);
                     tx->local_put[key] = value;
                 }
@@ -257,12 +245,10 @@ void Loom::PreExecute(vector<T>& batch, const size_t& block_id) {
             statistics.JournalExecute();
             tx->Execute();
             statistics.JournalOverheads(tx->CountOverheads());
-        }));
-    }
-    // wait for all futures to finish
-    for (auto& future : preExecFutures) {
-        future.get();
-    }
+        }
+    });
+    statistics.JournalPhase(Phase::PRE_EXECUTE, duration_cast<microseconds>(chrono::steady_clock::now() - begin_time).count());
+    perf.Journal(Phase::PRE_EXECUTE);
     LOG(INFO) << "PreExecute block " << block_id << " done";
 }
 
@@ -271,20 +257,25 @@ void Loom::PreExecute(vector<T>& batch, const size_t& block_id) {
 /// @param block_id the block id
 void Loom::PreExecuteInterBlock(vector<T>& batch, const size_t& block_id) {
     LOG(INFO) << "PreExecute inter block " << block_id;
-    vector<future<void>> preExecFutures;
-    tbb::concurrent_vector<T> retryTxs;
+    TraceScope trace("PreExecuteInterBlock", block_id);
+    PerfSampler perf(statistics, PerfSampler::Scope::PROCESS);
+    auto begin_time = chrono::steady_clock::now();
+    // 每个事务无冲突地执行完一次计数一次; 任务共享持有任务组与执行函数, 等待返回后仍在收尾的任务不会访问已释放的内存
+    auto preExecGroup = make_shared<TaskGroup>();
+    preExecGroup->add(batch.size());
     // Lambda for executing a single transaction
-    std::function<void(T)> executeTx = [&](T tx) {
+    auto executeTx = make_shared<std::function<void(T)>>([this, block_id, preExecGroup](T tx) {
         // LOG(INFO) << "PreExecute block " << block_id << " tx " << tx->id;
+        TraceScope trace("execute", block_id, -1, tx->id);
         // Reset aborted state before each execution
         tx->aborted.store(false);
         // read locally from local storage
         tx->InstallGetStorageHandler([&](
-            const unordered_set<string>& readSet
+            const KeySet& readSet
         ) {
             string keys;
             for (auto& key : readSet) {
-                keys += key + " ";
+                keys += keyToString(key) + " ";
                 string value = "";
                 table.ReserveGet(tx, key);
                 if (tx->aborted.load()) return;
@@ -293,12 +284,12 @@ void Loom::PreExecuteInterBlock(vector<T>& batch, const size_t& block_id) {
         });
         // write locally to local storage
         tx->InstallSetStorageHandler([&](
-            const unordered_set<string>& writeSet,
+            const KeySet& writeSet,
             const string& value
         ) {
             string keys;
             for (auto& key : writeSet) {
-                keys += key + " ";
+                keys += keyToString(key) + " ";
                 table.ReservePut(tx, key);
                 tx->local_put[key] = value;
             }
@@ -308,58 +299,32 @@ void Loom::PreExecuteInterBlock(vector<T>& batch, const size_t& block_id) {
         tx->Execute();
         // Check if transaction was aborted
         if (tx->aborted.load()) {
-            DLOG(WARNING) << "Transaction " << tx->id << " aborted, queuing for retry...";
-            // enqueue the task for retry and exit to avoid continuing the loop
-            retryTxs.push_back(tx);
+            DLOG(WARNING) << "Transaction " << tx->id << " aborted, waiting for the key to be released...";
+            // ReserveGet queued the transaction on the key, it is re-enqueued once the previous block releases the key
+            Resume(tx);
             return;
         }
         statistics.JournalExecute();
         statistics.JournalOverheads(tx->CountOverheads());
-    };
+        preExecGroup->done();
+    });
 
     // Enqueue all transactions for initial execution
     for (T tx : batch) {
-        preExecFutures.push_back(pool1->enqueue([this, executeTx, tx] {
-            executeTx(tx);
-        }, loom::TaskPriority::LOW_PRIORITY));
-    }
-    // wait for all futures to finish
-    for (auto& future : preExecFutures) {
-        future.get();
+        tx->retry = [executeTx](T tx) {(*executeTx)(tx);};
+        pool1->execute([executeTx, tx] {
+            (*executeTx)(tx);
+        }, loom::TaskPriority::LOW_PRIORITY);
     }
-
-    // Continue processing retry transactions until all are complete
-    while (!retryTxs.empty()) {
-        LOG(INFO) << "Block " << block_id << " wait to retry...";
-        // wait retry signal to be true
-        std::unique_lock<std::mutex> lk(mtx);
-        while (!canRetry.load()) {
-            cv.wait(lk);
-        }
-        // cv.wait(lk, [this] { return canRetry.load(); });
-        // set retry signal to false
-        resetRetry();
-        // unlock mutex
-        lk.unlock();
-
-        LOG(INFO) << "Block " << block_id << " begin to retry...";
-        // Swap retryTxs with currentTxs
-        tbb::concurrent_vector<T> currentRetryTxs = std::move(retryTxs);
-        // Clear retryTxs
-        retryTxs.clear();
-        // retry transactions
-        vector<future<void>> retryFutures;
-        for (T tx : currentRetryTxs) {
-            retryFutures.push_back(pool1->enqueue([this, executeTx, tx] { 
-                executeTx(tx);
-            }, loom::TaskPriority::LOW_PRIORITY));
-        }
-        // Wait for all retry transactions to finish
-        for (auto& future : retryFutures) {
-            future.get();
-        }
+    // wait until every transaction is executed without conflict
+    preExecGroup->wait();
+    for (T tx : batch) {
+        tx->retry = nullptr;
     }
 
+    // 包含等待前一区块释放冲突后重试的时间
+    statistics.JournalPhase(Phase::PRE_EXECUTE, duration_cast<microseconds>(chrono::steady_clock::now() - begin_time).count());
+    perf.Journal(Phase::PRE_EXECUTE);
     LOG(INFO) << "PreExecute block " << block_id << " done";
 }
 
@@ -368,83 +333,90 @@ void Loom::PreExecuteInterBlock(vector<T>& batch, const size_t& block_id) {
 /// @param block the block to be executed
 /// @param rbList the list of transactions to be rolled back
 /// @param serialOrders the serial order of transactions to be rolled back
-void Loom::MinWRollBack(vector<T>& batch, Block::Ptr block, vector<Vertex::Ptr>& rbList, vector<vector<int>>& serialOrders, ThreadPool::Ptr pool) {
+/// @return the time spent finalizing the committed transactions in us
+size_t Loom::MinWRollBack(vector<T>& batch, Block::Ptr block, vector<Vertex::Ptr>& rbList, vector<vector<int>>& serialOrders, ThreadPool::Ptr pool) {
     #define LATENCY duration_cast<microseconds>(tx->GetTx()->m_commit_time - tx->start_time).count()
     #define COMMIT_TIME tx->GetTx()->m_commit_time
     #define PRASE_TIME duration_cast<microseconds>(chrono::steady_clock::now() - begin_time).count()
 
     LOG(INFO) << "MinWRollBack block " << block->getBlockId();
     auto begin_time = chrono::steady_clock::now();
-    vector<future<void>> graphFutures, finalFutures;
-    std::vector<std::future<loom::ReExecuteInfo>> rollbackFutures;
+    auto block_id = block->getBlockId();
+    auto phase_begin = begin_time;
+    PerfSampler perf(statistics, PerfSampler::Scope::PROCESS);
+    // close the current phase: record it on the trace and the counters, start the next one and return its latency in us
+    auto endPhase = [&phase_begin, &perf, block_id](const char* name, Phase phase) {
+        auto now = chrono::steady_clock::now();
+        Trace::instance().Record(name, phase_begin, now, block_id);
+        perf.Journal(phase);
+        auto latency = duration_cast<microseconds>(now - phase_begin).count();
+        phase_begin = now;
+        return latency;
+    };
+    vector<future<void>> graphFutures;
+    // derive the block indexes from the observed read/write sets, also when the block carries none
+    if (enable_online_index || block->getKeyCount() == 0) {
+        IndexBuilder(pool).build(batch, block);
+        DLOG(INFO) << "build block " << block->getBlockId() << " index done";
+    }
     MinWRollback minw(block->getTxList(), block->getRWIndex(), num_threads);
+    minw.setRWEdges(block->getRWEdges());
     // build graph
     minw.buildGraphNoEdgeC(pool, graphFutures);
     DLOG(INFO) << "build block " << block->getBlockId() << " graph done";
-    // recognize scc
-    minw.onWarm2SCC();
+    statistics.JournalPhase(Phase::GRAPH_BUILD, endPhase("buildGraphNoEdgeC", Phase::GRAPH_BUILD));
     // rollback transactions
     minw.fastRollback(block->getRBIndex(), rbList);
-    std::vector<std::tuple<std::function<loom::ReExecuteInfo()>>> taskList;
-    for (auto& scc : minw.m_sccs) {
-        // rollbackFutures.emplace_back(pool->enqueue([this, &scc, &minw] {
-        //     // 回滚事务
-        //     auto reExecuteInfo = minw.rollbackNoEdge(scc, true);
-        //     // 获得回滚事务并根据事务顺序排序
-        //     set<Vertex::Ptr, loom::customCompare> rollbackTxs(loom::customCompare(reExecuteInfo.m_serialOrder));            
-        //     rollbackTxs.insert(reExecuteInfo.m_rollbackTxs.begin(), reExecuteInfo.m_rollbackTxs.end());
-        //     // 更新m_orderedRollbackTxs
-        //     reExecuteInfo.m_orderedRollbackTxs = std::move(rollbackTxs);
-        //     return std::move(reExecuteInfo);
-        // }));
-        taskList.emplace_back(std::make_tuple([this, &scc, &minw]() {
-            // 回滚事务
-            auto reExecuteInfo = minw.rollbackNoEdge(scc, true);
-            // 获得回滚事务并根据事务顺序排序
-            set<Vertex::Ptr, loom::customCompare> rollbackTxs(loom::customCompare(reExecuteInfo.m_serialOrder));            
-            rollbackTxs.insert(reExecuteInfo.m_rollbackTxs.begin(), reExecuteInfo.m_rollbackTxs.end());
-            // 更新m_orderedRollbackTxs
-            reExecuteInfo.m_orderedRollbackTxs = std::move(rollbackTxs);
-            return std::move(reExecuteInfo);
-        }));
-    }
-    rollbackFutures = pool->enqueueBatch(taskList);
-    // wait for all futures to finish
-    for (auto& future : rollbackFutures) {
+    auto rollback_time = endPhase("fastRollback", Phase::ROLLBACK_SELECT);
+    // recognize scc and rollback each scc as soon as it is found
+    std::mutex futureMutex;
+    std::vector<std::pair<int, std::future<loom::ReExecuteInfo>>> orderedFutures;
+    minw.onWarm2SCC(pool, [&](int order, unordered_set<HyperVertex::Ptr, HyperVertex::HyperVertexHash>& scc) {
+        auto future = pool->enqueue([&scc, &minw, block_id, order]() {
+            TraceScope trace("rollbackNoEdge", block_id, order);
+            // 回滚事务, 结果已按事务顺序排序
+            return minw.rollbackNoEdge(scc, true);
+        });
+        std::lock_guard<std::mutex> lock(futureMutex);
+        orderedFutures.emplace_back(order, std::move(future));
+    });
+    DLOG(INFO) << "recognize block " << block->getBlockId() << " scc done";
+    statistics.JournalPhase(Phase::SCC, endPhase("onWarm2SCC", Phase::SCC));
+    // collect results in deterministic scc order
+    std::sort(orderedFutures.begin(), orderedFutures.end(), [](auto& a, auto& b) {return a.first < b.first;});
+    unordered_set<Vertex::Ptr, Vertex::VertexHash> added(rbList.begin(), rbList.end());
+    for (auto& [order, future] : orderedFutures) {
         auto res = future.get();
-        // 获得回滚事务顺序
-        serialOrders.push_back(std::move(res.m_serialOrder));
-        // 将排序后的交易插入rbList
-        rbList.insert(rbList.end(), std::make_move_iterator(res.m_orderedRollbackTxs.begin()), std::make_move_iterator(res.m_orderedRollbackTxs.end()));
+        // 将排序后的交易插入rbList, 并记录回滚事务顺序
+        MinWRollback::appendRollback(res, rbList, serialOrders, added);
     }
 
     // abort all the tx in rbList
     for (auto& tx : rbList) {
         tx->m_hyperVertex->m_aborted = true;
     }
+    // scc rollbacks overlap with the recognition, only the remaining wait is counted here
+    statistics.JournalPhase(Phase::ROLLBACK_SELECT, rollback_time + endPhase("collectRollback", Phase::ROLLBACK_SELECT));
 
     // finalize all txs (maybe async latter)
-    std::vector<std::tuple<std::function<void()>>> finalizeTasks;
+    vector<T> finalizeTxs;
+    finalizeTxs.reserve(batch.size());
     for (auto tx : batch) {
         if (!tx->GetTx()->m_aborted) {
             statistics.JournalCommit(LATENCY, COMMIT_TIME);
-            // finalFutures.push_back(pool->enqueue([this, tx] {
-            //     Finalize(tx);
-            // }));
-            finalizeTasks.emplace_back(std::make_tuple([this, tx] {
-                Finalize(tx);
-            }));
+            finalizeTxs.push_back(tx);
         }
     }
-    finalFutures = pool->enqueueBatch(finalizeTasks);
-    for (auto& future : finalFutures) {
-        future.get();
-    }
+    TaskGroup finalGroup;
+    pool->enqueueBulk(finalGroup, finalizeTxs.begin(), finalizeTxs.end(), [this](T& tx) {
+        Finalize(tx);
+    });
+    pool->wait(finalGroup);
+    auto finalize_time = endPhase("finalize", Phase::FINALIZE);
 
-    // notify retry
-    // notifyRetry();
     if(block->getBlockId() != 1) statistics.JournalRollbackExecution(PRASE_TIME * 2);
     LOG(INFO) << "MinWRollBack block " << block->getBlockId() << " done";
+    return finalize_time;
     #undef LATENCY
     #undef COMMIT_TIME
     #undef PRASE_TIME
@@ -457,11 +429,15 @@ void Loom::ReExecute(Block::Ptr block, vector<Vertex::Ptr>& rbList, vector<vecto
     LOG(INFO) << "ReExecute block " << block->getBlockId() << " with nested mode: " << enable_nested_reExecution;
     std::vector<std::future<void>> reExecuteFutures;
     chrono::time_point<steady_clock> begin_time;
+    auto phase_begin = chrono::steady_clock::now();
+    PerfSampler perf(statistics, PerfSampler::Scope::PROCESS);
 
     if (enable_nested_reExecution) {
         // re-execute using nested structure
         DeterReExecute reExecute(rbList, serialOrders, block->getConflictIndex());
-        reExecute.buildAndReSchedule();
+        reExecute.setBlockId(block->getBlockId());
+        reExecute.buildAndReScheduleParallel(true, pool);
+        reExecute.setCriticalPathFirst(critical_path_first);
         begin_time = chrono::steady_clock::now();
         reExecute.reExcution(pool, reExecuteFutures, statistics);
     } else {
@@ -469,12 +445,19 @@ void Loom::ReExecute(Block::Ptr block, vector<Vertex::Ptr>& rbList, vector<vecto
         vector<Vertex::Ptr> normalList;
         DeterReExecute::setNormalList(rbList, normalList);
         DeterReExecute reExecute(normalList, serialOrders, block->getConflictIndex());
-        reExecute.buildAndReScheduleFlat();
+        reExecute.setBlockId(block->getBlockId());
+        reExecute.buildAndReScheduleParallel(false, pool);
+        reExecute.setCriticalPathFirst(critical_path_first);
         begin_time = chrono::steady_clock::now();
         reExecute.reExcution(pool, reExecuteFutures, statistics);
     }
     
+    auto end_time = chrono::steady_clock::now();
+    Trace::instance().Record(enable_nested_reExecution ? "buildAndReSchedule" : "buildAndReScheduleFlat", phase_begin, begin_time, block->getBlockId());
+    Trace::instance().Record("reExcution", begin_time, end_time, block->getBlockId());
     if (block->getBlockId() != 1) statistics.JournalReExecution(PRASE_TIME * 2);
+    statistics.JournalPhase(Phase::RE_EXECUTE, duration_cast<microseconds>(end_time - phase_begin).count());
+    perf.Journal(Phase::RE_EXECUTE);
     LOG(INFO) << "ReExecute block " << block->getBlockId() << " done";
     #undef PRASE_TIME
 }
@@ -484,6 +467,7 @@ void Loom::ReExecute(Block::Ptr block, vector<Vertex::Ptr>& rbList, vector<vecto
 void Loom::Finalize(T tx) {
     DLOG(INFO) << "Finalize tx " << tx->id;
     tx->committed.store(true);
+    vector<T> ready;
     // release reserved put
     for (auto& kv : tx->local_put) {
         table.Put(std::get<0>(kv), [&](LoomEntry& entry) {
@@ -492,19 +476,22 @@ void Loom::Finalize(T tx) {
                 entry.reserved_put_num--;
                 if (entry.reserved_put_num == 0) {
                     // update block id put
-                    if (entry.next_reserved_put > 0) {
-                        entry.block_id_put++;
-                        entry.reserved_put_num = entry.next_reserved_put;
-                        entry.next_reserved_put = 0;
-                    } else {
-                        entry.block_id_put = 0;
-                    }
+                    entry.ReleasePut(ready);
                 } else if (entry.reserved_put_num < 0) {
                     LOG(ERROR) << kv.first << " reserved put num = " << entry.reserved_put_num;
                 }
+            } else {
+                // an older block in the pipeline still holds the key, count down the reservation of this block
+                auto& next = entry.next_reserved_puts;
+                auto it = std::find_if(next.begin(), next.end(), [&tx](auto& reserved) {return reserved.first == tx->block_id;});
+                if (it != next.end() && --it->second == 0) next.erase(it);
             }
         });
     }
+    // wake the transactions waiting for the released keys
+    for (auto& waiter : ready) {
+        Resume(waiter);
+    }
 }
 
 /// @brief clear table
@@ -512,78 +499,37 @@ void Loom::Finalize(T tx) {
 void Loom::ClearTable(T tx) {
     DLOG(INFO) << "Clear table of tx " << tx->id;
     tx->committed.store(true);
+    vector<T> ready;
     // release reserved put
     for (auto& kv : tx->local_put) {
         table.Put(std::get<0>(kv), [&](LoomEntry& entry) {
             if (entry.block_id_put == tx->block_id) {
                 // update block id put
-                if (entry.next_reserved_put > 0) {
-                    entry.block_id_put++;
-                    entry.reserved_put_num = entry.next_reserved_put;
-                    entry.next_reserved_put = 0;
-                } else {
-                    entry.block_id_put = 0;
-                    entry.reserved_put_num = 0;
-                }
+                entry.ReleasePut(ready);
+            } else {
+                // not expected as blocks are finalized in order, drop the reservation of this block anyway
+                auto& next = entry.next_reserved_puts;
+                auto it = std::find_if(next.begin(), next.end(), [&tx](auto& reserved) {return reserved.first == tx->block_id;});
+                if (it != next.end()) next.erase(it);
             }
         });
     }
-}
-
-/* old version
-/// @brief finalize a transaction
-/// @param tx the transaction to be finalized
-void Loom::Finalize(T tx) {
-    DLOG(INFO) << "Finalize tx " << tx->id;
-    tx->committed.store(true);
-    // release reserved get
-    for (auto& kv : tx->local_get) {
-        table.Put(std::get<0>(kv), [&](LoomEntry& entry) {
-            if (entry.block_id_get == tx->block_id) {
-                entry.reserved_get_txs.erase(tx);
-                if (entry.reserved_get_txs.empty()) {
-                    entry.block_id_get = 0;
-                }
-            }
-        });
-    }
-    // release reserved put
-    for (auto& kv : tx->local_put) {
-        table.Put(std::get<0>(kv), [&](LoomEntry& entry) {
-            if (entry.block_id_put == tx->block_id) {
-                // update reserved put number
-                entry.reserved_put_num--;
-                if (entry.reserved_put_num == 0) {
-                    // update block id put
-                    if (entry.next_reserved_put > 0) {
-                        entry.block_id_put++;
-                        entry.reserved_put_num = entry.next_reserved_put;
-                        entry.next_reserved_put = 0;
-                    } else {
-                        entry.block_id_put = 0;
-                    }
-                } else if (entry.reserved_put_num < 0) {
-                    LOG(ERROR) << kv.first << " reserved put num = " << entry.reserved_put_num;
-                }
-            }
-        });
+    // wake the transactions waiting for the released keys
+    for (auto& waiter : ready) {
+        Resume(waiter);
     }
 }
-*/
-
-/// @brief notify retry
-void Loom::notifyRetry() {
-    DLOG(INFO) << "notifyRetry";
-    // if (canRetry.load()) return;
-    std::lock_guard<std::mutex> lk(mtx);
-    canRetry.store(true);
-    cv.notify_all();
-}
 
-/// @brief reset retry
-void Loom::resetRetry() {
-    DLOG(INFO) << "resetRetry";
-    canRetry.store(false);
+/// @brief re-enqueue a transaction that waited for a key, called once its execution returned and once the key was released
+///        only the second call re-executes it, so two executions of the same transaction never overlap
+/// @param tx the waiting transaction
+void Loom::Resume(T tx) {
+    if (tx->parked.fetch_add(1, memory_order_acq_rel) == 0) return;
+    tx->parked.store(0, memory_order_relaxed);
+    DLOG(INFO) << "Resume tx " << tx->block_id << ":" << tx->id;
+    pool1->execute([tx, retry = tx->retry] {
+        retry(tx);
+    }, loom::TaskPriority::LOW_PRIORITY);
 }
 
 /// @brief construct an empty LoomTransaction
@@ -595,8 +541,8 @@ LoomTransaction::LoomTransaction(
     block_id(block_id)
 {
     // initial readSet and writeSet empty
-    local_get = unordered_map<string, string>();
-    local_put = unordered_map<string, string>();
+    local_get = unordered_map<Key, string>();
+    local_put = unordered_map<Key, string>();
 }
 
 /// @brief move constructor for LoomTransaction
@@ -661,6 +607,8 @@ void LoomTable::ReserveGet(T tx, const K& k) {
             DLOG(INFO) << tx->block_id << ":" << tx->id << " reserve get " << k << " ok" << std::endl;
         } else {
             tx->aborted.store(true);
+            // wait on the key, the release of the reservation re-enqueues the transaction
+            entry.waiting_txs.push_back(tx);
             DLOG(INFO) << tx->block_id << ":" << tx->id << " reserve get " << k << " failed: put id = " << entry.block_id_put << std::endl;
         }
     });
@@ -681,70 +629,39 @@ void LoomTable::ReservePut(T tx, const K& k) {
             // store reserved put
             entry.reserved_put_num++;
         } else if (entry.block_id_put < tx->block_id) {
-            // restore next reserved put
-            entry.next_reserved_put++;
-        }
-        DLOG(INFO) << tx->block_id << ":" << tx->id << " reserve put " << k << " ok" << std::endl;
-    });
-}
-
-/* old version
-/// @brief reserve a get operation
-/// @param tx the transaction
-/// @param k the key
-void LoomTable::ReserveGet(T tx, const K& k) {
-    Table::Put(k, [&](LoomEntry& entry) {
-        DLOG(INFO) << tx->block_id << ":" <<  tx->id << " reserve get " << k << ", current tx(" << entry.block_id_get << ")" << endl;
-        // don't have war conflict
-        if (entry.block_id_put == 0 || entry.block_id_put >= tx->block_id) {
-            if (entry.block_id_get < tx->block_id) {
-                entry.block_id_get = tx->block_id;
-                entry.reserved_get_txs.clear();
-                entry.reserved_get_txs.insert(tx);
-            } else if (entry.block_id_get == tx->block_id) {
-                entry.reserved_get_txs.insert(tx);
+            // restore next reserved put, blocks are pre-executed in order so the list stays sorted
+            auto& next = entry.next_reserved_puts;
+            if (!next.empty() && next.back().first == tx->block_id) {
+                next.back().second++;
+            } else {
+                next.emplace_back(tx->block_id, 1);
             }
-            DLOG(INFO) << tx->block_id << ":" << tx->id << " reserve get " << k << " ok" << std::endl;
-        } else {
-            tx->aborted.store(true);
-            DLOG(INFO) << tx->block_id << ":" << tx->id << " reserve get " << k << " failed: put id = " << entry.block_id_put << std::endl;
         }
+        DLOG(INFO) << tx->block_id << ":" << tx->id << " reserve put " << k << " ok" << std::endl;
     });
 }
 
-/// @brief reserve a put operation
-/// @param tx the transaction
-/// @param k the key
-void LoomTable::ReservePut(T tx, const K& k) {
-    Table::Put(k, [&](LoomEntry& entry) {
-        DLOG(INFO) << tx->block_id << ":" <<  tx->id << " reserve put " << k << ", current tx(" << entry.block_id_get << ")" << endl;
-        if (entry.block_id_get > tx->block_id) {
-            for (auto rtx : entry.reserved_get_txs) {
-                rtx->aborted.store(true);
-            }
-        }
-        if (entry.block_id_put == 0) {
-            // reserve put
-            entry.block_id_put = tx->block_id;
-            // flag have a bigger block_id put
-            entry.reserved_put_num = 1;
-        } else if (entry.block_id_put > tx->block_id) {
-            // reserve put
-            entry.block_id_put = tx->block_id;
-            // restore next reserved put
-            entry.next_reserved_put = entry.reserved_put_num;
-            // store reserved put
-            entry.reserved_put_num = 1;
-        } else if (entry.block_id_put == tx->block_id) {
-            entry.reserved_put_num++;
-        } else if (entry.block_id_put < tx->block_id) {
-            entry.next_reserved_put++;
+/// @brief release the reservation of the oldest block, the next block in the pipeline takes over
+/// @param ready collects the waiting transactions that can reserve the key now, the others keep waiting for their predecessor
+void LoomEntry::ReleasePut(vector<T>& ready) {
+    if (next_reserved_puts.empty()) {
+        block_id_put = 0;
+        reserved_put_num = 0;
+    } else {
+        block_id_put = next_reserved_puts.front().first;
+        reserved_put_num = next_reserved_puts.front().second;
+        next_reserved_puts.erase(next_reserved_puts.begin());
+    }
+    size_t kept = 0;
+    for (size_t i = 0; i < waiting_txs.size(); i++) {
+        if (block_id_put == 0 || block_id_put == waiting_txs[i]->block_id) {
+            ready.push_back(std::move(waiting_txs[i]));
+        } else if (kept++ != i) {
+            waiting_txs[kept - 1] = std::move(waiting_txs[i]);
         }
-
-        DLOG(INFO) << tx->block_id << ":" << tx->id << " reserve put " << k << " ok" << std::endl;
-    });
+    }
+    waiting_txs.resize(kept);
 }
-*/
 
 #undef T
 #undef K
\ No newline at end of file
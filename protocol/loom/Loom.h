@@ -6,11 +6,14 @@
 #include <loom/utils/Ulock.h>
 #include <loom/utils/thread/ThreadPool.h>
 #include <loom/common/Block.h>
+#include <loom/common/BlockSource.h>
+#include <loom/protocol/loom/BlockPipeline.h>
 #include <loom/utils/Statistic/Statistics.h>
+#include <loom/utils/Statistic/Trace.h>
 
 namespace loom {
 
-#define K string
+#define K loom::Key
 #define T shared_ptr<LoomTransaction>
 
 /// @brief loom tranaction.
@@ -20,26 +23,49 @@ struct LoomTransaction: public Transaction {
     std::atomic<bool>   committed{false};
     std::atomic<bool>   aborted{false};
     std::chrono::time_point<std::chrono::steady_clock> start_time;
-    std::unordered_map<string, string> local_get;
-    std::unordered_map<string, string> local_put;
+    std::unordered_map<Key, string> local_get;
+    std::unordered_map<Key, string> local_put;
+    std::atomic<int>    parked{0};      // 因键被占用中止的事务: 执行返回与键释放两方都到达后才重新执行
+    std::function<void(shared_ptr<LoomTransaction>)> retry;    // 区块间模式下重新预执行该事务
     void Execute() override;
     LoomTransaction(Transaction&& inner, size_t id, size_t block_id);
     LoomTransaction(LoomTransaction&& tx) noexcept; // move constructor
     LoomTransaction(const LoomTransaction& other); // copy constructor
 };
 
+#ifndef LOOM_TABLE_KIND
+#define LOOM_TABLE_KIND TableKind::FLAT
+#endif
+
+/// @brief number of blocks in the inter-block pipeline, override with -DLOOM_PIPELINE_DEPTH=N
+#ifndef LOOM_PIPELINE_DEPTH
+#define LOOM_PIPELINE_DEPTH 2
+#endif
+
+/// @brief dispatch ready re-executions by bottom level instead of list order, override with -DLOOM_CRITICAL_PATH_FIRST=true
+#ifndef LOOM_CRITICAL_PATH_FIRST
+#define LOOM_CRITICAL_PATH_FIRST false
+#endif
+
+/// @brief derive block indexes from the pre-executed read/write sets instead of the generator's, override with -DLOOM_ONLINE_INDEX=false
+#ifndef LOOM_ONLINE_INDEX
+#define LOOM_ONLINE_INDEX true
+#endif
+
 /// @brief loom table entry for execution
 struct LoomEntry {
     string              value               = "";
     size_t              block_id_get        = 0;
     unordered_set<T>    reserved_get_txs    = {};
-    size_t              block_id_put        = 0;
+    size_t              block_id_put        = 0;    // the oldest block reserving a put
     size_t              reserved_put_num    = 0;
-    size_t              next_reserved_put   = 0;
+    vector<pair<size_t, size_t>> next_reserved_puts = {};  // later blocks and their reserved puts, in block order
+    vector<T>           waiting_txs         = {};  // transactions of later blocks waiting for the put reservation to be released
+    void ReleasePut(vector<T>& ready);
 };
 
 /// @brief loom table for execution
-struct LoomTable: public Table<K, LoomEntry, KeyHasher> {
+struct LoomTable: public Table<K, LoomEntry, KeyHasher, LOOM_TABLE_KIND> {
     LoomTable(size_t partitions);
     void ReserveGet(T tx, const K& k);
     void ReservePut(T tx, const K& k);
@@ -48,37 +74,49 @@ struct LoomTable: public Table<K, LoomEntry, KeyHasher> {
 /// @brief loom protocol master class
 class Loom: public Protocol {
 public:
-    Loom(vector<Block::Ptr>& blocks, Statistics& statistics, size_t num_threads, size_t table_partitions = 1, bool enable_nested_reExecution = true, bool enable_inter_block = true);
+    /// @brief the state of a block passed between the stages of the inter-block pipeline
+    struct PipelineBlock {
+        Block::Ptr                  block;
+        size_t                      batch_id;
+        vector<T>                   batch;
+        vector<Vertex::Ptr>         rbList;
+        vector<vector<int>>         serialOrders;
+        size_t                      finalize_time = 0;
+        std::chrono::steady_clock::time_point block_begin;
+    };
+    typedef BlockPipeline<std::shared_ptr<PipelineBlock>> Pipeline;
+
+    Loom(BlockSource::Ptr source, Statistics& statistics, size_t num_threads, size_t table_partitions = 1, bool enable_nested_reExecution = true, bool enable_inter_block = true, bool enable_online_index = LOOM_ONLINE_INDEX, size_t pipeline_depth = LOOM_PIPELINE_DEPTH, bool critical_path_first = LOOM_CRITICAL_PATH_FIRST);
+    Loom(vector<Block::Ptr>& blocks, Statistics& statistics, size_t num_threads, size_t table_partitions = 1, bool enable_nested_reExecution = true, bool enable_inter_block = true, bool enable_online_index = LOOM_ONLINE_INDEX, size_t pipeline_depth = LOOM_PIPELINE_DEPTH, bool critical_path_first = LOOM_CRITICAL_PATH_FIRST);
+    ~Loom() override;
     void Start() override;
     void Stop() override;
+    vector<T> MakeBatch(const Block::Ptr& block, size_t batch_id);
     void NormalMode(Block::Ptr block, vector<T>& batch);
-    void InterBlockMode(Block::Ptr block, vector<T> batch);
-    void PostExecuteBlock(Block::Ptr block, vector<T> batch, ThreadPool::Ptr pool);
-    void ExecuteNextBlock(Block::Ptr block, vector<T> batch);
+    void InterBlockMode();
+    void FinalizeBlock(Block::Ptr block, vector<T>& batch, size_t finalize_time, std::chrono::steady_clock::time_point block_begin);
     void PreExecute(vector<T>& batch, const size_t& block_id);
     void PreExecuteInterBlock(vector<T>& batch, const size_t& block_id);
-    void MinWRollBack(vector<T>& batch, Block::Ptr block, vector<Vertex::Ptr>& rbList, vector<vector<int>>& serialOrders, ThreadPool::Ptr pool);
+    size_t MinWRollBack(vector<T>& batch, Block::Ptr block, vector<Vertex::Ptr>& rbList, vector<vector<int>>& serialOrders, ThreadPool::Ptr pool);
     void ReExecute(Block::Ptr block, vector<Vertex::Ptr>& rbList, vector<vector<int>>& serialOrders, ThreadPool::Ptr pool);
     void Finalize(T tx);
     void ClearTable(T tx);
-    void notifyRetry();
-    void resetRetry();
+    void Resume(T tx);
 
 private:
     Statistics&                     statistics;
-    vector<Block::Ptr>&             blocks;
-    vector<vector<T>>               batches;
+    BlockSource::Ptr                source;
     size_t                          num_threads;
     LoomTable                       table;
-    std::atomic<size_t>             committed_block;
     bool                            enable_inter_block;
     bool                            enable_nested_reExecution;
+    bool                            enable_online_index;    // 由预执行观察到的读写集在线构建区块索引
+    size_t                          pipeline_depth;         // 区块间模式同时执行的区块数
+    bool                            critical_path_first;    // 重执行时关键路径上的事务优先
     std::shared_ptr<ThreadPool>     pool1;
     std::shared_ptr<ThreadPool>     pool2;
     size_t                          block_idx;
-    std::mutex                      mtx;
-    std::condition_variable         cv;
-    std::atomic<bool>               canRetry;
+    std::unique_ptr<Pipeline>       pipeline;               // 区块间模式的流水线, 最后声明因而最先析构, 析构时线程池仍可用
 };
 
 #undef T
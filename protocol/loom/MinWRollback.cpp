@@ -1,6 +1,7 @@
 #include <algorithm>
 #include <tbb/tbb.h>
 #include "MinWRollback.h"
+#include "SCC.h"
 #include <iostream>
 #include <chrono>
 #include <future>
@@ -82,7 +83,7 @@ void MinWRollback::onWarm2SCC() {
     }
     */
 
-    /* Gabow */
+    /* Gabow
     int index = 0;
     stack<HyperVertex::Ptr> S, B;
     unordered_map<HyperVertex::Ptr, int, HyperVertex::HyperVertexHash> indices(m_hyperVertices.size());
@@ -93,11 +94,66 @@ void MinWRollback::onWarm2SCC() {
             Gabow(hv, index, S, B, indices, onStack);
         }
     }
+    */
+
+    ThreadPool::Ptr pool = nullptr;
+    onWarm2SCC(pool);
 
     // auto end = std::chrono::high_resolution_clock::now();
     // cout << "recognizeSCC time: " << (double)chrono::duration_cast<chrono::microseconds>(end - start).count() / 1000 << "ms" << endl;
 }
 
+/* 获取图中所有强连通分量(整数id + 扁平数组)
+    1. 将超节点映射为 [0, n) 的下标, 按 m_out_hv 建图
+    2. 剪枝 + 弱连通分量切分后, 各分量在线程池中并行执行迭代版 Tarjan
+    3. 强连通分量按最小下标排序, 结果与线程数无关
+*/
+void MinWRollback::onWarm2SCC(ThreadPool::Ptr& pool) {
+    for (auto& component : buildSCCGraph().compute(pool, m_thread_num)) {
+        m_sccs.push_back(toSCC(component));
+    }
+}
+
+/* 流式获取强连通分量: Tarjan 每弹出一个scc立即发布并回调, 回滚可以与后续识别重叠 */
+void MinWRollback::onWarm2SCC(ThreadPool::Ptr& pool, const std::function<void(int, unordered_set<HyperVertex::Ptr, HyperVertex::HyperVertexHash>&)>& onSCC) {
+    buildSCCGraph().compute(pool, m_thread_num, [this, &onSCC](const vector<int>& component) {
+        auto it = m_sccs.push_back(toSCC(component));
+        onSCC(component.front(), *it);
+    });
+}
+
+/* 将超节点映射为 [0, n) 的下标, 按 m_out_hv 建图 */
+loom::SCCGraph MinWRollback::buildSCCGraph() {
+    // hyperId => 下标
+    int maxId = 0;
+    for (const auto& hv : m_hyperVertices) {
+        maxId = max(maxId, hv->m_hyperId);
+    }
+    vector<int> position(maxId + 1, -1);
+    for (size_t i = 0; i < m_hyperVertices.size(); i++) {
+        position[m_hyperVertices[i]->m_hyperId] = i;
+    }
+
+    loom::SCCGraph graph(m_hyperVertices.size());
+    for (size_t i = 0; i < m_hyperVertices.size(); i++) {
+        for (const auto& out : m_hyperVertices[i]->m_out_hv) {
+            int id = out->m_hyperId;
+            if (id <= maxId && position[id] != -1) {
+                graph.addEdge(i, position[id]);
+            }
+        }
+    }
+    return graph;
+}
+
+unordered_set<HyperVertex::Ptr, HyperVertex::HyperVertexHash> MinWRollback::toSCC(const vector<int>& component) {
+    unordered_set<HyperVertex::Ptr, HyperVertex::HyperVertexHash> scc(component.size());
+    for (int idx : component) {
+        scc.insert(m_hyperVertices[idx]);
+    }
+    return scc;
+}
+
 /* 构建超图
 */
 void MinWRollback::buildGraph() {
@@ -230,16 +286,19 @@ void MinWRollback::buildGraphNoEdgeC(UThreadPoolPtr& Pool, std::vector<std::futu
 void MinWRollback::buildGraphNoEdgeC(ThreadPool::Ptr& Pool, std::vector<std::future<void>>& futures) {
     // edgeCounter = 0;
     
-    // 将多个onRW的处理作为一个任务
-    std::vector<std::pair<Vertex::Ptr, Vertex::Ptr>> rwPairs;
-    for (auto& rTxs : m_RWIndex) {
-        auto& rTx = rTxs.first;
-        auto& wTxs = rTxs.second;
-        for (auto& wTx : wTxs) {
-            // 构建超图
-            rwPairs.emplace_back(rTx, wTx);
+    // 将多个onRW的处理作为一个任务; 区块已展开rw边时直接使用
+    std::vector<std::pair<Vertex::Ptr, Vertex::Ptr>> localPairs;
+    if (m_rwEdges.empty()) {
+        for (auto& rTxs : m_RWIndex) {
+            auto& rTx = rTxs.first;
+            auto& wTxs = rTxs.second;
+            for (auto& wTx : wTxs) {
+                // 构建超图
+                localPairs.emplace_back(rTx, wTx);
+            }
         }
     }
+    std::span<const std::pair<Vertex::Ptr, Vertex::Ptr>> rwPairs = m_rwEdges.empty() ? localPairs : m_rwEdges;
 
     size_t totalPairs = rwPairs.size();
     // size_t chunkSize = (totalPairs + UTIL_DEFAULT_THREAD_SIZE - 1) / (UTIL_DEFAULT_THREAD_SIZE * 1);
@@ -255,39 +314,13 @@ void MinWRollback::buildGraphNoEdgeC(ThreadPool::Ptr& Pool, std::vector<std::fut
     //     }));
     // }
 
-    // size_t thread_num = min(m_thread_num, (size_t)36);
-    size_t thread_num = m_thread_num;
-    size_t chunkSize = totalPairs / thread_num;
-    size_t remainder = totalPairs % thread_num;
-    // cout << "totalPairs: " << totalPairs << " chunkSize: " << chunkSize << endl;
-    
-    // std::vector<std::function<void()>> taskList;
-    std::vector<std::tuple<std::function<void()>>> taskList;
-    for (size_t i = 0; i < thread_num; ++i) {
-        size_t startIdx = i * chunkSize + std::min(i, remainder);
-        size_t endIdx = startIdx + chunkSize + (i < remainder ? 1 : 0);
-        endIdx = std::min(endIdx, totalPairs);
-        // // enqueue the threadpool
-        // futures.emplace_back(Pool->enqueue([this, &rwPairs, startIdx, endIdx] {
-        //     // LOG(INFO) << "begin onRWCNoEdge";
-        //     for (size_t j = startIdx; j < endIdx; ++j) {
-        //         onRWCNoEdge(rwPairs[j].first, rwPairs[j].second);
-        //     }
-        // }));
-        taskList.emplace_back(std::make_tuple([this, &rwPairs, startIdx, endIdx] {
-            DLOG(INFO) << "begin onRWCNoEdge";
-            for (size_t j = startIdx; j < endIdx; ++j) {
-                onRWCNoEdge(rwPairs[j].first, rwPairs[j].second);
-            }
-        }));
-    }
-
-    futures = Pool->enqueueBatch(taskList);
-
-    // 等待所有任务完成
-    for (auto &future : futures) {
-        future.get();
-    }
+    // 由线程池按块切分并行处理, 调用线程同样参与, 返回时图已构建完毕
+    Pool->parallelFor(0, totalPairs, 0, [this, &rwPairs](size_t startIdx, size_t endIdx) {
+        DLOG(INFO) << "begin onRWCNoEdge";
+        for (size_t j = startIdx; j < endIdx; ++j) {
+            onRWCNoEdge(rwPairs[j].first, rwPairs[j].second);
+        }
+    });
 
     // LOG(INFO) << "Graph futures size: " << futures.size();
     // try {
@@ -552,7 +585,7 @@ void MinWRollback::build(set<Vertex::Ptr, Vertex::VertexCompare2>& vertices) {
                 // 更新newV对应的hyperVertex的out_edges
                 // handleNewEdge(newV, oldV, newHyperVertex->m_out_edges[oldHyperVertex]);
                 newHyperVertex->m_out_hv.insert(oldHyperVertex);
-                newHyperVertex->m_out_edges[oldHyperIdx].insert(oldV);
+                newHyperVertex->m_out[oldHyperIdx].edges.insert(oldV);
 
                 // 更新依赖数
                 newV->m_degree++;
@@ -562,13 +595,13 @@ void MinWRollback::build(set<Vertex::Ptr, Vertex::VertexCompare2>& vertices) {
                     recursiveUpdate(newHyperVertex, min_out, loom::EdgeType::OUT);
                 }
                 // 更新回滚集合
-                newHyperVertex->m_out_rollback[oldHyperIdx].insert(newV->cascadeVertices.cbegin(), newV->cascadeVertices.cend());
+                newHyperVertex->m_out[oldHyperIdx].rollback.insert(newV->cascadeVertices.cbegin(), newV->cascadeVertices.cend());
 
 
                 // 更新oldV对应的hyperVertex的in_edges
                 // handleNewEdge(oldV, newV, oldHyperVertex->m_in_edges[newHyperVertex]);
                 oldHyperVertex->m_in_hv.insert(newHyperVertex);
-                oldHyperVertex->m_in_edges[newHyperIdx].insert(newV);
+                oldHyperVertex->m_in[newHyperIdx].edges.insert(newV);
                 // 更新依赖数
                 oldV->m_degree++;
                 // 尝试更新oldV对应的hyperVertex的min_in
@@ -586,7 +619,7 @@ void MinWRollback::build(set<Vertex::Ptr, Vertex::VertexCompare2>& vertices) {
                 // 更新newV对应的hyperVertex的in_edges
                 // handleNewEdge(newV, oldV, newHyperVertex->m_in_edges[oldHyperVertex]);
                 newHyperVertex->m_in_hv.insert(oldHyperVertex);
-                newHyperVertex->m_in_edges[oldHyperIdx].insert(oldV);
+                newHyperVertex->m_in[oldHyperIdx].edges.insert(oldV);
                 // 更新依赖数
                 newV->m_degree++;
                 // 尝试更新newV对应的hyperVertex的min_in
@@ -601,7 +634,7 @@ void MinWRollback::build(set<Vertex::Ptr, Vertex::VertexCompare2>& vertices) {
                 // 更新oldV对应的hyperVertex的out_edges
                 // handleNewEdge(oldV, newV, oldHyperVertex->m_out_edges[newHyperVertex]);
                 oldHyperVertex->m_out_hv.insert(newHyperVertex);
-                oldHyperVertex->m_out_edges[newHyperIdx].insert(newV);
+                oldHyperVertex->m_out[newHyperIdx].edges.insert(newV);
                 // 更新依赖数
                 oldV->m_degree++;
                 // 尝试更新oldV对应的hyperVertex的min_out
@@ -610,7 +643,7 @@ void MinWRollback::build(set<Vertex::Ptr, Vertex::VertexCompare2>& vertices) {
                     recursiveUpdate(oldHyperVertex, min_out, loom::EdgeType::OUT);
                 }
                 // 更新回滚集合
-                oldHyperVertex->m_out_rollback[newHyperIdx].insert(oldV->cascadeVertices.cbegin(), oldV->cascadeVertices.cend());
+                oldHyperVertex->m_out[newHyperIdx].rollback.insert(oldV->cascadeVertices.cbegin(), oldV->cascadeVertices.cend());
             }
         }
     }
@@ -627,16 +660,16 @@ void MinWRollback::onRWC(const Vertex::Ptr &rTx, const Vertex::Ptr &wTx) {
 
     // 更新newV对应的hyperVertex的out_edges
     rHyperVertex->m_out_hv.insert(wHyperVertex);
-    rHyperVertex->m_out_edges[whvIdx].insert(wTx);
+    rHyperVertex->m_out[whvIdx].edges.insert(wTx);
 
     // 更新依赖数
     rTx->m_degree++;
     // 更新回滚集合
-    rHyperVertex->m_out_rollback[whvIdx].insert(rTx->cascadeVertices.cbegin(), rTx->cascadeVertices.cend());
+    rHyperVertex->m_out[whvIdx].rollback.insert(rTx->cascadeVertices.cbegin(), rTx->cascadeVertices.cend());
 
     // 更新oldV对应的hyperVertex的in_edges
     wHyperVertex->m_in_hv.insert(rHyperVertex);
-    wHyperVertex->m_in_edges[rhvIdx].insert(rTx);
+    wHyperVertex->m_in[rhvIdx].edges.insert(rTx);
     // 更新依赖数
     wTx->m_degree++;
     // 更新回滚集合
@@ -655,7 +688,7 @@ void MinWRollback::onRW(const Vertex::Ptr &rTx, const Vertex::Ptr &wTx) {
 
     // 更新newV对应的hyperVertex的out_edges
     rHyperVertex->m_out_hv.insert(wHyperVertex);
-    rHyperVertex->m_out_edges[whvIdx].insert(wTx);
+    rHyperVertex->m_out[whvIdx].edges.insert(wTx);
 
     // 更新依赖数
     rTx->m_degree++;
@@ -665,12 +698,12 @@ void MinWRollback::onRW(const Vertex::Ptr &rTx, const Vertex::Ptr &wTx) {
         recursiveUpdate(rHyperVertex, min_out, loom::EdgeType::OUT);
     }
     // 更新回滚集合
-    rHyperVertex->m_out_rollback[whvIdx].insert(rTx->cascadeVertices.cbegin(), rTx->cascadeVertices.cend());
+    rHyperVertex->m_out[whvIdx].rollback.insert(rTx->cascadeVertices.cbegin(), rTx->cascadeVertices.cend());
 
 
     // 更新oldV对应的hyperVertex的in_edges
     wHyperVertex->m_in_hv.insert(rHyperVertex);
-    wHyperVertex->m_in_edges[rhvIdx].insert(rTx);
+    wHyperVertex->m_in[rhvIdx].edges.insert(rTx);
 
     // 更新依赖数
     wTx->m_degree++;
@@ -703,9 +736,10 @@ void MinWRollback::onRWCNoEdge(const Vertex::Ptr &rTx, const Vertex::Ptr &wTx) {
     rHyperVertex->m_out_hv.insert(wHyperVertex);
 
     // 更新回滚集合
-    rHyperVertex->m_out_rollback[whvIdx].insert(rTx->cascadeVertices.cbegin(), rTx->cascadeVertices.cend());
+    auto& outEdge = rHyperVertex->m_out[whvIdx];
+    outEdge.rollback.insert(rTx->cascadeVertices.cbegin(), rTx->cascadeVertices.cend());
     // 计算回滚代价
-    rHyperVertex->m_out_weights[whvIdx] += rTx->m_cost;
+    outEdge.weight.fetch_add(rTx->m_cost, std::memory_order_relaxed);
 
     // 更新oldV对应的hyperVertex的in_edges
     wHyperVertex->m_in_hv.insert(rHyperVertex);
@@ -713,7 +747,7 @@ void MinWRollback::onRWCNoEdge(const Vertex::Ptr &rTx, const Vertex::Ptr &wTx) {
     // 更新回滚集合
     wHyperVertex->m_in_allRB.insert(rTx->cascadeVertices.cbegin(), rTx->cascadeVertices.cend());
     // 计算回滚代价
-    wHyperVertex->m_in_cost += rTx->m_cost;
+    std::atomic_ref<double>(wHyperVertex->m_in_cost).fetch_add(rTx->m_cost, std::memory_order_relaxed);
 }
 
 void MinWRollback::onRWNoEdge(const Vertex::Ptr &rTx, const Vertex::Ptr &wTx) {
@@ -736,8 +770,9 @@ void MinWRollback::onRWNoEdge(const Vertex::Ptr &rTx, const Vertex::Ptr &wTx) {
         recursiveUpdate(rHyperVertex, min_out, loom::EdgeType::OUT);
     }
     // 更新回滚集合
-    rHyperVertex->m_out_rollback[whvIdx].insert(rTx->cascadeVertices.cbegin(), rTx->cascadeVertices.cend());
-    rHyperVertex->m_out_weights[whvIdx] += rTx->m_cost;
+    auto& outEdge = rHyperVertex->m_out[whvIdx];
+    outEdge.rollback.insert(rTx->cascadeVertices.cbegin(), rTx->cascadeVertices.cend());
+    outEdge.weight.fetch_add(rTx->m_cost, std::memory_order_relaxed);
 
 
     // 更新oldV对应的hyperVertex的in_edges
@@ -752,7 +787,7 @@ void MinWRollback::onRWNoEdge(const Vertex::Ptr &rTx, const Vertex::Ptr &wTx) {
     }
     // 更新回滚集合
     wHyperVertex->m_in_allRB.insert(rTx->cascadeVertices.cbegin(), rTx->cascadeVertices.cend());
-    wHyperVertex->m_in_cost += rTx->m_cost;
+    std::atomic_ref<double>(wHyperVertex->m_in_cost).fetch_add(rTx->m_cost, std::memory_order_relaxed);
 }
 
 // 判断v1是否是v2的祖先
@@ -1122,6 +1157,9 @@ loom::ReExecuteInfo MinWRollback::rollbackNoEdge(unordered_set<HyperVertex::Ptr,
     
     reExecuteInfo.m_rollbackTxs = rollbackTxs;
     reExecuteInfo.m_serialOrder = queueOrder;
+    // 根据事务顺序排序回滚事务
+    reExecuteInfo.m_orderedRollbackTxs = set<Vertex::Ptr, loom::customCompare>(loom::customCompare(reExecuteInfo.m_serialOrder));
+    reExecuteInfo.m_orderedRollbackTxs.insert(rollbackTxs.begin(), rollbackTxs.end());
 
     // auto end = std::chrono::high_resolution_clock::now();
     // cout << "scc rollback time: " << (double)chrono::duration_cast<chrono::microseconds>(end - start).count() / 1000 << "ms" << endl;
@@ -1129,6 +1167,16 @@ loom::ReExecuteInfo MinWRollback::rollbackNoEdge(unordered_set<HyperVertex::Ptr,
     return reExecuteInfo;
 }
 
+/* 按scc顺序合并各scc的回滚结果: 入边回滚可能选中其它scc的事务, 每个事务只保留第一次出现 */
+void MinWRollback::appendRollback(loom::ReExecuteInfo& reExecuteInfo, std::vector<Vertex::Ptr>& rbList, vector<vector<int>>& serialOrders, unordered_set<Vertex::Ptr, Vertex::VertexHash>& added) {
+    for (auto& tx : reExecuteInfo.m_orderedRollbackTxs) {
+        if (added.insert(tx).second) {
+            rbList.push_back(tx);
+        }
+    }
+    serialOrders.push_back(std::move(reExecuteInfo.m_serialOrder));
+}
+
 /* 确定性回滚(优化2:去边): 多线程版 */
 void MinWRollback::rollbackNoEdgeConcurrent(UThreadPoolPtr& Pool, std::vector<std::future<void>>& futures, bool fastMode) {
     // 拿到所有scc
@@ -1328,7 +1376,7 @@ void MinWRollback::calculateHyperVertexWeight(const unordered_set<HyperVertex::P
             if (scc.find(out_hv) != scc.cend()) {
                 auto out_idx = out_hv->m_hyperId;
                 // 统计m_out_allRB
-                for (auto & v : hyperVertex->m_out_rollback[out_idx]) {
+                for (auto & v : hyperVertex->outEdge(out_idx).rollback) {
                     // 如果之前没有这个节点，则新增map并设置值为1，否则值+1
                     if (hyperVertex->m_out_allRB.find(v) == hyperVertex->m_out_allRB.end()) {
                         hyperVertex->m_out_allRB[v] = 1;
@@ -1349,12 +1397,12 @@ void MinWRollback::calculateHyperVertexWeight(const unordered_set<HyperVertex::P
             // 同属于一个scc
             if (scc.find(in_hv) != scc.cend()) {
                 auto idx = hyperVertex->m_hyperId;
-                auto rbs = in_hv->m_out_rollback[idx];
+                const auto& rbs = in_hv->outEdge(idx).rollback;
                 for (auto& rb : rbs) {
                     hyperVertex->m_in_cost += rb->m_self_cost;
                     in_degree += rb->m_degree;
                 }
-                hyperVertex->m_in_allRB.insert(rbs.cbegin(), rbs.cend());
+                hyperVertex->m_in_allRB.insert(rbs.begin(), rbs.end());
             }
         }
 
@@ -1388,11 +1436,11 @@ void MinWRollback::calculateHyperVertexWeightNoEdge(const unordered_set<HyperVer
             if (scc.find(out_hv) != scc.cend()) {
                 auto out_idx = out_hv->m_hyperId;
                 // 统计m_out_allRB
-                for (auto & v : hyperVertex->m_out_rollback[out_idx]) {
+                for (auto & v : hyperVertex->outEdge(out_idx).rollback) {
                     // 如果之前没有这个节点，则新增map并设置值为1，否则值+1
                     hyperVertex->m_out_allRB[v]++;                    
                 }
-                hyperVertex->m_out_cost += hyperVertex->m_out_weights[out_idx];
+                hyperVertex->m_out_cost += hyperVertex->outEdge(out_idx).weight;
             }
         }
         
@@ -1433,11 +1481,11 @@ void MinWRollback::calculateHyperVertexWeightNoEdge(const unordered_set<HyperVer
             if (scc.find(out_hv) != scc.cend()) {
                 auto out_idx = out_hv->m_hyperId;
                 // 统计m_out_allRB
-                for (auto & v : hyperVertex->m_out_rollback[out_idx]) {
+                for (auto & v : hyperVertex->outEdge(out_idx).rollback) {
                     // 如果之前没有这个节点，则新增map并设置值为1，否则值+1
                     hyperVertex->m_out_allRB[v]++;                    
                 }
-                hyperVertex->m_out_cost += hyperVertex->m_out_weights[out_idx];
+                hyperVertex->m_out_cost += hyperVertex->outEdge(out_idx).weight;
             }
         }
         
@@ -1810,7 +1858,7 @@ void MinWRollback::updateSCCandDependency(unordered_set<HyperVertex::Ptr, HyperV
                     }
 
                     // 更新超节点入边回滚子事务
-                    for (auto& vertex : rb->m_out_rollback[out_vertex_idx]) {
+                    for (auto& vertex : rb->outEdge(out_vertex_idx).rollback) {
                         // in_allRB不存在当前rollback节点还是与其它超节点间的rollback节点的情况，因此直接删除
                         out_vertex->m_in_allRB.unsafe_erase(vertex);
                     }
@@ -1824,7 +1872,7 @@ void MinWRollback::updateSCCandDependency(unordered_set<HyperVertex::Ptr, HyperV
                        ==> 必须更新度
                     */
                     // 遍历并记录这个超节点out_vertex与rb存在依赖的子事务udVertexs，更新子事务的度
-                    for (auto& udVertex : rb->m_out_edges[out_vertex_idx]) {
+                    for (auto& udVertex : rb->outEdge(out_vertex_idx).edges) {
                         udVertex->m_degree--;
                         udVertexs.insert(udVertex);
                     }
@@ -1875,7 +1923,7 @@ void MinWRollback::updateSCCandDependency(unordered_set<HyperVertex::Ptr, HyperV
                     // 更新超节点出边回滚子事务
                     // 若rb是out类型的abort，则尝试删除
                     if (rb->m_rollback_type == loom::EdgeType::OUT) {
-                        for (auto& vertex : in_vertex->m_out_rollback[rbIdx]) {
+                        for (auto& vertex : in_vertex->outEdge(rbIdx).rollback) {
                             // 尝试删除
                             if (in_vertex->m_out_allRB[vertex] == 1) {
                                 in_vertex->m_out_allRB.unsafe_erase(vertex);
@@ -1885,12 +1933,12 @@ void MinWRollback::updateSCCandDependency(unordered_set<HyperVertex::Ptr, HyperV
                         }
                         
                         // 若rb是out类型的abort，则更新度
-                        for (auto& udVertex : rb->m_in_edges[in_vertex_idx]) {
+                        for (auto& udVertex : rb->inEdge(in_vertex_idx).edges) {
                             udVertex->m_degree--;
                             udVertexs.insert(udVertex);
                         }
                     } else { // 若rb是in类型的abort，则直接删除
-                        for (auto& vertex : in_vertex->m_out_rollback[rbIdx]) {    
+                        for (auto& vertex : in_vertex->outEdge(rbIdx).rollback) {    
                             in_vertex->m_out_allRB.unsafe_erase(vertex);
                         }
                         // 若rb是in类型的abort，则不更新度
@@ -1990,7 +2038,7 @@ void MinWRollback::recursiveDelete(unordered_set<HyperVertex::Ptr, HyperVertex::
             }
 
             // 更新事务回滚事务集
-            for (auto& vertex : rb->m_out_rollback[out_vertex_idx]) {
+            for (auto& vertex : rb->outEdge(out_vertex_idx).rollback) {
                 out_vertex->m_in_allRB.unsafe_erase(vertex);
             }
 
@@ -2017,7 +2065,7 @@ void MinWRollback::recursiveDelete(unordered_set<HyperVertex::Ptr, HyperVertex::
             }
 
             // 更新依赖子事务(入)度
-            for (auto& udVertex : rb->m_out_edges[out_vertex_idx]) {
+            for (auto& udVertex : rb->outEdge(out_vertex_idx).edges) {
                 udVertex->m_degree--;   
             }
         }
@@ -2040,7 +2088,7 @@ void MinWRollback::recursiveDelete(unordered_set<HyperVertex::Ptr, HyperVertex::
             
             // 更新事务回滚事务集
             if (rb->m_rollback_type == loom::EdgeType::OUT) {
-                for (auto& vertex : in_vertex->m_out_rollback[rbIdx]) {
+                for (auto& vertex : in_vertex->outEdge(rbIdx).rollback) {
                     // 若value为1，代表只有本节点和该节点依赖，可直接删除
                     if (in_vertex->m_out_allRB[vertex] == 1) {
                         in_vertex->m_out_allRB.unsafe_erase(vertex);
@@ -2059,12 +2107,12 @@ void MinWRollback::recursiveDelete(unordered_set<HyperVertex::Ptr, HyperVertex::
                 }
 
                 // 更新依赖子事务(出)度
-                for (auto& udVertex : rb->m_in_edges[in_vertex_idx]) {
+                for (auto& udVertex : rb->inEdge(in_vertex_idx).edges) {
                     udVertex->m_degree--;
                 }
 
             } else {
-                for (auto& vertex : in_vertex->m_out_rollback[rbIdx]) {
+                for (auto& vertex : in_vertex->outEdge(rbIdx).rollback) {
                     in_vertex->m_out_allRB.unsafe_erase(vertex);
                 }
             }
@@ -2096,7 +2144,7 @@ void MinWRollback::updateSCCandDependencyNoEdge(unordered_set<HyperVertex::Ptr,
             // 记录出边超节点索引
             auto out_vertex_idx = out_vertex->m_hyperId;
 
-            out_vertex->m_in_cost -= rb->m_out_weights[out_vertex_idx];
+            out_vertex->m_in_cost -= rb->outEdge(out_vertex_idx).weight;
             if (out_vertex->m_in_cost < out_vertex->m_cost) {
                 pq.erase(out_vertex);
                 out_vertex->m_cost = out_vertex->m_in_cost;
@@ -2113,7 +2161,7 @@ void MinWRollback::updateSCCandDependencyNoEdge(unordered_set<HyperVertex::Ptr,
 
             // 更新事务回滚事务集
             if (rb->m_rollback_type == loom::EdgeType::IN) {
-                for (auto& vertex : rb->m_out_rollback[out_vertex_idx]) {
+                for (auto& vertex : rb->outEdge(out_vertex_idx).rollback) {
                     out_vertex->m_in_allRB.unsafe_erase(vertex);
                 }
             }
@@ -2134,7 +2182,7 @@ void MinWRollback::updateSCCandDependencyNoEdge(unordered_set<HyperVertex::Ptr,
     for (auto& in_vertex : rb->m_in_hv) {
         // 超节点在scc中
         if (scc.find(in_vertex) != scc.end()) {
-            in_vertex->m_out_cost -= in_vertex->m_out_weights[rbIdx];
+            in_vertex->m_out_cost -= in_vertex->outEdge(rbIdx).weight;
             if (in_vertex->m_out_cost < in_vertex->m_cost) {
                 pq.erase(in_vertex);
                 in_vertex->m_cost = in_vertex->m_out_cost;
@@ -2152,7 +2200,7 @@ void MinWRollback::updateSCCandDependencyNoEdge(unordered_set<HyperVertex::Ptr,
 
             // 更新事务回滚事务集
             if (rb->m_rollback_type == loom::EdgeType::OUT) {
-                for (auto& vertex : in_vertex->m_out_rollback[rbIdx]) {
+                for (auto& vertex : in_vertex->outEdge(rbIdx).rollback) {
                     // 若value为1，代表只有本节点和该节点依赖，可直接删除
                     if (in_vertex->m_out_allRB[vertex] == 1) {
                         in_vertex->m_out_allRB.unsafe_erase(vertex);
@@ -2161,7 +2209,7 @@ void MinWRollback::updateSCCandDependencyNoEdge(unordered_set<HyperVertex::Ptr,
                     }
                 }
             } else {
-                for (auto& vertex : in_vertex->m_out_rollback[rbIdx]) {
+                for (auto& vertex : in_vertex->outEdge(rbIdx).rollback) {
                     in_vertex->m_out_allRB.unsafe_erase(vertex);
                 }
             }
@@ -2189,7 +2237,7 @@ void MinWRollback::updateSCCandDependencyNoEdge(unordered_set<HyperVertex::Ptr,
             // 记录出边超节点索引
             auto out_vertex_idx = out_vertex->m_hyperId;
 
-            out_vertex->m_in_cost -= rb->m_out_weights[out_vertex_idx];
+            out_vertex->m_in_cost -= rb->outEdge(out_vertex_idx).weight;
             if (out_vertex->m_in_cost < out_vertex->m_cost) {
                 pq.erase(out_vertex);
                 out_vertex->m_cost = out_vertex->m_in_cost;
@@ -2207,7 +2255,7 @@ void MinWRollback::updateSCCandDependencyNoEdge(unordered_set<HyperVertex::Ptr,
 
             // 更新事务回滚事务集
             if (rb->m_rollback_type == loom::EdgeType::IN) {
-                for (auto& vertex : rb->m_out_rollback[out_vertex_idx]) {
+                for (auto& vertex : rb->outEdge(out_vertex_idx).rollback) {
                     out_vertex->m_in_allRB.unsafe_erase(vertex);
                 }
             }
@@ -2229,7 +2277,7 @@ void MinWRollback::updateSCCandDependencyNoEdge(unordered_set<HyperVertex::Ptr,
     for (auto& in_vertex : rb->m_in_hv) {
         // 超节点在scc中
         if (scc.find(in_vertex) != scc.end()) {
-            in_vertex->m_out_cost -= in_vertex->m_out_weights[rbIdx];
+            in_vertex->m_out_cost -= in_vertex->outEdge(rbIdx).weight;
             if (in_vertex->m_out_cost < in_vertex->m_cost) {
                 pq.erase(in_vertex);
                 in_vertex->m_cost = in_vertex->m_out_cost;
@@ -2248,7 +2296,7 @@ void MinWRollback::updateSCCandDependencyNoEdge(unordered_set<HyperVertex::Ptr,
 
             // 更新事务回滚事务集
             if (rb->m_rollback_type == loom::EdgeType::OUT) {
-                for (auto& vertex : in_vertex->m_out_rollback[rbIdx]) {
+                for (auto& vertex : in_vertex->outEdge(rbIdx).rollback) {
                     // 若value为1，代表只有本节点和该节点依赖，可直接删除
                     if (in_vertex->m_out_allRB[vertex] == 1) {
                         in_vertex->m_out_allRB.unsafe_erase(vertex);
@@ -2257,7 +2305,7 @@ void MinWRollback::updateSCCandDependencyNoEdge(unordered_set<HyperVertex::Ptr,
                     }
                 }
             } else {
-                for (auto& vertex : in_vertex->m_out_rollback[rbIdx]) {
+                for (auto& vertex : in_vertex->outEdge(rbIdx).rollback) {
                     in_vertex->m_out_allRB.unsafe_erase(vertex);
                 }
             }
@@ -2284,7 +2332,7 @@ void MinWRollback::updateSCCandDependencyFastMode(unordered_set<HyperVertex::Ptr
             auto out_vertex_idx = out_vertex->m_hyperId;
             // 更新事务回滚事务集
             if (rb->m_rollback_type == loom::EdgeType::IN) {
-                for (auto& vertex : rb->m_out_rollback[out_vertex_idx]) {
+                for (auto& vertex : rb->outEdge(out_vertex_idx).rollback) {
                     out_vertex->m_in_allRB.unsafe_erase(vertex);
                 }
             }
@@ -2305,7 +2353,7 @@ void MinWRollback::updateSCCandDependencyFastMode(unordered_set<HyperVertex::Ptr
         if (scc.find(in_vertex) != scc.end()) {
             // 更新事务回滚事务集
             if (rb->m_rollback_type == loom::EdgeType::OUT) {
-                for (auto& vertex : in_vertex->m_out_rollback[rbIdx]) {
+                for (auto& vertex : in_vertex->outEdge(rbIdx).rollback) {
                     // 若value为1，代表只有本节点和该节点依赖，可直接删除
                     if (in_vertex->m_out_allRB[vertex] == 1) {
                         in_vertex->m_out_allRB.unsafe_erase(vertex);
@@ -2314,7 +2362,7 @@ void MinWRollback::updateSCCandDependencyFastMode(unordered_set<HyperVertex::Ptr
                     }
                 }
             } else {
-                for (auto& vertex : in_vertex->m_out_rollback[rbIdx]) {
+                for (auto& vertex : in_vertex->outEdge(rbIdx).rollback) {
                     in_vertex->m_out_allRB.unsafe_erase(vertex);
                 }
             }
@@ -2353,7 +2401,7 @@ void MinWRollback::updateSCCandDependencyFastMode(unordered_set<HyperVertex::Ptr
 
 
                 // 更新事务回滚事务集
-                for (auto& vertex : in_vertex->m_out_rollback[rbIdx]) {
+                for (auto& vertex : in_vertex->outEdge(rbIdx).rollback) {
                     // 若value为1，代表只有本节点和该节点依赖，可直接删除
                     if (in_vertex->m_out_allRB[vertex] == 1) {
                         in_vertex->m_out_allRB.unsafe_erase(vertex);
@@ -2400,7 +2448,7 @@ void MinWRollback::updateSCCandDependencyFastMode(unordered_set<HyperVertex::Ptr
                 // }
 
                 // 更新事务回滚事务集
-                for (auto& vertex : rb->m_out_rollback[out_vertex_idx]) {
+                for (auto& vertex : rb->outEdge(out_vertex_idx).rollback) {
                     out_vertex->m_in_allRB.unsafe_erase(vertex);
                 }
                 
@@ -2436,7 +2484,7 @@ void MinWRollback::updateSCCandDependencyFastMode(unordered_set<HyperVertex::Ptr
 
 
                 // 更新事务回滚事务集
-                for (auto& vertex : in_vertex->m_out_rollback[rbIdx]) {
+                for (auto& vertex : in_vertex->outEdge(rbIdx).rollback) {
                     in_vertex->m_out_allRB.unsafe_erase(vertex);
                 }
                 
@@ -2471,7 +2519,7 @@ void MinWRollback::updateSCCandDependencyFastMode(unordered_set<HyperVertex::Ptr
             auto out_vertex_idx = out_vertex->m_hyperId;
             // 更新事务回滚事务集
             if (rb->m_rollback_type == loom::EdgeType::IN) {
-                for (auto& vertex : rb->m_out_rollback[out_vertex_idx]) {
+                for (auto& vertex : rb->outEdge(out_vertex_idx).rollback) {
                     out_vertex->m_in_allRB.unsafe_erase(vertex);
                 }
             }
@@ -2494,7 +2542,7 @@ void MinWRollback::updateSCCandDependencyFastMode(unordered_set<HyperVertex::Ptr
         if (scc.find(in_vertex) != scc.end()) {
             // 更新事务回滚事务集
             if (rb->m_rollback_type == loom::EdgeType::OUT) {
-                for (auto& vertex : in_vertex->m_out_rollback[rbIdx]) {
+                for (auto& vertex : in_vertex->outEdge(rbIdx).rollback) {
                     // 若value为1，代表只有本节点和该节点依赖，可直接删除
                     if (in_vertex->m_out_allRB[vertex] == 1) {
                         in_vertex->m_out_allRB.unsafe_erase(vertex);
@@ -2503,7 +2551,7 @@ void MinWRollback::updateSCCandDependencyFastMode(unordered_set<HyperVertex::Ptr
                     }
                 }
             } else {
-                for (auto& vertex : in_vertex->m_out_rollback[rbIdx]) {
+                for (auto& vertex : in_vertex->outEdge(rbIdx).rollback) {
                     in_vertex->m_out_allRB.unsafe_erase(vertex);
                 }
             }
@@ -2542,7 +2590,7 @@ void MinWRollback::updateSCCandDependencyFastMode(unordered_set<HyperVertex::Ptr
 
 
                 // 更新事务回滚事务集
-                for (auto& vertex : in_vertex->m_out_rollback[rbIdx]) {
+                for (auto& vertex : in_vertex->outEdge(rbIdx).rollback) {
                     // 若value为1，代表只有本节点和该节点依赖，可直接删除
                     if (in_vertex->m_out_allRB[vertex] == 1) {
                         in_vertex->m_out_allRB.unsafe_erase(vertex);
@@ -2589,7 +2637,7 @@ void MinWRollback::updateSCCandDependencyFastMode(unordered_set<HyperVertex::Ptr
                 // }
 
                 // 更新事务回滚事务集
-                for (auto& vertex : rb->m_out_rollback[out_vertex_idx]) {
+                for (auto& vertex : rb->outEdge(out_vertex_idx).rollback) {
                     out_vertex->m_in_allRB.unsafe_erase(vertex);
                 }
                 
@@ -2625,7 +2673,7 @@ void MinWRollback::updateSCCandDependencyFastMode(unordered_set<HyperVertex::Ptr
 
 
                 // 更新事务回滚事务集
-                for (auto& vertex : in_vertex->m_out_rollback[rbIdx]) {
+                for (auto& vertex : in_vertex->outEdge(rbIdx).rollback) {
                     in_vertex->m_out_allRB.unsafe_erase(vertex);
                 }
                 
@@ -2658,7 +2706,7 @@ void MinWRollback::updateSCCandDependencyNoEdge(unordered_set<HyperVertex::Ptr,
         for (auto& out_vertex : rb->m_out_hv) {
             if (scc.find(out_vertex) != scc.end()) {
                 auto out_vertex_idx = out_vertex->m_hyperId;
-                out_vertex->m_in_cost -= rb->m_out_weights[out_vertex_idx];
+                out_vertex->m_in_cost -= rb->outEdge(out_vertex_idx).weight;
                 if (out_vertex->m_in_cost == 0) {
                     cout << "can delete without in: " << out_vertex->m_hyperId << endl;
                     scc.erase(out_vertex);
@@ -2678,7 +2726,7 @@ void MinWRollback::updateSCCandDependencyNoEdge(unordered_set<HyperVertex::Ptr,
                 }
                 if (rb->m_rollback_type == loom::EdgeType::IN) {
                     // 更新事务回滚事务集
-                    for (auto& vertex : rb->m_out_rollback[out_vertex_idx]) {
+                    for (auto& vertex : rb->outEdge(out_vertex_idx).rollback) {
                         out_vertex->m_in_allRB.unsafe_erase(vertex);
                     } 
                 }
@@ -2688,7 +2736,7 @@ void MinWRollback::updateSCCandDependencyNoEdge(unordered_set<HyperVertex::Ptr,
         // 遍历入边
         for (auto& in_vertex : rb->m_in_hv) {
             if (scc.find(in_vertex) != scc.end()) {                
-                in_vertex->m_out_cost -= in_vertex->m_out_weights[rbIdx];
+                in_vertex->m_out_cost -= in_vertex->outEdge(rbIdx).weight;
                 if (in_vertex->m_out_cost == 0) {
                     cout << "can delete without out: " << in_vertex->m_hyperId << endl;
                     scc.erase(in_vertex);
@@ -2708,7 +2756,7 @@ void MinWRollback::updateSCCandDependencyNoEdge(unordered_set<HyperVertex::Ptr,
                 }
                 if (rb->m_rollback_type == loom::EdgeType::OUT) {
                     // 更新事务回滚事务集
-                    for (auto& vertex : in_vertex->m_out_rollback[rbIdx]) {
+                    for (auto& vertex : in_vertex->outEdge(rbIdx).rollback) {
                         // 若value为1，代表只有本节点和该节点依赖，可直接删除
                         if (in_vertex->m_out_allRB[vertex] == 1) {
                             in_vertex->m_out_allRB.unsafe_erase(vertex);
@@ -2738,7 +2786,7 @@ void MinWRollback::updateHyperVertexWeight(const unordered_set<HyperVertex::Ptr,
 
     // 遍历出边需要回滚的子事务
     for (auto& out_hv : hyperVertex->m_out_hv) {
-        auto& rollbackSet = hyperVertex->m_out_rollback[out_hv->m_hyperId];
+        auto& rollbackSet = hyperVertex->outEdge(out_hv->m_hyperId).rollback;
         // 判断是否在scc中 && 已经被计算过
         if (scc.find(out_hv) == scc.cend() || calculated.find(out_hv) != calculated.cend()) {
             continue;
@@ -2838,13 +2886,13 @@ void MinWRollback::calculateWeight(HyperVertex::Ptr& hyperVertex, loom::EdgeType
 }
 
 /* 基于RBIndex快速回滚 */
-void MinWRollback::fastRollback(const unordered_map<string, set<Vertex::Ptr, Vertex::VertexCompare>>& RBIndex, std::vector<Vertex::Ptr>& rbList) {
+void MinWRollback::fastRollback(const unordered_map<Key, set<Vertex::Ptr, Vertex::VertexCompare>>& RBIndex, std::vector<Vertex::Ptr>& rbList) {
     // cout << "RBIndex size: " << RBIndex.size() << endl;
     for (auto& rbMap : RBIndex) {
         auto& rbKey = rbMap.first;
         auto& rbSet = rbMap.second;
         // // rbKey.substr(0, 5) == "Dytd-" || rbKey.substr(0, 2) == "S-" || rbKey.substr(0, 10) == "Cdelivery-"
-        if (rbKey.substr(0, 10) == "Cdelivery-") {
+        if (TPCC::Keys::table(rbKey) == TPCC::Table::CUSTOMER_DELIVERY) {
             // 把rbset中除第一个元素的其它元素的回滚子事务加入rbList中
             auto it = std::next(rbSet.begin());
             std::for_each(it, rbSet.end(), [&](const auto& elem) {
@@ -2870,19 +2918,19 @@ void MinWRollback::fastRollback(const unordered_map<string, set<Vertex::Ptr, Ver
     }
 }
 
-void MinWRollback::fastRollback(const unordered_map<string, set<Vertex::Ptr, Vertex::VertexCompare>>& RBIndex, std::vector<Vertex::Ptr>& rbList, std::vector<Vertex::Ptr>& nestedList) {
+void MinWRollback::fastRollback(const unordered_map<Key, set<Vertex::Ptr, Vertex::VertexCompare>>& RBIndex, std::vector<Vertex::Ptr>& rbList, std::vector<Vertex::Ptr>& nestedList) {
     // cout << "RBIndex size: " << RBIndex.size() << endl;
     for (auto& rbMap : RBIndex) {
         auto& rbKey = rbMap.first;
         auto& rbSet = rbMap.second;
         // // rbKey.substr(0, 5) == "Dytd-" || rbKey.substr(0, 2) == "S-" || rbKey.substr(0, 10) == "Cdelivery-"
-        if (rbKey.substr(0, 10) == "Cdelivery-") {
+        if (TPCC::Keys::table(rbKey) == TPCC::Table::CUSTOMER_DELIVERY) {
             // 把rbset中除第一个元素的其它元素的回滚子事务加入rbList中
             auto it = std::next(rbSet.begin());
             std::for_each(it, rbSet.end(), [&](const auto& elem) {
                 std::copy(elem->cascadeVertices.begin(), elem->cascadeVertices.end(), std::back_inserter(rbList));
             });
-        } else if (rbKey.substr(0, 2) == "S-") {
+        } else if (TPCC::Keys::table(rbKey) == TPCC::Table::STOCK) {
             // 把rbSet中除第一个元素的其它元素加入rbList中
             auto it = std::next(rbSet.begin());
             std::copy(it, rbSet.end(), std::back_inserter(rbList));
@@ -2921,7 +2969,7 @@ void MinWRollback::printHyperGraph() {
         // 输出超节点的出边和入边
         cout << "==========Edges==========" << endl;
         for (auto& out_hv : hyperVertex->m_out_hv) {
-            auto out_edges = hyperVertex->m_out_edges[out_hv->m_hyperId];
+            const auto& out_edges = hyperVertex->outEdge(out_hv->m_hyperId).edges;
             cout << "OutEdge: " << out_hv->m_hyperId << ", size: " << out_edges.size() << " => ";
             for (auto& edge : out_edges) {
                 cout << edge->m_id << " ";
@@ -2929,7 +2977,7 @@ void MinWRollback::printHyperGraph() {
             cout << endl;
         }
         for (auto& in_hv : hyperVertex->m_in_hv) {
-            auto in_edges = hyperVertex->m_in_edges[in_hv->m_hyperId];
+            const auto& in_edges = hyperVertex->inEdge(in_hv->m_hyperId).edges;
             cout << "InEdge: " << in_hv->m_hyperId << ", size: " << in_edges.size() << " => ";
             for (auto& edge : in_edges) {
                 cout << edge->m_id << " ";
@@ -3006,7 +3054,7 @@ void MinWRollback::printEdgeRollBack(HyperVertex::Ptr& hyperVertex, const tbb::c
             continue;
         }
         cout << "out edge: " << out_hv->m_hyperId << " rollback: ";
-        for (auto& vertex : hyperVertex->m_out_rollback[out_hv->m_hyperId]) {
+        for (auto& vertex : hyperVertex->outEdge(out_hv->m_hyperId).rollback) {
             cout << vertex->m_id << " ";
         }
         cout << endl;
@@ -3017,7 +3065,7 @@ void MinWRollback::printEdgeRollBack(HyperVertex::Ptr& hyperVertex, const tbb::c
             continue;
         }
         cout << "in edge: " << in_hv->m_hyperId << " rollback: ";
-        for (auto& vertex : hyperVertex->m_in_rollback[in_hv->m_hyperId]) {
+        for (auto& vertex : hyperVertex->inEdge(in_hv->m_hyperId).rollback) {
             cout << vertex->m_id << " ";
         }
         cout << endl;
@@ -1,12 +1,14 @@
 #pragma once
 
 #include <atomic>
+#include <span>
 #include <stack>
 #include <boost/heap/fibonacci_heap.hpp>
 #include <loom/utils/thread/ThreadPool.h>
 #include <loom/utils/thread/threadpool.h>
 #include <loom/utils/ThreadPool/UThreadPool.h>
 #include "common.h"
+#include "SCC.h"
 
 
 using namespace Util;
@@ -21,6 +23,9 @@ class MinWRollback
         
         ~MinWRollback() = default;
 
+        // 使用区块预先展开的rw边构图, 不再在构图阶段遍历rw冲突索引
+        void setRWEdges(std::span<const std::pair<Vertex::Ptr, Vertex::Ptr>> rwEdges) {m_rwEdges = rwEdges;}
+
         int getId() {
             return id_counter.fetch_add(1, std::memory_order_relaxed) + 1;
         }
@@ -31,6 +36,11 @@ class MinWRollback
 
         void onWarm2SCC();
 
+        void onWarm2SCC(ThreadPool::Ptr& pool);
+
+        // 流式识别: 每弹出一个scc即回调 onSCC(order, scc), order 为scc的确定性序号(最小下标)
+        void onWarm2SCC(ThreadPool::Ptr& pool, const std::function<void(int, unordered_set<HyperVertex::Ptr, HyperVertex::HyperVertexHash>&)>& onSCC);
+
         void build(set<Vertex::Ptr, Vertex::VertexCompare2>& vertices);
 
         void onRW(const Vertex::Ptr &rTx, const Vertex::Ptr &wTx);
@@ -123,6 +133,7 @@ class MinWRollback
         void rollbackNoEdge(bool fastMode);
         loom::ReExecuteInfo rollbackNoEdge(unordered_set<HyperVertex::Ptr, HyperVertex::HyperVertexHash>& scc, bool fastMode);
         void rollbackNoEdgeConcurrent(UThreadPoolPtr& Pool, std::vector<std::future<void>>& futures, bool fastMode);
+        static void appendRollback(loom::ReExecuteInfo& reExecuteInfo, std::vector<Vertex::Ptr>& rbList, vector<vector<int>>& serialOrders, unordered_set<Vertex::Ptr, Vertex::VertexHash>& added);
         void GreedySelectVertexNoEdge(unordered_set<HyperVertex::Ptr, HyperVertex::HyperVertexHash>& scc, set<HyperVertex::Ptr, loom::cmp>& pq, tbb::concurrent_unordered_set<Vertex::Ptr, Vertex::VertexHash>& result, bool fastMode);
         void GreedySelectVertexNoEdge(unordered_set<HyperVertex::Ptr, HyperVertex::HyperVertexHash>& scc, set<HyperVertex::Ptr, loom::cmp>& pq, unordered_set<Vertex::Ptr, Vertex::VertexHash>& result, vector<int>& queueOrder, stack<int>& stackOrder, bool fastMode);
         void updateSCCandDependencyNoEdge(unordered_set<HyperVertex::Ptr, HyperVertex::HyperVertexHash>& scc, const HyperVertex::Ptr& rb, set<HyperVertex::Ptr, loom::cmp>& pq);
@@ -132,8 +143,8 @@ class MinWRollback
 
 
         //opt3:FastRollback
-        void fastRollback(const unordered_map<string, set<Vertex::Ptr, Vertex::VertexCompare>>& RBIndex, std::vector<Vertex::Ptr>& rbList);
-        void fastRollback(const unordered_map<string, set<Vertex::Ptr, Vertex::VertexCompare>>& RBIndex, std::vector<Vertex::Ptr>& rbList, std::vector<Vertex::Ptr>& nestedList);
+        void fastRollback(const unordered_map<Key, set<Vertex::Ptr, Vertex::VertexCompare>>& RBIndex, std::vector<Vertex::Ptr>& rbList);
+        void fastRollback(const unordered_map<Key, set<Vertex::Ptr, Vertex::VertexCompare>>& RBIndex, std::vector<Vertex::Ptr>& rbList, std::vector<Vertex::Ptr>& nestedList);
         
 
         // 打印超图
@@ -160,13 +171,18 @@ class MinWRollback
         // 记录所有回滚事务
         tbb::concurrent_unordered_set<Vertex::Ptr, Vertex::VertexHash> m_rollbackTxs;
         // 建立倒排索引
-        unordered_map<string, loom::RWSets<Vertex::Ptr>> m_invertedIndex;
+        unordered_map<Key, loom::RWSets<Vertex::Ptr>> m_invertedIndex;
         unordered_map<Vertex::Ptr, unordered_set<Vertex::Ptr, Vertex::VertexHash>, Vertex::VertexHash>& m_RWIndex;
         // 记录图中所有强连通分量
-        vector<unordered_set<HyperVertex::Ptr, HyperVertex::HyperVertexHash>> m_sccs;
+        // 使用 concurrent_vector 保证流式识别时已发布的 scc 地址不变
+        tbb::concurrent_vector<unordered_set<HyperVertex::Ptr, HyperVertex::HyperVertexHash>> m_sccs;
         size_t m_thread_num;
+        std::span<const std::pair<Vertex::Ptr, Vertex::Ptr>> m_rwEdges;    // 区块展开的rw边, 为空时由 m_RWIndex 生成
     
     private:
+        loom::SCCGraph buildSCCGraph();
+        unordered_set<HyperVertex::Ptr, HyperVertex::HyperVertexHash> toSCC(const vector<int>& component);
+
         // 定义虚拟变量以供默认构造函数使用
         static std::vector<HyperVertex::Ptr> dummyHyperVertices;
         static std::unordered_map<Vertex::Ptr, std::unordered_set<Vertex::Ptr, Vertex::VertexHash>, Vertex::VertexHash> dummyRWIndex;
@@ -0,0 +1,200 @@
+#include "SCC.h"
+#include <algorithm>
+#include <numeric>
+
+using namespace std;
+
+namespace loom {
+
+SCCGraph::SCCGraph(size_t vertexNum) : m_vertexNum(vertexNum) {}
+
+void SCCGraph::addEdge(int from, int to) {
+    if (from != to) {
+        m_edges.emplace_back(from, to);
+    }
+}
+
+/* 计数排序构建出边与入边的CSR */
+void SCCGraph::buildCSR() {
+    m_outOffset.assign(m_vertexNum + 1, 0);
+    m_inOffset.assign(m_vertexNum + 1, 0);
+    for (auto& [from, to] : m_edges) {
+        m_outOffset[from + 1]++;
+        m_inOffset[to + 1]++;
+    }
+    partial_sum(m_outOffset.begin(), m_outOffset.end(), m_outOffset.begin());
+    partial_sum(m_inOffset.begin(), m_inOffset.end(), m_inOffset.begin());
+    m_outAdj.resize(m_edges.size());
+    m_inAdj.resize(m_edges.size());
+    vector<int> outPos(m_outOffset.begin(), m_outOffset.end() - 1);
+    vector<int> inPos(m_inOffset.begin(), m_inOffset.end() - 1);
+    for (auto& [from, to] : m_edges) {
+        m_outAdj[outPos[from]++] = to;
+        m_inAdj[inPos[to]++] = from;
+    }
+    m_edges.clear();
+    m_edges.shrink_to_fit();
+}
+
+/* 剪除入度或出度为0的节点, 每删除一个节点就更新其邻居的度数, 直到不动点 */
+void SCCGraph::trim() {
+    vector<int> inDegree(m_vertexNum), outDegree(m_vertexNum);
+    vector<int> queue;
+    queue.reserve(m_vertexNum);
+    m_alive.assign(m_vertexNum, 1);
+    for (size_t v = 0; v < m_vertexNum; v++) {
+        inDegree[v] = m_inOffset[v + 1] - m_inOffset[v];
+        outDegree[v] = m_outOffset[v + 1] - m_outOffset[v];
+        if (inDegree[v] == 0 || outDegree[v] == 0) {
+            m_alive[v] = 0;
+            queue.push_back(v);
+        }
+    }
+    for (size_t head = 0; head < queue.size(); head++) {
+        int v = queue[head];
+        for (int i = m_outOffset[v]; i < m_outOffset[v + 1]; i++) {
+            int w = m_outAdj[i];
+            if (m_alive[w] && --inDegree[w] == 0) {
+                m_alive[w] = 0;
+                queue.push_back(w);
+            }
+        }
+        for (int i = m_inOffset[v]; i < m_inOffset[v + 1]; i++) {
+            int w = m_inAdj[i];
+            if (m_alive[w] && --outDegree[w] == 0) {
+                m_alive[w] = 0;
+                queue.push_back(w);
+            }
+        }
+    }
+}
+
+/* 并查集求剩余节点的弱连通分量 */
+vector<vector<int>> SCCGraph::partition() {
+    vector<int> parent(m_vertexNum);
+    iota(parent.begin(), parent.end(), 0);
+    auto find = [&](int x) {
+        while (parent[x] != x) {
+            parent[x] = parent[parent[x]];
+            x = parent[x];
+        }
+        return x;
+    };
+    for (size_t v = 0; v < m_vertexNum; v++) {
+        if (!m_alive[v]) continue;
+        for (int i = m_outOffset[v]; i < m_outOffset[v + 1]; i++) {
+            int w = m_outAdj[i];
+            if (!m_alive[w]) continue;
+            int a = find(v), b = find(w);
+            if (a != b) parent[max(a, b)] = min(a, b);
+        }
+    }
+    vector<int> slot(m_vertexNum, -1);
+    vector<vector<int>> components;
+    for (size_t v = 0; v < m_vertexNum; v++) {
+        if (!m_alive[v]) continue;
+        int root = find(v);
+        if (slot[root] == -1) {
+            slot[root] = components.size();
+            components.emplace_back();
+        }
+        components[slot[root]].push_back(v);
+    }
+    return components;
+}
+
+/* 迭代版Tarjan, 用显式栈记录 (节点, 下一条待访问出边) 代替递归 */
+void SCCGraph::tarjan(const vector<int>& component, vector<vector<int>>& sccs, const Emit& emit) {
+    int counter = 0;
+    vector<int> S;
+    vector<pair<int, int>> callStack;
+    auto visit = [&](int v) {
+        m_index[v] = m_lowlink[v] = counter++;
+        S.push_back(v);
+        m_onStack[v] = 1;
+        callStack.emplace_back(v, m_outOffset[v]);
+    };
+    for (int root : component) {
+        if (m_index[root] != -1) continue;
+        visit(root);
+        while (!callStack.empty()) {
+            int v = callStack.back().first;
+            int& next = callStack.back().second;
+            if (next < m_outOffset[v + 1]) {
+                int w = m_outAdj[next++];
+                if (!m_alive[w]) continue;
+                if (m_index[w] == -1) {
+                    visit(w);
+                } else if (m_onStack[w]) {
+                    m_lowlink[v] = min(m_lowlink[v], m_index[w]);
+                }
+                continue;
+            }
+            callStack.pop_back();
+            if (!callStack.empty()) {
+                int u = callStack.back().first;
+                m_lowlink[u] = min(m_lowlink[u], m_lowlink[v]);
+            }
+            if (m_lowlink[v] == m_index[v]) {
+                vector<int> scc;
+                int w;
+                do {
+                    w = S.back();
+                    S.pop_back();
+                    m_onStack[w] = 0;
+                    scc.push_back(w);
+                } while (w != v);
+                if (scc.size() > 1) {
+                    sort(scc.begin(), scc.end());
+                    if (emit) emit(scc);
+                    sccs.push_back(std::move(scc));
+                }
+            }
+        }
+    }
+}
+
+vector<vector<int>> SCCGraph::compute(ThreadPool::Ptr pool, size_t taskNum, const Emit& emit) {
+    buildCSR();
+    trim();
+    auto components = partition();
+    m_index.assign(m_vertexNum, -1);
+    m_lowlink.assign(m_vertexNum, 0);
+    m_onStack.assign(m_vertexNum, 0);
+
+    vector<vector<int>> sccs;
+    if (!pool || taskNum <= 1 || components.size() <= 1) {
+        for (auto& component : components) {
+            tarjan(component, sccs, emit);
+        }
+    } else {
+        // 按规模从大到小贪心分配给负载最小的任务
+        sort(components.begin(), components.end(), [](auto& a, auto& b) {return a.size() > b.size();});
+        taskNum = min(taskNum, components.size());
+        vector<vector<const vector<int>*>> buckets(taskNum);
+        vector<size_t> load(taskNum, 0);
+        for (auto& component : components) {
+            size_t target = min_element(load.begin(), load.end()) - load.begin();
+            buckets[target].push_back(&component);
+            load[target] += component.size();
+        }
+        vector<vector<vector<int>>> results(taskNum);
+        vector<size_t> ids(taskNum);
+        iota(ids.begin(), ids.end(), 0);
+        // emit 会向同一线程池提交回滚任务, 在工作线程中等待时须边等待边执行, 不能阻塞在 future 上
+        TaskGroup group;
+        pool->enqueueBulk(group, ids.begin(), ids.end(), [this, &buckets, &results, &emit](size_t i) {
+            for (auto component : buckets[i]) {
+                tarjan(*component, results[i], emit);
+            }
+        });
+        pool->wait(group);
+        for (auto& result : results) {
+            sccs.insert(sccs.end(), std::make_move_iterator(result.begin()), std::make_move_iterator(result.end()));
+        }
+    }
+    sort(sccs.begin(), sccs.end(), [](auto& a, auto& b) {return a.front() < b.front();});
+    return sccs;
+}
+
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <functional>
+#include <loom/utils/thread/ThreadPool.h>
+
+namespace loom {
+
+/// @brief 基于整数id与扁平数组的强连通分量识别
+///        1. 迭代剪除入度或出度为 0 的节点, 这些节点不可能位于环中
+///        2. 剩余节点按弱连通分量切分, 各分量互不相交, 可以分配给不同线程
+///        3. 每个分量内执行迭代版 Tarjan 算法, 不受递归深度限制
+class SCCGraph {
+    public:
+        explicit SCCGraph(size_t vertexNum);
+
+        // 强连通分量一经弹出即回调, 可能在多个线程中并发调用
+        typedef std::function<void(const std::vector<int>&)> Emit;
+
+        // 添加有向边 from -> to, 需在 compute 之前调用
+        void addEdge(int from, int to);
+
+        /// @brief 计算所有规模大于 1 的强连通分量
+        /// @param pool 线程池, 为空时在当前线程串行计算
+        /// @param emit 每找到一个强连通分量立即回调, 使下游处理与识别重叠
+        /// @return 强连通分量列表, 分量内 id 升序, 分量按最小 id 升序, 结果与线程数无关
+        std::vector<std::vector<int>> compute(ThreadPool::Ptr pool = nullptr, size_t taskNum = 1, const Emit& emit = nullptr);
+
+    private:
+        void buildCSR();
+        void trim();
+        std::vector<std::vector<int>> partition();
+        void tarjan(const std::vector<int>& component, std::vector<std::vector<int>>& sccs, const Emit& emit);
+
+        size_t m_vertexNum;
+        std::vector<std::pair<int, int>> m_edges;
+        // CSR 出边/入边
+        std::vector<int> m_outOffset, m_outAdj;
+        std::vector<int> m_inOffset, m_inAdj;
+        // 剪枝后仍可能位于环中的节点
+        std::vector<char> m_alive;
+        // Tarjan 状态, 不同弱连通分量访问的下标互不相交, 可以并行共享
+        std::vector<int> m_index, m_lowlink;
+        std::vector<char> m_onStack;
+};
+
+}
@@ -0,0 +1,64 @@
+#include <loom/protocol/loom/TimeSpaceGraph.h>
+#include <algorithm>
+
+namespace loom {
+
+TimeSpaceGraph& TimeSpaceGraph::local() {
+    thread_local TimeSpaceGraph graph;
+    graph.clear();
+    return graph;
+}
+
+void TimeSpaceGraph::clear() {
+    m_keys.clear();
+    m_entries.clear();
+    m_readers.clear();
+    // 代数回绕时才真正清零散列槽
+    if (++m_generation == 0) {
+        for (auto& slot : m_slots) {
+            slot.generation = 0;
+        }
+        m_generation = 1;
+    }
+}
+
+TimeSpaceGraph::Entry& TimeSpaceGraph::operator[](Key key) {
+    if ((m_entries.size() + 1) * 2 > m_slots.size()) grow();
+    auto mask = m_slots.size() - 1;
+    for (auto idx = slotOf(key); ; idx = (idx + 1) & mask) {
+        auto& slot = m_slots[idx];
+        if (slot.generation != m_generation) {
+            slot = Slot{key, (int)m_entries.size(), m_generation};
+            m_keys.push_back(key);
+            m_entries.emplace_back();
+            return m_entries.back();
+        }
+        if (slot.key == key) return m_entries[slot.id];
+    }
+}
+
+/// @brief 散列槽数翻倍, 按 id 重新放入本区块的键
+void TimeSpaceGraph::grow() {
+    auto capacity = std::max<size_t>(m_slots.size() * 2, 1024);
+    m_slots.assign(capacity, Slot{});
+    m_shift = 64 - __builtin_ctzll(capacity);
+    m_generation = 1;
+    auto mask = capacity - 1;
+    for (size_t id = 0; id < m_keys.size(); id++) {
+        auto idx = slotOf(m_keys[id]);
+        while (m_slots[idx].generation == m_generation) {
+            idx = (idx + 1) & mask;
+        }
+        m_slots[idx] = Slot{m_keys[id], (int)id, m_generation};
+    }
+}
+
+int TimeSpaceGraph::totalTime() const {
+    int total = 0;
+    for (auto& entry : m_entries) {
+        total = std::max(total, entry.total_time);
+    }
+    return total;
+}
+
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <loom/common/Key.h>
+
+namespace loom {
+
+/// @brief 区块的紧凑时空图, 供 DeterReExecute 串行构建使用
+///        1. 键在区块内映射为连续的 id, 每个键一个定长表项, 按 id 存放在数组中
+///        2. 上一次写之后的读事务串成链表, 节点放在共享数组中, 写入时整条链表丢弃
+///        3. 每个线程一份, 在区块之间复用: 清空只递增代数, 不释放也不清零散列槽
+class TimeSpaceGraph {
+    public:
+        /// @brief 一个键的表项, 事务以其在重执行列表中的下标表示
+        struct Entry {
+            int lastGet = -1;       // 最后一个读事务
+            int lastPut = -1;       // 最后一个写事务
+            int readers = -1;       // 上一次写之后的读事务链表头
+            int total_time = 0;     // 访问该键的事务最晚的结束时间
+        };
+
+        /// @brief 当前线程的时空图, 返回前已清空
+        static TimeSpaceGraph& local();
+
+        /// @brief 查找键的表项, 不存在时插入空表项; 插入可能使之前返回的引用失效
+        Entry& operator[](Key key);
+
+        /// @brief 记录一个读事务
+        void addReader(Entry& entry, int tx) {
+            m_readers.push_back(Reader{tx, entry.readers});
+            entry.readers = m_readers.size() - 1;
+        }
+
+        /// @brief 遍历上一次写之后的读事务, 从最近的开始
+        template <typename F>
+        void forEachReader(const Entry& entry, F&& f) const {
+            for (int r = entry.readers; r >= 0; r = m_readers[r].next) {
+                f(m_readers[r].tx);
+            }
+        }
+
+        /// @brief 所有键中最晚的结束时间
+        int totalTime() const;
+
+        /// @brief 区块中的键数
+        size_t size() const {return m_entries.size();}
+
+    private:
+        friend class TimeSpaceGraphTest;
+
+        struct Slot {
+            Key         key = 0;
+            int         id = -1;
+            uint32_t    generation = 0;     // 与当前代数不同的槽为空
+        };
+
+        struct Reader {
+            int tx;
+            int next;
+        };
+
+        void clear();
+        void grow();
+        size_t slotOf(Key key) const {return (key * 0x9E3779B97F4A7C15ull) >> m_shift;}
+
+        std::vector<Slot>   m_slots;                // 开放寻址散列, 线性探测, 负载不超过 1/2
+        int                 m_shift = 64;
+        uint32_t            m_generation = 0;
+        std::vector<Key>    m_keys;                 // id 到键
+        std::vector<Entry>  m_entries;              // id 到表项
+        std::vector<Reader> m_readers;
+};
+
+}
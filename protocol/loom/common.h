@@ -24,6 +24,7 @@ namespace loom {
     };
 
     /// @brief 自定义比较函数: 根据给定的顺序对Vertex进行排序
+    ///        入边回滚会选中scc外的读事务, 其超节点不在顺序中, 排在所有已知超节点之后并按超节点id排序
     struct customCompare {
         unordered_map<int, int> idToOrder;
 
@@ -36,12 +37,20 @@ namespace loom {
             }
         }
     
+        int rank(const Vertex::Ptr& v) const {
+            auto it = idToOrder.find(v->m_hyperId);
+            return it == idToOrder.end() ? (int)idToOrder.size() : it->second;
+        }
+
         bool operator()(const Vertex::Ptr& a, const Vertex::Ptr& b) const {
-            auto aIdx = idToOrder.at(a->m_hyperId);
-            auto bIdx = idToOrder.at(b->m_hyperId);
+            auto aIdx = rank(a);
+            auto bIdx = rank(b);
             if (aIdx != bIdx) {
                 return aIdx < bIdx;
             }
+            if (a->m_hyperId != b->m_hyperId) {
+                return a->m_hyperId < b->m_hyperId;
+            }
             // 如果数字部分相同，比较整个字符串
             return a->m_id > b->m_id; // 注意这里是按字典序比较
         }
@@ -125,11 +134,11 @@ namespace loom {
             DLOG(INFO) << "id: " << tx->m_id << " cost: " << tx->m_self_cost << " scheduledTime: " << tx->scheduledTime;
             string readKeys, writeKeys;
             for (auto& readKey : tx->readSet) {
-                readKeys += readKey + " ";
+                readKeys += loom::keyToString(readKey) + " ";
             }
             DLOG(INFO) << "tx read set: " << readKeys;
             for (auto& writeKey : tx->writeSet) {
-                writeKeys += writeKey + " ";
+                writeKeys += loom::keyToString(writeKey) + " ";
             }
             DLOG(INFO) << "tx write set: " << writeKeys;
         }
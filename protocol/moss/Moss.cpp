@@ -5,49 +5,60 @@
 
 using namespace std::chrono;
 
-#define K std::string
+#define K loom::Key
 #define V MossEntry
 #define T shared_ptr<MossTransaction>
 #define ST shared_ptr<MossSubTransaction>
 
 
 /// @brief initialize moss protocol
-/// @param blocks the blocks to be executed
+/// @param source the source to pull blocks from
 /// @param num_threads the number of threads
 /// @param table_partitions the number of partitions for the table
 Moss::Moss(
-    vector<Block::Ptr> blocks,
+    BlockSource::Ptr source,
     Statistics& statistics,
     size_t num_threads, 
     size_t table_partitions
 ): 
-    blocks(std::move(blocks)),
+    source(std::move(source)),
     statistics(statistics),
     num_threads(num_threads),
     table(table_partitions),
     pool(std::make_shared<ThreadPool>(num_threads))
 {
+    this->table.Reserve(this->source->keyHint());
     LOG(INFO) << fmt::format("Moss(num_threads={}, table_partitions={})", num_threads, table_partitions) << std::endl;
 }
 
-/// @brief prepare the transactions
-/// @param m_blocks the transactions to be transformed
-void Moss::Preparation(vector<vector<T>>& m_blocks) {
-    for (size_t i = 0; i < blocks.size(); i++) {
-        auto txs = blocks[i]->getTxs();
-        vector<T> m_txs;
-        for (size_t j = 0; j < txs.size(); j++) {
-            auto tx = txs[j];
-            auto txid = tx->GetTx()->m_hyperId;
-            auto rootVertex = tx->GetTx()->m_rootVertex;
-            T m_tx = make_shared<MossTransaction>(std::move(*tx), txid);
-            ST root_tx = make_shared<MossSubTransaction>(std::move(*rootVertex), m_tx);
-            BuildRoot(root_tx, rootVertex, m_tx);
-            m_tx->root_tx = root_tx;
-            m_txs.push_back(m_tx);
-        }
-        m_blocks.push_back(m_txs);
+/// @brief initialize moss protocol with pre-generated blocks
+/// @param blocks the blocks to be executed
+Moss::Moss(
+    vector<Block::Ptr> blocks,
+    Statistics& statistics,
+    size_t num_threads, 
+    size_t table_partitions
+): 
+    Moss(std::make_shared<VectorBlockSource>(std::move(blocks)), statistics, num_threads, table_partitions)
+{}
+
+/// @brief prepare the transactions of a block
+/// @param block the block to be transformed
+/// @return the moss transactions of the block
+vector<T> Moss::Preparation(const Block::Ptr& block) {
+    auto& txs = block->getTxs();
+    vector<T> m_txs;
+    for (size_t j = 0; j < txs.size(); j++) {
+        auto tx = txs[j];
+        auto txid = tx->GetTx()->m_hyperId;
+        auto rootVertex = tx->GetTx()->m_rootVertex;
+        T m_tx = make_shared<MossTransaction>(Transaction(*tx), txid);
+        ST root_tx = make_shared<MossSubTransaction>(*rootVertex, m_tx);
+        BuildRoot(root_tx, rootVertex, m_tx);
+        m_tx->root_tx = root_tx;
+        m_txs.push_back(m_tx);
     }
+    return m_txs;
 }
 
 /// @brief build the root sub-transaction
@@ -57,7 +68,7 @@ void Moss::Preparation(vector<vector<T>>& m_blocks) {
 void Moss::BuildRoot(ST stx, Vertex::Ptr v, T ftx) {
     if (!v->m_children.empty()) {
         for (auto& child : v->m_children) {
-            auto sub_tx = make_shared<MossSubTransaction>(std::move(*child.vertex), ftx);
+            auto sub_tx = make_shared<MossSubTransaction>(*child.vertex, ftx);
             BuildRoot(sub_tx, child.vertex, ftx);
             stx->children_txs.push_back(sub_tx);
         }
@@ -66,19 +77,15 @@ void Moss::BuildRoot(ST stx, Vertex::Ptr v, T ftx) {
 
 /// @brief start the protocol
 void Moss::Start() {
-    // transform Transaction to MossTransaction
-    vector<vector<T>> m_blocks;
-    Preparation(m_blocks);
-    
     // execute all transactions in the blocks
     LOG(INFO) << "Start" << endl;
-    DLOG(INFO) << "block num: " << m_blocks.size() << endl;
 
     auto start_time = std::chrono::steady_clock::now();
     std::chrono::seconds duration(2);
 
-    for (size_t i = 0; i < m_blocks.size(); i++) {
-        auto m_txs = m_blocks[i];
+    for (size_t i = 0; auto block = source->next(); i++) {
+        // transform Transaction to MossTransaction
+        auto m_txs = Preparation(block);
         // execute all transactions in the block
         DLOG(INFO) << "block size: " << m_txs.size() << endl;
         std::vector<std::future<void>> futures;
@@ -125,6 +132,7 @@ void Moss::Start() {
 
 /// @brief stop the protocol
 void Moss::Stop() {
+    source->close();
     stop_flag.store(true);
     pool->shutdown();
     LOG(INFO) << "Moss stop";
@@ -135,13 +143,13 @@ void Moss::Stop() {
 void Moss::Execute(ST stx, bool reExecute) {
     // set the handlers
     stx->InstallGetStorageHandler([this, stx](
-        const std::unordered_set<string>& readSet
+        const KeySet& readSet
     ) {
         string keys;
         // no multi-version
         for (auto& key : readSet) {
             DLOG(INFO) << "stx " << stx->m_id << " read " << key << std::endl;
-            keys += key + " ";
+            keys += keyToString(key) + " ";
             string value;
             table.Get(stx, key, value);
             if (stx->ftx->HasWAR(stx)) { return; }
@@ -151,13 +159,13 @@ void Moss::Execute(ST stx, bool reExecute) {
     });
 
     stx->InstallSetStorageHandler([this, stx](
-        const std::unordered_set<string>& writeSet,
+        const KeySet& writeSet,
         const std::string& value
     ) {
         string keys;
         for (auto& key : writeSet) {
             DLOG(INFO) << "stx " << stx->m_id << " write " << key << std::endl;
-            keys += key + " ";
+            keys += keyToString(key) + " ";
             table.Put(stx, key, value);
             if (stx->ftx->HasWAR(stx)) { return; }
             stx->local_put[key] = value;
@@ -314,9 +322,9 @@ void MossTransaction::Execute() {
 
 /// @brief construct an empty MossSubTransaction
 MossSubTransaction::MossSubTransaction(
-    Vertex&& inner, T ftx
+    const Vertex& inner, T ftx
 ): 
-    Vertex(std::move(inner)), 
+    Vertex(inner), 
     ftx(ftx)
 {
     if (!ftx) {
@@ -5,6 +5,7 @@
 #include <loom/utils/Ulock.h>
 #include <loom/protocol/common.h>
 #include <loom/common/Block.h>
+#include <loom/common/BlockSource.h>
 #include <loom/common/Transaction.h>
 #include <unordered_set>
 #include <loom/utils/thread/ThreadPool.h>
@@ -15,7 +16,7 @@ using namespace std;
 
 namespace loom {
 
-#define K string
+#define K loom::Key
 #define V MossEntry
 #define T shared_ptr<MossTransaction>
 #define ST shared_ptr<MossSubTransaction>
@@ -43,10 +44,14 @@ struct MossSubTransaction: public Vertex {
     vector<ST> children_txs{};
     std::unordered_map<K, std::string> local_get{};
     std::unordered_map<K, std::string> local_put{};
-    MossSubTransaction(Vertex&& inner, T ftx);
+    MossSubTransaction(const Vertex& inner, T ftx);
     void Execute() override;
 };
 
+#ifndef MOSS_TABLE_KIND
+#define MOSS_TABLE_KIND TableKind::FLAT
+#endif
+
 /// @brief moss table entry for execution
 struct MossEntry {
     string value;
@@ -57,7 +62,7 @@ struct MossEntry {
 };
 
 /// @brief moss table for execution
-struct MossTable: public Table<K, MossEntry, KeyHasher> {
+struct MossTable: public Table<K, MossEntry, KeyHasher, MOSS_TABLE_KIND> {
     MossTable(size_t partitions);
     void Get(ST stx, const K& k, std::string& v);
     void Put(ST stx, const K& k, const std::string& v);
@@ -69,10 +74,11 @@ struct MossTable: public Table<K, MossEntry, KeyHasher> {
 class Moss: public Protocol {
 
 public:
+    Moss(BlockSource::Ptr source, Statistics& statistics, size_t num_threads, size_t table_partitions = 1);
     Moss(vector<Block::Ptr> blocks, Statistics& statistics, size_t num_threads, size_t table_partitions = 1);
     void Start() override;
     void Stop() override;
-    void Preparation(vector<vector<T>>& m_blocks);
+    vector<T> Preparation(const Block::Ptr& block);
     void BuildRoot(ST stx, Vertex::Ptr v, T ftx);
     void Execute(T tx);
     void Execute(ST stx, bool reExecute = false);
@@ -82,7 +88,7 @@ public:
 
 private:
     Statistics&                             statistics;
-    vector<Block::Ptr>                      blocks;
+    BlockSource::Ptr                        source;
     size_t                                  num_threads;
     MossTable                               table;
     std::atomic<bool>                       stop_flag{false};
@@ -6,24 +6,23 @@ using namespace std;
 using namespace loom;
 
 #define T shared_ptr<OptMETransaction>
-#define K string
+#define K loom::Key
 
 using namespace std::chrono;
 
 /// @brief initialize optme protocol
-/// @param blocks the blocks to be executed
+/// @param source the source to pull blocks from
 /// @param num_threads the number of threads
 /// @param table_partitions the number of partitions for the table
 OptME::OptME(
-    vector<Block::Ptr>& blocks,
+    BlockSource::Ptr source,
     Statistics& statistics,
     size_t num_threads, 
     size_t table_partitions,
     bool enable_parallel
 ):
-    blocks(blocks),
+    source(std::move(source)),
     statistics(statistics),
-    batches(), // empty
     table(table_partitions),
     num_threads(num_threads),
     pool(make_shared<ThreadPool>(num_threads)),
@@ -31,40 +30,41 @@ OptME::OptME(
     committed_block(0),
     enable_parallel(enable_parallel)
 {
+    this->table.Reserve(this->source->keyHint());
     LOG(INFO) << fmt::format("OptME(num_threads={}, table_partitions={}, enable_parallel={})", num_threads, table_partitions, enable_parallel) << endl;
 }
 
+/// @brief initialize optme protocol with pre-generated blocks
+/// @param blocks the blocks to be executed
+OptME::OptME(
+    vector<Block::Ptr>& blocks,
+    Statistics& statistics,
+    size_t num_threads, 
+    size_t table_partitions,
+    bool enable_parallel
+):
+    OptME(make_shared<VectorBlockSource>(blocks), statistics, num_threads, table_partitions, enable_parallel)
+{}
+
 /// @brief start optme protocol
 void OptME::Start() {
     LOG(INFO) << "OptME started";
-    
-    // split blocks into batches
-    for (size_t i = 0; i < blocks.size(); ++i) {
-        auto& block = blocks[i];
-        auto& txs = block->getTxs();
-        vector<T> batch;
-        batch.reserve(txs.size());
-        size_t batch_id = i + 1;
-        // get all batch of one block
-        for (size_t j = 0; j < txs.size(); j++) {
-            auto& tx = txs[j];
-            size_t txid = tx->GetTx()->m_hyperId;
-            batch.emplace_back(make_shared<OptMETransaction>(std::move(*tx), txid, batch_id));
-        }
-        // store block batch
-        acgs.push_back(make_shared<AddressBasedConflictGraph>(pool, batch));
-        batches.push_back(std::move(batch));
-    }
-
     Run();
 }
 
 /// @brief run optme protocol
 void OptME::Run() {
-    // execute each batch
-    for (int i = 0; i < batches.size(); ++i) {
-        auto& batch = batches[i];
-        auto& acg = acgs[i];
+    // pull and execute blocks one by one
+    while (auto block = source->next()) {
+        auto& txs = block->getTxs();
+        vector<T> batch;
+        batch.reserve(txs.size());
+        size_t batch_id = block_idx + 1;
+        for (auto& tx : txs) {
+            size_t txid = tx->GetTx()->m_hyperId;
+            batch.emplace_back(make_shared<OptMETransaction>(Transaction(*tx), txid, batch_id));
+        }
+        auto acg = make_shared<AddressBasedConflictGraph>(pool, batch);
         vector<vector<T>> schedules;
         vector<T> aborted_txs;
         Simulate(batch);
@@ -81,6 +81,7 @@ void OptME::Run() {
 
 /// @brief stop optme protocol
 void OptME::Stop() {
+    source->close();
     pool->shutdown();
     LOG(INFO) << "OptME stopped";
 }
@@ -95,11 +96,11 @@ void OptME::Simulate(vector<T>& batch) {
         simulateFutures.push_back(pool->enqueue([this, tx] {
             // read locally from local storage
             tx->InstallGetStorageHandler([&](
-                const unordered_set<string>& readSet
+                const KeySet& readSet
             ) {
                 string keys;
                 for (auto& key : readSet) {
-                    keys += key + " ";
+                    keys += keyToString(key) + " ";
                     string value = "";
                     table.ReserveGet(tx, key);
                     tx->local_get[key] = value;
@@ -108,12 +109,12 @@ void OptME::Simulate(vector<T>& batch) {
             });
             // write locally to local storage
             tx->InstallSetStorageHandler([&](
-                const unordered_set<string>& writeSet,
+                const KeySet& writeSet,
                 const string& value
             ) {
                 string keys;
                 for (auto& key : writeSet) {
-                    keys += key + " ";
+                    keys += keyToString(key) + " ";
                     table.ReservePut(tx, key);
                     tx->local_put[key] = value;
                 }
@@ -221,10 +222,12 @@ void OptME::IntraEpochReordering(shared_ptr<AddressBasedConflictGraph>& acg, vec
 /// @brief inter epoch reordering
 void OptME::InterEpochReordering(vector<vector<T>>& schedules, vector<T>& aborted_txs) {
     // rescedule aborted txs
-    vector<unordered_set<K>> epoch_map;
+    vector<KeySet> epoch_map;
     for (const auto& tx : aborted_txs) {
+        // local_get/local_put 的键即为根节点的全部读写集
+        auto& root = tx->m_tx->m_rootVertex;
         int epoch = 0;
-        while (epoch < epoch_map.size() && (loom::hasContain(tx->local_get, epoch_map[epoch]) || loom::hasContain(tx->local_put, epoch_map[epoch]))) {
+        while (epoch < epoch_map.size() && (loom::hasConflict(root->allReadSet, epoch_map[epoch]) || loom::hasConflict(root->allWriteSet, epoch_map[epoch]))) {
             epoch++;
         }
 
@@ -237,7 +240,7 @@ void OptME::InterEpochReordering(vector<vector<T>>& schedules, vector<T>& aborte
         // for (const auto& kv : tx->local_put) {
         //     epoch_map[epoch].insert(kv.first);
         // }
-        std::transform(tx->local_put.begin(), tx->local_put.end(), std::inserter(epoch_map[epoch], epoch_map[epoch].end()), [](const auto& kv) { return kv.first; });
+        epoch_map[epoch].insert(root->allWriteSet);
     }
 }
 
@@ -308,11 +311,11 @@ void OptME::Finalize(T tx) {
 void OptME::ReExecute(T tx) {
     // read from the public table
     tx->InstallGetStorageHandler([&](
-        const std::unordered_set<string>& readSet
+        const KeySet& readSet
     ) {
         string keys;
         for (auto& key : readSet) {
-            keys += key + " ";
+            keys += keyToString(key) + " ";
             string value;
             table.Get(key, [&](auto& entry){
                 value = entry.value;
@@ -323,12 +326,12 @@ void OptME::ReExecute(T tx) {
     });
     // write directly into the public table
     tx->InstallSetStorageHandler([&](
-        const std::unordered_set<string>& writeSet,
+        const KeySet& writeSet,
         const std::string& value
     ) {
         string keys;
         for (auto& key : writeSet) {
-            keys += key + " ";
+            keys += keyToString(key) + " ";
             table.Put(key, [&](auto& entry){
                 entry.value = value;
             });
@@ -349,8 +352,8 @@ OptMETransaction::OptMETransaction(
     sequence(0)
 {
     // initial readSet and writeSet empty
-    local_get = unordered_map<string, string>();
-    local_put = unordered_map<string, string>();
+    local_get = unordered_map<Key, string>();
+    local_put = unordered_map<Key, string>();
 }
 
 /// @brief move constructor for OptMETransaction
@@ -507,7 +510,7 @@ void OptMETable::ReservePut(T tx, const K& k) {
 
 // /// @brief check if there is an updater conflict
 // /// @param tx the transaction
-// bool AddressBasedConflictGraph::check_updater_conflict(unordered_map<string, string>& write_units) {
+// bool AddressBasedConflictGraph::check_updater_conflict(unordered_map<Key, string>& write_units) {
 //     for (auto& tup: write_units) {
 //         auto key = std::get<0>(tup);
 //         if (addresses.find(key) != addresses.end() && !addresses.at(key)->write_units.empty()) {
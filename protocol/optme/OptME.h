@@ -5,11 +5,12 @@
 #include <loom/utils/Ulock.h>
 #include <loom/utils/thread/ThreadPool.h>
 #include <loom/common/Block.h>
+#include <loom/common/BlockSource.h>
 #include <loom/utils/Statistic/Statistics.h>
 
 namespace loom {
 
-#define K string
+#define K loom::Key
 #define T shared_ptr<OptMETransaction>
 
 class AddressBasedConflictGraph;
@@ -22,8 +23,8 @@ struct OptMETransaction: public Transaction {
     std::atomic<bool>   committed{false};
     std::atomic<bool>   aborted{false};
     std::chrono::time_point<std::chrono::steady_clock> start_time;
-    std::unordered_map<string, string> local_get;
-    std::unordered_map<string, string> local_put;
+    std::unordered_map<Key, string> local_get;
+    std::unordered_map<Key, string> local_put;
     void Execute() override;
     void set_sequence(size_t seq) { sequence = seq; }
     size_t get_sequence() const { return sequence; }
@@ -32,6 +33,10 @@ struct OptMETransaction: public Transaction {
     OptMETransaction(const OptMETransaction& other); // copy constructor
 };
 
+#ifndef OPTME_TABLE_KIND
+#define OPTME_TABLE_KIND TableKind::FLAT
+#endif
+
 /// @brief optme table entry for execution
 struct OptMEEntry {
     string              value               = "";
@@ -43,7 +48,7 @@ struct OptMEEntry {
 };
 
 /// @brief optme table for execution
-struct OptMETable: public Table<K, OptMEEntry, KeyHasher> {
+struct OptMETable: public Table<K, OptMEEntry, KeyHasher, OPTME_TABLE_KIND> {
     OptMETable(size_t partitions);
     void ReserveGet(T tx, const K& k);
     void ReservePut(T tx, const K& k);
@@ -52,6 +57,7 @@ struct OptMETable: public Table<K, OptMEEntry, KeyHasher> {
 /// @brief optme protocol master class
 class OptME: public Protocol {
 public:
+    OptME(BlockSource::Ptr source, Statistics& statistics, size_t num_threads, size_t table_partitions = 1, bool enable_parallel = true);
     OptME(vector<Block::Ptr>& blocks, Statistics& statistics, size_t num_threads, size_t table_partitions = 1, bool enable_parallel = true);
     void Start() override;
     void Stop() override;
@@ -68,9 +74,7 @@ public:
 
 private:
     Statistics&                     statistics;
-    vector<Block::Ptr>&             blocks;
-    vector<vector<T>>               batches;
-    vector<shared_ptr<AddressBasedConflictGraph>> acgs;
+    BlockSource::Ptr                source;
     size_t                          num_threads;
     OptMETable                      table;
     bool                            enable_parallel;
@@ -10,7 +10,7 @@ using namespace std;
 
 namespace loom {
 
-#define K string
+#define K loom::Key
 #define T shared_ptr<OptMETransaction>
 #define U shared_ptr<Unit>
 
@@ -223,25 +223,14 @@ public:
         size_t ncpu = pool->getThreadNum();
         size_t chunk_size = max(num_of_txn / ncpu, size_t(1));
 
-        vector<future<shared_ptr<AddressBasedConflictGraph>>> futures;
-
-        // 使用动态任务划分，避免固定大小块的负载不均
-        for (size_t i = 0; i < num_of_txn; i += chunk_size) {
-            size_t end = min(i + chunk_size, num_of_txn);
-            
-            futures.push_back(pool->enqueue([this, &simulation_result, i, end]() {
-                vector<T> chunk(simulation_result.begin() + i, simulation_result.begin() + end);
-                shared_ptr<AddressBasedConflictGraph> sub_graph = make_shared<AddressBasedConflictGraph>(this->pool);
-                sub_graph->construct(chunk);
-                return sub_graph;
-            }));
-        }
-
-        vector<shared_ptr<AddressBasedConflictGraph>> sub_graphs;
-        sub_graphs.reserve(futures.size());
-        for (auto& f : futures) {
-            sub_graphs.push_back(f.get());
-        }
+        // 每块构建一个子图, 子图按块顺序存放, 合并结果与调度无关
+        vector<shared_ptr<AddressBasedConflictGraph>> sub_graphs((num_of_txn + chunk_size - 1) / chunk_size);
+        pool->parallelFor(0, num_of_txn, chunk_size, [this, &simulation_result, &sub_graphs, chunk_size](size_t i, size_t end) {
+            vector<T> chunk(simulation_result.begin() + i, simulation_result.begin() + end);
+            shared_ptr<AddressBasedConflictGraph> sub_graph = make_shared<AddressBasedConflictGraph>(this->pool);
+            sub_graph->construct(chunk);
+            sub_graphs[i / chunk_size] = std::move(sub_graph);
+        });
 
         // 使用局部合并和并行归约来减少合并时的同步开销
         while (sub_graphs.size() > 1) {
@@ -301,7 +290,7 @@ public:
         return units;
     }
 
-    vector<U> convert_to_units2(T tx, UnitType unit_type, unordered_set<K> read_or_write_set, unordered_set<K> read_set = {}) {    
+    vector<U> convert_to_units2(T tx, UnitType unit_type, const KeySet& read_or_write_set, const KeySet& read_set = {}) {    
         vector<U> units;
         for (const auto& key : read_or_write_set) {
             bool co_locate = false;
@@ -2,81 +2,84 @@
 #include <fmt/core.h>
 #include <glog/logging.h>
 
-#define K string
+#define K loom::Key
 #define V string
 #define T SerialTransaction
 
 /// @brief initialize serial protocol
-/// @param blocks blocks to execute
+/// @param source source to pull blocks from
 /// @param statistics statistics to record
 /// @param table_partitions number of partitions for table
 Serial::Serial(
-    vector<Block::Ptr> blocks, Statistics& statistics, 
+    BlockSource::Ptr source, Statistics& statistics, 
     size_t thread_num, size_t table_partitions
 ): 
-    blocks(blocks), 
+    source(std::move(source)), 
     statistics(statistics), 
     thread_num(thread_num),
     table(table_partitions)
 {
+    this->table.Reserve(this->source->keyHint());
     LOG(INFO) << fmt::format("Serial(table_partitions={})", table_partitions) << std::endl;
 }
 
+/// @brief initialize serial protocol with pre-generated blocks
+/// @param blocks blocks to execute
+Serial::Serial(
+    vector<Block::Ptr> blocks, Statistics& statistics, 
+    size_t thread_num, size_t table_partitions
+): 
+    Serial(make_shared<VectorBlockSource>(std::move(blocks)), statistics, thread_num, table_partitions)
+{}
+
 /// @brief start serial protocol
 void Serial::Start() {
     LOG(INFO) << "Serial Start";
-    vector<T> workloads;
-    for (auto& block: blocks) {
-        size_t block_id = block->getBlockId();
-        for (auto& tx: block->getTxs()) {
-            size_t txid = tx->GetTx()->m_hyperId;
-            workloads.emplace_back(std::move(*tx), txid, block_id);
-        }
-    }
 
-    thread = new std::thread([this, txs = std::move(workloads)]() {
-        size_t idx = 0;
-        size_t block_id = 0;
+    thread = new std::thread([this]() {
         LOG(INFO) << "Execution Start";
-        while (!stop_flag.load() && idx < txs.size()) {
-            auto tx = std::move(txs[idx]);
-            if (tx.block_id != block_id) {
-                block_id = tx.block_id;
-                statistics.JournalBlock();
+        // pull blocks one by one until the source is exhausted or closed
+        while (!stop_flag.load()) {
+            auto block = source->next();
+            if (!block) break;
+            statistics.JournalBlock();
+            size_t block_id = block->getBlockId();
+            for (auto& inner: block->getTxs()) {
+                if (stop_flag.load()) break;
+                T tx(Transaction(*inner), inner->GetTx()->m_hyperId, block_id);
+                auto start_time = std::chrono::steady_clock::now();
+                tx.InstallGetStorageHandler([&](
+                    const KeySet& readSet
+                ) {
+                    string keys;
+                    for (auto& key: readSet) {
+                        keys += keyToString(key) + " ";
+                        string value;
+                        table.Put(key, [&](auto& entry) {
+                            value = entry.value;
+                        });
+                        tx.local_get[key] = value;
+                    }
+                    DLOG(INFO) << "tx " << tx.id << " read: " << keys;
+                });
+                tx.InstallSetStorageHandler([&](
+                    const KeySet& writeSet, 
+                    const string& value
+                ) {
+                    string keys;
+                    for (auto& key: writeSet) {
+                        keys += keyToString(key) + " ";
+                        tx.local_put[key] = value;
+                    }
+                    DLOG(INFO) << "tx " << tx.id << " write: " << keys;
+                });
+                // execute transaction
+                tx.Execute();
+                // record statistics
+                statistics.JournalExecute();
+                statistics.JournalCommit(chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start_time).count());
+                statistics.JournalOverheads(tx.m_tx->m_rootVertex->m_cost);
             }
-            auto start_time = std::chrono::steady_clock::now();
-            tx.InstallGetStorageHandler([&](
-                const std::unordered_set<string>& readSet
-            ) {
-                string keys;
-                for (auto& key: readSet) {
-                    keys += key + " ";
-                    string value;
-                    table.Put(key, [&](auto& entry) {
-                        value = entry.value;
-                    });
-                    tx.local_get[key] = value;
-                }
-                DLOG(INFO) << "tx " << tx.id << " read: " << keys;
-            });
-            tx.InstallSetStorageHandler([&](
-                const std::unordered_set<string>& writeSet, 
-                const string& value
-            ) {
-                string keys;
-                for (auto& key: writeSet) {
-                    keys += key + " ";
-                    tx.local_put[key] = value;
-                }
-                DLOG(INFO) << "tx " << tx.id << " write: " << keys;
-            });
-            // execute transaction
-            tx.Execute();
-            // record statistics
-            statistics.JournalExecute();
-            statistics.JournalCommit(chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start_time).count());
-            statistics.JournalOverheads(tx.m_tx->m_rootVertex->m_cost);
-            idx++;
         }
         LOG(INFO) << "Execution Finish";
     });
@@ -85,6 +88,7 @@ void Serial::Start() {
 /// @brief stop serial protocol
 void Serial::Stop() {
     stop_flag.store(true);
+    source->close();
     thread->join();
     delete thread;
     thread = nullptr;
@@ -100,8 +104,8 @@ SerialTransaction::SerialTransaction(
     block_id{block_id}
 {
     // initial readSet and writeSet empty
-    local_get = std::unordered_map<string, string>();
-    local_put = std::unordered_map<string, string>();
+    local_get = std::unordered_map<Key, string>();
+    local_put = std::unordered_map<Key, string>();
 }
 
 /// @brief move constructor
@@ -6,6 +6,7 @@
 #include <loom/utils/Ulock.h>
 #include <loom/protocol/common.h>
 #include <loom/common/Block.h>
+#include <loom/common/BlockSource.h>
 #include <loom/common/Transaction.h>
 #include <loom/utils/Statistic/Statistics.h>
 
@@ -14,7 +15,7 @@ using namespace std;
 
 namespace loom {
 
-#define K string
+#define K loom::Key
 #define V string
 #define T SerialTransaction
 
@@ -23,32 +24,37 @@ struct SerialTransaction: public Transaction {
     size_t      id;
     size_t      block_id;
     std::chrono::time_point<std::chrono::steady_clock> start_time;
-    std::unordered_map<string, string> local_get;
-    std::unordered_map<string, string> local_put;
+    std::unordered_map<Key, string> local_get;
+    std::unordered_map<Key, string> local_put;
     SerialTransaction(Transaction&& inner, size_t id, size_t block_id);
     SerialTransaction(SerialTransaction&& tx) noexcept; // move constructor
     SerialTransaction(const SerialTransaction& other); // copy constructor
 };
 
+#ifndef SERIAL_TABLE_KIND
+#define SERIAL_TABLE_KIND TableKind::FLAT
+#endif
+
 /// @brief aria table entry for first round execution
 struct SerialEntry {
     string value = "";
 };
 
 /// @brief aria table for first round execution
-struct SerialTable: public Table<K, SerialEntry, KeyHasher> {
+struct SerialTable: public Table<K, SerialEntry, KeyHasher, SERIAL_TABLE_KIND> {
     SerialTable(size_t partitions);
 };
 
 class Serial: public Protocol {
 
 public:
+    Serial(BlockSource::Ptr source, Statistics& statistics, size_t thread_num = 1, size_t table_partitions = 1);
     Serial(vector<Block::Ptr> blocks, Statistics& statistics, size_t thread_num = 1, size_t table_partitions = 1);
     void Start() override;
     void Stop()  override;
 
 private:
-    vector<Block::Ptr>  blocks;
+    BlockSource::Ptr    source;
     SerialTable         table;
     size_t              thread_num;
     std::thread*        thread{nullptr};
@@ -1,10 +1,15 @@
 #include <gtest/gtest.h>
 #include <chrono>
+#include <fstream>
+#include <random>
+#include <set>
+#include <unistd.h>
 #include "workload/tpcc/Workload.hpp"
 #include "protocol/loom/MinWRollback.h"
 #include "protocol/loom/common.h"
 #include "utils/Generator/UTxGenerator.h"
 #include "protocol/loom/DeterReExecute.h"
+#include "protocol/loom/TimeSpaceGraph.h"
 
 using namespace std;
 
@@ -49,7 +54,7 @@ TEST(DeterReExecuteTest, TestTimeSpaceGraph) {
     TxGenerator txGenerator_normal(loom::BLOCK_SIZE), txGenerator_nested(loom::BLOCK_SIZE);
     unordered_map<Vertex::Ptr, unordered_set<Vertex::Ptr, Vertex::VertexHash>, Vertex::VertexHash> RWIndex_normal, RWIndex_nested;// rw冲突索引
     unordered_map<Vertex::Ptr, unordered_set<Vertex::Ptr, Vertex::VertexHash>, Vertex::VertexHash> conflictIndex_normal, conflictIndex_nested;// 冲突索引
-    unordered_map<string, set<Vertex::Ptr, Vertex::VertexCompare>> RBIndex_normal, RBIndex_nested;// 回滚索引
+    unordered_map<Key, set<Vertex::Ptr, Vertex::VertexCompare>> RBIndex_normal, RBIndex_nested;// 回滚索引
     txGenerator_normal.generateIndex(rbList_normal, minw_normal.m_invertedIndex, RWIndex_normal, conflictIndex_normal, RBIndex_normal);
 
     auto start = chrono::high_resolution_clock::now();
@@ -95,4 +100,296 @@ TEST(DeterReExecuteTest, TestTimeSpaceGraph) {
     cout << "Origin Optimized Percent: " << originOptimizedPercent << "%" << endl;
     double optimizedPercent = (1.0/executionTime_nested - 1.0/executionTime_normal) * 100.0 / (1.0/executionTime_normal);
     cout << "Optimized Percent: " << optimizedPercent << "%" << endl;
-}
\ No newline at end of file
+}
+
+/// @brief 生成访问少量键的事务, 每个事务一个超节点, 便于检查重执行顺序
+vector<Vertex::Ptr> makeConflictingTxs(int n, int keys, unsigned seed) {
+    std::mt19937 rng(seed);
+    vector<Vertex::Ptr> txs;
+    for (int i = 0; i < n; i++) {
+        auto hyperVertex = make_shared<HyperVertex>(i + 1, false);
+        auto tx = make_shared<Vertex>(hyperVertex, i + 1, to_string(i + 1), 0);
+        tx->m_self_cost = 1 + rng() % 5;
+        for (int k = 1 + rng() % 2; k > 0; k--) tx->writeSet.insert(1 + rng() % keys);
+        for (int k = 1 + rng() % 3; k > 0; k--) tx->readSet.insert(1 + rng() % keys);
+        txs.push_back(tx);
+    }
+    return txs;
+}
+
+/// @brief 重执行 rbList 并检查: 每个事务恰好执行一次, 且在与其冲突的所有前序事务完成之后才开始
+void expectDependencyOrder(DeterReExecute& reExecute, const vector<Vertex::Ptr>& txs) {
+    int n = txs.size();
+    std::unique_ptr<std::atomic<int>[]> runs(new std::atomic<int>[n]);
+    std::atomic<int> violations{0};
+    for (int i = 0; i < n; i++) {
+        runs[i] = 0;
+        txs[i]->InstallGetStorageHandler([&, i](const KeySet&) {
+            runs[i]++;
+            for (int j = 0; j < i; j++) {
+                bool conflict = loom::intersects(txs[j]->writeSet, txs[i]->writeSet) || loom::intersects(txs[j]->writeSet, txs[i]->readSet) || loom::intersects(txs[j]->readSet, txs[i]->writeSet);
+                if (conflict && !txs[j]->m_hyperVertex->m_setted) violations++;
+            }
+        });
+    }
+    auto pool = std::make_shared<ThreadPool>(4);
+    Statistics statistics;
+    std::vector<std::future<void>> futures;
+    reExecute.reExcution(pool, futures, statistics);
+    for (int i = 0; i < n; i++) {
+        EXPECT_EQ(runs[i], 1) << "tx " << i;
+        EXPECT_TRUE(txs[i]->m_hyperVertex->m_setted) << "tx " << i;
+    }
+    EXPECT_EQ(violations, 0);
+}
+
+TEST(DeterReExecuteTest, TestReExecuteOrder) {
+    // 构图之后重排 m_rbList(calculateTotalExecutionTime 按调度时间排序)不影响按依赖图执行
+    auto txs = makeConflictingTxs(300, 20, 42);
+    vector<Vertex::Ptr> rbList = txs;
+    vector<vector<int>> serialOrders;
+    unordered_map<Vertex::Ptr, unordered_set<Vertex::Ptr, Vertex::VertexHash>, Vertex::VertexHash> conflictIndex;
+    DeterReExecute reExecute(rbList, serialOrders, conflictIndex);
+    reExecute.buildAndReScheduleFlat();
+    reExecute.calculateTotalExecutionTime();
+    ASSERT_NE(rbList, txs);
+    expectDependencyOrder(reExecute, txs);
+}
+
+TEST(DeterReExecuteTest, TestCriticalPathFirst) {
+    // 按 bottom level 调度就绪事务时同样全部执行一次且遵守依赖
+    auto txs = makeConflictingTxs(300, 20, 7);
+    vector<Vertex::Ptr> rbList = txs;
+    vector<vector<int>> serialOrders;
+    unordered_map<Vertex::Ptr, unordered_set<Vertex::Ptr, Vertex::VertexHash>, Vertex::VertexHash> conflictIndex;
+    DeterReExecute reExecute(rbList, serialOrders, conflictIndex);
+    reExecute.buildAndReScheduleFlat();
+    reExecute.setCriticalPathFirst(true);
+    expectDependencyOrder(reExecute, txs);
+}
+
+TEST(DeterReExecuteTest, TestReExecuteTrace) {
+    // 重执行区间记录所属区块与事务, 写入 trace
+    auto txs = makeConflictingTxs(50, 10, 3);
+    vector<Vertex::Ptr> rbList = txs;
+    vector<vector<int>> serialOrders;
+    unordered_map<Vertex::Ptr, unordered_set<Vertex::Ptr, Vertex::VertexHash>, Vertex::VertexHash> conflictIndex;
+    DeterReExecute reExecute(rbList, serialOrders, conflictIndex);
+    reExecute.setBlockId(9);
+    reExecute.buildAndReScheduleFlat();
+    string path = testing::TempDir() + "loom_reexecute_trace_" + to_string(getpid()) + ".json";
+    loom::Trace::instance().Start(path);
+    expectDependencyOrder(reExecute, txs);
+    loom::Trace::instance().Flush();
+    // 每行一个事件
+    ifstream in(path);
+    set<int> traced;
+    string args = "\"args\":{\"block\":9,\"tx\":";
+    for (string line; getline(in, line);) {
+        if (line.find("\"name\":\"reExecute\"") == string::npos) continue;
+        auto pos = line.find(args);
+        EXPECT_NE(pos, string::npos) << line;
+        if (pos != string::npos) traced.insert(stoi(line.substr(pos + args.size())));
+    }
+    // 后续测试不再记录
+    loom::Trace::instance().Stop();
+    remove(path.c_str());
+    set<int> expected;
+    for (auto& tx : txs) expected.insert(tx->m_hyperId);
+    ASSERT_EQ(traced, expected);
+}
+
+TEST(DeterReExecuteTest, TestBottomLevel) {
+    // T0 写 k1, T1 读 k1, T2 写 k2, T3 写 k1: T3 同时依赖 T0(写写)与 T1(读写)
+    vector<Vertex::Ptr> rbList;
+    vector<int> costs = {2, 3, 1, 4};
+    for (int i = 0; i < costs.size(); i++) {
+        auto tx = make_shared<Vertex>(nullptr, i + 1, to_string(i + 1), 0);
+        tx->m_self_cost = costs[i];
+        rbList.push_back(tx);
+    }
+    rbList[0]->writeSet.insert(1);
+    rbList[1]->readSet.insert(1);
+    rbList[2]->writeSet.insert(2);
+    rbList[3]->writeSet.insert(1);
+    vector<vector<int>> serialOrders = {{1, 2, 3, 4}};
+    unordered_map<Vertex::Ptr, unordered_set<Vertex::Ptr, Vertex::VertexHash>, Vertex::VertexHash> conflictIndex;
+
+    DeterReExecute reExecute(rbList, serialOrders, conflictIndex);
+    reExecute.buildAndReScheduleFlat();
+    reExecute.calculateBottomLevels();
+    // 关键路径 T0 -> T1 -> T3
+    EXPECT_EQ(reExecute.getBottomLevels(), vector<int>({9, 7, 1, 4}));
+}
+
+TEST(DeterReExecuteTest, TestParallelTimeSpaceGraph) {
+    // 并行构建与串行构建得到相同的调度时间、等待事务与依赖图
+    Workload workload;
+    MinWRollback minw_normal, minw_nested;
+    vector<Vertex::Ptr> rbList_normal, rbList_nested;
+    vector<int> serialOrder;
+    for (int j = 1; j <= 2000; j++) {
+        serialOrder.push_back(j);
+    }
+    vector<vector<int>> serialOrders = {serialOrder};
+    set<Vertex::Ptr, loom::customCompare> rollbackTxs(loom::customCompare{serialOrder});
+    for (int i = 0; i < 2000; i++) {
+        auto tx = workload.NextTransaction();
+        auto nested_rbs = minw_nested.execute(tx, true)->m_vertices;
+        rollbackTxs.insert(nested_rbs.begin(), nested_rbs.end());
+        rbList_normal.push_back(minw_normal.execute(tx, false)->m_rootVertex);
+    }
+    rbList_nested.assign(rollbackTxs.begin(), rollbackTxs.end());
+    unordered_map<Vertex::Ptr, unordered_set<Vertex::Ptr, Vertex::VertexHash>, Vertex::VertexHash> conflictIndex;
+    auto pool = std::make_shared<ThreadPool>(4);
+
+    for (bool nested : {false, true}) {
+        auto& rbList = nested ? rbList_nested : rbList_normal;
+        auto build = [&](bool parallel) {
+            for (auto& tx : rbList) {
+                tx->scheduledTime = 0;
+                tx->m_should_wait = nullptr;
+            }
+            DeterReExecute reExecute(rbList, serialOrders, conflictIndex);
+            if (parallel) {
+                reExecute.buildAndReScheduleParallel(nested, pool);
+            } else if (nested) {
+                reExecute.buildAndReSchedule();
+            } else {
+                reExecute.buildAndReScheduleFlat();
+            }
+            reExecute.calculateBottomLevels();
+            vector<pair<int, Vertex::Ptr>> schedule;
+            for (auto& tx : rbList) {
+                schedule.emplace_back(tx->scheduledTime, tx->m_should_wait);
+            }
+            return make_tuple(schedule, reExecute.getBottomLevels(), reExecute.calculateTotalNormalExecutionTime());
+        };
+        EXPECT_EQ(build(false), build(true)) << "nested: " << nested;
+    }
+}
+
+TEST(DeterReExecuteTest, TestFlatReExecuteTwice) {
+    // 同一组回滚事务以平坦模式重执行两次, 回滚事务不被修改, 两次结果相同
+    Workload workload;
+    MinWRollback minw;
+    vector<int> serialOrder;
+    for (int j = 1; j <= 200; j++) {
+        serialOrder.push_back(j);
+    }
+    vector<vector<int>> serialOrders = {serialOrder};
+    set<Vertex::Ptr, loom::customCompare> rollbackTxs(loom::customCompare{serialOrder});
+    for (int i = 0; i < 200; i++) {
+        auto vertices = minw.execute(workload.NextTransaction(), true)->m_vertices;
+        rollbackTxs.insert(vertices.begin(), vertices.end());
+    }
+    vector<Vertex::Ptr> rbList(rollbackTxs.begin(), rollbackTxs.end());
+    unordered_map<Vertex::Ptr, unordered_set<Vertex::Ptr, Vertex::VertexHash>, Vertex::VertexHash> conflictIndex;
+    auto snapshot = [&rbList]() {
+        vector<tuple<int, int, size_t, size_t>> txs;
+        for (auto& tx : rbList) {
+            txs.emplace_back(tx->m_hyperId, tx->m_self_cost, tx->readSet.size(), tx->writeSet.size());
+        }
+        return txs;
+    };
+    auto before = snapshot();
+
+    auto pool = std::make_shared<ThreadPool>(4);
+    auto run = [&]() {
+        vector<Vertex::Ptr> normalList;
+        DeterReExecute::setNormalList(rbList, normalList);
+        DeterReExecute reExecute(normalList, serialOrders, conflictIndex);
+        reExecute.buildAndReScheduleFlat();
+        Statistics statistics;
+        std::vector<std::future<void>> futures;
+        reExecute.reExcution(pool, futures, statistics);
+        vector<tuple<int, int, size_t, size_t, int>> result;
+        for (auto& tx : normalList) {
+            result.emplace_back(tx->m_hyperId, tx->m_self_cost, tx->readSet.size(), tx->writeSet.size(), tx->scheduledTime);
+        }
+        return make_pair(result, reExecute.calculateTotalNormalExecutionTime());
+    };
+    auto first = run();
+    EXPECT_EQ(snapshot(), before);
+    EXPECT_EQ(run(), first);
+    EXPECT_EQ(snapshot(), before);
+}
+
+namespace loom {
+
+class TimeSpaceGraphTest : public ::testing::Test {
+    protected:
+        static void clear(TimeSpaceGraph& graph) {graph.clear();}
+        static uint32_t& generation(TimeSpaceGraph& graph) {return graph.m_generation;}
+};
+
+}
+
+using loom::TimeSpaceGraph;
+using loom::TimeSpaceGraphTest;
+
+// 插入远超初始容量的键, 多次扩容后每个键仍映射到自己的表项, 读事务链表不受影响
+TEST_F(TimeSpaceGraphTest, TestGrow) {
+    std::mt19937_64 rng(42);
+    set<loom::Key> unique;
+    while (unique.size() < 5000) unique.insert(rng());
+    vector<loom::Key> keys(unique.begin(), unique.end());
+    shuffle(keys.begin(), keys.end(), rng);
+
+    auto& graph = TimeSpaceGraph::local();
+    for (int i = 0; i < (int)keys.size(); i++) {
+        auto& entry = graph[keys[i]];
+        entry.lastPut = i;
+        entry.total_time = i;
+        graph.addReader(entry, i);
+        graph.addReader(entry, i + 1);
+    }
+    ASSERT_EQ(graph.size(), keys.size());
+    ASSERT_EQ(graph.totalTime(), (int)keys.size() - 1);
+    for (int i = 0; i < (int)keys.size(); i++) {
+        auto& entry = graph[keys[i]];
+        ASSERT_EQ(entry.lastPut, i);
+        vector<int> readers;
+        graph.forEachReader(entry, [&readers](int tx) {readers.push_back(tx);});
+        ASSERT_EQ(readers, (vector<int>{i + 1, i}));
+    }
+    ASSERT_EQ(graph.size(), keys.size());
+
+    // 下一个区块复用同一张图, 上一区块的键全部消失
+    auto& next = TimeSpaceGraph::local();
+    ASSERT_EQ(&next, &graph);
+    ASSERT_EQ(next.size(), 0u);
+    for (auto key : keys) {
+        ASSERT_EQ(next[key].lastPut, -1);
+    }
+    ASSERT_EQ(next.size(), keys.size());
+}
+
+// 代数回绕时必须清零散列槽, 否则代数为 1 的旧槽会被当作本区块的键
+TEST_F(TimeSpaceGraphTest, TestGenerationWrap) {
+    TimeSpaceGraph graph;
+    for (loom::Key key = 0; key < 100; key++) {
+        graph[key].lastPut = key;
+    }
+    ASSERT_EQ(generation(graph), 1u);
+
+    generation(graph) = UINT32_MAX - 1;
+    clear(graph);
+    ASSERT_EQ(generation(graph), UINT32_MAX);
+    ASSERT_EQ(graph.size(), 0u);
+    for (loom::Key key = 100; key < 200; key++) {
+        graph[key].lastPut = key;
+    }
+    for (loom::Key key = 100; key < 200; key++) {
+        ASSERT_EQ(graph[key].lastPut, (int)key);
+    }
+    ASSERT_EQ(graph.size(), 100u);
+
+    clear(graph);
+    ASSERT_EQ(generation(graph), 1u);
+    ASSERT_EQ(graph.size(), 0u);
+    for (loom::Key key = 0; key < 200; key++) {
+        ASSERT_EQ(graph[key].lastPut, -1);
+        ASSERT_EQ(graph.size(), key + 1);
+    }
+}
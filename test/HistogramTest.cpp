@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <thread>
+#include <vector>
+#include <loom/utils/Statistic/Histogram.h>
+
+using namespace std;
+using loom::Histogram;
+
+// 桶的上界与下一个桶的起点相接, 每个值落入的桶上界不小于该值且相对误差不超过 1/SUB
+TEST(HistogramTest, TestIndexAndUpperBound) {
+    for (uint64_t value = 0; value < Histogram::SUB; value++) {
+        ASSERT_EQ(Histogram::Index(value), value);
+        ASSERT_EQ(Histogram::UpperBound(value), value);
+    }
+    for (size_t index = 0; index + 1 < Histogram::BUCKETS; index++) {
+        auto upper = Histogram::UpperBound(index);
+        ASSERT_EQ(Histogram::Index(upper), index);
+        ASSERT_EQ(Histogram::Index(upper + 1), index + 1);
+    }
+    std::mt19937_64 rng(42);
+    for (int i = 0; i < 100000; i++) {
+        // 覆盖各个数量级, 不超过 2^MAX_BITS
+        uint64_t value = rng() >> (64 - Histogram::MAX_BITS + rng() % Histogram::MAX_BITS);
+        auto upper = Histogram::UpperBound(Histogram::Index(value));
+        ASSERT_GE(upper, value);
+        ASSERT_LE(upper - value, value / Histogram::SUB);
+    }
+    ASSERT_EQ(Histogram::Index(1ULL << Histogram::MAX_BITS), Histogram::BUCKETS - 1);
+    ASSERT_EQ(Histogram::Index(UINT64_MAX), Histogram::BUCKETS - 1);
+}
+
+// 分位数返回所在桶的上界, 不超过记录到的最大值
+TEST(HistogramTest, TestPercentile) {
+    Histogram::Snapshot empty;
+    ASSERT_EQ(empty.Percentile(0.5), 0u);
+
+    Histogram histogram;
+    for (uint64_t value = 1; value <= 10000; value++) histogram.Record(value);
+    Histogram::Snapshot snapshot;
+    snapshot.Merge(histogram);
+    ASSERT_EQ(snapshot.total, 10000u);
+    ASSERT_EQ(snapshot.max, 10000u);
+    for (double q : {0.01, 0.5, 0.9, 0.99, 0.999}) {
+        uint64_t exact = q * 10000;
+        auto value = snapshot.Percentile(q);
+        ASSERT_GE(value, exact) << q;
+        ASSERT_LE(value - exact, exact / Histogram::SUB) << q;
+    }
+    ASSERT_EQ(snapshot.Percentile(1), 10000u);
+    ASSERT_EQ(snapshot.Percentile(0), 1u);
+
+    // 快照可以合并多个直方图
+    Histogram other;
+    other.Record(1ULL << 50);
+    snapshot.Merge(other);
+    ASSERT_EQ(snapshot.total, 10001u);
+    ASSERT_EQ(snapshot.Percentile(1), 1ULL << 50);
+}
+
+// 多线程并发记录不丢失计数
+TEST(HistogramTest, TestConcurrentRecord) {
+    Histogram histogram;
+    vector<thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&histogram, t] {
+            for (uint64_t value = 0; value < 100000; value++) histogram.Record(value * 4 + t);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    Histogram::Snapshot snapshot;
+    snapshot.Merge(histogram);
+    ASSERT_EQ(snapshot.total, 400000u);
+    ASSERT_EQ(snapshot.max, 399999u);
+    ASSERT_EQ(snapshot.Percentile(1), 399999u);
+}
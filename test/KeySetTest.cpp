@@ -0,0 +1,46 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <set>
+#include <loom/common/KeySet.h>
+
+using namespace std;
+
+// 随机生成有序集合, 对比KeySet求交/包含结果与朴素实现
+TEST(KeySetTest, TestIntersectAndContain) {
+    std::mt19937_64 rng(42);
+    for (int round = 0; round < 10000; round++) {
+        // 小值域制造冲突, 大值域覆盖最高位(无符号比较)
+        uint64_t range = (rng() % 2) ? 100 : (1ULL << 63);
+        uint64_t base = (rng() % 2) ? (1ULL << 63) : 0;
+        size_t na = rng() % 40, nb = (rng() % 3 == 0) ? rng() % 2000 : rng() % 40;
+        std::set<loom::Key> A, B;
+        loom::KeySet a, b;
+        for (size_t i = 0; i < na; i++) { auto k = base + rng() % range; A.insert(k); a.insert(k); }
+        vector<loom::Key> keys;
+        for (size_t i = 0; i < nb; i++) { auto k = base + rng() % range; B.insert(k); keys.push_back(k); }
+        b.insert(keys.begin(), keys.end());
+        if (rng() % 4 == 0) { b.insert(a); B.insert(A.begin(), A.end()); }
+
+        bool intersect = false, contain = true;
+        for (auto k : A) { B.count(k) ? intersect = true : contain = false; }
+        ASSERT_TRUE(std::equal(a.begin(), a.end(), A.begin(), A.end()));
+        ASSERT_TRUE(std::equal(b.begin(), b.end(), B.begin(), B.end()));
+        ASSERT_EQ(loom::intersects(a, b), intersect);
+        ASSERT_EQ(loom::intersects(b, a), intersect);
+        ASSERT_EQ(loom::contains(b, a), contain);
+    }
+}
+
+// 普通区间即使是有序容器的 const_iterator 也要排序, 只有显式标记 sorted_unique 才跳过排序
+TEST(KeySetTest, TestInsertRange) {
+    const vector<loom::Key> unsorted = {5, 1, 3, 1, 9};
+    loom::KeySet a(unsorted.cbegin(), unsorted.cend());
+    ASSERT_EQ(a, loom::KeySet({1, 3, 5, 9}));
+    a.insert(unsorted.cbegin(), unsorted.cend());
+    ASSERT_EQ(a, loom::KeySet({1, 3, 5, 9}));
+
+    const vector<loom::Key> sorted = {2, 3, 10};
+    loom::KeySet b(loom::sorted_unique, sorted.cbegin(), sorted.cend());
+    b.insert(a);
+    ASSERT_EQ(b, loom::KeySet({1, 2, 3, 5, 9, 10}));
+}
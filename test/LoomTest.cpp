@@ -5,6 +5,7 @@
 #include <loom/protocol/loom/MinWRollback.h>
 #include <loom/protocol/loom/DeterReExecute.h>
 #include <loom/protocol/loom/Loom.h>
+#include <loom/protocol/loom/IndexBuilder.h>
 #include <loom/utils/Statistic/Statistics.h>
 
 
@@ -336,25 +337,25 @@ TEST(LoomTest, TestProtocol) {
             preExecFutures.emplace_back(threadPool->commit([this, tx] {
                 // read locally from local storage
                 tx->InstallGetStorageHandler([&](
-                    const std::unordered_set<string>& readSet
+                    const KeySet& readSet
                 ) {
                     string keys;
-                    std::unordered_map<string, string> local_get;
+                    std::unordered_map<Key, string> local_get;
                     for (auto& key : readSet) {
-                        keys += key + " ";
+                        keys += keyToString(key) + " ";
                         string value;
                         local_get[key] = value;
                     }
                 });
                 // write locally to local storage
                 tx->InstallSetStorageHandler([&](
-                    const std::unordered_set<string>& writeSet,
+                    const KeySet& writeSet,
                     const std::string& value
                 ) {
                     string keys;
-                    std::unordered_map<string, string> local_put;
+                    std::unordered_map<Key, string> local_put;
                     for (auto& key : writeSet) {
-                        keys += key + " ";
+                        keys += keyToString(key) + " ";
                         local_put[key] = value;
                     }
                 });
@@ -374,25 +375,25 @@ TEST(LoomTest, TestProtocol) {
                     auto& tx = txs[j];
                     // read locally from local storage
                     tx->InstallGetStorageHandler([&](
-                        const std::unordered_set<string>& readSet
+                        const KeySet& readSet
                     ) {
                         string keys;
-                        std::unordered_map<string, string> local_get;
+                        std::unordered_map<Key, string> local_get;
                         for (auto& key : readSet) {
-                            keys += key + " ";
+                            keys += keyToString(key) + " ";
                             string value;
                             local_get[key] = value;
                         }
                     });
                     // write locally to local storage
                     tx->InstallSetStorageHandler([&](
-                        const std::unordered_set<string>& writeSet,
+                        const KeySet& writeSet,
                         const std::string& value
                     ) {
                         string keys;
-                        std::unordered_map<string, string> local_put;
+                        std::unordered_map<Key, string> local_put;
                         for (auto& key : writeSet) {
-                            keys += key + " ";
+                            keys += keyToString(key) + " ";
                             local_put[key] = value;
                         }
                     });
@@ -503,25 +504,25 @@ TEST(LoomTest, TestPreExecute) {
                 for (auto& tx : batch) {
                     // read locally from local storage
                     tx->InstallGetStorageHandler([&](
-                        const std::unordered_set<string>& readSet
+                        const KeySet& readSet
                     ) {
                         string keys;
-                        std::unordered_map<string, string> local_get;
+                        std::unordered_map<Key, string> local_get;
                         for (auto& key : readSet) {
-                            keys += key + " ";
+                            keys += keyToString(key) + " ";
                             string value;
                             local_get[key] = value;
                         }
                     });
                     // write locally to local storage
                     tx->InstallSetStorageHandler([&](
-                        const std::unordered_set<string>& writeSet,
+                        const KeySet& writeSet,
                         const std::string& value
                     ) {
                         string keys;
-                        std::unordered_map<string, string> local_put;
+                        std::unordered_map<Key, string> local_put;
                         for (auto& key : writeSet) {
-                            keys += key + " ";
+                            keys += keyToString(key) + " ";
                             local_put[key] = value;
                         }
                     });
@@ -585,25 +586,25 @@ TEST(LoomTest, TestOtherPool) {
         //             auto& tx = txs[j];
         //             // read locally from local storage
         //             tx->InstallGetStorageHandler([&](
-        //                 const std::unordered_set<string>& readSet
+        //                 const KeySet& readSet
         //             ) {
         //                 string keys;
-        //                 std::unordered_map<string, string> local_get;
+        //                 std::unordered_map<Key, string> local_get;
         //                 for (auto& key : readSet) {
-        //                     keys += key + " ";
+        //                     keys += keyToString(key) + " ";
         //                     string value;
         //                     local_get[key] = value;
         //                 }
         //             });
         //             // write locally to local storage
         //             tx->InstallSetStorageHandler([&](
-        //                 const std::unordered_set<string>& writeSet,
+        //                 const KeySet& writeSet,
         //                 const std::string& value
         //             ) {
         //                 string keys;
-        //                 std::unordered_map<string, string> local_put;
+        //                 std::unordered_map<Key, string> local_put;
         //                 for (auto& key : writeSet) {
-        //                     keys += key + " ";
+        //                     keys += keyToString(key) + " ";
         //                     local_put[key] = value;
         //                 }
         //             });
@@ -618,25 +619,25 @@ TEST(LoomTest, TestOtherPool) {
             preExecFutures.emplace_back(threadPool->enqueue([this, tx] {
                 // read locally from local storage
                 tx->InstallGetStorageHandler([&](
-                    const std::unordered_set<string>& readSet
+                    const KeySet& readSet
                 ) {
                     string keys;
-                    std::unordered_map<string, string> local_get;
+                    std::unordered_map<Key, string> local_get;
                     for (auto& key : readSet) {
-                        keys += key + " ";
+                        keys += keyToString(key) + " ";
                         string value;
                         local_get[key] = value;
                     }
                 });
                 // write locally to local storage
                 tx->InstallSetStorageHandler([&](
-                    const std::unordered_set<string>& writeSet,
+                    const KeySet& writeSet,
                     const std::string& value
                 ) {
                     string keys;
-                    std::unordered_map<string, string> local_put;
+                    std::unordered_map<Key, string> local_put;
                     for (auto& key : writeSet) {
-                        keys += key + " ";
+                        keys += keyToString(key) + " ";
                         local_put[key] = value;
                     }
                 });
@@ -729,4 +730,148 @@ TEST(LoomTest, TestLoom) {
     // Print the statistics
     LOG(INFO) << statistics.Print();
     cout << statistics.Print() << endl;
-}
\ No newline at end of file
+}
+
+TEST(LoomTest, TestStreamingSource) {
+    // 生产者边生成边执行, 队列中最多缓存2个区块
+    size_t produced = 0;
+    TxGenerator txGenerator(0, loom::BLOCK_SIZE);
+    Workload workload;
+    auto source = make_shared<StreamingBlockSource>([&]() -> Block::Ptr {
+        return produced < 10 ? txGenerator.generateBlock(true, workload, ++produced) : nullptr;
+    }, 2);
+    auto statistics = Statistics();
+    auto protocol = Loom(source, statistics, 4, 9973, true, false);
+    protocol.Start();
+    EXPECT_EQ(produced, 10);
+    EXPECT_EQ(source->next(), nullptr);
+    protocol.Stop();
+    cout << statistics.Print() << endl;
+
+    // 无限区块流在关闭后停止
+    auto endless = make_shared<StreamingBlockSource>([&]() -> Block::Ptr {
+        return txGenerator.generateBlock(true, workload, ++produced);
+    }, 2);
+    EXPECT_NE(endless->next(), nullptr);
+    endless->close();
+    EXPECT_EQ(endless->next(), nullptr);
+}
+
+TEST(LoomTest, TestBlockPipeline) {
+    // 3个阶段, 最多2个区块在流水线中
+    std::mutex mutex;
+    vector<int> committed;
+    std::atomic<int> running{0}, maxRunning{0};
+    auto stage = [&](int& item) {
+        auto now = running.fetch_add(1) + 1;
+        for (auto seen = maxRunning.load(); now > seen && !maxRunning.compare_exchange_weak(seen, now);) {}
+        std::this_thread::sleep_for(std::chrono::microseconds(100 * (item % 3)));
+        running.fetch_sub(1);
+    };
+    BlockPipeline<int> pipeline(2, {stage, stage, [&](int& item) {
+        std::lock_guard<std::mutex> lock(mutex);
+        committed.push_back(item);
+    }});
+    for (int i = 1; i <= 50; i++) {
+        EXPECT_TRUE(pipeline.Push(i));
+        EXPECT_LE(pipeline.InFlight(), 2);
+    }
+    pipeline.Drain();
+    // 按放入顺序全部提交, 排空后不再接收区块
+    ASSERT_EQ(committed.size(), 50);
+    for (int i = 0; i < 50; i++) {EXPECT_EQ(committed[i], i + 1);}
+    EXPECT_LE(maxRunning.load(), 2);
+    EXPECT_EQ(pipeline.InFlight(), 0);
+    EXPECT_FALSE(pipeline.Push(51));
+}
+
+TEST(LoomTest, TestInterBlockPipeline) {
+    // 流水线深度为3, 区块数远多于深度, Start 返回时全部区块已提交
+    size_t produced = 0, txs = 0;
+    TxGenerator txGenerator(0, loom::BLOCK_SIZE);
+    Workload workload;
+    auto source = make_shared<StreamingBlockSource>([&]() -> Block::Ptr {
+        if (produced >= 20) return nullptr;
+        auto block = txGenerator.generateBlock(true, workload, ++produced);
+        txs += block->getTxs().size();
+        return block;
+    }, 2);
+    auto statistics = Statistics();
+    auto protocol = Loom(source, statistics, 4, 9973, true, true, false, 3);
+    protocol.Start();
+    EXPECT_EQ(produced, 20);
+    protocol.Stop();
+    EXPECT_EQ(statistics.CountBlock(), 20);
+    EXPECT_EQ(statistics.CountCommit(), txs);
+    cout << statistics.Print() << endl;
+}
+
+TEST(LoomTest, TestKeyWaiters) {
+    TxGenerator txGenerator(loom::BLOCK_SIZE);
+    auto blocks = txGenerator.generateWorkload(true);
+    auto& txs = blocks[0]->getTxs();
+    ASSERT_GE(txs.size(), 3);
+    // 区块1、2依次预留写同一个键, 区块2、3的事务读该键时在键上等待
+    vector<shared_ptr<LoomTransaction>> batch;
+    for (size_t i = 0; i < 3; i++) {
+        batch.push_back(make_shared<LoomTransaction>(Transaction(*txs[i]), i + 1, i + 1));
+    }
+    LoomTable table(1);
+    Key key = 42;
+    table.ReservePut(batch[0], key);
+    table.ReservePut(batch[1], key);
+    table.ReserveGet(batch[1], key);
+    table.ReserveGet(batch[2], key);
+    EXPECT_TRUE(batch[1]->aborted.load());
+    EXPECT_TRUE(batch[2]->aborted.load());
+    // 区块1释放后只唤醒区块2的事务, 区块3的事务继续等待区块2
+    vector<shared_ptr<LoomTransaction>> ready;
+    table.Put(key, [&](LoomEntry& entry) {
+        EXPECT_EQ(entry.waiting_txs.size(), 2);
+        entry.ReleasePut(ready);
+        EXPECT_EQ(entry.block_id_put, 2);
+    });
+    ASSERT_EQ(ready.size(), 1);
+    EXPECT_EQ(ready[0], batch[1]);
+    ready.clear();
+    table.Put(key, [&](LoomEntry& entry) {
+        entry.ReleasePut(ready);
+        EXPECT_EQ(entry.block_id_put, 0);
+        EXPECT_TRUE(entry.waiting_txs.empty());
+    });
+    ASSERT_EQ(ready.size(), 1);
+    EXPECT_EQ(ready[0], batch[2]);
+}
+
+TEST(LoomTest, TestOnlineIndex) {
+    TxGenerator txGenerator(loom::BLOCK_SIZE * 2);
+    auto blocks = txGenerator.generateWorkload(true);
+    auto pool = make_shared<ThreadPool>(4);
+
+    for (auto& block : blocks) {
+        // 记录生成器预先构建的索引
+        auto RWIndex = block->getRWIndex();
+        auto conflictIndex = block->getConflictIndex();
+        auto RBIndex = block->getRBIndex();
+        auto invertedIndex = block->getInvertedIndex();
+        // 模拟预执行: 记录每个事务观察到的读写集
+        vector<shared_ptr<LoomTransaction>> batch;
+        for (auto& tx : block->getTxs()) {
+            auto loomTx = make_shared<LoomTransaction>(Transaction(*tx), tx->GetTx()->m_hyperId, block->getBlockId());
+            for (auto& key : tx->GetTx()->m_rootVertex->allReadSet) {loomTx->local_get[key] = "";}
+            for (auto& key : tx->GetTx()->m_rootVertex->allWriteSet) {loomTx->local_put[key] = "";}
+            batch.push_back(loomTx);
+        }
+        // 在线构建的索引应与预先构建的一致
+        IndexBuilder(pool).build(batch, block);
+        EXPECT_EQ(block->getRWIndex(), RWIndex);
+        EXPECT_EQ(block->getConflictIndex(), conflictIndex);
+        EXPECT_EQ(block->getRBIndex(), RBIndex);
+        auto onlineIndex = block->getInvertedIndex();
+        ASSERT_EQ(onlineIndex.size(), invertedIndex.size());
+        for (auto& [key, sets] : invertedIndex) {
+            EXPECT_EQ(onlineIndex.at(key).readSet, sets.readSet);
+            EXPECT_EQ(onlineIndex.at(key).writeSet, sets.writeSet);
+        }
+    }
+}
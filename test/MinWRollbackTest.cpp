@@ -10,12 +10,12 @@ using namespace std;
 using namespace Util;
 
 void simulateRow(TPCCTransaction::Ptr tx, string txid) {
-    tx->addReadRow(txid + "4");
-    tx->addReadRow(txid + "5");
-    tx->addReadRow(txid + "6");
-    tx->addUpdateRow(txid + "4");
-    tx->addUpdateRow(txid + "5");
-    tx->addUpdateRow(txid + "6");
+    tx->addReadRow(std::stoull(txid + "4"));
+    tx->addReadRow(std::stoull(txid + "5"));
+    tx->addReadRow(std::stoull(txid + "6"));
+    tx->addUpdateRow(std::stoull(txid + "4"));
+    tx->addUpdateRow(std::stoull(txid + "5"));
+    tx->addUpdateRow(std::stoull(txid + "6"));
 }
 
 // 自定义tx1
@@ -43,13 +43,13 @@ TPCCTransaction::Ptr makeTx1() {
     // 需要修改读写集
     TPCCTransaction::Ptr tx122;
     simulateRow(tx122, "122");
-    tx122->addReadRow("4");
+    tx122->addReadRow(4);
     tx12->addChild(tx122, loom::DependencyType::WEAK);
     
     // 需要修改读写集
     TPCCTransaction::Ptr tx1221;
     simulateRow(tx1221, "1221");
-    tx1221->addReadRow("5");
+    tx1221->addReadRow(5);
     tx122->addChild(tx1221, loom::DependencyType::STRONG);
 
     TPCCTransaction::Ptr tx12211;
@@ -59,19 +59,19 @@ TPCCTransaction::Ptr makeTx1() {
     // 需要修改读写集
     TPCCTransaction::Ptr tx12212;
     simulateRow(tx12212, "12212");
-    tx12212->addUpdateRow("6");
+    tx12212->addUpdateRow(6);
     tx1221->addChild(tx12212, loom::DependencyType::STRONG);
 
     // 需要修改读写集
     TPCCTransaction::Ptr tx122121;
     simulateRow(tx122121, "122121");
-    tx122121->addUpdateRow("7");
+    tx122121->addUpdateRow(7);
     tx12212->addChild(tx122121, loom::DependencyType::WEAK);
     
     // 需要修改读写集
     TPCCTransaction::Ptr tx1221211;
     simulateRow(tx1221211, "1221211");
-    tx1221211->addReadRow("8");
+    tx1221211->addReadRow(8);
     tx122121->addChild(tx1221211, loom::DependencyType::STRONG);
 
     return tx1;
@@ -84,18 +84,18 @@ TPCCTransaction::Ptr makeTx2() {
 
     TPCCTransaction::Ptr tx21;
     simulateRow(tx21, "21");
-    tx21->addUpdateRow("4");
+    tx21->addUpdateRow(4);
     tx2->addChild(tx21, loom::DependencyType::STRONG);
     TPCCTransaction::Ptr tx211;
     simulateRow(tx211, "211");
-    tx211->addUpdateRow("5");
+    tx211->addUpdateRow(5);
     tx21->addChild(tx211, loom::DependencyType::WEAK);
     TPCCTransaction::Ptr tx212;
     simulateRow(tx212, "212");
     tx21->addChild(tx212, loom::DependencyType::STRONG);
     TPCCTransaction::Ptr tx2121;
     simulateRow(tx2121, "2121");
-    tx2121->addReadRow("6");
+    tx2121->addReadRow(6);
     tx212->addChild(tx2121, loom::DependencyType::WEAK);
 
     
@@ -103,12 +103,12 @@ TPCCTransaction::Ptr makeTx2() {
 
     TPCCTransaction::Ptr tx22;
     simulateRow(tx22, "22");
-    tx22->addReadRow("9");
+    tx22->addReadRow(9);
     tx2->addChild(tx22, loom::DependencyType::WEAK);
     
     TPCCTransaction::Ptr tx221;
     simulateRow(tx221, "221");
-    tx221->addReadRow("44");
+    tx221->addReadRow(44);
     tx22->addChild(tx221, loom::DependencyType::STRONG);
     
     TPCCTransaction::Ptr tx2211;
@@ -123,7 +123,7 @@ TPCCTransaction::Ptr makeTx2() {
 
     TPCCTransaction::Ptr tx222;
     simulateRow(tx222, "222");
-    tx222->addReadRow("10");
+    tx222->addReadRow(10);
     tx22->addChild(tx222, loom::DependencyType::WEAK);
 
     return tx2;
@@ -136,16 +136,16 @@ TPCCTransaction::Ptr makeTx3() {
 
     TPCCTransaction::Ptr tx31;
     simulateRow(tx31, "31");
-    tx31->addUpdateRow("9");
+    tx31->addUpdateRow(9);
     tx3->addChild(tx31, loom::DependencyType::STRONG);
     TPCCTransaction::Ptr tx311;
     simulateRow(tx311, "311");
-    tx311->addUpdateRow("10");
+    tx311->addUpdateRow(10);
     tx31->addChild(tx311, loom::DependencyType::STRONG);
     
     TPCCTransaction::Ptr tx312;
     simulateRow(tx312, "312");
-    tx312->addReadRow("45");
+    tx312->addReadRow(45);
     tx31->addChild(tx312, loom::DependencyType::WEAK);
 
 
@@ -161,18 +161,18 @@ TPCCTransaction::Ptr makeTx3() {
     tx321->addChild(tx3211, loom::DependencyType::WEAK);
     TPCCTransaction::Ptr tx32111;
     simulateRow(tx32111, "32111");
-    tx32111->addReadRow("7");
+    tx32111->addReadRow(7);
     tx3211->addChild(tx32111, loom::DependencyType::STRONG);
     TPCCTransaction::Ptr tx32112;
     simulateRow(tx32112, "32112");
-    tx32112->addUpdateRow("8");
-    tx32112->addReadRow("55");
+    tx32112->addUpdateRow(8);
+    tx32112->addReadRow(55);
     tx3211->addChild(tx32112, loom::DependencyType::STRONG);
 
 
     TPCCTransaction::Ptr tx322;
     simulateRow(tx322, "322");
-    tx322->addReadRow("54");
+    tx322->addReadRow(54);
     tx32->addChild(tx322, loom::DependencyType::WEAK);
 
     return tx3;
@@ -190,13 +190,13 @@ TEST(MinWRollbackTest, TestExecute) {
     // tx4
     TPCCTransaction::Ptr tx4;
     simulateRow(tx4, "4");
-    tx4->addReadRow("22114");
+    tx4->addReadRow(22114);
 
     // tx5
     TPCCTransaction::Ptr tx5;
     simulateRow(tx5, "5");
-    tx5->addReadRow("3214");
-    tx5->addReadRow("32114");
+    tx5->addReadRow(3214);
+    tx5->addReadRow(32114);
 
     txs.push_back(tx1);
     txs.push_back(tx2);
@@ -1002,4 +1002,27 @@ TEST(MinWRollbackTest, TestSerialOrder) {
     
 
     cout << "nestCounter: " << nestCounter << endl;
-}
\ No newline at end of file
+}
+
+TEST(MinWRollbackTest, TestRollbackOutsideSCC) {
+    // 入边回滚选中的scc外事务(超节点3)不在串行序中, 排在最后而不抛出异常
+    vector<Vertex::Ptr> txs;
+    for (int i = 1; i <= 3; i++) {
+        txs.push_back(make_shared<Vertex>(nullptr, i, to_string(i), 0));
+    }
+    vector<int> serialOrder = {2, 1};
+    loom::ReExecuteInfo info;
+    info.m_serialOrder = serialOrder;
+    info.m_orderedRollbackTxs = set<Vertex::Ptr, loom::customCompare>(loom::customCompare(serialOrder));
+    info.m_orderedRollbackTxs.insert(txs.begin(), txs.end());
+    ASSERT_EQ(info.m_orderedRollbackTxs.size(), 3);
+
+    // 另一scc也回滚了事务1, 合并后每个事务只出现一次
+    vector<Vertex::Ptr> rbList;
+    vector<vector<int>> serialOrders;
+    unordered_set<Vertex::Ptr, Vertex::VertexHash> added = {txs[0]};
+    rbList.push_back(txs[0]);
+    MinWRollback::appendRollback(info, rbList, serialOrders, added);
+    EXPECT_EQ(rbList, vector<Vertex::Ptr>({txs[0], txs[1], txs[2]}));
+    EXPECT_EQ(serialOrders, vector<vector<int>>({{2, 1}}));
+}
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <mutex>
+#include <random>
+#include <vector>
+#include <loom/protocol/loom/SCC.h>
+#include <loom/utils/thread/ThreadPool.h>
+
+using namespace std;
+
+namespace {
+
+typedef vector<vector<int>> Components;
+
+// 朴素实现: 两两可达的节点属于同一强连通分量, 只保留规模大于 1 的分量
+Components naiveSCC(int n, const vector<pair<int, int>>& edges) {
+    vector<vector<int>> adj(n);
+    for (auto& [from, to] : edges) adj[from].push_back(to);
+    vector<vector<char>> reach(n, vector<char>(n, 0));
+    for (int s = 0; s < n; s++) {
+        vector<int> stack{s};
+        while (!stack.empty()) {
+            int v = stack.back();
+            stack.pop_back();
+            for (int w : adj[v]) {
+                if (!reach[s][w]) {
+                    reach[s][w] = 1;
+                    stack.push_back(w);
+                }
+            }
+        }
+    }
+    Components sccs;
+    vector<char> assigned(n, 0);
+    for (int v = 0; v < n; v++) {
+        if (assigned[v]) continue;
+        vector<int> scc;
+        for (int w = v; w < n; w++) {
+            if (w == v ? reach[v][v] : reach[v][w] && reach[w][v]) {
+                scc.push_back(w);
+                assigned[w] = 1;
+            }
+        }
+        if (scc.size() > 1) sccs.push_back(scc);
+    }
+    return sccs;
+}
+
+// 若干个稀疏的随机子图, 子图之间不连边, 使剪枝后有多个弱连通分量可以并行
+vector<pair<int, int>> randomEdges(int n, int groups, std::mt19937& rng) {
+    vector<pair<int, int>> edges;
+    int size = n / groups;
+    for (int g = 0; g < groups; g++) {
+        int base = g * size;
+        for (int i = 0; i < size * 2; i++) {
+            edges.emplace_back(base + rng() % size, base + rng() % size);
+        }
+    }
+    return edges;
+}
+
+Components computeSCC(int n, const vector<pair<int, int>>& edges, ThreadPool::Ptr pool, size_t taskNum, Components* emitted = nullptr) {
+    SCCGraph graph(n);
+    for (auto& [from, to] : edges) graph.addEdge(from, to);
+    mutex mu;
+    SCCGraph::Emit emit = nullptr;
+    if (emitted) {
+        emit = [&mu, emitted](const vector<int>& scc) {
+            lock_guard<mutex> lock(mu);
+            emitted->push_back(scc);
+        };
+    }
+    return graph.compute(pool, taskNum, emit);
+}
+
+}
+
+// 随机图上与朴素实现对比, 串行与并行结果一致, 回调恰好覆盖每个分量一次
+TEST(SCCTest, TestCompareNaive) {
+    std::mt19937 rng(42);
+    auto pool = make_shared<ThreadPool>(4);
+    for (int round = 0; round < 200; round++) {
+        int n = 4 + rng() % 60;
+        auto edges = randomEdges(n, 1 + rng() % 4, rng);
+        auto expected = naiveSCC(n, edges);
+        ASSERT_EQ(computeSCC(n, edges, nullptr, 1), expected);
+        Components emitted;
+        ASSERT_EQ(computeSCC(n, edges, pool, 4, &emitted), expected);
+        sort(emitted.begin(), emitted.end());
+        ASSERT_EQ(emitted, expected);
+    }
+}
+
+// 自环不构成分量, 长环不受递归深度限制
+TEST(SCCTest, TestSelfLoopAndLongCycle) {
+    ASSERT_TRUE(computeSCC(3, {{0, 0}, {1, 1}, {1, 2}}, nullptr, 1).empty());
+
+    int n = 1000000;
+    vector<pair<int, int>> edges;
+    for (int v = 0; v < n; v++) edges.emplace_back(v, (v + 1) % n);
+    // 环外挂一条链, 应被剪枝
+    edges.emplace_back(0, n);
+    edges.emplace_back(n, n + 1);
+    auto sccs = computeSCC(n + 2, edges, nullptr, 1);
+    ASSERT_EQ(sccs.size(), 1u);
+    ASSERT_EQ(sccs[0].size(), (size_t)n);
+    ASSERT_EQ(sccs[0].front(), 0);
+    ASSERT_EQ(sccs[0].back(), n - 1);
+}
+
+// 在线程池的工作线程中并行计算, 等待时帮助执行任务, 单线程的池也不会死锁
+TEST(SCCTest, TestComputeInsidePool) {
+    std::mt19937 rng(7);
+    int n = 400;
+    auto edges = randomEdges(n, 8, rng);
+    auto expected = naiveSCC(n, edges);
+    auto pool = make_shared<ThreadPool>(1);
+    Components sccs;
+    auto group = make_shared<TaskGroup>();
+    group->add();
+    pool->execute([&, group] {
+        sccs = computeSCC(n, edges, pool, 4);
+        group->done();
+    });
+    group->wait();
+    ASSERT_EQ(sccs, expected);
+}
@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <loom/utils/Ulock.h>
+#include <loom/protocol/common.h>
+
+using namespace std;
+
+namespace {
+
+// 所有键散列到同一个槽, 用于构造探测窗口溢出
+struct SameSlotHasher {
+    size_t operator()(const loom::Key&) const {return 0;}
+};
+
+// 初始容量下所有键落在同一个探测窗口, 扩容后分散到不同窗口
+struct GrowingHasher {
+    size_t operator()(const loom::Key& key) const {return key << 16;}
+};
+
+// 两个字段总由同一次写入赋为相同的值, 读到不相等即为撕裂读
+struct Pair {
+    uint64_t first = 0;
+    uint64_t second = 0;
+};
+
+template <typename V, typename Hasher = loom::KeyHasher>
+using FlatTable = loom::Table<loom::Key, V, Hasher, loom::TableKind::FLAT>;
+
+}
+
+// 写入的键都能读回, 未写入的键不回调
+TEST(TableTest, TestFlatPutGet) {
+    FlatTable<uint64_t> table(4);
+    std::mt19937_64 rng(42);
+    vector<loom::Key> keys(10000);
+    for (auto& key : keys) key = rng() >> 1;
+    for (size_t i = 0; i < keys.size(); i++) {
+        table.Put(keys[i], [i](uint64_t& value) {value = i;});
+    }
+    for (size_t i = 0; i < keys.size(); i++) {
+        uint64_t value = -1;
+        table.Get(keys[i], [&value](const uint64_t& v) {value = v;});
+        // 随机键可能重复, 以最后一次写入为准
+        ASSERT_LT(value, keys.size());
+        ASSERT_EQ(keys[value], keys[i]);
+    }
+    bool called = false;
+    table.Get(1, [&called](const uint64_t&) {called = true;});
+    ASSERT_FALSE(called);
+}
+
+// 非平凡拷贝的值在槽锁下读写
+TEST(TableTest, TestFlatLockedValue) {
+    FlatTable<string> table(4);
+    for (loom::Key key = 0; key < 1000; key++) {
+        table.Put(key, [key](string& value) {value = to_string(key);});
+        table.Put(key, [](string& value) {value += "!";});
+    }
+    for (loom::Key key = 0; key < 1000; key++) {
+        string value;
+        table.Get(key, [&value](const string& v) {value = v;});
+        ASSERT_EQ(value, to_string(key) + "!");
+    }
+}
+
+// 探测窗口占满后的键放入溢出表, 扩容后所有键仍可读回
+TEST(TableTest, TestFlatOverflowAndReserve) {
+    FlatTable<uint64_t, SameSlotHasher> table(4);
+    for (loom::Key key = 0; key < 1000; key++) {
+        table.Put(key, [key](uint64_t& value) {value = key * 2;});
+    }
+    auto check = [&table] {
+        for (loom::Key key = 0; key < 1000; key++) {
+            uint64_t value = -1;
+            table.Get(key, [&value](const uint64_t& v) {value = v;});
+            ASSERT_EQ(value, key * 2);
+        }
+    };
+    check();
+    table.Reserve(1 << 20);
+    check();
+}
+
+// 扩容把溢出表中的键迁回槽数组, 之后写入这些键仍修改原来的值
+TEST(TableTest, TestFlatReserveMigratesOverflow) {
+    FlatTable<uint64_t, GrowingHasher> table(4);
+    for (loom::Key key = 0; key < 1000; key++) {
+        table.Put(key, [key](uint64_t& value) {value = key * 2;});
+    }
+    table.Reserve(1 << 20);
+    for (loom::Key key = 0; key < 1000; key++) {
+        table.Put(key, [](uint64_t& value) {value++;});
+    }
+    for (loom::Key key = 0; key < 1000; key++) {
+        uint64_t value = -1;
+        table.Get(key, [&value](const uint64_t& v) {value = v;});
+        ASSERT_EQ(value, key * 2 + 1) << key;
+    }
+}
+
+// 并发写入时的乐观读: 读到的值不会撕裂, 且同一读线程看到的值单调不减
+TEST(TableTest, TestFlatSeqlockRead) {
+    static constexpr int KEYS = 4;
+    static constexpr int WRITES = 50000;
+    FlatTable<Pair> table(4);
+    for (loom::Key key = 0; key < KEYS; key++) {
+        table.Put(key, [](Pair& value) {value = Pair{};});
+    }
+    std::atomic<bool> stop{false};
+    std::atomic<size_t> reads{0};
+    vector<thread> readers;
+    for (int r = 0; r < 4; r++) {
+        readers.emplace_back([&table, &stop, &reads] {
+            vector<uint64_t> last(KEYS, 0);
+            size_t count = 0;
+            while (!stop.load(std::memory_order_relaxed) || count == 0) {
+                for (loom::Key key = 0; key < KEYS; key++) {
+                    Pair pair;
+                    table.Get(key, [&pair](const Pair& value) {pair = value;});
+                    ASSERT_EQ(pair.first, pair.second);
+                    ASSERT_GE(pair.first, last[key]);
+                    last[key] = pair.first;
+                    count++;
+                }
+            }
+            reads.fetch_add(count);
+        });
+    }
+    vector<thread> writers;
+    for (int w = 0; w < 4; w++) {
+        writers.emplace_back([&table] {
+            for (int i = 0; i < WRITES; i++) {
+                table.Put(i % KEYS, [](Pair& value) {
+                    auto next = value.first + 1;
+                    value.first = next;
+                    value.second = next;
+                });
+            }
+        });
+    }
+    for (auto& writer : writers) writer.join();
+    stop.store(true);
+    for (auto& reader : readers) reader.join();
+    ASSERT_GT(reads.load(), 0u);
+    // 每次写入在槽锁内自增, 不丢失更新
+    uint64_t total = 0;
+    for (loom::Key key = 0; key < KEYS; key++) {
+        table.Get(key, [&total](const Pair& value) {total += value.first;});
+    }
+    ASSERT_EQ(total, 4u * WRITES);
+}
@@ -0,0 +1,206 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <loom/utils/thread/ThreadPool.h>
+
+using namespace std;
+
+// 外部线程并发提交, 每个任务恰好执行一次并通过 future 返回结果
+TEST(ThreadPoolTest, TestEnqueue) {
+    auto pool = make_shared<ThreadPool>(4);
+    vector<thread> producers;
+    vector<vector<future<int>>> futures(4);
+    for (int p = 0; p < 4; p++) {
+        producers.emplace_back([&pool, &futures, p] {
+            for (int i = 0; i < 2500; i++) {
+                futures[p].push_back(pool->enqueue([p, i] {return p * 2500 + i;}));
+            }
+        });
+    }
+    for (auto& producer : producers) producer.join();
+    vector<char> seen(10000, 0);
+    for (auto& list : futures) {
+        for (auto& future : list) {
+            auto value = future.get();
+            ASSERT_FALSE(seen[value]);
+            seen[value] = 1;
+        }
+    }
+}
+
+// 工作线程中提交的任务进入本地队列, 由本线程或窃取的线程执行; 低优先级任务同样会被执行
+TEST(ThreadPoolTest, TestNestedSubmit) {
+    auto pool = make_shared<ThreadPool>(4);
+    auto group = make_shared<TaskGroup>();
+    atomic<int> count{0};
+    group->add(1 + 1000);
+    pool->execute([pool, group, &count] {
+        for (int i = 0; i < 1000; i++) {
+            auto priority = i % 2 ? TaskPriority::HIGH_PRIORITY : TaskPriority::LOW_PRIORITY;
+            pool->execute([group, &count] {
+                count.fetch_add(1);
+                group->done();
+            }, priority);
+        }
+        group->done();
+    });
+    group->wait();
+    ASSERT_EQ(count.load(), 1000);
+}
+
+// 工作线程在 wait 中帮助执行队列中的任务, 单线程的池上嵌套等待不会死锁
+TEST(ThreadPoolTest, TestHelpingWait) {
+    auto pool = make_shared<ThreadPool>(1);
+    auto outer = make_shared<TaskGroup>();
+    atomic<int> count{0};
+    outer->add();
+    pool->execute([pool, outer, &count] {
+        TaskGroup inner;
+        vector<int> items(100);
+        pool->enqueueBulk(inner, items.begin(), items.end(), [&count](int&) {count.fetch_add(1);});
+        pool->wait(inner);
+        outer->done();
+    });
+    outer->wait();
+    ASSERT_EQ(count.load(), 100);
+}
+
+// 批量提交的每个元素恰好执行一次; 任务抛出的第一个异常在 wait 中重新抛出, 其余任务仍会完成
+TEST(ThreadPoolTest, TestTaskGroupBulk) {
+    auto pool = make_shared<ThreadPool>(4);
+    vector<atomic<int>> visits(10000);
+    TaskGroup group;
+    pool->enqueueBulk(group, visits.begin(), visits.end(), [](atomic<int>& visit) {visit.fetch_add(1);});
+    pool->wait(group);
+    for (auto& visit : visits) ASSERT_EQ(visit.load(), 1);
+
+    vector<int> items(1000);
+    iota(items.begin(), items.end(), 0);
+    atomic<int> count{0};
+    TaskGroup failing;
+    pool->enqueueBulk(failing, items.begin(), items.end(), [&count](int& item) {
+        count.fetch_add(1);
+        if (item % 100 == 0) throw runtime_error("task " + to_string(item));
+    });
+    ASSERT_THROW(pool->wait(failing), runtime_error);
+    ASSERT_TRUE(failing.finished());
+    ASSERT_EQ(count.load(), 1000);
+}
+
+// 等待者在计数归零后立即销毁栈上的 TaskGroup, 仍在 done 中收尾的任务不会访问已释放的状态
+TEST(ThreadPoolTest, TestTaskGroupLifetime) {
+    auto pool = make_shared<ThreadPool>(4);
+    for (int round = 0; round < 2000; round++) {
+        TaskGroup group;
+        group.add(4);
+        for (int i = 0; i < 4; i++) {
+            pool->execute([&group] {group.done();});
+        }
+        group.wait();
+    }
+}
+
+// 小任务放在内联缓冲区, 大任务退化为堆分配; 移动后只执行与析构一次
+TEST(ThreadPoolTest, TestSmallTask) {
+    auto token = make_shared<int>(0);
+    {
+        SmallTask small([token] {(*token)++;});
+        array<char, SmallTask::INLINE_SIZE * 2> payload{};
+        SmallTask large([token, payload] {(*token) += 1 + payload[0];});
+        ASSERT_EQ(token.use_count(), 3);
+        SmallTask moved(std::move(small));
+        ASSERT_FALSE(small);
+        moved();
+        large();
+        SmallTask assigned;
+        assigned = std::move(large);
+        ASSERT_FALSE(large);
+        assigned();
+        ASSERT_EQ(*token, 3);
+        ASSERT_EQ(token.use_count(), 3);
+        assigned = nullptr;
+        ASSERT_EQ(token.use_count(), 2);
+    }
+    ASSERT_EQ(token.use_count(), 1);
+
+    // 只可移动的捕获, 如 packaged_task
+    auto value = make_unique<int>(42);
+    packaged_task<int()> task([value = std::move(value)] {return *value;});
+    auto future = task.get_future();
+    SmallTask job([task = std::move(task)]() mutable {task();});
+    SmallTask other(std::move(job));
+    other();
+    ASSERT_EQ(future.get(), 42);
+}
+
+// 任意区间与块大小下每个下标恰好访问一次, 每次回调恰好对应一块
+TEST(ThreadPoolTest, TestParallelFor) {
+    auto pool = make_shared<ThreadPool>(4);
+    for (size_t grain : {0, 1, 7, 1000, 20000}) {
+        size_t begin = 13, end = 10013;
+        vector<atomic<int>> visits(end);
+        pool->parallelFor(begin, end, grain, [&visits, begin, end, grain](size_t lo, size_t hi) {
+            ASSERT_LT(lo, hi);
+            if (grain > 0) {
+                ASSERT_EQ((lo - begin) % grain, 0u);
+                ASSERT_EQ(hi, min(lo + grain, end));
+            }
+            for (auto i = lo; i < hi; i++) visits[i].fetch_add(1);
+        });
+        for (size_t i = 0; i < end; i++) {
+            ASSERT_EQ(visits[i].load(), i < begin ? 0 : 1) << "grain " << grain << " index " << i;
+        }
+    }
+    bool called = false;
+    pool->parallelFor(5, 5, 1, [&called](size_t, size_t) {called = true;});
+    ASSERT_FALSE(called);
+}
+
+// 回调中嵌套 parallelFor, 工作线程边等待边执行
+TEST(ThreadPoolTest, TestNestedParallelFor) {
+    auto pool = make_shared<ThreadPool>(2);
+    vector<atomic<int>> visits(64 * 64);
+    pool->parallelFor(0, 64, 1, [&pool, &visits](size_t lo, size_t) {
+        pool->parallelFor(0, 64, 4, [&visits, lo](size_t l, size_t h) {
+            for (auto i = l; i < h; i++) visits[lo * 64 + i].fetch_add(1);
+        });
+    });
+    for (auto& visit : visits) ASSERT_EQ(visit.load(), 1);
+}
+
+// 归约按块顺序合并, 不满足交换律的合并结果也与串行一致, 且与线程数无关
+TEST(ThreadPoolTest, TestParallelReduce) {
+    size_t n = 100000;
+    auto sum = [](size_t lo, size_t hi) {
+        uint64_t s = 0;
+        for (auto i = lo; i < hi; i++) s += i;
+        return s;
+    };
+    auto concat = [](size_t lo, size_t hi) {
+        vector<size_t> part(hi - lo);
+        iota(part.begin(), part.end(), lo);
+        return part;
+    };
+    auto append = [](vector<size_t> a, vector<size_t> b) {
+        a.insert(a.end(), b.begin(), b.end());
+        return a;
+    };
+    vector<size_t> expected(n);
+    iota(expected.begin(), expected.end(), 0);
+    for (size_t threads : {1, 4}) {
+        auto pool = make_shared<ThreadPool>(threads);
+        auto total = pool->parallelReduce(0, n, 0, uint64_t(0), sum, std::plus<uint64_t>());
+        ASSERT_EQ(total, uint64_t(n) * (n - 1) / 2);
+        ASSERT_EQ(pool->parallelReduce(0, n, 333, vector<size_t>{}, concat, append), expected);
+        ASSERT_EQ(pool->parallelReduce(7, 7, 1, uint64_t(5), sum, std::plus<uint64_t>()), 5u);
+    }
+}
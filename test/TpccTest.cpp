@@ -2,6 +2,9 @@
 #include <chrono>
 #include "workload/tpcc/Workload.hpp"
 #include "protocol/loom/MinWRollback.h"
+#include "utils/Generator/UTxGenerator.h"
+#include "utils/Generator/UWorkloadFile.h"
+#include <fstream>
 
 using namespace std;
 
@@ -185,4 +188,109 @@ TEST(TpccTest, MultiWarehouseTEST) {
             continue;
         }
     }
-}
\ No newline at end of file
+}
+
+/* 测试二进制负载文件
+    1. 读回的区块与生成的区块结构一致
+    2. 重复写出得到逐字节相同的文件
+*/
+TEST(TpccTest, WorkloadFileTEST) {
+    auto readAll = [](const string& path) {
+        ifstream in(path, ios::binary);
+        return string(istreambuf_iterator<char>(in), {});
+    };
+    TxGenerator txGenerator(100 * 2, 100);
+    auto blocks = txGenerator.generateWorkload(true);
+    string path = "/tmp/loom_workload_test.wl";
+    WorkloadWriter::write(path, blocks, TPCC::N_WAREHOUSES, 100, true);
+
+    WorkloadFile file(path);
+    ASSERT_EQ(file.getBlockCount(), blocks.size());
+    EXPECT_EQ(file.getBlockSize(), 100);
+    EXPECT_TRUE(file.isNested());
+    auto loaded = file.getBlocks(std::make_shared<ThreadPool>(2));
+    for (size_t i = 0; i < blocks.size(); i++) {
+        EXPECT_EQ(loaded[i]->getBlockId(), blocks[i]->getBlockId());
+        EXPECT_EQ(loaded[i]->getTotalCost(), blocks[i]->getTotalCost());
+        EXPECT_EQ(loaded[i]->getVertices().size(), blocks[i]->getVertices().size());
+        EXPECT_EQ(loaded[i]->getRWEdges().size(), blocks[i]->getRWEdges().size());
+        EXPECT_EQ(loaded[i]->getInvertedIndex().size(), blocks[i]->getInvertedIndex().size());
+        EXPECT_EQ(loaded[i]->getRBIndex().size(), blocks[i]->getRBIndex().size());
+    }
+
+    string copy = path + ".copy";
+    WorkloadWriter::write(copy, loaded, TPCC::N_WAREHOUSES, 100, true);
+    EXPECT_EQ(readAll(path), readAll(copy));
+    remove(path.c_str());
+    remove(copy.c_str());
+}
+
+/* 测试按需读取负载文件
+    1. 来源按顺序物化区块, 耗尽或关闭后返回 nullptr
+    2. 文件头标记为非嵌套时拒绝嵌套事务
+*/
+TEST(TpccTest, WorkloadFileSourceTEST) {
+    TxGenerator txGenerator(100 * 3, 100);
+    auto blocks = txGenerator.generateWorkload(true);
+    string path = "/tmp/loom_workload_source_test.wl";
+    WorkloadWriter::write(path, blocks, TPCC::N_WAREHOUSES, 100, true);
+
+    auto file = std::make_shared<WorkloadFile>(path);
+    WorkloadFileSource source(file);
+    size_t keys = 0;
+    for (size_t i = 0; i < blocks.size(); i++) keys += file->getKeyCount(i);
+    EXPECT_EQ(source.keyHint(), keys);
+    EXPECT_GT(keys, 0);
+    for (size_t i = 0; i < blocks.size(); i++) {
+        auto block = source.next();
+        ASSERT_NE(block, nullptr);
+        EXPECT_EQ(block->getBlockId(), blocks[i]->getBlockId());
+        EXPECT_EQ(block->getVertices().size(), blocks[i]->getVertices().size());
+    }
+    EXPECT_EQ(source.next(), nullptr);
+    WorkloadFileSource closed(file);
+    closed.close();
+    EXPECT_EQ(closed.next(), nullptr);
+
+    // 清除文件头的嵌套标记
+    {
+        fstream out(path, ios::binary | ios::in | ios::out);
+        out.seekp(offsetof(loom::workload_file::FileHeader, flags));
+        uint32_t flags = 0;
+        out.write(reinterpret_cast<const char*>(&flags), sizeof(flags));
+    }
+    WorkloadFile flat(path);
+    EXPECT_FALSE(flat.isNested());
+    bool nested = false;
+    for (auto& block : blocks) {
+        for (auto& tx : block->getTxList()) nested |= tx->m_isNested;
+    }
+    ASSERT_TRUE(nested);
+    EXPECT_THROW(flat.getBlocks(), std::runtime_error);
+    remove(path.c_str());
+}
+
+/* 测试并行生成负载
+    1. 同一种子在串行与多线程下生成逐字节相同的负载
+*/
+TEST(TpccTest, ParallelWorkloadTEST) {
+    auto readAll = [](const string& path) {
+        ifstream in(path, ios::binary);
+        return string(istreambuf_iterator<char>(in), {});
+    };
+    auto warehouses = TPCC::N_WAREHOUSES;
+    TPCC::N_WAREHOUSES = 4;
+    auto generate = [](const ThreadPool::Ptr& pool, const string& path) {
+        Workload workload(42);
+        TxGenerator txGenerator(100 * 3, 100);
+        auto blocks = txGenerator.generateWorkload(true, workload, pool);
+        WorkloadWriter::write(path, blocks, TPCC::N_WAREHOUSES, 100, true);
+    };
+    string serial = "/tmp/loom_workload_serial.wl", parallel = "/tmp/loom_workload_parallel.wl";
+    generate(nullptr, serial);
+    generate(std::make_shared<ThreadPool>(4), parallel);
+    EXPECT_EQ(readAll(serial), readAll(parallel));
+    remove(serial.c_str());
+    remove(parallel.c_str());
+    TPCC::N_WAREHOUSES = warehouses;
+}
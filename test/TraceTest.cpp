@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <fstream>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <loom/utils/Statistic/Trace.h>
+
+using namespace std;
+using loom::Trace;
+using loom::TraceScope;
+
+namespace {
+
+string readFile(const string& path) {
+    ifstream in(path);
+    stringstream buffer;
+    buffer << in.rdbuf();
+    return buffer.str();
+}
+
+size_t countOf(const string& text, const string& pattern) {
+    size_t count = 0;
+    for (auto pos = text.find(pattern); pos != string::npos; pos = text.find(pattern, pos + 1)) count++;
+    return count;
+}
+
+}
+
+// 多个线程记录的区间都写入 trace, 未知的 block/scc/tx 不输出
+TEST(TraceTest, TestFlush) {
+    string path = testing::TempDir() + "loom_trace_" + to_string(getpid()) + ".json";
+    auto& trace = Trace::instance();
+    trace.Start(path);
+    ASSERT_TRUE(trace.Enabled());
+    vector<thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([t] {
+            for (int i = 0; i < 100; i++) {
+                TraceScope scope("execute", 7, -1, t * 100 + i);
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    auto now = chrono::steady_clock::now();
+    trace.Record("finalize", now, now + chrono::microseconds(5), 7, 3);
+    trace.Record("idle", now, now);
+    trace.Flush();
+    ASSERT_FALSE(trace.Enabled());
+
+    auto json = readFile(path);
+    ASSERT_EQ(json.rfind("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", 0), 0u);
+    ASSERT_EQ(json.substr(json.size() - 4), "\n]}\n");
+    ASSERT_EQ(countOf(json, "\"ph\":\"X\""), 402u);
+    ASSERT_EQ(countOf(json, "\"name\":\"execute\""), 400u);
+    ASSERT_EQ(countOf(json, "\"args\":{\"block\":7,\"tx\":"), 400u);
+    ASSERT_EQ(countOf(json, "\"args\":{\"block\":7,\"scc\":3}"), 1u);
+    ASSERT_NE(json.find("\"dur\":5.000,\"args\""), string::npos);
+    ASSERT_NE(json.find("{\"name\":\"idle\",\"ph\":\"X\",\"pid\":1,\"tid\":"), string::npos);
+    ASSERT_EQ(countOf(json, "\"idle\""), 1u);
+    // 每个记录线程一个 tid
+    for (int tid = 1; tid <= 5; tid++) {
+        ASSERT_NE(json.find("\"tid\":" + to_string(tid) + ","), string::npos) << tid;
+    }
+
+    // 停止后的记录与重复 Flush 都不会改写文件
+    trace.Record("late", now, now);
+    trace.Flush();
+    ASSERT_EQ(readFile(path), json);
+
+    // 重新 Start 丢弃上一次的缓冲区
+    trace.Start(path);
+    trace.Record("again", now, now, 8);
+    trace.Flush();
+    json = readFile(path);
+    ASSERT_EQ(countOf(json, "\"ph\":\"X\""), 1u);
+    ASSERT_NE(json.find("\"name\":\"again\""), string::npos);
+
+    // Stop 丢弃已记录的区间, 之后的 Flush 不写文件
+    trace.Start(path);
+    trace.Record("dropped", now, now);
+    trace.Stop();
+    ASSERT_FALSE(trace.Enabled());
+    trace.Flush();
+    ASSERT_EQ(readFile(path), json);
+    remove(path.c_str());
+}
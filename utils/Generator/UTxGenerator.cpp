@@ -2,7 +2,7 @@
 
 
 // 构造函数
-TxGenerator::TxGenerator(int txNum, size_t block_size) : id_counter(0), m_txNum(txNum), m_blockSize(block_size) {}
+TxGenerator::TxGenerator(int txNum, size_t block_size) : m_txNum(txNum), m_blockSize(block_size) {}
 
 // 生成事务
 std::vector<Block::Ptr> TxGenerator::generateWorkload(bool isNest) {
@@ -12,40 +12,78 @@ std::vector<Block::Ptr> TxGenerator::generateWorkload(bool isNest) {
     auto seed = workload.get_seed();
     cout << "block size: " << m_blockSize << endl;
     cout << "seed: " << seed << endl;
-    // generateBlock
-    auto blockNum = m_txNum / m_blockSize;
-    for (int i = 0; i < blockNum; i++) {
-        auto block = generateBlock(isNest, workload, i + 1);
-        m_blocks.push_back(block);
+    auto pool = std::make_shared<ThreadPool>(std::max(1u, std::thread::hardware_concurrency()));
+    return generateWorkload(isNest, workload, pool);
+}
+
+// 并行生成事务: 每轮先并行抽取事务类型与仓库, 再按仓库并行生成事务内容, 最后按区块并行构建
+std::vector<Block::Ptr> TxGenerator::generateWorkload(bool isNest, Workload& workload, const ThreadPool::Ptr& pool) {
+    auto parallelFor = [&pool](size_t begin, size_t end, auto&& fn) {
+        if (pool) {
+            pool->parallelFor(begin, end, 1, fn);
+        } else if (begin < end) {
+            fn(begin, end);
+        }
+    };
+    size_t blockNum = m_txNum / m_blockSize;
+    m_blocks.assign(blockNum, nullptr);
+    for (size_t chunkBegin = 0; chunkBegin < blockNum; chunkBegin += GENERATE_CHUNK) {
+        size_t chunkEnd = std::min(blockNum, chunkBegin + GENERATE_CHUNK);
+        size_t txNum = (chunkEnd - chunkBegin) * m_blockSize;
+        size_t first = workload.Reserve(txNum);
+        // 抽取事务类型与所属仓库
+        std::vector<Workload::Slot> slots(txNum);
+        parallelFor(0, txNum, [&](size_t lo, size_t hi) {
+            for (size_t i = lo; i < hi; i++) {slots[i] = workload.DrawSlot(first + i);}
+        });
+        // 按仓库分组, 组内保持序号顺序
+        std::vector<std::vector<size_t>> byWarehouse(TPCC::N_WAREHOUSES);
+        for (size_t i = 0; i < txNum; i++) {byWarehouse[slots[i].w_id - 1].push_back(i);}
+        // 各仓库依次生成自己的事务
+        std::vector<TPCCTransaction::Ptr> txs(txNum);
+        parallelFor(0, byWarehouse.size(), [&](size_t lo, size_t hi) {
+            for (size_t w = lo; w < hi; w++) {
+                for (auto i : byWarehouse[w]) {txs[i] = workload.MakeTransaction(slots[i]);}
+            }
+        });
+        // 构建区块
+        parallelFor(chunkBegin, chunkEnd, [&](size_t lo, size_t hi) {
+            for (size_t b = lo; b < hi; b++) {
+                auto begin = txs.begin() + (b - chunkBegin) * m_blockSize;
+                m_blocks[b] = buildBlock(isNest, std::vector<TPCCTransaction::Ptr>(std::make_move_iterator(begin), std::make_move_iterator(begin + m_blockSize)), b + 1);
+            }
+        });
     }
     return m_blocks;
 }
 
 // 生成区块
-Block::Ptr TxGenerator::generateBlock(bool isNest, Workload workload, size_t blockId) {
+Block::Ptr TxGenerator::generateBlock(bool isNest, Workload& workload, size_t blockId) {
+    std::vector<TPCCTransaction::Ptr> txs;
+    txs.reserve(m_blockSize);
+    for (int i = 0; i < m_blockSize; i++) {
+        // 生成TPCC事务
+        txs.push_back(workload.NextTransaction());
+    }
+    return buildBlock(isNest, txs, blockId);
+}
+
+// 由已生成的事务构建区块, 区块内事务id依次为 [1, BLOCK_SIZE]
+Block::Ptr TxGenerator::buildBlock(bool isNest, const std::vector<TPCCTransaction::Ptr>& tpccTxs, size_t blockId) {
     size_t totalCost = 0;
     vector<Vertex::Ptr> txLists;
     vector<Transaction::Ptr> txs;
     vector<HyperVertex::Ptr> txInfos;
-    unordered_map<string, loom::RWSets<Vertex::Ptr>> invertedIndex;// 倒排索引
+    unordered_map<Key, loom::RWSets<Vertex::Ptr>> invertedIndex;// 倒排索引
     unordered_map<Vertex::Ptr, unordered_set<Vertex::Ptr, Vertex::VertexHash>, Vertex::VertexHash> RWIndex;// rw冲突索引
     unordered_map<Vertex::Ptr, unordered_set<Vertex::Ptr, Vertex::VertexHash>, Vertex::VertexHash> conflictIndex;// 冲突索引
-    unordered_map<string, set<Vertex::Ptr, Vertex::VertexCompare>> RBIndex;// 回滚索引
+    unordered_map<Key, set<Vertex::Ptr, Vertex::VertexCompare>> RBIndex;// 回滚索引
+    auto arena = make_shared<BlockArena>(m_blockSize * BlockArena::BYTES_PER_TX);// 区块内存池
 
     
 
-    // 生成事务
-    // loom::Random random = workload.get_random();
-    // loom::Random tx_random = workload.get_tx_random();
-    // auto NO_txGenerator = std::make_shared<NewOrderTransaction>(tx_random);
-    // auto P_txGenerator = std::make_shared<PaymentTransaction>(tx_random);
-    // auto D_txGenerator = std::make_shared<DeliveryTransaction>(tx_random);
-    // auto OS_txGenerator = std::make_shared<OrderStatusTransaction>(tx_random);
-    // auto SL_txGenerator = std::make_shared<StockLevelTransaction>(tx_random);
-
-    for (int i = 0; i < m_blockSize; i++) {
-        // 生成TPCC事务
-        auto tx = workload.NextTransaction();
+    for (int i = 0; i < tpccTxs.size(); i++) {
+        auto& tx = tpccTxs[i];
         // cout << "tx " << i + 1 << " type: " << TPCC::transactionTypeToString(tx->getType()) << endl;
         // // 构建事务 -- 控制嵌套事务比例
         // HyperVertex::Ptr txVertex;
@@ -54,7 +92,7 @@ Block::Ptr TxGenerator::generateBlock(bool isNest, Workload workload, size_t blo
         // } else {
         //     txVertex = generateTransaction(tx, true, invertedIndex);
         // }
-        HyperVertex::Ptr txVertex = generateTransaction(tx, isNest, invertedIndex);
+        HyperVertex::Ptr txVertex = generateTransaction(tx, i + 1, isNest, invertedIndex, arena);
 
         // 记录所有子事务
         txLists.insert(txLists.end(), txVertex->m_vertices.begin(), txVertex->m_vertices.end());
@@ -69,15 +107,15 @@ Block::Ptr TxGenerator::generateBlock(bool isNest, Workload workload, size_t blo
     generateIndex(txLists, invertedIndex, RWIndex, conflictIndex, RBIndex);
     
     // 生成并返回区块
-    return make_shared<Block>(blockId, txs, txInfos, invertedIndex, RWIndex, conflictIndex, RBIndex, totalCost);
+    auto block = make_shared<Block>(blockId, std::move(txs), std::move(txInfos), std::move(invertedIndex), std::move(RWIndex), std::move(conflictIndex), std::move(RBIndex), totalCost);
+    block->setArena(arena);
+    return block;
 }
 
 // 生成事务
-HyperVertex::Ptr TxGenerator::generateTransaction(const TPCCTransaction::Ptr& tx, bool isNest, unordered_map<string, loom::RWSets<Vertex::Ptr>>& invertedIndex) {
-    // range of txid: [1, BLOCK_SIZE] => (x - 1) % BLOCK_SIZE + 1
-    int txid = (getId() - 1) % m_blockSize + 1;
-    HyperVertex::Ptr hyperVertex = make_shared<HyperVertex>(txid, isNest);
-    Vertex::Ptr rootVertex = make_shared<Vertex>(hyperVertex, txid, to_string(txid), 0, isNest);
+HyperVertex::Ptr TxGenerator::generateTransaction(const TPCCTransaction::Ptr& tx, int txid, bool isNest, unordered_map<Key, loom::RWSets<Vertex::Ptr>>& invertedIndex, const BlockArena::Ptr& arena) {
+    HyperVertex::Ptr hyperVertex = arenaMakeShared<HyperVertex>(arena, txid, isNest, arena);
+    Vertex::Ptr rootVertex = arenaMakeShared<Vertex>(arena, hyperVertex, txid, to_string(txid), 0, isNest);
     // 根据事务结构构建超节点
     string txid_str = to_string(txid);
     
@@ -105,10 +143,10 @@ HyperVertex::Ptr TxGenerator::generateTransaction(const TPCCTransaction::Ptr& tx
 }
 
 // 生成事务索引
-void TxGenerator::generateIndex(vector<Vertex::Ptr> txLists, unordered_map<string, loom::RWSets<Vertex::Ptr>>& invertedIndex, 
+void TxGenerator::generateIndex(vector<Vertex::Ptr> txLists, unordered_map<Key, loom::RWSets<Vertex::Ptr>>& invertedIndex, 
                                 unordered_map<Vertex::Ptr, unordered_set<Vertex::Ptr, Vertex::VertexHash>, Vertex::VertexHash>& RWIndex, 
                                 unordered_map<Vertex::Ptr, unordered_set<Vertex::Ptr, Vertex::VertexHash>, Vertex::VertexHash>& conflictIndex,
-                                unordered_map<string, set<Vertex::Ptr, Vertex::VertexCompare>>& RBIndex) {
+                                unordered_map<Key, set<Vertex::Ptr, Vertex::VertexCompare>>& RBIndex) {
     // 利用invertedIndex构建RWIndex
     for (auto& kv : invertedIndex) {
         auto& readTxs = kv.second.readSet;
@@ -117,8 +155,8 @@ void TxGenerator::generateIndex(vector<Vertex::Ptr> txLists, unordered_map<strin
         if (writeTxs.empty()) {
             continue;
         }
-        // 针对"Dytd-", "S-", "Cdelivery-"开头的key, 构建RBIndex
-        if (kv.first.substr(0, 5) == "Dytd-" || kv.first.substr(0, 2) == "S-" || kv.first.substr(0, 10) == "Cdelivery-") {
+        // 针对Dytd, S, Cdelivery表的key, 构建RBIndex
+        if (TPCC::isRollbackIndexed(kv.first)) {
             // 找到在readTxs和writeTxs中都存在的事务
             set<Vertex::Ptr, Vertex::VertexCompare> intersectTxs;
             for (auto& rTx : readTxs) {
@@ -160,8 +198,3 @@ void TxGenerator::generateIndex(vector<Vertex::Ptr> txLists, unordered_map<strin
 std::vector<Block::Ptr> TxGenerator::getBlocks() {
     return m_blocks;
 }
-
-// 获取全局事务ID
-int TxGenerator::getId() {
-    return id_counter.fetch_add(1, std::memory_order_relaxed) + 1;
-}
\ No newline at end of file
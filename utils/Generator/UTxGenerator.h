@@ -7,12 +7,14 @@
     3. 生成事务对应索引
     4. 输入：事务数量，区块大小
     5. 输出：区块，区块内事务索引
+    6. 事务生成按仓库并行, 区块构建按区块并行, 同一种子的结果与线程数无关
 ***************************/
 #pragma once
 
 #include <vector>
 #include "common/Block.h"
 #include "workload/tpcc/Workload.hpp"
+#include <loom/utils/thread/ThreadPool.h>
 
 namespace loom {
 
@@ -23,22 +25,25 @@ class TxGenerator {
         ~TxGenerator(){}; // 析构函数
 
         std::vector<Block::Ptr> generateWorkload(bool isNest); // 生成负载
+
+        std::vector<Block::Ptr> generateWorkload(bool isNest, Workload& workload, const ThreadPool::Ptr& pool); // 在线程池上生成负载, pool 为空时串行生成
         
-        Block::Ptr generateBlock(bool isNest, Workload workload, size_t blockId); // 生成区块
+        Block::Ptr generateBlock(bool isNest, Workload& workload, size_t blockId); // 生成区块
+
+        Block::Ptr buildBlock(bool isNest, const std::vector<TPCCTransaction::Ptr>& txs, size_t blockId); // 由已生成的事务构建区块
         
-        HyperVertex::Ptr generateTransaction(const TPCCTransaction::Ptr& tx, bool isNest, unordered_map<string, loom::RWSets<Vertex::Ptr>>& invertedIndex); // 生成事务
+        HyperVertex::Ptr generateTransaction(const TPCCTransaction::Ptr& tx, int txid, bool isNest, unordered_map<Key, loom::RWSets<Vertex::Ptr>>& invertedIndex, const BlockArena::Ptr& arena = nullptr); // 生成事务
         
-        void generateIndex(vector<Vertex::Ptr> txLists, unordered_map<string, loom::RWSets<Vertex::Ptr>>& invertedIndex, unordered_map<Vertex::Ptr, unordered_set<Vertex::Ptr, Vertex::VertexHash>, Vertex::VertexHash>& RWIndex, unordered_map<Vertex::Ptr, unordered_set<Vertex::Ptr, Vertex::VertexHash>, Vertex::VertexHash>& conflictIndex, unordered_map<string, set<Vertex::Ptr, Vertex::VertexCompare>>& RBIndex); // 生成索引
+        void generateIndex(vector<Vertex::Ptr> txLists, unordered_map<Key, loom::RWSets<Vertex::Ptr>>& invertedIndex, unordered_map<Vertex::Ptr, unordered_set<Vertex::Ptr, Vertex::VertexHash>, Vertex::VertexHash>& RWIndex, unordered_map<Vertex::Ptr, unordered_set<Vertex::Ptr, Vertex::VertexHash>, Vertex::VertexHash>& conflictIndex, unordered_map<Key, set<Vertex::Ptr, Vertex::VertexCompare>>& RBIndex); // 生成索引
         
         std::vector<Block::Ptr> getBlocks(); // 获取区块
-        
-        int getId(); // 获取事务ID
 
     private:
+        static constexpr size_t GENERATE_CHUNK = 64;   // 并行生成时每轮的区块数, 限制同时存在的 TPCC 事务数量
+
         int m_txNum;                        // 生成事务数量
         int m_blockSize;                    // 区块大小
         std::vector<Block::Ptr> m_blocks;   // 产生的所有区块
-        std::atomic<int> id_counter;        // 分配事务ID
 };
 
 }
@@ -0,0 +1,424 @@
+#include "UWorkloadFile.h"
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace loom::workload_file;
+
+namespace loom {
+
+namespace {
+
+// 按8字节对齐区块数据段
+size_t alignUp(size_t n) {return (n + 7) & ~size_t(7);}
+
+void fail(const std::string& what) {throw std::runtime_error("workload file: " + what);}
+
+template <typename T>
+void append(std::vector<char>& out, const T* data, size_t n) {
+    auto bytes = reinterpret_cast<const char*>(data);
+    out.insert(out.end(), bytes, bytes + n * sizeof(T));
+}
+
+template <typename T>
+void append(std::vector<char>& out, const std::vector<T>& values) {append(out, values.data(), values.size());}
+
+/// @brief 行号连续的 CSR 段: offsets[行数 + 1] | values[]
+struct CSR {
+    std::vector<uint32_t> offsets{0};
+    std::vector<uint32_t> values;
+
+    template <typename It>
+    void addRow(It first, It last) {
+        values.insert(values.end(), first, last);
+        offsets.push_back(values.size());
+    }
+};
+
+/// @brief 稀疏行的 CSR 段: rows[行数] | offsets[行数 + 1] | values[], 保留内容为空的行
+struct SparseCSR : CSR {
+    std::vector<uint32_t> rows;
+
+    template <typename It>
+    void addRow(uint32_t row, It first, It last) {
+        rows.push_back(row);
+        CSR::addRow(first, last);
+    }
+};
+
+/// @brief 顺序读取区块数据段, 越界即报错
+class Cursor {
+    public:
+        Cursor(const char* begin, const char* end) : m_pos(begin), m_end(end) {}
+
+        template <typename T>
+        std::span<const T> take(size_t n) {
+            if (n > size_t(m_end - m_pos) / sizeof(T)) fail("truncated block section");
+            std::span<const T> result(reinterpret_cast<const T*>(m_pos), n);
+            m_pos += n * sizeof(T);
+            return result;
+        }
+
+    private:
+        const char* m_pos;
+        const char* m_end;
+};
+
+struct CSRView {
+    std::span<const uint32_t> offsets;
+    std::span<const uint32_t> values;
+
+    std::span<const uint32_t> row(size_t i) const {return values.subspan(offsets[i], offsets[i + 1] - offsets[i]);}
+};
+
+struct SparseCSRView : CSRView {
+    std::span<const uint32_t> rows;
+};
+
+// 读取 CSR 段并校验偏移单调、取值不越界, 之后的物化过程无需再检查
+CSRView takeCSR(Cursor& in, size_t rows, size_t count, size_t bound) {
+    CSRView csr{in.take<uint32_t>(rows + 1), in.take<uint32_t>(count)};
+    if (csr.offsets.front() != 0 || csr.offsets.back() != count) fail("corrupted csr offsets");
+    for (size_t i = 0; i < rows; i++) {
+        if (csr.offsets[i] > csr.offsets[i + 1]) fail("corrupted csr offsets");
+    }
+    for (auto value : csr.values) {
+        if (value >= bound) fail("csr value out of range");
+    }
+    return csr;
+}
+
+SparseCSRView takeSparseCSR(Cursor& in, size_t rows, size_t count, size_t rowBound, size_t bound) {
+    auto rowIds = in.take<uint32_t>(rows);
+    for (auto row : rowIds) {
+        if (row >= rowBound) fail("csr row out of range");
+    }
+    SparseCSRView csr;
+    static_cast<CSRView&>(csr) = takeCSR(in, rows, count, bound);
+    csr.rows = rowIds;
+    return csr;
+}
+
+}
+
+// 区块编码: 节点按事务顺序、事务内先序编号, 哈希容器中的内容全部按编号排序后写出, 保证输出与内存地址无关
+std::vector<char> WorkloadWriter::encodeBlock(Block& block) {
+    auto& txList = block.getTxList();
+    std::vector<TxRecord> txRecords;
+    std::vector<VertexRecord> vertexRecords;
+    std::vector<Vertex::Ptr> vertices;
+    std::unordered_map<const Vertex*, uint32_t> vertexIndex;
+    txRecords.reserve(txList.size());
+
+    for (auto& hv : txList) {
+        auto& root = hv->m_rootVertex;
+        if (!root || root->m_id != std::to_string(hv->m_hyperId)) fail("unexpected root vertex id of tx " + std::to_string(hv->m_hyperId));
+        TxRecord txRecord{hv->m_hyperId, uint32_t(vertices.size()), 0, hv->m_isNested};
+        // 先序遍历, 子节点按序号逆序入栈
+        struct Frame {Vertex::Ptr vertex; uint32_t parent; uint32_t ordinal; bool strong;};
+        std::vector<Frame> stack{{root, NONE, 0, false}};
+        while (!stack.empty()) {
+            auto frame = std::move(stack.back());
+            stack.pop_back();
+            auto& vertex = frame.vertex;
+            uint32_t index = vertices.size();
+            vertexIndex[vertex.get()] = index;
+            uint32_t flags = (vertex->isNested ? VERTEX_NESTED : 0) | (frame.strong ? VERTEX_STRONG : 0);
+            vertexRecords.push_back({frame.parent, frame.ordinal, vertex->m_layer, vertex->m_cost, vertex->m_self_cost, flags});
+            vertices.push_back(vertex);
+
+            std::vector<Frame> children;
+            for (auto& child : vertex->getChildren()) {
+                auto& id = child.vertex->m_id;
+                auto pos = id.rfind('_');
+                if (pos == std::string::npos || id.compare(0, pos, vertex->m_id) != 0) fail("unexpected child vertex id " + id);
+                uint32_t ordinal = std::stoul(id.substr(pos + 1));
+                children.push_back({child.vertex, index, ordinal, child.dependency == loom::DependencyType::STRONG});
+            }
+            std::sort(children.begin(), children.end(), [](const Frame& a, const Frame& b) {return a.ordinal > b.ordinal;});
+            for (auto& child : children) {stack.push_back(std::move(child));}
+        }
+        txRecord.vertexCount = vertices.size() - txRecord.firstVertex;
+        if (txRecord.vertexCount != hv->m_vertices.size()) fail("tx " + std::to_string(hv->m_hyperId) + " has unreachable vertices");
+        txRecords.push_back(txRecord);
+    }
+
+    // 键表: 区块内访问过的全部键, 有序去重
+    std::vector<Key> keys;
+    for (auto& vertex : vertices) {
+        keys.insert(keys.end(), vertex->allReadSet.begin(), vertex->allReadSet.end());
+        keys.insert(keys.end(), vertex->allWriteSet.begin(), vertex->allWriteSet.end());
+        keys.insert(keys.end(), vertex->readSet.begin(), vertex->readSet.end());
+        keys.insert(keys.end(), vertex->writeSet.begin(), vertex->writeSet.end());
+    }
+    for (auto& [key, _] : block.getRBIndex()) {keys.push_back(key);}
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    auto keyIndex = [&](Key key) {return uint32_t(std::lower_bound(keys.begin(), keys.end(), key) - keys.begin());};
+
+    std::vector<uint32_t> row;
+    auto keyRow = [&](const KeySet& set) -> std::vector<uint32_t>& {
+        row.clear();
+        for (auto key : set) {row.push_back(keyIndex(key));}
+        return row;
+    };
+    auto indexOf = [&](const Vertex::Ptr& vertex) {
+        auto it = vertexIndex.find(vertex.get());
+        if (it == vertexIndex.end()) fail("index refers to a vertex outside the block");
+        return it->second;
+    };
+    auto vertexRow = [&](auto& set) -> std::vector<uint32_t>& {
+        row.clear();
+        for (auto& vertex : set) {row.push_back(indexOf(vertex));}
+        std::sort(row.begin(), row.end());
+        return row;
+    };
+
+    CSR readSets, writeSets, allReadSets, allWriteSets, cascades;
+    for (auto& vertex : vertices) {
+        auto& r = keyRow(vertex->readSet); readSets.addRow(r.begin(), r.end());
+        auto& w = keyRow(vertex->writeSet); writeSets.addRow(w.begin(), w.end());
+        auto& ar = keyRow(vertex->allReadSet); allReadSets.addRow(ar.begin(), ar.end());
+        auto& aw = keyRow(vertex->allWriteSet); allWriteSets.addRow(aw.begin(), aw.end());
+        auto& c = vertexRow(vertex->cascadeVertices); cascades.addRow(c.begin(), c.end());
+    }
+
+    // 索引项按行号排序写出
+    auto encodeIndex = [&](auto& index) {
+        std::vector<std::pair<uint32_t, const unordered_set<Vertex::Ptr, Vertex::VertexHash>*>> entries;
+        for (auto& [vertex, targets] : index) {entries.emplace_back(indexOf(vertex), &targets);}
+        std::sort(entries.begin(), entries.end(), [](auto& a, auto& b) {return a.first < b.first;});
+        SparseCSR csr;
+        for (auto& [source, targets] : entries) {
+            auto& t = vertexRow(*targets);
+            csr.addRow(source, t.begin(), t.end());
+        }
+        return csr;
+    };
+    auto rwIndex = encodeIndex(block.getRWIndex());
+    auto conflictIndex = encodeIndex(block.getConflictIndex());
+
+    std::vector<std::pair<uint32_t, const set<Vertex::Ptr, Vertex::VertexCompare>*>> rbEntries;
+    for (auto& [key, rbVertices] : block.getRBIndex()) {rbEntries.emplace_back(keyIndex(key), &rbVertices);}
+    std::sort(rbEntries.begin(), rbEntries.end(), [](auto& a, auto& b) {return a.first < b.first;});
+    SparseCSR rbIndex;
+    for (auto& [key, rbVertices] : rbEntries) {
+        auto& t = vertexRow(*rbVertices);
+        rbIndex.addRow(key, t.begin(), t.end());
+    }
+
+    BlockHeader header{};
+    header.txCount = txRecords.size();
+    header.vertexCount = vertices.size();
+    header.keyCount = keys.size();
+    header.readCount = readSets.values.size();
+    header.writeCount = writeSets.values.size();
+    header.allReadCount = allReadSets.values.size();
+    header.allWriteCount = allWriteSets.values.size();
+    header.cascadeCount = cascades.values.size();
+    header.rwRows = rwIndex.rows.size();
+    header.rwCount = rwIndex.values.size();
+    header.conflictRows = conflictIndex.rows.size();
+    header.conflictCount = conflictIndex.values.size();
+    header.rbRows = rbIndex.rows.size();
+    header.rbCount = rbIndex.values.size();
+
+    std::vector<char> out;
+    append(out, &header, 1);
+    append(out, keys);
+    append(out, txRecords);
+    append(out, vertexRecords);
+    for (auto* csr : {&readSets, &writeSets, &allReadSets, &allWriteSets, &cascades}) {
+        append(out, csr->offsets);
+        append(out, csr->values);
+    }
+    for (auto* csr : {&rwIndex, &conflictIndex, &rbIndex}) {
+        append(out, csr->rows);
+        append(out, csr->offsets);
+        append(out, csr->values);
+    }
+    out.resize(alignUp(out.size()), 0);
+    return out;
+}
+
+void WorkloadWriter::write(const std::string& path, const std::vector<Block::Ptr>& blocks, size_t warehouseNum, size_t blockSize, bool isNest) {
+    std::vector<std::vector<char>> sections;
+    std::vector<BlockEntry> entries;
+    size_t offset = sizeof(FileHeader) + blocks.size() * sizeof(BlockEntry);
+    for (auto& block : blocks) {
+        sections.push_back(encodeBlock(*block));
+        entries.push_back({offset, sections.back().size(), block->getBlockId(), block->getTotalCost()});
+        offset += sections.back().size();
+    }
+
+    FileHeader header{MAGIC, VERSION, isNest ? FILE_NESTED : 0u, warehouseNum, blockSize, blocks.size(), offset};
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) fail("cannot open " + path + " for writing");
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(BlockEntry));
+    for (auto& section : sections) {
+        out.write(section.data(), section.size());
+    }
+    out.close();
+    if (!out) fail("failed to write " + path);
+}
+
+WorkloadFile::WorkloadFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) fail("cannot open " + path);
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(FileHeader)) {
+        ::close(fd);
+        fail(path + " is too small");
+    }
+    m_size = st.st_size;
+    void* data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) fail("cannot mmap " + path);
+    m_data = static_cast<const char*>(data);
+    m_header = reinterpret_cast<const FileHeader*>(m_data);
+
+    try {
+        if (m_header->magic != MAGIC) fail(path + " is not a loom workload file");
+        if (m_header->version != VERSION) fail("unsupported version " + std::to_string(m_header->version));
+        if (m_header->fileSize != m_size) fail(path + " is truncated");
+        if (m_header->blockCount > (m_size - sizeof(FileHeader)) / sizeof(BlockEntry)) fail("corrupted block directory");
+        m_entries = {reinterpret_cast<const BlockEntry*>(m_data + sizeof(FileHeader)), m_header->blockCount};
+        size_t dataStart = sizeof(FileHeader) + m_entries.size() * sizeof(BlockEntry);
+        for (auto& entry : m_entries) {
+            if (entry.offset < dataStart || entry.offset % 8 != 0 || entry.size > m_size - entry.offset) fail("corrupted block directory");
+        }
+    } catch (...) {
+        ::munmap(const_cast<char*>(m_data), m_size);
+        throw;
+    }
+}
+
+WorkloadFile::~WorkloadFile() {
+    ::munmap(const_cast<char*>(m_data), m_size);
+}
+
+Block::Ptr WorkloadFile::getBlock(size_t i) const {
+    if (i >= m_entries.size()) throw std::out_of_range("workload file: block " + std::to_string(i) + " out of range");
+    auto& entry = m_entries[i];
+    Cursor in(m_data + entry.offset, m_data + entry.offset + entry.size);
+
+    auto& header = in.take<BlockHeader>(1)[0];
+    size_t vertexNum = header.vertexCount;
+    auto keys = in.take<Key>(header.keyCount);
+    auto txRecords = in.take<TxRecord>(header.txCount);
+    auto vertexRecords = in.take<VertexRecord>(vertexNum);
+    auto readSets = takeCSR(in, vertexNum, header.readCount, keys.size());
+    auto writeSets = takeCSR(in, vertexNum, header.writeCount, keys.size());
+    auto allReadSets = takeCSR(in, vertexNum, header.allReadCount, keys.size());
+    auto allWriteSets = takeCSR(in, vertexNum, header.allWriteCount, keys.size());
+    auto cascades = takeCSR(in, vertexNum, header.cascadeCount, vertexNum);
+    auto rwSection = takeSparseCSR(in, header.rwRows, header.rwCount, vertexNum, vertexNum);
+    auto conflictSection = takeSparseCSR(in, header.conflictRows, header.conflictCount, vertexNum, vertexNum);
+    auto rbSection = takeSparseCSR(in, header.rbRows, header.rbCount, keys.size(), vertexNum);
+
+    auto arena = make_shared<BlockArena>(std::max<size_t>(header.txCount, 1) * BlockArena::BYTES_PER_TX);
+    auto toKeySet = [&](std::span<const uint32_t> indexes) {
+        KeySet set;
+        set.reserve(indexes.size());
+        for (auto k : indexes) {set.insert(keys[k]);}
+        return set;
+    };
+
+    // 重建超节点与节点树
+    vector<Vertex::Ptr> vertices(vertexNum);
+    vector<Transaction::Ptr> txs;
+    vector<HyperVertex::Ptr> txInfos;
+    unordered_map<Key, loom::RWSets<Vertex::Ptr>> invertedIndex;
+    txs.reserve(txRecords.size());
+    txInfos.reserve(txRecords.size());
+    for (auto& txRecord : txRecords) {
+        size_t first = txRecord.firstVertex, last = first + txRecord.vertexCount;
+        if (txRecord.vertexCount == 0 || first > vertexNum || txRecord.vertexCount > vertexNum - first) fail("corrupted tx record");
+        if (txRecord.nested && !isNested()) fail("nested tx " + std::to_string(txRecord.hyperId) + " in a flat workload");
+        auto hyperVertex = arenaMakeShared<HyperVertex>(arena, txRecord.hyperId, txRecord.nested != 0, arena);
+        for (size_t v = first; v < last; v++) {
+            auto& record = vertexRecords[v];
+            bool isRoot = v == first;
+            if (isRoot != (record.parent == NONE) || (!isRoot && (record.parent < first || record.parent >= v))) fail("corrupted vertex record");
+            string id = isRoot ? to_string(txRecord.hyperId) : vertices[record.parent]->m_id + "_" + to_string(record.ordinal);
+            auto vertex = arenaMakeShared<Vertex>(arena, hyperVertex, txRecord.hyperId, std::move(id), record.layer, (record.flags & VERTEX_NESTED) != 0);
+            vertex->m_cost = record.cost;
+            vertex->m_self_cost = record.selfCost;
+            vertex->readSet = toKeySet(readSets.row(v));
+            vertex->writeSet = toKeySet(writeSets.row(v));
+            vertex->allReadSet = toKeySet(allReadSets.row(v));
+            vertex->allWriteSet = toKeySet(allWriteSets.row(v));
+            for (auto k : readSets.row(v)) {invertedIndex[keys[k]].readSet.insert(vertex);}
+            for (auto k : writeSets.row(v)) {invertedIndex[keys[k]].writeSet.insert(vertex);}
+            if (!isRoot) {
+                auto& parent = vertices[record.parent];
+                bool strong = record.flags & VERTEX_STRONG;
+                parent->addChild(vertex, strong ? loom::DependencyType::STRONG : loom::DependencyType::WEAK);
+                if (strong) {
+                    parent->hasStrong = true;
+                    parent->m_strongChildren.insert(vertex);
+                    vertex->m_strongParent = parent;
+                }
+            }
+            hyperVertex->m_vertices.insert(vertex);
+            vertices[v] = std::move(vertex);
+        }
+        hyperVertex->m_rootVertex = vertices[first];
+        txs.push_back(make_shared<Transaction>(hyperVertex));
+        txInfos.push_back(std::move(hyperVertex));
+    }
+    for (size_t v = 0; v < vertexNum; v++) {
+        if (!vertices[v]) fail("vertex " + std::to_string(v) + " does not belong to any tx");
+    }
+    for (size_t v = 0; v < vertexNum; v++) {
+        for (auto c : cascades.row(v)) {vertices[v]->cascadeVertices.insert(vertices[c]);}
+    }
+
+    // 还原索引
+    unordered_map<Vertex::Ptr, unordered_set<Vertex::Ptr, Vertex::VertexHash>, Vertex::VertexHash> RWIndex, conflictIndex;
+    unordered_map<Key, set<Vertex::Ptr, Vertex::VertexCompare>> RBIndex;
+    auto decodeIndex = [&](const SparseCSRView& csr, auto& index) {
+        index.reserve(csr.rows.size());
+        for (size_t r = 0; r < csr.rows.size(); r++) {
+            auto& targets = index[vertices[csr.rows[r]]];
+            for (auto t : csr.row(r)) {targets.insert(vertices[t]);}
+        }
+    };
+    decodeIndex(rwSection, RWIndex);
+    decodeIndex(conflictSection, conflictIndex);
+    for (size_t r = 0; r < rbSection.rows.size(); r++) {
+        auto& rbVertices = RBIndex[keys[rbSection.rows[r]]];
+        for (auto t : rbSection.row(r)) {rbVertices.insert(vertices[t]);}
+    }
+
+    auto block = make_shared<Block>(entry.blockId, std::move(txs), std::move(txInfos), std::move(invertedIndex), std::move(RWIndex), std::move(conflictIndex), std::move(RBIndex), entry.totalCost);
+    block->setArena(arena);
+    return block;
+}
+
+size_t WorkloadFile::getKeyCount(size_t i) const {
+    if (i >= m_entries.size()) throw std::out_of_range("workload file: block " + std::to_string(i) + " out of range");
+    auto& entry = m_entries[i];
+    Cursor in(m_data + entry.offset, m_data + entry.offset + entry.size);
+    return in.take<BlockHeader>(1)[0].keyCount;
+}
+
+std::vector<Block::Ptr> WorkloadFile::getBlocks(const ThreadPool::Ptr& pool) const {
+    std::vector<Block::Ptr> blocks(m_entries.size());
+    if (!pool) {
+        for (size_t i = 0; i < blocks.size(); i++) {blocks[i] = getBlock(i);}
+        return blocks;
+    }
+    // 每个区块由单个线程物化, 符合内存池单线程填充的约束
+    pool->parallelFor(0, blocks.size(), 1, [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; i++) {blocks[i] = getBlock(i);}
+    });
+    return blocks;
+}
+
+}
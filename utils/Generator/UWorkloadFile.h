@@ -0,0 +1,157 @@
+/***************************
+@Author: huan
+@File: UWorkloadFile.h
+@Desc:
+    1. 二进制负载文件: 将生成好的区块落盘, 运行时 mmap 读取, 跳过 TPCC 事务生成与索引构建
+    2. 文件布局: 文件头 | 区块目录 | 各区块数据段(8字节对齐)
+    3. 区块数据段: 区块头 | 键表 | 事务表 | 节点表 | 读写集/级联/索引 CSR 段
+    4. 键表为区块内有序去重的整数键, 读写集只记录键表下标; 节点id由事务id与子事务序号还原, 文件中不含字符串
+    5. 区块按需物化, 只有被访问的区块才会构建节点图
+***************************/
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <span>
+#include "common/Block.h"
+#include "common/BlockSource.h"
+#include <loom/utils/thread/ThreadPool.h>
+
+namespace loom {
+
+namespace workload_file {
+
+// 魔数 "LOOMWKLD", 按本机字节序写入, 字节序不同的文件在校验魔数时即被拒绝
+inline constexpr uint64_t MAGIC = 0x444c4b574d4f4f4cULL;
+inline constexpr uint32_t VERSION = 1;
+inline constexpr uint32_t NONE = UINT32_MAX;
+
+// 文件头标记
+inline constexpr uint32_t FILE_NESTED = 1u << 0;
+
+// 节点标记
+inline constexpr uint32_t VERTEX_NESTED = 1u << 0;  // 节点为嵌套节点
+inline constexpr uint32_t VERTEX_STRONG = 1u << 1;  // 与父节点为强依赖
+
+struct FileHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t flags;
+    uint64_t warehouseNum;
+    uint64_t blockSize;
+    uint64_t blockCount;
+    uint64_t fileSize;
+};
+
+// 区块目录项, offset 为区块数据段相对文件起始的偏移
+struct BlockEntry {
+    uint64_t offset;
+    uint64_t size;
+    uint64_t blockId;
+    uint64_t totalCost;
+};
+
+// 区块头, 记录各段元素个数; CSR 段的偏移数组长度为 行数 + 1
+struct BlockHeader {
+    uint32_t txCount;
+    uint32_t vertexCount;
+    uint32_t keyCount;
+    uint32_t readCount;         // 读集键下标总数
+    uint32_t writeCount;        // 写集键下标总数
+    uint32_t allReadCount;      // 全部读集键下标总数
+    uint32_t allWriteCount;     // 全部写集键下标总数
+    uint32_t cascadeCount;      // 级联回滚节点总数
+    uint32_t rwRows;            // rw冲突索引项数(可为空集合)
+    uint32_t rwCount;           // rw冲突索引边数
+    uint32_t conflictRows;      // 冲突索引项数
+    uint32_t conflictCount;     // 冲突索引边数
+    uint32_t rbRows;            // 回滚索引键数
+    uint32_t rbCount;           // 回滚索引节点总数
+};
+
+struct TxRecord {
+    int32_t hyperId;
+    uint32_t firstVertex;       // 事务节点在节点表中连续存放, 按先序排列, 首个为根节点
+    uint32_t vertexCount;
+    uint32_t nested;
+};
+
+struct VertexRecord {
+    uint32_t parent;            // 父节点在区块节点表中的下标, 根节点为 NONE
+    uint32_t ordinal;           // 在父节点中的子事务序号(从1开始), 节点id = 父节点id + "_" + 序号
+    int32_t layer;
+    int32_t cost;
+    int32_t selfCost;
+    uint32_t flags;
+};
+
+static_assert(sizeof(FileHeader) % 8 == 0 && sizeof(BlockEntry) % 8 == 0 && sizeof(BlockHeader) % 8 == 0);
+
+}
+
+/// @brief 将区块写入二进制负载文件, 相同区块总是得到逐字节相同的文件
+class WorkloadWriter {
+    public:
+        static void write(const std::string& path, const std::vector<Block::Ptr>& blocks, size_t warehouseNum, size_t blockSize, bool isNest);
+
+    private:
+        static std::vector<char> encodeBlock(Block& block);
+};
+
+/// @brief 以 mmap 方式打开二进制负载文件, 打开时只校验文件头与目录, 区块在访问时才物化
+class WorkloadFile {
+    public:
+        explicit WorkloadFile(const std::string& path);
+        ~WorkloadFile();
+
+        WorkloadFile(const WorkloadFile&) = delete;
+        WorkloadFile& operator=(const WorkloadFile&) = delete;
+
+        size_t getBlockCount() const {return m_header->blockCount;}
+        size_t getWarehouseNum() const {return m_header->warehouseNum;}
+        size_t getBlockSize() const {return m_header->blockSize;}
+        bool isNested() const {return m_header->flags & workload_file::FILE_NESTED;}
+
+        /// @brief 第 i 个区块的键数量, 只读取区块头, 不物化区块
+        size_t getKeyCount(size_t i) const;
+
+        /// @brief 物化第 i 个区块, 每次调用都会构建一份新的节点图与索引
+        Block::Ptr getBlock(size_t i) const;
+
+        /// @brief 物化全部区块, 区块之间相互独立, 给定线程池时并行构建
+        std::vector<Block::Ptr> getBlocks(const ThreadPool::Ptr& pool = nullptr) const;
+
+    private:
+        const char* m_data;
+        size_t m_size;
+        const workload_file::FileHeader* m_header;
+        std::span<const workload_file::BlockEntry> m_entries;
+};
+
+/// @brief 按需读取负载文件的区块来源, 协议拉取时才在调用线程上物化区块, 内存中只保留正在执行的区块
+class WorkloadFileSource : public BlockSource {
+    public:
+        explicit WorkloadFileSource(std::shared_ptr<WorkloadFile> file) : m_file(std::move(file)) {}
+
+        Block::Ptr next() override {
+            if (m_closed.load(std::memory_order_acquire)) return nullptr;
+            auto i = m_cursor.fetch_add(1, std::memory_order_relaxed);
+            return i < m_file->getBlockCount() ? m_file->getBlock(i) : nullptr;
+        }
+
+        size_t keyHint() override {
+            size_t count = 0;
+            for (size_t i = 0; i < m_file->getBlockCount(); i++) {count += m_file->getKeyCount(i);}
+            return count;
+        }
+
+        void close() override {m_closed.store(true, std::memory_order_release);}
+
+    private:
+        std::shared_ptr<WorkloadFile> m_file;
+        std::atomic<size_t> m_cursor{0};
+        std::atomic<bool> m_closed{false};
+};
+
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+namespace loom {
+
+/// @brief 对数分桶直方图 (HDR 风格): 每个 2 的幂区间再等分为 SUB 个子桶, 相对误差不超过 1/SUB
+///        记录只做一次 relaxed 自增, 可多线程并发调用; 读取时合并为快照再求分位数
+class Histogram {
+    public:
+        static constexpr int SUB_BITS = 5;
+        static constexpr uint64_t SUB = 1ULL << SUB_BITS;
+        static constexpr int MAX_BITS = 40;     // 不小于 2^40 的值计入单独的最后一个桶
+        static constexpr size_t BUCKETS = (MAX_BITS - SUB_BITS + 1) * SUB + 1;
+
+        /// @brief 直方图的合并快照
+        struct Snapshot {
+            std::vector<uint64_t> counts = std::vector<uint64_t>(BUCKETS);
+            uint64_t total = 0;
+            uint64_t max = 0;
+
+            void Merge(const Histogram& histogram) {
+                for (size_t i = 0; i < BUCKETS; i++) {
+                    auto count = histogram.m_buckets[i].load(std::memory_order_relaxed);
+                    counts[i] += count;
+                    total += count;
+                }
+                max = std::max(max, histogram.m_max.load(std::memory_order_relaxed));
+            }
+
+            /// @brief 分位数 q ∈ [0, 1], 返回所在桶的上界且不超过最大值
+            uint64_t Percentile(double q) const {
+                if (total == 0) return 0;
+                uint64_t rank = std::max<uint64_t>(1, (uint64_t)(q * total + 0.999999));
+                uint64_t seen = 0;
+                for (size_t i = 0; i < BUCKETS; i++) {
+                    seen += counts[i];
+                    if (seen >= rank) return std::min(UpperBound(i), max);
+                }
+                return max;
+            }
+        };
+
+        void Record(uint64_t value) {
+            m_buckets[Index(value)].fetch_add(1, std::memory_order_relaxed);
+            auto max = m_max.load(std::memory_order_relaxed);
+            while (value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {}
+        }
+
+        static size_t Index(uint64_t value) {
+            if (value < SUB) return value;
+            int high = 63 - std::countl_zero(value);
+            if (high >= MAX_BITS) return BUCKETS - 1;
+            int shift = high - SUB_BITS;
+            return (shift + 1) * SUB + ((value >> shift) - SUB);
+        }
+
+        /// @brief 桶中最大的值, 最后一个桶没有上界
+        static uint64_t UpperBound(size_t index) {
+            if (index < SUB) return index;
+            if (index >= BUCKETS - 1) return UINT64_MAX;
+            int shift = index / SUB - 1;
+            uint64_t sub = index % SUB + SUB;
+            return ((sub + 1) << shift) - 1;
+        }
+
+    private:
+        std::array<std::atomic<uint64_t>, BUCKETS> m_buckets{};
+        std::atomic<uint64_t> m_max{0};
+};
+
+} // namespace loom
@@ -0,0 +1,243 @@
+#include <loom/utils/Statistic/PerfCounters.h>
+#include <loom/utils/Statistic/Statistics.h>
+#include <dirent.h>
+#include <glog/logging.h>
+#include <linux/perf_event.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace loom {
+
+namespace {
+
+int perfEventOpen(perf_event_attr& attr, int tid, int group_fd) {
+    return syscall(SYS_perf_event_open, &attr, tid, -1, group_fd, PERF_FLAG_FD_CLOEXEC);
+}
+
+int currentTid() {
+    return syscall(SYS_gettid);
+}
+
+/// @brief 线程是否仍在本进程中
+bool threadAlive(int tid) {
+    return syscall(SYS_tgkill, getpid(), tid, 0) == 0 || errno != ESRCH;
+}
+
+/// @brief 线程的启动时间(/proc/self/task/<tid>/stat 的第 22 个字段), 读取失败时为 0
+uint64_t threadStart(int tid) {
+    std::ifstream in("/proc/self/task/" + std::to_string(tid) + "/stat");
+    std::string stat;
+    if (!std::getline(in, stat)) return 0;
+    // 线程名可能包含空格, 从最后一个 ')' 之后数起, 之后的第一个字段是第 3 个字段
+    auto pos = stat.rfind(')');
+    if (pos == std::string::npos) return 0;
+    std::istringstream fields(stat.substr(pos + 1));
+    std::string field;
+    for (int i = 3; i <= 22; i++) {
+        if (!(fields >> field)) return 0;
+    }
+    return std::strtoull(field.c_str(), nullptr, 10);
+}
+
+perf_event_attr eventAttr(PerfCounts::Event event, bool kernel) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    switch (event) {
+        case PerfCounts::CYCLES:            attr.config = PERF_COUNT_HW_CPU_CYCLES; break;
+        case PerfCounts::INSTRUCTIONS:      attr.config = PERF_COUNT_HW_INSTRUCTIONS; break;
+        case PerfCounts::LLC_MISSES:        attr.config = PERF_COUNT_HW_CACHE_MISSES; break;
+        case PerfCounts::BRANCH_MISSES:     attr.config = PERF_COUNT_HW_BRANCH_MISSES; break;
+        default:
+            attr.type = PERF_TYPE_SOFTWARE;
+            attr.config = PERF_COUNT_SW_CONTEXT_SWITCHES;
+    }
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attr.exclude_kernel = !kernel;
+    attr.exclude_hv = 1;
+    return attr;
+}
+
+}
+
+PerfCounters& PerfCounters::instance() {
+    static PerfCounters counters;
+    return counters;
+}
+
+bool PerfCounters::Enable() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_enabled.load()) return true;
+    // 在调用线程上逐个探测事件, 能以内核态打开的事件之后也包含内核态
+    bool any = false;
+    for (size_t i = 0; i < PerfCounts::COUNT; i++) {
+        auto event = (PerfCounts::Event)i;
+        for (bool kernel : {true, false}) {
+            auto attr = eventAttr(event, kernel);
+            int fd = perfEventOpen(attr, 0, -1);
+            if (fd >= 0) {
+                close(fd);
+                m_available[i] = true;
+                m_kernel[i] = kernel;
+                any = true;
+                break;
+            }
+        }
+        if (!m_available[i]) LOG(WARNING) << "perf event " << PerfCounts::Name(event) << " is not available: " << std::strerror(errno);
+    }
+    if (!any) {
+        LOG(WARNING) << "perf_event_open is not permitted, hardware counters stay disabled";
+        return false;
+    }
+    m_enabled.store(true);
+    return true;
+}
+
+PerfCounters::~PerfCounters() {
+    for (auto& [tid, group] : m_groups) {
+        for (auto fd : group.fds) {
+            if (fd >= 0) close(fd);
+        }
+    }
+}
+
+PerfCounters::Group PerfCounters::open(int tid) {
+    Group group;
+    group.fds.fill(-1);
+    group.slot.fill(-1);
+    group.start = threadStart(tid);
+    for (size_t i = 0; i < PerfCounts::COUNT; i++) {
+        if (!m_available[i]) continue;
+        auto attr = eventAttr((PerfCounts::Event)i, m_kernel[i]);
+        int fd = perfEventOpen(attr, tid, group.leader);
+        if (fd < 0) continue;
+        if (group.leader < 0) group.leader = fd;
+        group.fds[i] = fd;
+        group.slot[i] = group.size++;
+    }
+    return group;
+}
+
+PerfCounts PerfCounters::read(const Group& group) const {
+    PerfCounts counts;
+    if (group.leader < 0) return counts;
+    // layout: nr, time_enabled, time_running, values[nr]
+    uint64_t buffer[3 + PerfCounts::COUNT];
+    if (::read(group.leader, buffer, sizeof(buffer)) < (ssize_t)(3 + group.size) * (ssize_t)sizeof(uint64_t)) return counts;
+    auto enabled = buffer[1], running = buffer[2];
+    if (running == 0) return counts;
+    for (size_t i = 0; i < PerfCounts::COUNT; i++) {
+        if (group.slot[i] < 0) continue;
+        auto value = buffer[3 + group.slot[i]];
+        counts.values[i] = running == enabled ? value : (uint64_t)((double)value * enabled / running);
+    }
+    return counts;
+}
+
+/// @brief 把已退出线程的最终计数并入 m_retired 并关闭其描述符, 调用方持有 m_mutex 并随后移除该组
+///        线程退出后计数器保留最终值, 不再变化
+void PerfCounters::retire(Group& group) {
+    m_retired += read(group);
+    for (auto& fd : group.fds) {
+        if (fd >= 0) close(fd);
+        fd = -1;
+    }
+    group.leader = -1;
+}
+
+/// @brief 线程的计数器组, 首次使用时打开, 调用方持有 m_mutex
+///        已登记的组属于已退出的线程(线程号被复用时启动时间不同)时, 先退出旧组再为新线程打开;
+///        读不到启动时间时不视为复用, 存活线程的组因此不会被移除, ReadThread 缓存的指针保持有效
+PerfCounters::Group& PerfCounters::group(int tid) {
+    auto it = m_groups.find(tid);
+    if (it != m_groups.end()) {
+        auto start = threadStart(tid);
+        bool reused = start != 0 && it->second.start != 0 && start != it->second.start;
+        if (!threadAlive(tid) || reused) {
+            retire(it->second);
+            m_groups.erase(it);
+            it = m_groups.end();
+        }
+    }
+    if (it == m_groups.end()) it = m_groups.emplace(tid, open(tid)).first;
+    return it->second;
+}
+
+/// @brief 登记 /proc/self/task 中尚无计数器组的线程, 调用方持有 m_mutex
+void PerfCounters::scan() {
+    if (auto dir = opendir("/proc/self/task")) {
+        while (auto entry = readdir(dir)) {
+            if (entry->d_name[0] != '.') group(std::atoi(entry->d_name));
+        }
+        closedir(dir);
+    }
+}
+
+PerfCounts PerfCounters::ReadThread() {
+    // 每个线程缓存自己的计数器组, 只有线程退出或线程号被复用时组才会被移除, 线程存活期间指针有效
+    thread_local Group* local = nullptr;
+    if (!local) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        local = &group(currentTid());
+    }
+    return read(*local);
+}
+
+PerfCounts PerfCounters::ReadProcess() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // 先退出已结束的线程, 再读出存活线程的计数
+    bool retired = false;
+    for (auto it = m_groups.begin(); it != m_groups.end();) {
+        if (!threadAlive(it->first)) {
+            retire(it->second);
+            it = m_groups.erase(it);
+            retired = true;
+        } else {
+            ++it;
+        }
+    }
+    // 线程数变化或有线程退出时才重新登记, 新登记的计数器从零开始, 不影响本次的和
+    struct stat st;
+    if (stat("/proc/self/task", &st) == 0 && (retired || (size_t)st.st_nlink != m_tasks)) {
+        m_tasks = st.st_nlink;
+        scan();
+    }
+    PerfCounts counts = m_retired;
+    for (auto& [tid, group] : m_groups) {
+        counts += read(group);
+    }
+    return counts;
+}
+
+PerfSampler::PerfSampler(Statistics& statistics, Scope scope)
+ : m_statistics(statistics), m_scope(scope), m_enabled(PerfCounters::instance().Enabled()) {
+    Restart();
+}
+
+PerfCounts PerfSampler::read() {
+    return m_scope == Scope::THREAD ? PerfCounters::instance().ReadThread() : PerfCounters::instance().ReadProcess();
+}
+
+void PerfSampler::Restart() {
+    if (m_enabled) m_begin = read();
+}
+
+void PerfSampler::Journal(const char* stage) {
+    if (!m_enabled) return;
+    auto now = read();
+    m_statistics.JournalCounters(stage, now - m_begin);
+    m_begin = now;
+}
+
+void PerfSampler::Journal(Phase phase) {
+    Journal(PhaseName(phase));
+}
+
+} // namespace loom
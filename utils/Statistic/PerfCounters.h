@@ -0,0 +1,124 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace loom {
+
+class Statistics;
+enum class Phase;
+
+/// @brief 一组 perf 事件的计数
+struct PerfCounts {
+    enum Event {
+        CYCLES,
+        INSTRUCTIONS,
+        LLC_MISSES,         // PERF_COUNT_HW_CACHE_MISSES, 即末级缓存未命中
+        BRANCH_MISSES,
+        CONTEXT_SWITCHES,
+        COUNT
+    };
+
+    std::array<uint64_t, COUNT> values{};
+
+    static const char* Name(Event event) {
+        switch (event) {
+            case CYCLES:            return "cycles";
+            case INSTRUCTIONS:      return "instructions";
+            case LLC_MISSES:        return "LLC misses";
+            case BRANCH_MISSES:     return "branch misses";
+            default:                return "context switches";
+        }
+    }
+
+    PerfCounts& operator+=(const PerfCounts& other) {
+        for (size_t i = 0; i < COUNT; i++) values[i] += other.values[i];
+        return *this;
+    }
+
+    PerfCounts operator-(const PerfCounts& other) const {
+        PerfCounts result;
+        for (size_t i = 0; i < COUNT; i++) result.values[i] = values[i] >= other.values[i] ? values[i] - other.values[i] : 0;
+        return result;
+    }
+};
+
+/// @brief 基于 perf_event_open 的硬件计数器, 每个线程打开一组计数器
+///        计数只包含用户态(内核允许时上下文切换包含内核态), 被复用时按启用/运行时间比例缩放
+///        线程退出后其最终计数并入进程总数, 计数器随即关闭, 线程号被复用时重新打开
+class PerfCounters {
+    public:
+        static PerfCounters& instance();
+
+        ~PerfCounters();
+
+        /// @brief 启用计数, 内核不支持或没有权限时给出警告并保持关闭
+        bool Enable();
+
+        bool Enabled() const {return m_enabled.load(std::memory_order_relaxed);}
+
+        /// @brief 事件在本机是否可用, 不可用的事件计数恒为 0
+        bool Available(PerfCounts::Event event) const {return m_available[event];}
+
+        /// @brief 调用线程自身的累计计数
+        PerfCounts ReadThread();
+
+        /// @brief 进程内所有线程的累计计数之和
+        PerfCounts ReadProcess();
+
+    private:
+        /// @brief 一个线程的计数器组, 以第一个打开的事件为组长, 一次 read 读出整组
+        struct Group {
+            int leader = -1;
+            std::array<int, PerfCounts::COUNT> fds;     // 各事件的描述符, -1 为未打开
+            std::array<int, PerfCounts::COUNT> slot;    // 事件在组内的位置, -1 为未打开
+            size_t size = 0;
+            uint64_t start = 0;                         // 线程的启动时间, 与线程号一起标识线程
+        };
+
+        PerfCounters() = default;
+        Group open(int tid);
+        PerfCounts read(const Group& group) const;
+        void retire(Group& group);
+        Group& group(int tid);
+        void scan();
+
+        std::atomic<bool> m_enabled{false};
+        std::array<bool, PerfCounts::COUNT> m_available{};
+        std::array<bool, PerfCounts::COUNT> m_kernel{};     // 是否可以包含内核态
+        std::mutex m_mutex;                                 // 保护线程计数器组的登记与退出
+        std::unordered_map<int, Group> m_groups;            // 存活线程的计数器组, 按线程号索引
+        PerfCounts m_retired;                               // 已退出线程的最终计数之和
+        size_t m_tasks = 0;                                 // 上次登记时 /proc/self/task 的链接数, 随线程数变化
+};
+
+/// @brief 按阶段累计计数: 每次 Journal 把上次 Restart/Journal 以来的计数差值记入一个阶段
+///        THREAD 只统计调用线程, 用于各工作线程自己执行的阶段(Aria/Harmony)
+///        PROCESS 统计进程内所有线程, 用于由线程池并行执行的阶段(Loom); 阶段重叠时(如区块间流水)各阶段都会计入重叠部分
+///        计数器未启用时什么也不做
+class PerfSampler {
+    public:
+        enum class Scope {THREAD, PROCESS};
+
+        PerfSampler(Statistics& statistics, Scope scope);
+
+        /// @brief 丢弃之前的计数, 重新开始, 例如跳过屏障等待
+        void Restart();
+
+        void Journal(const char* stage);
+
+        void Journal(Phase phase);
+
+    private:
+        PerfCounts read();
+
+        Statistics& m_statistics;
+        Scope m_scope;
+        bool m_enabled;
+        PerfCounts m_begin;
+};
+
+} // namespace loom
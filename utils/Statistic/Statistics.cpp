@@ -10,62 +10,183 @@
 
 namespace loom {
 
+/// @brief 当前线程的分片, 线程首次记录时按到达顺序分配
+Statistics::Shard& Statistics::local() {
+    static std::atomic<size_t> next_slot{0};
+    thread_local size_t slot = next_slot.fetch_add(1, std::memory_order_relaxed) % SHARDS;
+    return shards[slot];
+}
+
+void Statistics::JournalEnd(std::chrono::steady_clock::time_point n_end_time) {
+    auto ticks = n_end_time.time_since_epoch().count();
+    auto current = end_time.load(std::memory_order_relaxed);
+    while (ticks > current && !end_time.compare_exchange_weak(current, ticks, std::memory_order_relaxed)) {}
+}
+
 void Statistics::JournalCommit(size_t latency) {
-    // if (count_commit.load() == 0) {
-    //     begin_time = std::chrono::steady_clock::now();
-    // } else {
-    //     end_time = std::chrono::steady_clock::now();
-    // }
-    end_time = std::chrono::steady_clock::now();
-    count_commit.fetch_add(1, std::memory_order_relaxed);
-    count_latency.fetch_add(latency, std::memory_order_relaxed);
-    DLOG(INFO) << "latency: " << latency << "us";
+    JournalCommit(latency, std::chrono::steady_clock::now());
 }
 
 void Statistics::JournalCommit(size_t latency, std::chrono::time_point<std::chrono::steady_clock> n_end_time) {
-    end_time = std::max(end_time, n_end_time);
-    count_commit.fetch_add(1, std::memory_order_relaxed);
-    count_latency.fetch_add(latency, std::memory_order_relaxed);
+    JournalEnd(n_end_time);
+    auto& shard = local();
+    shard.count_commit.fetch_add(1, std::memory_order_relaxed);
+    shard.count_latency.fetch_add(latency, std::memory_order_relaxed);
+    shard.tx_latency.Record(latency);
     DLOG(INFO) << "latency: " << latency << "us";
 }
 
 void Statistics::JournalExecute() {
-    if (count_execution.load() == 0) {
-        begin_time = std::chrono::steady_clock::now();
+    // 只有第一次执行设置开始时间
+    if (begin_time.load(std::memory_order_relaxed) == 0) {
+        std::chrono::steady_clock::rep expected = 0;
+        begin_time.compare_exchange_strong(expected, std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
     }
-    count_execution.fetch_add(1, std::memory_order_relaxed);
+    local().count_execution.fetch_add(1, std::memory_order_relaxed);
 }
 
 void Statistics::JournalOverheads(size_t count) {
-    count_overhead.fetch_add(count, std::memory_order_relaxed);
+    local().count_overhead.fetch_add(count, std::memory_order_relaxed);
 }
 
 void Statistics::JournalRollback(size_t count) {
-    count_rollback.fetch_add(count, std::memory_order_relaxed);
+    local().count_rollback.fetch_add(count, std::memory_order_relaxed);
 }
 
 void Statistics::JournalBlock() {
-    count_block.fetch_add(1, std::memory_order_relaxed);
+    local().count_block.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Statistics::JournalBlock(size_t latency) {
+    JournalBlock();
+    block_latency.Record(latency);
+}
+
+void Statistics::JournalPhase(Phase phase, size_t latency) {
+    phase_latency[(size_t)phase].Record(latency);
+}
+
+void Statistics::JournalCounters(const std::string& stage, const PerfCounts& counts) {
+    std::lock_guard<std::mutex> lock(counters_mutex);
+    for (auto& [name, total] : stage_counters) {
+        if (name == stage) {
+            total += counts;
+            return;
+        }
+    }
+    stage_counters.emplace_back(stage, counts);
 }
 
 void Statistics::JournalRollbackExecution(size_t latency) {
-    count_latency_rollback.fetch_add(latency, std::memory_order_relaxed);
+    local().count_latency_rollback.fetch_add(latency, std::memory_order_relaxed);
 }
 
 void Statistics::JournalReExecution(size_t latency) {
-    count_latency_reExecution.fetch_add(latency, std::memory_order_relaxed);
+    local().count_latency_reExecution.fetch_add(latency, std::memory_order_relaxed);
+}
+
+size_t Statistics::CountBlock() const {
+    size_t count = 0;
+    for (size_t i = 0; i < SHARDS; i++) count += shards[i].count_block.load(std::memory_order_relaxed);
+    return count;
+}
+
+size_t Statistics::CountCommit() const {
+    size_t count = 0;
+    for (size_t i = 0; i < SHARDS; i++) count += shards[i].count_commit.load(std::memory_order_relaxed);
+    return count;
+}
+
+const char* PhaseName(Phase phase) {
+    switch (phase) {
+        case Phase::PRE_EXECUTE:        return "pre-execute";
+        case Phase::GRAPH_BUILD:        return "graph build";
+        case Phase::SCC:                return "scc";
+        case Phase::ROLLBACK_SELECT:    return "rollback select";
+        case Phase::RE_EXECUTE:         return "re-execute";
+        case Phase::FINALIZE:           return "finalize";
+        default:                        return "unknown";
+    }
+}
+
+namespace {
+
+/// @brief 以毫秒输出各直方图的 p50/p90/p99/p99.9/max, 没有记录的直方图不输出
+std::string PrintPercentiles(const Histogram::Snapshot& tx_latency, const Histogram& block_latency, const Histogram* phase_latency) {
+    std::string result = fmt::format("\n{:<19}{:>10} {:>10} {:>10} {:>10} {:>10} (ms)", "percentile", "p50", "p90", "p99", "p99.9", "max");
+    auto line = [&result](const std::string& name, const Histogram::Snapshot& snapshot) {
+        if (snapshot.total == 0) return;
+        #define MS(X) ((double)(X) / (double)(1000))
+        result += fmt::format("\n{:<19}{:>10.3f} {:>10.3f} {:>10.3f} {:>10.3f} {:>10.3f}", name,
+            MS(snapshot.Percentile(0.5)), MS(snapshot.Percentile(0.9)), MS(snapshot.Percentile(0.99)), MS(snapshot.Percentile(0.999)), MS(snapshot.max));
+        #undef MS
+    };
+    line("tx", tx_latency);
+    Histogram::Snapshot block;
+    block.Merge(block_latency);
+    line("block", block);
+    for (size_t i = 0; i < (size_t)Phase::COUNT; i++) {
+        Histogram::Snapshot phase;
+        phase.Merge(phase_latency[i]);
+        line(PhaseName((Phase)i), phase);
+    }
+    return result;
+}
+
+/// @brief 输出各阶段的硬件计数: 总量(百万)、IPC 与每千条指令的未命中数, 不可用的事件输出 "-"
+std::string PrintCounters(const std::vector<std::pair<std::string, PerfCounts>>& stage_counters) {
+    if (stage_counters.empty()) return "";
+    auto& counters = PerfCounters::instance();
+    auto value = [&counters](const PerfCounts& counts, PerfCounts::Event event) {
+        return counters.Available(event) ? fmt::format("{:.3f}", counts.values[event] / 1e6) : std::string("-");
+    };
+    auto ratio = [&counters](const PerfCounts& counts, PerfCounts::Event event, PerfCounts::Event base, double scale) {
+        if (!counters.Available(event) || !counters.Available(base)) return std::string("-");
+        if (counts.values[base] == 0) return std::string("0");
+        return fmt::format("{:.3f}", (double)counts.values[event] / counts.values[base] * scale);
+    };
+    std::string result = fmt::format("\n{:<19}{:>12} {:>12} {:>8} {:>12} {:>8} {:>12} {:>8} {:>12}",
+        "counters (M)", "cycles", "instructions", "IPC", "LLC misses", "MPKI", "br misses", "BPKI", "ctx switches");
+    for (auto& [stage, counts] : stage_counters) {
+        result += fmt::format("\n{:<19}{:>12} {:>12} {:>8} {:>12} {:>8} {:>12} {:>8} {:>12}", stage,
+            value(counts, PerfCounts::CYCLES), value(counts, PerfCounts::INSTRUCTIONS),
+            ratio(counts, PerfCounts::INSTRUCTIONS, PerfCounts::CYCLES, 1),
+            value(counts, PerfCounts::LLC_MISSES), ratio(counts, PerfCounts::LLC_MISSES, PerfCounts::INSTRUCTIONS, 1000),
+            value(counts, PerfCounts::BRANCH_MISSES), ratio(counts, PerfCounts::BRANCH_MISSES, PerfCounts::INSTRUCTIONS, 1000),
+            counters.Available(PerfCounts::CONTEXT_SWITCHES) ? std::to_string(counts.values[PerfCounts::CONTEXT_SWITCHES]) : std::string("-"));
+    }
+    return result;
+}
+
 }
 
 std::string Statistics::Print() {
+    // merge the shards
+    size_t count_commit = 0, count_execution = 0, count_overhead = 0, count_latency = 0;
+    size_t count_latency_rollback = 0, count_latency_reExecution = 0, count_block = 0, count_rollback = 0;
+    Histogram::Snapshot tx_latency;
+    for (size_t i = 0; i < SHARDS; i++) {
+        auto& shard = shards[i];
+        #define MERGE(X) X += shard.X.load(std::memory_order_relaxed)
+        MERGE(count_commit); MERGE(count_execution); MERGE(count_overhead); MERGE(count_latency);
+        MERGE(count_latency_rollback); MERGE(count_latency_reExecution); MERGE(count_block); MERGE(count_rollback);
+        #undef MERGE
+        tx_latency.Merge(shard.tx_latency);
+    }
+    std::vector<std::pair<std::string, PerfCounts>> counters;
+    {
+        std::lock_guard<std::mutex> lock(counters_mutex);
+        counters = stage_counters;
+    }
     // calculate the statistics duration
-    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - begin_time).count();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::duration(end_time.load() - begin_time.load())).count();
     LOG(INFO) << std::fixed << std::setprecision(3) << "duration: " << duration / (double)(1000) << "ms";
 
-    #define TIME(X, Y) ((double)(X.load()) / (double)(Y.load()) / (double)(1000))
-    #define BLOCKLATENCY(X) ((double)(duration) / (double)(X.load()) / (double)(1000))
+    #define TIME(X, Y) ((double)(X) / (double)(Y) / (double)(1000))
+    #define BLOCKLATENCY(X) ((double)(duration) / (double)(X) / (double)(1000))
     #define PRELATENCY(X, Y, Z) (BLOCKLATENCY(Z) - TIME(X, Z) - TIME(Y, Z))
-    #define RATIO(X, Y) ((Y.load() == 0) ? 0 : ((double)(X.load()) / (double)(Y.load())))
-    #define TPS(X) ((double)(X.load()) / (double)(duration) * (double)(1000000))
+    #define RATIO(X, Y) ((Y == 0) ? 0 : ((double)(X) / (double)(Y)))
+    #define TPS(X) ((double)(X) / (double)(duration) * (double)(1000000))
 
     
     auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
@@ -88,9 +209,9 @@ std::string Statistics::Print() {
         "re-execute latency {:.3f} ms\n"
         "concurrency ratio  {:.3f}",
         time_buffer,
-        count_block.load(),
-        count_commit.load(),
-        count_execution.load(),
+        count_block,
+        count_commit,
+        count_execution,
         TIME(count_overhead, count_block),
         TIME(count_rollback, count_block),
         RATIO(count_rollback, count_overhead),
@@ -101,7 +222,7 @@ std::string Statistics::Print() {
         TIME(count_latency_rollback, count_block),
         TIME(count_latency_reExecution, count_block),
         RATIO(count_rollback, count_latency_reExecution)
-    ));
+    )) + PrintPercentiles(tx_latency, block_latency, phase_latency) + PrintCounters(counters);
     #undef TPS
     #undef LATENCY
 }
@@ -1,25 +1,60 @@
 #pragma once
 #include <atomic>
 #include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 #include <loom/utils/Ulock.h>
+#include <loom/utils/Statistic/Histogram.h>
+#include <loom/utils/Statistic/PerfCounters.h>
 
 namespace loom {
 
+/// @brief Loom 各阶段, 用于分阶段统计耗时
+enum class Phase {
+    PRE_EXECUTE,
+    GRAPH_BUILD,
+    SCC,
+    ROLLBACK_SELECT,
+    RE_EXECUTE,
+    FINALIZE,
+    COUNT
+};
+
+const char* PhaseName(Phase phase);
 
 class Statistics {
 
     private:
     static const int SAMPLE = 1000;
-    std::atomic<size_t> count_commit{0};
-    std::atomic<size_t> count_execution{0};
-    std::atomic<size_t> count_overhead{0};
-    std::atomic<size_t> count_latency{0};
-    std::atomic<size_t> count_latency_rollback{0};
-    std::atomic<size_t> count_latency_reExecution{0};
-    std::atomic<size_t> count_block{0};
-    std::atomic<size_t> count_rollback{0};
-    std::chrono::steady_clock::time_point begin_time;
-    std::chrono::steady_clock::time_point end_time;
+    static const size_t SHARDS = 64;
+
+    /// @brief 每个线程固定写入一个分片, 各分片独占缓存行, Print() 时再合并
+    struct alignas(64) Shard {
+        std::atomic<size_t> count_commit{0};
+        std::atomic<size_t> count_execution{0};
+        std::atomic<size_t> count_overhead{0};
+        std::atomic<size_t> count_latency{0};
+        std::atomic<size_t> count_latency_rollback{0};
+        std::atomic<size_t> count_latency_reExecution{0};
+        std::atomic<size_t> count_block{0};
+        std::atomic<size_t> count_rollback{0};
+        Histogram tx_latency;
+    };
+
+    std::unique_ptr<Shard[]> shards{new Shard[SHARDS]};
+    Histogram block_latency;
+    Histogram phase_latency[(size_t)Phase::COUNT];
+    // 以 steady_clock 的计数保存, 多线程下原子地取最早/最晚时间
+    std::atomic<std::chrono::steady_clock::rep> begin_time{0};
+    std::atomic<std::chrono::steady_clock::rep> end_time{0};
+    // 各阶段累计的硬件计数, 按首次记录的顺序输出
+    std::mutex counters_mutex;
+    std::vector<std::pair<std::string, PerfCounts>> stage_counters;
+
+    Shard& local();
+    void JournalEnd(std::chrono::steady_clock::time_point n_end_time);
 
     public:
     Statistics() = default;
@@ -30,8 +65,15 @@ class Statistics {
     void JournalOverheads(size_t count);
     void JournalRollback(size_t count);
     void JournalBlock();
+    void JournalBlock(size_t latency);
+    void JournalPhase(Phase phase, size_t latency);
+    void JournalCounters(const std::string& stage, const PerfCounts& counts);
     void JournalRollbackExecution(size_t latency);
     void JournalReExecution(size_t latency);
+    /// @brief 已提交的区块数, 合并各分片
+    size_t CountBlock() const;
+    /// @brief 已提交的事务数, 合并各分片
+    size_t CountCommit() const;
     std::string Print();
 
 };
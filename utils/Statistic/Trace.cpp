@@ -0,0 +1,88 @@
+#include <loom/utils/Statistic/Trace.h>
+#include <fmt/core.h>
+#include <fstream>
+#include <glog/logging.h>
+
+namespace loom {
+
+Trace& Trace::instance() {
+    static Trace trace;
+    return trace;
+}
+
+void Trace::Start(const std::string& path) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_path = path;
+    m_origin = std::chrono::steady_clock::now();
+    m_buffers.clear();
+    m_generation.fetch_add(1, std::memory_order_relaxed);
+    m_enabled.store(true, std::memory_order_release);
+}
+
+/// @brief 当前线程的缓冲区, 每次 Start 后首次记录时登记
+Trace::Buffer& Trace::local() {
+    thread_local std::shared_ptr<Buffer> buffer;
+    thread_local uint64_t generation = 0;
+    auto current = m_generation.load(std::memory_order_relaxed);
+    if (!buffer || generation != current) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        buffer = std::make_shared<Buffer>();
+        buffer->tid = m_buffers.size() + 1;
+        buffer->events.reserve(1024);
+        m_buffers.push_back(buffer);
+        generation = current;
+    }
+    return *buffer;
+}
+
+void Trace::Record(const char* name, std::chrono::steady_clock::time_point begin, std::chrono::steady_clock::time_point end, int64_t block, int64_t scc, int64_t tx) {
+    if (!Enabled()) return;
+    auto& buffer = local();
+    buffer.events.push_back({
+        name,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(begin - m_origin).count(),
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - m_origin).count(),
+        block, scc, tx
+    });
+}
+
+void Trace::Flush() {
+    if (!m_enabled.exchange(false, std::memory_order_acq_rel)) return;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::ofstream out(m_path);
+    if (!out) {
+        LOG(ERROR) << "cannot write trace to " << m_path;
+        return;
+    }
+    // Chrome trace event format, 每个事件为一个 "X" (complete) 事件, 时间单位为 us
+    size_t count = 0;
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    for (auto& buffer : m_buffers) {
+        for (auto& event : buffer->events) {
+            std::string args;
+            if (event.block >= 0) args += fmt::format(",\"block\":{}", event.block);
+            if (event.scc >= 0) args += fmt::format(",\"scc\":{}", event.scc);
+            if (event.tx >= 0) args += fmt::format(",\"tx\":{}", event.tx);
+            if (!args.empty()) {
+                args[0] = '{';
+                args += '}';
+            }
+            out << (count++ ? ",\n" : "\n") << fmt::format(
+                "{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}{}}}",
+                event.name, buffer->tid, event.begin / 1000.0, (event.end - event.begin) / 1000.0,
+                args.empty() ? "" : ",\"args\":" + args
+            );
+        }
+    }
+    out << "\n]}\n";
+    LOG(INFO) << "wrote " << count << " trace events of " << m_buffers.size() << " threads to " << m_path;
+    m_buffers.clear();
+}
+
+void Trace::Stop() {
+    m_enabled.store(false, std::memory_order_release);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_buffers.clear();
+}
+
+} // namespace loom
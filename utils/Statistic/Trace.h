@@ -0,0 +1,84 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace loom {
+
+/// @brief 时间线记录器, 导出 Chrome/Perfetto 可读的 trace JSON
+///        每个线程写入自己的缓冲区, 记录路径无锁; 只有线程首次记录时加锁登记缓冲区
+///        未启用时记录只多一次 acquire 读
+class Trace {
+    public:
+        /// @brief 一段完整的执行区间, 未知的 block/scc/tx 为 -1
+        struct Event {
+            const char* name;
+            int64_t begin;      // ns, 相对 Start() 时刻
+            int64_t end;
+            int64_t block;
+            int64_t scc;
+            int64_t tx;
+        };
+
+        static Trace& instance();
+
+        /// @brief 开始记录, Flush() 时写入 path
+        void Start(const std::string& path);
+
+        /// @brief 与 Start 的 release 配对, 看到启用时也能看到 Start 设置的起始时刻
+        bool Enabled() const {return m_enabled.load(std::memory_order_acquire);}
+
+        void Record(const char* name, std::chrono::steady_clock::time_point begin, std::chrono::steady_clock::time_point end, int64_t block = -1, int64_t scc = -1, int64_t tx = -1);
+
+        /// @brief 停止记录并写出 trace, 调用时记录线程应已停止; 未启用时什么也不做
+        void Flush();
+
+        /// @brief 停止记录并丢弃已记录的区间, 不写出 trace; 调用时记录线程应已停止
+        void Stop();
+
+    private:
+        struct Buffer {
+            uint32_t tid;
+            std::vector<Event> events;
+        };
+
+        Trace() = default;
+        Buffer& local();
+
+        std::atomic<bool> m_enabled{false};
+        std::string m_path;
+        std::chrono::steady_clock::time_point m_origin;
+        std::mutex m_mutex;                                 // 只保护缓冲区登记
+        std::vector<std::shared_ptr<Buffer>> m_buffers;
+        std::atomic<uint64_t> m_generation{0};              // 每次 Start 递增, 线程据此丢弃旧缓冲区
+};
+
+/// @brief 作用域内的执行区间, 析构时记录
+class TraceScope {
+    public:
+        TraceScope(const char* name, int64_t block = -1, int64_t scc = -1, int64_t tx = -1)
+         : m_name(name), m_block(block), m_scc(scc), m_tx(tx), m_enabled(Trace::instance().Enabled()) {
+            if (m_enabled) m_begin = std::chrono::steady_clock::now();
+        }
+
+        ~TraceScope() {
+            if (m_enabled) Trace::instance().Record(m_name, m_begin, std::chrono::steady_clock::now(), m_block, m_scc, m_tx);
+        }
+
+        TraceScope(const TraceScope&) = delete;
+        TraceScope& operator=(const TraceScope&) = delete;
+
+    private:
+        const char* m_name;
+        int64_t m_block;
+        int64_t m_scc;
+        int64_t m_tx;
+        bool m_enabled;
+        std::chrono::steady_clock::time_point m_begin;
+};
+
+} // namespace loom
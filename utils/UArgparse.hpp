@@ -8,6 +8,7 @@
 #include <loom/workload/tpcc/Workload.hpp>
 #include <loom/utils/UMacros.hpp>
 #include <loom/utils/Generator/UTxGenerator.h>
+#include <loom/utils/Generator/UWorkloadFile.h>
 #include <ranges>
 #include <iostream>
 #include <fmt/core.h>
@@ -73,9 +74,25 @@ milliseconds to<milliseconds>(std::basic_string_view<char> s) {
 	return milliseconds{};
 }
 
+// 打开二进制负载文件, 仓库数与区块大小取自文件头
+inline std::shared_ptr<WorkloadFile> OpenWorkloadFile(const std::string& path, size_t& warehouse_num, size_t& block_size) {
+    auto file = std::make_shared<WorkloadFile>(path);
+    TPCC::N_WAREHOUSES = file->getWarehouseNum();
+    warehouse_num = TPCC::N_WAREHOUSES;
+    loom::BLOCK_SIZE = file->getBlockSize();
+    block_size = loom::BLOCK_SIZE;
+    LOG(INFO) << "Opened workload " << path << " with " << file->getBlockCount() << (file->isNested() ? " nested" : " flat") << " blocks of size " << loom::BLOCK_SIZE << " and " << TPCC::N_WAREHOUSES << " warehouses";
+    return file;
+}
+
 inline std::vector<Block::Ptr> ParseWorkload(const char* arg, size_t& warehouse_num, size_t& block_size) {
     auto args = split(arg);
     auto name = *args.begin();
+    // FILE:<path> 一次物化文件中的全部区块
+    if (name == "FILE") {
+        auto file = OpenWorkloadFile(std::string{arg}.substr(name.size() + 1), warehouse_num, block_size);
+        return file->getBlocks(std::make_shared<ThreadPool>(std::max(1u, std::thread::hardware_concurrency())));
+    }
     auto iter = args.begin();
     TPCC::N_WAREHOUSES = INT;
     warehouse_num = TPCC::N_WAREHOUSES;
@@ -83,13 +100,52 @@ inline std::vector<Block::Ptr> ParseWorkload(const char* arg, size_t& warehouse_
     block_size = loom::BLOCK_SIZE;
     auto num_blocks = INT;
     auto is_nest = BOOL;
-    // Generate a workload
+    // Generate a workload, TPCC:w:bs:n:nest[:seed] 指定种子时生成结果可复现
     TxGenerator txGenerator(loom::BLOCK_SIZE * num_blocks);
     LOG(INFO) << "Generating workload with " << num_blocks << " blocks of size " << loom::BLOCK_SIZE << " and " << TPCC::N_WAREHOUSES << " warehouses";
-    return txGenerator.generateWorkload(is_nest);
+    if (args.size() < 6) return txGenerator.generateWorkload(is_nest);
+    Workload workload(INT);
+    LOG(INFO) << "Workload seed " << workload.get_seed();
+    return txGenerator.generateWorkload(is_nest, workload, std::make_shared<ThreadPool>(std::max(1u, std::thread::hardware_concurrency())));
+}
+
+inline BlockSource::Ptr ParseBlockSource(const char* arg, size_t& warehouse_num, size_t& block_size) {
+    auto args = split(arg);
+    // FILE:<path> 协议拉取时才物化区块
+    if (*args.begin() == "FILE") {
+        return std::make_shared<WorkloadFileSource>(OpenWorkloadFile(std::string{arg}.substr(args[0].size() + 1), warehouse_num, block_size));
+    }
+    if (*args.begin() != "STREAM") {
+        return std::make_shared<VectorBlockSource>(ParseWorkload(arg, warehouse_num, block_size));
+    }
+    // STREAM:<capacity>:<workload> 由生产者线程边生成边执行, 最多缓存 capacity 个区块
+    if (args.size() < 3) THROW("streaming workload ({}) should be STREAM:<capacity>:<workload>", arg);
+    auto capacity = to<size_t>(args[1]);
+    auto inner = std::string{arg}.substr(args[0].size() + args[1].size() + 2);
+    if (args[2] == "FILE") {
+        auto file = OpenWorkloadFile(inner.substr(args[2].size() + 1), warehouse_num, block_size);
+        LOG(INFO) << "Streaming workload file through " << capacity << " slots";
+        return std::make_shared<StreamingBlockSource>([file, i = size_t{0}]() mutable -> Block::Ptr {
+            return i < file->getBlockCount() ? file->getBlock(i++) : nullptr;
+        }, capacity);
+    }
+    auto iter = args.begin() + 2;
+    TPCC::N_WAREHOUSES = INT;
+    warehouse_num = TPCC::N_WAREHOUSES;
+    loom::BLOCK_SIZE = INT;
+    block_size = loom::BLOCK_SIZE;
+    auto num_blocks = INT;  // 0 表示不限区块数, 直到协议停止
+    auto is_nest = BOOL;
+    auto generator = std::make_shared<TxGenerator>(0, loom::BLOCK_SIZE);
+    auto workload = args.size() < 8 ? std::make_shared<Workload>() : std::make_shared<Workload>(INT);
+    LOG(INFO) << "Streaming workload with " << num_blocks << " blocks of size " << loom::BLOCK_SIZE << " and " << TPCC::N_WAREHOUSES << " warehouses through " << capacity << " slots";
+    return std::make_shared<StreamingBlockSource>([generator, workload, num_blocks, is_nest, id = size_t{0}]() mutable -> Block::Ptr {
+        if (num_blocks != 0 && id == num_blocks) return nullptr;
+        return generator->generateBlock(is_nest, *workload, ++id);
+    }, capacity);
 }
 
-inline std::unique_ptr<Protocol> ParseProtocol(const char* arg, vector<Block::Ptr>& workload, Statistics& statistics, std::string& protocol_name, size_t& thread_num) {
+inline std::unique_ptr<Protocol> ParseProtocol(const char* arg, BlockSource::Ptr workload, Statistics& statistics, std::string& protocol_name, size_t& thread_num) {
     auto args = split(arg);
     auto name = *args.begin();
     protocol_name = name;
@@ -1,39 +1,66 @@
 #pragma once
 
 #include <string>
-#include <random>
+#include <cstdint>
 
 namespace Util {
 
+/// @brief xoshiro256** 伪随机数生成器
+///        Random(seed, stream) 由 (seed, stream) 经 SplitMix64 直接导出第 stream 条流的初始状态,
+///        无需先生成前面的流, 并行任务按工作单元编号取流即可得到与线程数无关的结果
 class Random {
     public:
-        Random(uint64_t seed = 0) : distribution(0, 1000000), rng(seed) { init_seed(seed); }
-
-        void init_seed(uint64_t seed) {
-            seed_ = (seed ^ 0x5DEECE66DULL) & ((1ULL << 48) - 1);
+        Random(uint64_t seed = 0, uint64_t stream = 0) { init_seed(seed, stream); }
+
+        void init_seed(uint64_t seed, uint64_t stream = 0) {
+            seed_ = seed;
+            stream_ = stream;
+            uint64_t x = seed;
+            x = splitmix64(x) ^ (stream * 0xD1342543DE82EF95ULL);
+            for (auto& s : state_) { s = splitmix64(x); }
         }
 
-        void set_seed(uint64_t seed) { seed_ = seed; }
+        void set_seed(uint64_t seed) { init_seed(seed, stream_); }
 
+        /// @brief 创建生成器时的种子, 以相同种子 set_seed 可重放同一序列
         uint64_t get_seed() { return seed_; }
 
-        uint64_t next() { return ((uint64_t)next(32) << 32) + next(32); }
-        // uint64_t next() { return distribution(rng); }
-
-        uint64_t next(unsigned int bits) {
-            seed_ = (seed_ * 0x5DEECE66DULL + 0xBULL) & ((1ULL << 48) - 1);
-            return (seed_ >> (48 - bits));
+        uint64_t next() {
+            const uint64_t result = rotl(state_[1] * 5, 7) * 9;
+            const uint64_t t = state_[1] << 17;
+            state_[2] ^= state_[0];
+            state_[3] ^= state_[1];
+            state_[1] ^= state_[2];
+            state_[0] ^= state_[3];
+            state_[2] ^= t;
+            state_[3] = rotl(state_[3], 45);
+            return result;
         }
 
+        uint64_t next(unsigned int bits) { return next() >> (64 - bits); }
+
         /* [0.0, 1.0) */
         double next_double() {
-            return (((uint64_t)next(26) << 27) + next(27)) / (double)(1ULL << 53);
+            return next(53) / (double)(1ULL << 53);
         }
 
+        /// @brief [a, b] 上的均匀分布, 以乘法取高位映射区间并拒绝偏置部分, 避免取模的偏差与除法开销
         uint64_t uniform_dist(uint64_t a, uint64_t b) {
             if (a == b)
                 return a;
-            return next() % (b - a + 1) + a;
+            const uint64_t range = b - a + 1;
+            if (range == 0)
+                return next();
+            __uint128_t m = (__uint128_t)next() * range;
+            uint64_t low = (uint64_t)m;
+            if (low < range) {
+                const uint64_t threshold = -range % range;
+                while (low < threshold) {
+                    m = (__uint128_t)next() * range;
+                    low = (uint64_t)m;
+                }
+            }
+            return (uint64_t)(m >> 64) + a;
         }
 
         std::string rand_str(std::size_t length, const std::string &str) {
@@ -58,10 +85,18 @@ class Random {
             return alpha_;
         };
 
-        uint64_t seed_;
+        static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+        static uint64_t splitmix64(uint64_t& x) {
+            uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
 
-        std::mt19937 rng;
-        std::uniform_int_distribution<size_t> distribution;
+        uint64_t seed_;
+        uint64_t stream_;
+        uint64_t state_[4];
 };
 
-}
\ No newline at end of file
+}
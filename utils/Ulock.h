@@ -7,6 +7,10 @@
 #include <glog/logging.h>
 #include <vector>
 #include <functional>
+#include <bit>
+#include <limits>
+#include <type_traits>
+#include <utility>
 
 namespace loom {
 
@@ -97,9 +101,19 @@ class LockPriorityQueue {
 
 #undef TP
 
-template<typename K, typename V, typename Hasher>
+/// @brief 表实现: PARTITIONED 为分区加锁的哈希表, FLAT 为预分配的开放寻址无锁表
+///        各协议默认使用 FLAT, 编译时以 -D<PROTOCOL>_TABLE_KIND=TableKind::PARTITIONED 切换, 如 -DLOOM_TABLE_KIND, -DARIA_TABLE_KIND
+enum class TableKind {
+    PARTITIONED,
+    FLAT
+};
+
+template<typename K, typename V, typename Hasher, TableKind Kind = TableKind::PARTITIONED>
 class Table {
 
+    // the flat table moves its overflow entries back into the slot array when it grows
+    template<typename, typename, typename, TableKind> friend class Table;
+
     private:
     size_t                  num_partitions;
     std::vector<SpinLock>   locks;
@@ -107,33 +121,46 @@ class Table {
 
     public:
     Table(size_t partitions);
-    void Get(const K& k, std::function<void(const V& v)>&& vmap);
-    void Put(const K& k, std::function<void(V& v)>&& vmap);
+    void Reserve(size_t keys);
+    template<typename F> void Get(const K& k, F&& vmap);
+    template<typename F> void Put(const K& k, F&& vmap);
 
 };
 
-template<typename K, typename V, typename Hasher>
-Table<K, V, Hasher>::Table(size_t partitions)
+template<typename K, typename V, typename Hasher, TableKind Kind>
+Table<K, V, Hasher, Kind>::Table(size_t partitions)
     : locks(partitions),
       partitions(partitions),
       num_partitions{partitions}
 {}
 
-template<typename K, typename V, typename Hasher>
-void Table<K, V, Hasher>::Get(const K& k, std::function<void(const V& v)>&& vmap) {
+/// @brief pre-size every partition, not thread-safe
+/// @param keys the expected number of distinct keys
+template<typename K, typename V, typename Hasher, TableKind Kind>
+void Table<K, V, Hasher, Kind>::Reserve(size_t keys) {
+    for (auto& partition : partitions) {
+        partition.reserve(keys / num_partitions + 1);
+    }
+}
+
+template<typename K, typename V, typename Hasher, TableKind Kind>
+template<typename F>
+void Table<K, V, Hasher, Kind>::Get(const K& k, F&& vmap) {
     auto partition_id = ((size_t)Hasher()(k)) % num_partitions;
     DLOG(INFO) << "Get key: " << k << " at partition " << partition_id;
     auto guard = Guard{locks[partition_id]};
     auto& partition = this->partitions[partition_id];
-    if (partition.contains(k)) {
-        vmap(partition[k]);
+    auto it = partition.find(k);
+    if (it != partition.end()) {
+        vmap(std::as_const(it->second));
     } else {
         DLOG(INFO) << "key not found";
     }
 }
 
-template<typename K, typename V, typename Hasher>
-void Table<K, V, Hasher>::Put(const K& k, std::function<void(V& v)>&& vmap) {
+template<typename K, typename V, typename Hasher, TableKind Kind>
+template<typename F>
+void Table<K, V, Hasher, Kind>::Put(const K& k, F&& vmap) {
     auto partition_id = ((size_t)Hasher()(k)) % num_partitions;
     DLOG(INFO) << "Put key: " << k << " at partition " << partition_id;
     auto guard = Guard{locks[partition_id]};
@@ -141,4 +168,170 @@ void Table<K, V, Hasher>::Put(const K& k, std::function<void(V& v)>&& vmap) {
     vmap(partition[k]);
 }
 
+/// @brief open addressing table with linear probing
+///        keys are claimed by CAS and never removed, each slot carries a versioned lock word
+///        (odd while a writer is inside). Trivially copyable values are read optimistically
+///        as a seqlock, other values are read under the slot lock. Keys that cannot be placed
+///        within MAX_PROBE slots spill into a partitioned overflow table.
+template<typename K, typename V, typename Hasher>
+class Table<K, V, Hasher, TableKind::FLAT> {
+
+    static_assert(std::is_integral_v<K>, "flat table requires integral keys");
+
+    static constexpr K      EMPTY           = std::numeric_limits<K>::max();
+    static constexpr size_t MIN_CAPACITY    = 1 << 16;
+    static constexpr size_t MAX_PROBE       = 128;
+
+    struct Slot {
+        std::atomic<K>          key{EMPTY};
+        std::atomic<uint32_t>   version{0};
+        V                       value{};
+    };
+
+    private:
+    size_t                                          capacity;
+    std::unique_ptr<Slot[]>                         slots;
+    Table<K, V, Hasher, TableKind::PARTITIONED>     overflow;
+
+    Slot* Find(const K& k, bool insert);
+    static uint32_t Lock(Slot& slot);
+    static void Unlock(Slot& slot, uint32_t version);
+
+    public:
+    Table(size_t partitions);
+    void Reserve(size_t keys);
+    template<typename F> void Get(const K& k, F&& vmap);
+    template<typename F> void Put(const K& k, F&& vmap);
+
+};
+
+template<typename K, typename V, typename Hasher>
+Table<K, V, Hasher, TableKind::FLAT>::Table(size_t partitions)
+    : capacity{MIN_CAPACITY},
+      slots{new Slot[MIN_CAPACITY]},
+      overflow(partitions)
+{}
+
+/// @brief grow the slot array to hold keys at load factor <= 0.5, not thread-safe
+///        entries are rehashed only when V is movable, otherwise growth is limited to an empty table.
+///        overflow entries that fit into the grown slot array are moved there, a later Put of such
+///        a key would otherwise claim a new slot and hide the overflow entry
+/// @param keys the expected number of distinct keys, e.g. the key count of all blocks
+template<typename K, typename V, typename Hasher>
+void Table<K, V, Hasher, TableKind::FLAT>::Reserve(size_t keys) {
+    auto n = std::bit_ceil(std::max(keys * 2, MIN_CAPACITY));
+    if (n <= capacity) return;
+    auto old = std::move(slots);
+    auto old_capacity = capacity;
+    slots.reset(new Slot[n]);
+    capacity = n;
+    for (size_t i = 0; i < old_capacity; ++i) {
+        auto k = old[i].key.load(std::memory_order_relaxed);
+        if (k == EMPTY) continue;
+        if constexpr (std::is_move_assignable_v<V>) {
+            auto slot = Find(k, true);
+            if (slot) {
+                slot->value = std::move(old[i].value);
+            } else {
+                overflow.Put(k, [&](V& v) { v = std::move(old[i].value); });
+            }
+        } else {
+            LOG(WARNING) << "flat table can not grow after insertion, keep capacity " << old_capacity;
+            slots = std::move(old);
+            capacity = old_capacity;
+            return;
+        }
+    }
+    if constexpr (std::is_move_assignable_v<V>) {
+        for (auto& partition : overflow.partitions) {
+            for (auto it = partition.begin(); it != partition.end();) {
+                auto slot = Find(it->first, true);
+                if (!slot) {
+                    ++it;
+                    continue;
+                }
+                slot->value = std::move(it->second);
+                it = partition.erase(it);
+            }
+        }
+    }
+}
+
+template<typename K, typename V, typename Hasher>
+typename Table<K, V, Hasher, TableKind::FLAT>::Slot*
+Table<K, V, Hasher, TableKind::FLAT>::Find(const K& k, bool insert) {
+    auto mask = capacity - 1;
+    auto idx = ((size_t)Hasher()(k)) & mask;
+    for (size_t probe = 0; probe < MAX_PROBE; ++probe, idx = (idx + 1) & mask) {
+        auto& slot = slots[idx];
+        auto cur = slot.key.load(std::memory_order_acquire);
+        if (cur == k) return &slot;
+        if (cur == EMPTY) {
+            // keys are never removed, so an empty slot ends the probe sequence
+            if (!insert) return nullptr;
+            if (slot.key.compare_exchange_strong(cur, k, std::memory_order_acq_rel)) return &slot;
+            if (cur == k) return &slot;
+        }
+    }
+    return nullptr;
+}
+
+template<typename K, typename V, typename Hasher>
+uint32_t Table<K, V, Hasher, TableKind::FLAT>::Lock(Slot& slot) {
+    auto version = slot.version.load(std::memory_order_relaxed);
+    while (true) {
+        if (!(version & 1) && slot.version.compare_exchange_weak(version, version + 1, std::memory_order_acquire)) {
+            return version;
+        }
+        version = slot.version.load(std::memory_order_relaxed);
+    }
+}
+
+template<typename K, typename V, typename Hasher>
+void Table<K, V, Hasher, TableKind::FLAT>::Unlock(Slot& slot, uint32_t version) {
+    slot.version.store(version + 2, std::memory_order_release);
+}
+
+template<typename K, typename V, typename Hasher>
+template<typename F>
+void Table<K, V, Hasher, TableKind::FLAT>::Get(const K& k, F&& vmap) {
+    DLOG(INFO) << "Get key: " << k;
+    auto slot = Find(k, false);
+    if (!slot) {
+        // a key only lives in the overflow table if its whole probe window is occupied
+        overflow.Get(k, std::forward<F>(vmap));
+        return;
+    }
+    if constexpr (std::is_trivially_copyable_v<V>) {
+        while (true) {
+            auto before = slot->version.load(std::memory_order_acquire);
+            if (before & 1) continue;
+            V snapshot = slot->value;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot->version.load(std::memory_order_relaxed) == before) {
+                vmap(std::as_const(snapshot));
+                return;
+            }
+        }
+    } else {
+        auto version = Lock(*slot);
+        vmap(std::as_const(slot->value));
+        Unlock(*slot, version);
+    }
+}
+
+template<typename K, typename V, typename Hasher>
+template<typename F>
+void Table<K, V, Hasher, TableKind::FLAT>::Put(const K& k, F&& vmap) {
+    DLOG(INFO) << "Put key: " << k;
+    auto slot = Find(k, true);
+    if (!slot) {
+        overflow.Put(k, std::forward<F>(vmap));
+        return;
+    }
+    auto version = Lock(*slot);
+    vmap(slot->value);
+    Unlock(*slot, version);
+}
+
 } // namespace spectrum
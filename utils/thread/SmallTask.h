@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/// @brief 只可移动的 void() 任务, 小对象直接构造在内联缓冲区中
+///        线程池中绝大多数任务只捕获几个指针, 不再为每个任务单独申请堆内存; 超过缓冲区的可调用对象退化为堆分配
+class SmallTask {
+    public:
+        // 内联缓冲区大小, 足以容纳捕获 packaged_task / shared_ptr 及若干指针的 lambda
+        static constexpr size_t INLINE_SIZE = 48;
+
+        SmallTask() noexcept = default;
+        SmallTask(std::nullptr_t) noexcept {}
+
+        template <typename F, typename = std::enable_if_t<
+            !std::is_same_v<std::decay_t<F>, SmallTask> && !std::is_same_v<std::decay_t<F>, std::nullptr_t>>>
+        SmallTask(F&& f) {
+            using Fn = std::decay_t<F>;
+            if constexpr (fitsInline<Fn>()) {
+                ::new (static_cast<void*>(m_storage)) Fn(std::forward<F>(f));
+                m_ops = &s_inlineOps<Fn>;
+            } else {
+                *reinterpret_cast<Fn**>(m_storage) = new Fn(std::forward<F>(f));
+                m_ops = &s_heapOps<Fn>;
+            }
+        }
+
+        SmallTask(SmallTask&& other) noexcept { moveFrom(other); }
+
+        SmallTask& operator=(SmallTask&& other) noexcept {
+            if (this != &other) {
+                reset();
+                moveFrom(other);
+            }
+            return *this;
+        }
+
+        SmallTask& operator=(std::nullptr_t) noexcept {
+            reset();
+            return *this;
+        }
+
+        SmallTask(const SmallTask&) = delete;
+        SmallTask& operator=(const SmallTask&) = delete;
+
+        ~SmallTask() { reset(); }
+
+        void operator()() { m_ops->invoke(m_storage); }
+
+        explicit operator bool() const noexcept { return m_ops != nullptr; }
+
+        void reset() noexcept {
+            if (m_ops) {
+                m_ops->destroy(m_storage);
+                m_ops = nullptr;
+            }
+        }
+
+    private:
+        struct Ops {
+            void (*invoke)(void*);
+            void (*move)(void* dst, void* src) noexcept;
+            void (*destroy)(void*) noexcept;
+        };
+
+        template <typename Fn>
+        static constexpr bool fitsInline() {
+            return sizeof(Fn) <= INLINE_SIZE && alignof(Fn) <= alignof(std::max_align_t)
+                && std::is_nothrow_move_constructible_v<Fn>;
+        }
+
+        template <typename Fn>
+        static constexpr Ops s_inlineOps = {
+            [](void* p) { (*static_cast<Fn*>(p))(); },
+            [](void* dst, void* src) noexcept {
+                ::new (dst) Fn(std::move(*static_cast<Fn*>(src)));
+                static_cast<Fn*>(src)->~Fn();
+            },
+            [](void* p) noexcept { static_cast<Fn*>(p)->~Fn(); }
+        };
+
+        template <typename Fn>
+        static constexpr Ops s_heapOps = {
+            [](void* p) { (**static_cast<Fn**>(p))(); },
+            [](void* dst, void* src) noexcept { *static_cast<Fn**>(dst) = *static_cast<Fn**>(src); },
+            [](void* p) noexcept { delete *static_cast<Fn**>(p); }
+        };
+
+        void moveFrom(SmallTask& other) noexcept {
+            if (other.m_ops) {
+                other.m_ops->move(m_storage, other.m_storage);
+                m_ops = other.m_ops;
+                other.m_ops = nullptr;
+            }
+        }
+
+        alignas(std::max_align_t) unsigned char m_storage[INLINE_SIZE];
+        const Ops* m_ops = nullptr;
+};
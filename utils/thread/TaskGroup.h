@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/// @brief 一组任务的倒计数闩锁, 代替逐个等待 future
+///        计数状态由任务共享持有, 等待者返回并销毁 TaskGroup 后仍在收尾的任务不会访问已释放内存
+class TaskGroup {
+    public:
+        TaskGroup() : m_state(std::make_shared<State>()) {}
+
+        TaskGroup(const TaskGroup&) = delete;
+        TaskGroup& operator=(const TaskGroup&) = delete;
+
+        // 登记 n 个待完成任务, 需在任务提交之前调用
+        void add(size_t n = 1) { m_state->count.fetch_add(n, std::memory_order_relaxed); }
+
+        // 标记 n 个任务完成; 持有状态的副本, 计数归零后等待者即可销毁 TaskGroup
+        void done(size_t n = 1) {
+            auto state = m_state;
+            state->done(n);
+        }
+
+        bool finished() const { return m_state->count.load(std::memory_order_acquire) == 0; }
+
+        /// @brief 等待所有任务完成, 先短暂自旋再休眠; 任务抛出的第一个异常在此重新抛出
+        void wait() {
+            for (int spin = 0; spin < 64 && !finished(); ++spin) {
+                std::this_thread::yield();
+            }
+            if (!finished()) {
+                std::unique_lock<std::mutex> lock(m_state->mutex);
+                m_state->cv.wait(lock, [this] { return finished(); });
+            }
+            rethrow();
+        }
+
+    private:
+        friend class ThreadPool;
+
+        struct State {
+            std::atomic<int64_t> count{0};
+            std::mutex mutex;
+            std::condition_variable cv;
+            std::exception_ptr error;
+
+            void done(size_t n) {
+                if (count.fetch_sub(n, std::memory_order_acq_rel) == int64_t(n)) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    cv.notify_all();
+                }
+            }
+
+            // 只保留第一个异常
+            void fail(std::exception_ptr e) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error) error = e;
+            }
+        };
+
+        void rethrow() {
+            std::exception_ptr e;
+            {
+                std::lock_guard<std::mutex> lock(m_state->mutex);
+                std::swap(e, m_state->error);
+            }
+            if (e) std::rethrow_exception(e);
+        }
+
+        std::shared_ptr<State> m_state;
+};
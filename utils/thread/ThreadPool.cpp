@@ -1,5 +1,8 @@
 #include "ThreadPool.h"
 #include <pthread.h>
+#include <sched.h>
+#include <cctype>
+#include <filesystem>
 #include <sstream>
 #include <iostream>
 #include <glog/logging.h>
@@ -54,23 +57,45 @@ void ThreadPool::PinRoundRobin(std::jthread& thread, unsigned rotate_id) {
     }
 }
 
+thread_local ThreadPool* ThreadPool::local_pool = nullptr;
+thread_local size_t ThreadPool::local_id = 0;
+
 /* 构造函数，创建指定数量的线程并让它们等待任务 - orig */
 ThreadPool::ThreadPool(size_t threadNum) : stop(false), threadDurations(threadNum), threadNum(threadNum), taskCounts(threadNum, 0) {
-    // 创建指定数量的线程
-    for(size_t i = 0; i < threadNum; ++i) {
-        stopFlags.push_back(false); // 初始化停止标志
-        // 将新创建的线程添加到线程池中
-        workers.emplace_back([this, i] { workerFunc(i); });
-        // 绑定线程到核心
-        DLOG(INFO) << "Binding thread-" << workers.back().get_id() << " to core " << i;
-        PinRoundRobin(workers[i], i);
-    }
+    start(threadNum, 0);
 }
 
 ThreadPool::ThreadPool(size_t threadNum, size_t offset) : stop(false), threadDurations(threadNum), threadNum(threadNum), taskCounts(threadNum, 0) {
+    start(threadNum, offset);
+}
+
+/// @brief create the local queues and the worker threads
+/// @param threadNum the number of threads
+/// @param offset the first core to pin
+void ThreadPool::start(size_t threadNum, size_t offset) {
+    this->offset = offset;
+    size_t capacity = std::max<size_t>(threadNum, std::thread::hardware_concurrency());
+    queues.reserve(capacity);
+    for (size_t i = 0; i < capacity; ++i) {
+        queues.push_back(std::make_unique<WorkerQueues>());
+    }
+    stopFlags = std::make_unique<std::atomic<bool>[]>(capacity);
+    // 读取各核心所在的 NUMA 节点, 读取失败时视为单节点
+    core_nodes.assign(std::max(1u, std::thread::hardware_concurrency()), 0);
+    for (size_t core = 0; core < core_nodes.size(); ++core) {
+        std::error_code ec;
+        std::filesystem::directory_iterator it("/sys/devices/system/cpu/cpu" + std::to_string(core), ec);
+        for (; !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+            auto name = it->path().filename().string();
+            if (name.size() > 4 && name.compare(0, 4, "node") == 0 && std::isdigit(static_cast<unsigned char>(name[4]))) {
+                core_nodes[core] = std::stoi(name.substr(4));
+                break;
+            }
+        }
+    }
     // 创建指定数量的线程
     for(size_t i = 0; i < threadNum; ++i) {
-        stopFlags.push_back(false); // 初始化停止标志
+        stopFlags[i] = false; // 初始化停止标志
         // 将新创建的线程添加到线程池中
         workers.emplace_back([this, i] { workerFunc(i); });
         // 绑定线程到核心
@@ -122,74 +147,169 @@ std::future<void> ThreadPool::enqueue(std::function<void()> task) {
 }
 */
 
+/// @brief push a task into one local queue
+void ThreadPool::push(size_t queue_id, Job&& job, TaskPriority priority) {
+    auto& local = *queues[queue_id];
+    if (priority == TaskPriority::HIGH_PRIORITY) {
+        local.high.push(std::move(job));
+    } else {
+        local.low.push(std::move(job));
+    }
+}
+
+/// @brief submit one task, tasks from a worker go to its own queue, others are spread round robin
+void ThreadPool::submit(Job&& job, TaskPriority priority) {
+    // 如果收到停止信号，就抛出异常
+    if (stop) throw std::runtime_error("enqueue on stopped ThreadPool");
+    // 先计数再入队, 取任务的线程看到的 pending 不会小于实际任务数
+    pending.fetch_add(1);
+    size_t queue_id = local_pool == this ? local_id : next_queue.fetch_add(1) % threadNum;
+    push(queue_id, std::move(job), priority);
+    wakeUp(1);
+}
+
+/// @brief submit one task to the local queue of a given worker
+void ThreadPool::submitTo(size_t queue_id, Job&& job, TaskPriority priority) {
+    if (stop) throw std::runtime_error("enqueue on stopped ThreadPool");
+    pending.fetch_add(1);
+    push(queue_id, std::move(job), priority);
+    wakeUp(1);
+}
+
+/// @brief default grain of parallelFor, about 8 chunks per participant
+size_t ThreadPool::autoGrain(size_t n) const {
+    size_t participants = threadNum.load() + 1;
+    return std::max<size_t>(1, n / (participants * 8));
+}
+
+/// @brief numa node of a worker, workers are pinned round robin from offset
+int ThreadPool::workerNode(size_t worker_id) const {
+    return core_nodes[(offset + worker_id) % core_nodes.size()];
+}
+
+/// @brief numa node of the calling thread
+int ThreadPool::callerNode() const {
+    int cpu = sched_getcpu();
+    return cpu >= 0 && size_t(cpu) < core_nodes.size() ? core_nodes[cpu] : 0;
+}
+
+/// @brief submit a batch of tasks, spread over all workers
+void ThreadPool::submitBatch(std::vector<Job>& jobs, TaskPriority priority) {
+    if (stop) throw std::runtime_error("enqueue on stopped ThreadPool");
+    pending.fetch_add(jobs.size());
+    size_t first = next_queue.fetch_add(jobs.size());
+    size_t num = threadNum;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        push((first + i) % num, std::move(jobs[i]), priority);
+    }
+    wakeUp(jobs.size());
+}
+
+/// @brief wake up sleeping workers
+void ThreadPool::wakeUp(size_t num) {
+    if (idle.load() == 0) return;
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    if (num == 1) {
+        condition.notify_one();
+    } else {
+        condition.notify_all();
+    }
+}
+
+/// @brief take a task: own high -> steal high -> own low -> steal low
+bool ThreadPool::pick(size_t worker_id, Job& job) {
+    size_t num = queues.size();
+    if (queues[worker_id]->high.tryPop(job)) return true;
+    for (size_t i = 1; i < num; ++i) {
+        if (queues[(worker_id + i) % num]->high.trySteal(job)) return true;
+    }
+    if (queues[worker_id]->low.tryPop(job)) return true;
+    for (size_t i = 1; i < num; ++i) {
+        if (queues[(worker_id + i) % num]->low.trySteal(job)) return true;
+    }
+    return false;
+}
+
+/// @brief wait for a task group, workers of this pool keep running queued tasks meanwhile
+void ThreadPool::wait(TaskGroup& group) {
+    if (local_pool == this) {
+        Job task;
+        while (!group.finished()) {
+            if (pick(local_id, task)) {
+                pending.fetch_sub(1);
+                task();
+                task = nullptr;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+    group.wait();
+}
+
 /// @brief worker function for each thread
 /// @param worker_id the id of the worker
 void ThreadPool::workerFunc(size_t worker_id) {
+    local_pool = this;
+    local_id = worker_id;
+    // 用于存储要从任务队列中取出的任务
+    Job task;
+    size_t spin = 0;
     while(true) { // 每个线程会无限循环这个函数，直到线程被停止
-        // 用于存储要从任务队列中取出的任务
-        std::function<void()> task;
-        // Task task;
-        {
-            // 锁住任务队列
-            std::unique_lock<std::mutex> lock(this->queue_mutex);
-            // 如果任务队列为空，就等待
-            // this->condition.wait(lock, [this]{ return this->stop || !this->tasks.empty(); });
-            condition.wait(lock, [this, worker_id] { 
-                return stop || stopFlags[worker_id] || !highPriorityTasks.empty() || !lowPriorityTasks.empty(); 
-            });
-            // 如果收到停止信号，并且任务队列为空，就退出循环
-            // if(this->stop && this->tasks.empty()) return;
-            if(this->stop && highPriorityTasks.empty() && lowPriorityTasks.empty()) return;
-
-            // 当前线程应该停止
-            if (stopFlags[worker_id]) return;
-
-            // 从任务队列中取出一个任务
-            // task = std::move(this->tasks.front());
-            // task = std::move(this->tasks.top());
-            if (!highPriorityTasks.empty()) {
-                // LOG(INFO) << "Task priority: HIGH";
-                task = highPriorityTasks.front();
-                highPriorityTasks.pop();
-            } else {
-                // LOG(INFO) << "Task priority: LOW";
-                task = lowPriorityTasks.front();
-                lowPriorityTasks.pop();
-            }
-            // 删除已经取出的任务
-            // this->tasks.pop();
+        if (pick(worker_id, task)) {
+            pending.fetch_sub(1);
+            spin = 0;
+            // execute task
+            task();
+            task = nullptr;
+            continue;
         }
-        // 后面可以用来统计线程利用率？
-        // auto start = std::chrono::high_resolution_clock::now();
-        // execute task
-        // LOG(INFO) << "Task priority: " << loom::taskPriorityToString(task.priority);
-        task();
-        // task.func();
-        // auto end = std::chrono::high_resolution_clock::now();
-        // threadDurations[i] += std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-        // taskCounts[i] += 1; // 更新任务计数
+        // 当前线程应该停止, 本地队列中剩余的任务由其它线程窃取
+        if (stopFlags[worker_id]) return;
+        // 仍有任务(可能正被其它线程持有队列锁)时短暂让出, 否则休眠
+        if (pending.load() > 0 && ++spin < 64) {
+            std::this_thread::yield();
+            continue;
+        }
+        spin = 0;
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        // 如果收到停止信号，并且任务队列为空，就退出循环
+        if (stop && pending.load() == 0) return;
+        idle.fetch_add(1);
+        condition.wait(lock, [this, worker_id] { 
+            return stop || stopFlags[worker_id] || pending.load() > 0; 
+        });
+        idle.fetch_sub(1);
     }
 }
 
 /// @brief resize the thread pool
 /// @param newSize the new size of the thread pool
 void ThreadPool::resizePool(size_t newSize) {
-    std::unique_lock<std::mutex> lock(queue_mutex);
-
     size_t currentSize = workers.size();
+    if (newSize > queues.size()) {
+        LOG(WARNING) << "resize thread pool to " << newSize << " exceeds queue capacity " << queues.size();
+        newSize = queues.size();
+    }
     if (newSize > currentSize) {
         // 增加线程
         for (size_t i = currentSize; i < newSize; ++i) {
-            stopFlags.push_back(false); // 初始化停止标志
+            stopFlags[i] = false; // 初始化停止标志
             workers.emplace_back([this, i] { workerFunc(i); });
-            PinRoundRobin(workers.back(), i);  // 绑定新的线程到物理核
+            PinRoundRobin(workers.back(), offset + i);  // 绑定新的线程到物理核
         }
+        threadNum = newSize;
     } else if (newSize < currentSize) {
+        // 先停止向被移除的线程分发任务
+        threadNum = newSize;
         // 减少线程，按顺序让后创建的线程退出
         for (size_t i = newSize; i < currentSize; ++i) {
             stopFlags[i] = true; // 设置停止标志
         }
-        condition.notify_all(); // 唤醒等待中的线程，让它们退出
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            condition.notify_all(); // 唤醒等待中的线程，让它们退出
+        }
 
         // 等待这些多余的线程结束
         for (size_t i = newSize; i < currentSize; ++i) {
@@ -198,9 +318,7 @@ void ThreadPool::resizePool(size_t newSize) {
         }
 
         workers.resize(newSize);
-        stopFlags.resize(newSize);
     }
-    threadNum = newSize;
     std::cout << "Resized thread pool to " << newSize << " threads." << std::endl;
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 #include <queue>
@@ -8,7 +9,12 @@
 #include <condition_variable>
 #include <functional>
 #include <future>
+#include <atomic>
 #include <loom/common/common.h>
+#include <iterator>
+#include <loom/utils/ThreadPool/Queue/UWorkStealingQueue.h>
+#include "SmallTask.h"
+#include "TaskGroup.h"
 
 using namespace loom;
 
@@ -67,67 +73,133 @@ class ThreadPool : public std::enable_shared_from_this<ThreadPool>
         auto enqueue(F&& f, Args&&... args, TaskPriority priority = TaskPriority::HIGH_PRIORITY) -> std::future<typename std::result_of<F(Args...)>::type> {
             using return_type = typename std::result_of<F(Args...)>::type;
 
-            // 创建一个packaged_task，它包装了你的任务
-            auto task = std::make_shared<std::packaged_task<return_type()>>(
+            // 创建一个packaged_task，它包装了你的任务; packaged_task 只可移动, 直接放入任务的内联缓冲区
+            std::packaged_task<return_type()> task(
                 std::bind(std::forward<F>(f), std::forward<Args>(args)...)
             );
 
             // 获取与packaged_task关联的future
-            std::future<return_type> future = task->get_future();
-            {
-                // 锁住任务队列
-                std::unique_lock<std::mutex> lock(queue_mutex);
-                // 如果收到停止信号，就抛出异常
-                if(stop) throw std::runtime_error("enqueue on stopped ThreadPool");
-                // 将任务添加到任务队列，按优先级插入
-                // tasks.push({priority, [task]() { (*task)(); }});
-                
-                // 根据优先级将任务放入不同的队列
-                if (priority == TaskPriority::HIGH_PRIORITY) {
-                    highPriorityTasks.push([task]() { (*task)(); });
-                } else {
-                    lowPriorityTasks.push([task]() { (*task)(); });
-                }
-            }
-            // 唤醒一个等待的线程
-            condition.notify_one();
+            std::future<return_type> future = task.get_future();
+            // 工作线程内提交放入本地队列, 外部提交轮询分发
+            submit(Job([task = std::move(task)]() mutable { task(); }), priority);
             return future;
         }
 
+        /// @brief 提交不需要返回值的任务, 不创建 packaged_task 与 future
+        template<class F>
+        void execute(F&& f, TaskPriority priority = TaskPriority::HIGH_PRIORITY) {
+            submit(Job(std::forward<F>(f)), priority);
+        }
+
         template<class F, class... Args>
         auto enqueueBatch(const std::vector<std::tuple<F, Args...>>& taskList, TaskPriority priority = TaskPriority::HIGH_PRIORITY) 
             -> std::vector<std::future<typename std::result_of<F(Args...)>::type>> {
             using return_type = typename std::result_of<F(Args...)>::type;
             std::vector<std::future<return_type>> futures;
             futures.reserve(taskList.size());  // 预先分配足够的空间
+            std::vector<Job> jobs;
+            jobs.reserve(taskList.size());
 
-            {
-                std::unique_lock<std::mutex> lock(queue_mutex);  // 锁住任务队列
+            for (const auto& taskTuple : taskList) {
+                // 创建一个packaged_task，将任务包装
+                std::packaged_task<return_type()> task(
+                    std::bind(std::get<0>(taskTuple), std::get<Args>(taskTuple)...)
+                );
 
-                // 如果线程池已经停止，抛出异常
-                if (stop) throw std::runtime_error("enqueue on stopped ThreadPool");
+                // 获取与packaged_task关联的future，并将其存储
+                futures.push_back(task.get_future());
+                jobs.emplace_back([task = std::move(task)]() mutable { task(); });
+            }
 
-                for (const auto& taskTuple : taskList) {
-                    // 创建一个packaged_task，将任务包装
-                    auto task = std::make_shared<std::packaged_task<return_type()>>(
-                        std::bind(std::get<0>(taskTuple), std::get<Args>(taskTuple)...)
-                    );
+            // 一次性分发到各工作线程的本地队列, 唤醒所有等待的线程
+            submitBatch(jobs, priority);
+            return futures;  // 返回future列表
+        }
 
-                    // 获取与packaged_task关联的future，并将其存储
-                    futures.push_back(task->get_future());
+        /// @brief 对 [first, last) 中每个元素并行调用 f(*it), 完成情况记录在 group 中
+        ///        不为每个元素创建任务与 future: 每个工作线程一个任务, 从共享游标按块领取下标
+        /// @param group 调用方持有的任务组, 通过 wait(group) 等待
+        template<class It, class F>
+        void enqueueBulk(TaskGroup& group, It first, It last, F&& f, TaskPriority priority = TaskPriority::HIGH_PRIORITY) {
+            static_assert(std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<It>::iterator_category>,
+                          "enqueueBulk requires random access iterators");
+            size_t n = std::distance(first, last);
+            if (n == 0) return;
+            size_t chunks = std::min<size_t>(n, std::max(threadNum.load(), 1));
+            // 每个线程约领取 8 次, 兼顾负载均衡与游标争用
+            size_t grain = std::max<size_t>(1, n / (chunks * 8));
+            auto bulk = std::make_shared<Bulk<It, std::decay_t<F>>>(first, n, grain, std::forward<F>(f), group.m_state);
+            group.add(n);
+            std::vector<Job> jobs;
+            jobs.reserve(chunks);
+            for (size_t i = 0; i < chunks; ++i) {
+                jobs.emplace_back([bulk]() { bulk->run(); });
+            }
+            submitBatch(jobs, priority);
+        }
 
-                    // 根据优先级将任务放入不同的队列
-                    if (priority == TaskPriority::HIGH_PRIORITY) {
-                        highPriorityTasks.push([task]() { (*task)(); });
-                    } else {
-                        lowPriorityTasks.push([task]() { (*task)(); });
-                    }
+        /// @brief 等待任务组完成; 在本线程池的工作线程中调用时边等待边执行队列中的任务, 嵌套提交不会占满线程
+        void wait(TaskGroup& group);
+
+        /// @brief 将下标区间 [begin, end) 按 grain 切块并行执行 fn(lo, hi), 调用线程同样参与计算, 返回时全部完成
+        ///        区间先静态切分为与参与者数目相同的连续片段, 同一 NUMA 节点上的线程分到相邻片段;
+        ///        自己的片段做完后按片段顺序窃取, 优先窃取同节点的片段
+        /// @param grain 每块的下标数, 为 0 时自动选择; 每次回调恰好对应一块
+        template<class F>
+        void parallelFor(size_t begin, size_t end, size_t grain, F&& fn, TaskPriority priority = TaskPriority::HIGH_PRIORITY) {
+            if (begin >= end) return;
+            size_t n = end - begin;
+            size_t workerNum = threadNum.load();
+            if (grain == 0) grain = autoGrain(n);
+            size_t chunks = (n + grain - 1) / grain;
+            size_t participants = std::min(workerNum + 1, chunks);
+            if (participants <= 1) {
+                for (size_t lo = begin; lo < end; lo += grain) {
+                    fn(lo, std::min(lo + grain, end));
                 }
+                return;
             }
-            
-            // 唤醒所有等待的线程，处理新任务
-            condition.notify_all();  
-            return futures;  // 返回future列表
+
+            TaskGroup group;
+            group.add(n);
+            auto range = std::make_shared<Range<std::decay_t<F>>>(begin, end, grain, chunks, participants, std::forward<F>(fn), group.m_state);
+            // 参与者按 NUMA 节点稳定排序, 排序后的位置即其负责的片段; 最后一个参与者是调用线程
+            std::vector<std::pair<int, size_t>> nodes;
+            nodes.reserve(participants);
+            for (size_t i = 0; i + 1 < participants; ++i) {
+                nodes.emplace_back(workerNode(i), i);
+            }
+            nodes.emplace_back(callerNode(), participants - 1);
+            std::stable_sort(nodes.begin(), nodes.end(), [](auto& a, auto& b) { return a.first < b.first; });
+            size_t callerSlice = 0;
+            for (size_t slice = 0; slice < participants; ++slice) {
+                size_t who = nodes[slice].second;
+                if (who == participants - 1) {
+                    callerSlice = slice;
+                } else {
+                    // 放入对应工作线程的本地队列, 让其处理与自己同节点的片段
+                    submitTo(who, Job([range, slice]() { range->run(slice); }), priority);
+                }
+            }
+            range->run(callerSlice);
+            wait(group);
+        }
+
+        /// @brief 并行归约: 每块计算 fn(lo, hi) 得到部分结果, 再按块顺序用 reduce 合并
+        ///        块的划分只取决于 grain, 合并顺序固定, 结果与线程数及调度无关
+        template<class V, class F, class R>
+        V parallelReduce(size_t begin, size_t end, size_t grain, V identity, F&& fn, R&& reduce, TaskPriority priority = TaskPriority::HIGH_PRIORITY) {
+            if (begin >= end) return identity;
+            if (grain == 0) grain = autoGrain(end - begin);
+            std::vector<V> partial((end - begin + grain - 1) / grain, identity);
+            parallelFor(begin, end, grain, [&](size_t lo, size_t hi) {
+                partial[(lo - begin) / grain] = fn(lo, hi);
+            }, priority);
+            V result = std::move(identity);
+            for (auto& value : partial) {
+                result = reduce(std::move(result), std::move(value));
+            }
+            return result;
         }
 
         const std::vector<std::chrono::microseconds>& getThreadDurations() const;
@@ -147,23 +219,124 @@ class ThreadPool : public std::enable_shared_from_this<ThreadPool>
         static void PinRoundRobin(std::jthread& thread, unsigned rotate_id);
 
     private:
-        
+        typedef SmallTask Job;
+
+        /// @brief enqueueBulk 的共享状态, 由该批次的所有任务共同持有
+        template<class It, class F>
+        struct Bulk {
+            It first;
+            size_t n;
+            size_t grain;
+            F func;
+            std::shared_ptr<TaskGroup::State> group;
+            std::atomic<size_t> cursor{0};
+
+            Bulk(It first, size_t n, size_t grain, F&& func, std::shared_ptr<TaskGroup::State> group)
+                : first(first), n(n), grain(grain), func(std::move(func)), group(std::move(group)) {}
+            Bulk(It first, size_t n, size_t grain, const F& func, std::shared_ptr<TaskGroup::State> group)
+                : first(first), n(n), grain(grain), func(func), group(std::move(group)) {}
+
+            void run() {
+                while (true) {
+                    size_t begin = cursor.fetch_add(grain, std::memory_order_relaxed);
+                    if (begin >= n) return;
+                    size_t end = std::min(begin + grain, n);
+                    for (size_t i = begin; i < end; ++i) {
+                        try {
+                            func(first[i]);
+                        } catch (...) {
+                            group->fail(std::current_exception());
+                        }
+                    }
+                    group->done(end - begin);
+                }
+            }
+        };
+
+        /// @brief 每个工作线程的本地任务队列, 按优先级分开; 本线程从队头取, 其它线程从队尾窃取
+        struct WorkerQueues {
+            Util::UWorkStealingQueue<Job> high;
+            Util::UWorkStealingQueue<Job> low;
+        };
+
+        /// @brief parallelFor 的一个静态片段(以块为单位), 独占缓存行避免游标伪共享
+        struct alignas(64) Slice {
+            std::atomic<size_t> cursor{0};
+            size_t end{0};
+        };
+
+        /// @brief parallelFor 的共享状态, 由调用线程与所有参与任务共同持有
+        template<class F>
+        struct Range {
+            size_t begin, end, grain;
+            size_t sliceNum;
+            F func;
+            std::unique_ptr<Slice[]> slices;
+            std::shared_ptr<TaskGroup::State> group;
+
+            template<class G>
+            Range(size_t begin, size_t end, size_t grain, size_t chunks, size_t sliceNum, G&& func, std::shared_ptr<TaskGroup::State> group)
+                : begin(begin), end(end), grain(grain), sliceNum(sliceNum), func(std::forward<G>(func)),
+                  slices(new Slice[sliceNum]), group(std::move(group)) {
+                for (size_t i = 0; i < sliceNum; ++i) {
+                    slices[i].cursor = i * chunks / sliceNum;
+                    slices[i].end = (i + 1) * chunks / sliceNum;
+                }
+            }
+
+            // 从第 first 个片段开始, 依次处理各片段中尚未领取的块
+            void run(size_t first) {
+                for (size_t k = 0; k < sliceNum; ++k) {
+                    auto& slice = slices[(first + k) % sliceNum];
+                    while (slice.cursor.load(std::memory_order_relaxed) < slice.end) {
+                        size_t chunk = slice.cursor.fetch_add(1, std::memory_order_relaxed);
+                        if (chunk >= slice.end) break;
+                        size_t lo = begin + chunk * grain;
+                        size_t hi = std::min(lo + grain, end);
+                        try {
+                            func(lo, hi);
+                        } catch (...) {
+                            group->fail(std::current_exception());
+                        }
+                        group->done(hi - lo);
+                    }
+                }
+            }
+        };
+
+        void start(size_t threadNum, size_t offset);
+        void submit(Job&& job, TaskPriority priority);
+        void submitTo(size_t queue_id, Job&& job, TaskPriority priority);
+        size_t autoGrain(size_t n) const;
+        int workerNode(size_t worker_id) const;
+        int callerNode() const;
+        void submitBatch(std::vector<Job>& jobs, TaskPriority priority);
+        void push(size_t queue_id, Job&& job, TaskPriority priority);
+        bool pick(size_t worker_id, Job& job);
+        void wakeUp(size_t num);
+
         std::vector<std::thread> workers;
-        // std::queue<std::function<void()>> tasks;
-        // std::priority_queue<Task> tasks;
-        std::queue<std::function<void()>> highPriorityTasks; // 高优先级任务队列
-        std::queue<std::function<void()>> lowPriorityTasks;  // 低优先级任务队列
+        // 队列数量在构造时确定(不少于硬件线程数), 工作线程并发窃取时不会重新分配
+        std::vector<std::unique_ptr<WorkerQueues>> queues;
 
         std::mutex queue_mutex;
         std::condition_variable condition;
-        bool stop;
-        
+        std::atomic<bool> stop;
+        std::atomic<int64_t> pending{0};        // 已提交未取走的任务数
+        std::atomic<size_t> idle{0};            // 休眠中的线程数
+        std::atomic<size_t> next_queue{0};      // 外部提交时的轮询位置
+        size_t offset{0};                       // 绑核起始位置
+        std::vector<int> core_nodes;            // 每个核心所在的 NUMA 节点
+
+        // 当前线程所属的线程池及其编号, 用于把任务内部提交的子任务放入本地队列
+        static thread_local ThreadPool* local_pool;
+        static thread_local size_t local_id;
 
         // 线程统计信息
         std::vector<std::chrono::microseconds> threadDurations; // 存储每个线程的工作时间
         std::vector<size_t> taskCounts; // 新增成员变量存储任务计数
-        int threadNum;
-        std::vector<bool> stopFlags;            // 每个线程的停止标志
+        std::atomic<int> threadNum;
+        std::unique_ptr<std::atomic<bool>[]> stopFlags;  // 每个线程的停止标志
 
         /*
         // 线程池中的工作线程
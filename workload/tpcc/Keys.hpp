@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include "common/Key.h"
+
+namespace TPCC {
+
+/// @brief TPCC 各行(列组)对应的表标签, 编码在键的高 8 位
+///        不同形状的同名键(如 OL-w-d 与 OL-w-d-o-i)使用不同的标签, 与原字符串键一一对应
+enum class Table : uint8_t {
+    WAREHOUSE_TAX = 1,      // Wtax-w
+    DISTRICT_TAX,           // Dtax-w-d
+    DISTRICT_NEXT_O_ID,     // DnextOId-w-d
+    DISTRICT_YTD,           // Dytd-w-d
+    DISTRICT,               // D-w-d
+    NEW_ORDER,              // NO-w-d-o
+    NEW_ORDER_WD,           // NO-w-d
+    ORDER,                  // O-w-d-o-c
+    ORDER_WDC,              // O-w-d-c
+    ITEM,                   // I-i
+    ORDER_LINE,             // OL-w-d-o-n
+    ORDER_LINE_WDO,         // OL-w-d-o
+    ORDER_LINE_WD,          // OL-w-d
+    OL_DELIVERY,            // OLdelivery-w-d-o-n
+    OL_DELIVERY_WD,         // OLdelivery-w-d
+    STOCK,                  // S-w-i
+    STOCK_QTYS,             // Sqtys-w-i
+    CUSTOMER,               // C-w-d-c
+    CUSTOMER_DISCOUNT,      // Cdiscount-w-d-c
+    CUSTOMER_BALANCE,       // Cbalance-w-d-c
+    CUSTOMER_DELIVERY,      // Cdelivery-w-d-c
+    HISTORY,                // H-w-d-c
+};
+
+namespace Keys {
+
+using loom::Key;
+using loom::makeKey;
+
+// 仅含仓库
+inline constexpr Key warehouse(Table t, uint64_t w) { return makeKey(uint8_t(t), w); }
+// 仓库-地区
+inline constexpr Key district(Table t, uint64_t w, uint64_t d) { return makeKey(uint8_t(t), w, d); }
+// 仓库-地区-订单
+inline constexpr Key order(Table t, uint64_t w, uint64_t d, uint64_t o) { return makeKey(uint8_t(t), w, d, o); }
+// 仓库-地区-订单-(客户/订单行号)
+inline constexpr Key order(Table t, uint64_t w, uint64_t d, uint64_t o, uint64_t x) { return makeKey(uint8_t(t), w, d, o, x); }
+// 仓库-地区-客户
+inline constexpr Key customer(Table t, uint64_t w, uint64_t d, uint64_t c) { return makeKey(uint8_t(t), w, d, 0, c); }
+// (仓库)-商品
+inline constexpr Key item(Table t, uint64_t w, uint64_t i) { return makeKey(uint8_t(t), w, 0, i); }
+
+/// @brief 获取键所属的表
+inline constexpr Table table(Key key) { return Table(loom::keyTag(key)); }
+
+}
+
+/// @brief 判断键是否属于需要构建回滚索引的表 (原 "Dytd-", "S-", "Cdelivery-" 前缀)
+inline constexpr bool isRollbackIndexed(loom::Key key) {
+    auto t = Keys::table(key);
+    return t == Table::DISTRICT_YTD || t == Table::STOCK || t == Table::CUSTOMER_DELIVERY;
+}
+
+}
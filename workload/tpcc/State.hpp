@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <map>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+#include "Define.h"
+
+namespace TPCC {
+
+struct OrderInfo {
+    uint64_t o_id;
+    uint64_t o_ol_cnt;
+    int64_t o_c_id;
+};
+
+struct OrderLineInfo {
+    uint64_t o_id;
+    uint64_t ol_i_id;
+    int ol_number;
+};
+
+/// @brief 单个地区的生成状态
+struct DistrictState {
+    uint64_t next_o_id = 1;                                 // 下一个订单号
+    uint64_t orderLineCounter = 0;                          // 已生成的订单行数
+    std::vector<OrderLineInfo> latestOrderLines;            // 最近20条订单行, 写满后循环覆盖最旧的一条
+    std::queue<OrderInfo> oldestNewOrder;                   // 尚未配送的订单, 队首为最旧的订单
+    std::unordered_map<int64_t, OrderInfo> latestOrder;     // 各顾客最近的订单, format: (c_id, {o_id, o_ol_cnt, o_c_id})
+};
+
+/// @brief 单个仓库的生成状态
+struct WarehouseState {
+    std::array<DistrictState, N_DISTRICTS> districts;
+    std::map<size_t, int> ol_i_id_num;                      // 测试订单行出现频率
+};
+
+/// @brief TPCC 事务生成状态, 按仓库分片
+///        每笔事务只读写所属仓库的分片, 不同仓库的事务可以并行生成, 同一仓库内需按事务序号串行生成
+class State {
+    public:
+        State() {reset();}
+
+        /// @brief 按当前仓库数重建全部分片, 需在生成开始前串行调用
+        void reset() {m_warehouses.assign(N_WAREHOUSES, WarehouseState{});}
+
+        /// @brief 获取仓库分片; 分片数在构造或 reset 时确定, 并行生成期间不会改变
+        WarehouseState& warehouse(uint64_t w_id) {
+            assert(w_id >= 1 && w_id <= m_warehouses.size());
+            return m_warehouses[w_id - 1];
+        }
+
+        DistrictState& district(uint64_t w_id, uint64_t d_id) {return warehouse(w_id).districts[d_id - 1];}
+
+        size_t size() const {return m_warehouses.size();}
+
+        /// @brief 未指定状态的生成器共用的状态, 只在串行构造事务时取用;
+        ///        仓库数在创建后被调大时在此补齐分片, 已有分片保持不变
+        static State& shared() {
+            static State state;
+            if (state.m_warehouses.size() < N_WAREHOUSES) state.m_warehouses.resize(N_WAREHOUSES);
+            return state;
+        }
+
+    private:
+        std::vector<WarehouseState> m_warehouses;
+};
+
+}
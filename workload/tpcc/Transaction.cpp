@@ -43,22 +43,3 @@ static auto init_data = [] {
 const std::array<std::string, 3000> TPCCTransaction::c_lasts = init_data.first;
 const std::unordered_map<std::string, std::vector<int32_t>> TPCCTransaction::c_last_to_c_id = init_data.second;
 
-
-// 定义静态变量
-std::unordered_map<std::string, TPCCTransaction::OrderInfo> TPCCTransaction::wdc_latestOrder;
-std::unordered_map<std::string, std::queue<TPCCTransaction::OrderInfo>> TPCCTransaction::wd_oldestNewOrder;
-std::unordered_map<std::string, std::vector<TPCCTransaction::OrderLineInfo>> TPCCTransaction::wd_latestOrderLines;
-
-// 定义并初始化order_counters的每个元素
-std::array<std::atomic<uint64_t>, 10> TPCCTransaction::order_counters;
-static auto _ = [] {
-    for(auto& counter : TPCCTransaction::order_counters) {
-        counter.store(1);
-    }
-    return 0;
-}();
-
-// uint64_t TPCCTransaction::wd_orderLineCounters[TPCC::N_WAREHOUSES][TPCC::N_DISTRICTS];
-std::vector<std::vector<uint64_t>> TPCCTransaction::wd_orderLineCounters(TPCC::N_WAREHOUSES, std::vector<uint64_t>(TPCC::N_DISTRICTS));
-
-std::map<size_t, int> TPCCTransaction::ol_i_id_num;
\ No newline at end of file
@@ -10,6 +10,9 @@
 #include <map>
 #include "Random.hpp"
 #include "Define.h"
+#include "Keys.hpp"
+#include "State.hpp"
+#include "common/KeySet.h"
 #include "common/common.h"
 #include "utils/UConditionalOutputStream.h"
 
@@ -31,33 +34,27 @@ class TPCCTransaction : public std::enable_shared_from_this<TPCCTransaction>
             loom::DependencyType dependency;
         };
 
-        struct OrderInfo {
-            uint64_t o_id;
-            uint64_t o_ol_cnt;
-            int64_t o_c_id;
-        };
-
-        struct OrderLineInfo {
-            uint64_t o_id;
-            uint64_t ol_i_id;
-            int ol_number;
-        };
+        typedef TPCC::OrderInfo OrderInfo;
+        typedef TPCC::OrderLineInfo OrderLineInfo;
 
         // 随机
         // TPCCTransaction(): random(reinterpret_cast<uint64_t>(this)) {}
-        TPCCTransaction(Random& random): random(random) {}
+        // 生成器读写 state 中的订单状态, 未指定时使用共用状态
+        TPCCTransaction(Random& random, TPCC::State& state = TPCC::State::shared()): random(random), state(state) {}
 
         ~TPCCTransaction() = default;
 
         // 定义虚函数，生成事务
         virtual TPCCTransaction::Ptr makeTransaction() {}
 
-        // 原子地增加计数器，并返回增加后的值 
-        // 带测试？ 这个值不会每次初始化都是1吧？
-        uint64_t increment_order(int idx = 0) {return order_counters[idx].fetch_add(1, std::memory_order_relaxed);}
+        // 指定生成事务所属的仓库, 为 0 时随机选择
+        void setWarehouse(uint64_t w_id) {m_w_id = w_id;}
+
+        // 增加地区的订单计数器，并返回增加前的值
+        uint64_t increment_order(uint64_t w_id, uint64_t d_id) {return state.district(w_id, d_id).next_o_id++;}
 
-        // 获取当前计数器的值
-        const uint64_t get_order(int idx = 0) const {return order_counters[idx].load(std::memory_order_relaxed);}
+        // 获取地区订单计数器的值
+        const uint64_t get_order(uint64_t w_id, uint64_t d_id) const {return state.district(w_id, d_id).next_o_id;}
 
         // 获取交易执行时间
         const int getExecutionTime() const {return executionTime;}
@@ -72,16 +69,16 @@ class TPCCTransaction : public std::enable_shared_from_this<TPCCTransaction>
         const std::vector<ChildTransaction>& getChildren() const {return children;}
 
         // add readRows
-        void addReadRow(const std::string &row) {readRows.insert(row);}
+        void addReadRow(loom::Key row) {readRows.insert(row);}
 
         // get readRows
-        const unordered_set<std::string>& getReadRows() const {return readRows;}
+        const loom::KeySet& getReadRows() const {return readRows;}
 
         // add updateRows
-        void addUpdateRow(const std::string &row) {updateRows.insert(row);}
+        void addUpdateRow(loom::Key row) {updateRows.insert(row);}
 
         // get updateRows
-        const unordered_set<std::string>& getUpdateRows() const {return updateRows;}
+        const loom::KeySet& getUpdateRows() const {return updateRows;}
 
         // add sibling transaction
         void addSibling(TPCCTransaction::Ptr sibling) {siblings.push_back(sibling);}
@@ -95,24 +92,7 @@ class TPCCTransaction : public std::enable_shared_from_this<TPCCTransaction>
         // get transaction type
         const TPCC::TransactionType getType() const {return m_type;}
 
-        static std::array<std::atomic<uint64_t>, 10> order_counters;   // order counter
-
-        void resetStatic() {
-            // wdc_latestOrder
-            wdc_latestOrder.clear();
-            wd_oldestNewOrder.clear();
-            wd_latestOrderLines.clear();
-            for(auto& counter : TPCCTransaction::order_counters) {
-                counter.store(1);
-            }
-            // wd_orderLineCounters
-            wd_orderLineCounters.resize(TPCC::N_WAREHOUSES, std::vector<uint64_t>(TPCC::N_DISTRICTS));
-            for (int i = 0; i < TPCC::N_WAREHOUSES; i++) {
-                for (int j = 0; j < TPCC::N_DISTRICTS; j++) {
-                    wd_orderLineCounters[i][j] = 0;
-                }
-            }
-        }
+        void resetState() {state.reset();}
 
         void printCustomerInfo() {
             coutConditional << "c_lasts: ";
@@ -124,6 +104,12 @@ class TPCCTransaction : public std::enable_shared_from_this<TPCCTransaction>
 
         // 打印订单行频率
         void printOrderLineInfo() {
+            std::map<size_t, int> ol_i_id_num;
+            for (size_t w_id = 1; w_id <= state.size(); w_id++) {
+                for (auto& it : state.warehouse(w_id).ol_i_id_num) {
+                    ol_i_id_num[it.first] += it.second;
+                }
+            }
             coutConditional << "ol_i_id_num: " << endl;
             for (auto& it : ol_i_id_num) {
                 coutConditional << it.first << ":" << it.second << "\t";
@@ -132,26 +118,23 @@ class TPCCTransaction : public std::enable_shared_from_this<TPCCTransaction>
         }
 
         Random& random;                                          // random generator
+        TPCC::State& state;                                      // order state, sharded by warehouse
     protected:
-        
-// 静态变量 待测试...
+        // 生成器所属的仓库, 指定时不再随机选择
+        uint64_t warehouseId() {return m_w_id ? m_w_id : random.uniform_dist(1, TPCC::N_WAREHOUSES);}
+
         static const std::array<std::string, 3000> c_lasts;     // const last name
         static const std::unordered_map<std::string, std::vector<int32_t>> c_last_to_c_id;      // last name to customer id
-        static std::unordered_map<std::string, OrderInfo> wdc_latestOrder;                      // format: (w_id-d_id-c_id, {o_id, o_ol_cnt})
-        static std::unordered_map<std::string, std::queue<OrderInfo>> wd_oldestNewOrder;        // format: (w_id-d_id, {o_id, o_c_id, o_ol_cnt})
-        static std::unordered_map<std::string, std::vector<OrderLineInfo>> wd_latestOrderLines; // format: (d_id, [{o_id, ol_i_id}, ...])
-        // static uint64_t wd_orderLineCounters[TPCC::N_WAREHOUSES][TPCC::N_DISTRICTS];            // warehouse-distirct orderLine counter
-        static std::vector<std::vector<uint64_t>> wd_orderLineCounters;
-        static std::map<size_t, int> ol_i_id_num; // 测试订单行出现频率
 
         // tx operations
-        unordered_set<std::string> readRows;                    // read rows
-        unordered_set<std::string> updateRows;                  // update rows
+        loom::KeySet readRows;                                  // read rows
+        loom::KeySet updateRows;                                // update rows
         // tx structure
         std::vector<ChildTransaction> children;                 // child transactions
         std::vector<TPCCTransaction::Ptr> siblings;                 // sibling transactions
         int executionTime = TPCC::ConsumptionType::MEDIUM;      // execution time
         TPCC::TransactionType m_type;                             // transaction type
+        uint64_t m_w_id = 0;                                    // preset warehouse of generator
 };
 
 class NewOrderTransaction : public TPCCTransaction
@@ -159,14 +142,14 @@ class NewOrderTransaction : public TPCCTransaction
     public:
         typedef std::shared_ptr<NewOrderTransaction> Ptr;
         // NewOrderTransaction() = default;
-        NewOrderTransaction(Random& random) : TPCCTransaction(random) {};
+        NewOrderTransaction(Random& random, TPCC::State& state = TPCC::State::shared()) : TPCCTransaction(random, state) {};
         ~NewOrderTransaction() = default;
 
         // 构造NewOrder事务生成所需参数
         NewOrderTransaction::Ptr makeNewOrder() {
-            NewOrderTransaction::Ptr newOrderTx = std::make_shared<NewOrderTransaction>(random);
+            NewOrderTransaction::Ptr newOrderTx = std::make_shared<NewOrderTransaction>(random, state);
             // NewOrder主键ID
-            newOrderTx->w_id = random.uniform_dist(1, TPCC::N_WAREHOUSES);
+            newOrderTx->w_id = warehouseId();
             newOrderTx->d_id = random.uniform_dist(1, TPCC::N_DISTRICTS);
             newOrderTx->c_id = random.non_uniform_distribution(1023, 1, TPCC::N_CUSTOMERS);
             newOrderTx->o_ol_cnt = random.uniform_dist(5, 15);
@@ -213,22 +196,23 @@ class NewOrderTransaction : public TPCCTransaction
                 7. 计算总金额：total_amount = sum(ol_amount)*（1-c_discount）*(1+w_tax+d_tax)
             */
             // 根事务
-            TPCCTransaction::Ptr root = std::make_shared<TPCCTransaction>(random);
+            TPCCTransaction::Ptr root = std::make_shared<TPCCTransaction>(random, state);
             root->setType(TPCC::TransactionType::NEW_ORDER);
             root->setExecutionTime(TPCC::ConsumptionType::LOW);
             
             // warehouse子事务
-            TPCCTransaction::Ptr wAccess = std::make_shared<TPCCTransaction>(random);
-            wAccess->addReadRow("Wtax-" + std::to_string(newOrderTx->w_id));
+            TPCCTransaction::Ptr wAccess = std::make_shared<TPCCTransaction>(random, state);
+            wAccess->addReadRow(TPCC::Keys::warehouse(TPCC::Table::WAREHOUSE_TAX, newOrderTx->w_id));
             
             // district子事务
-            TPCCTransaction::Ptr dAccess = std::make_shared<TPCCTransaction>(random);
-            dAccess->addReadRow("Dtax-" + std::to_string(newOrderTx->w_id) + "-" + std::to_string(newOrderTx->d_id));
-            dAccess->addUpdateRow("DnextOId-" + std::to_string(newOrderTx->w_id) + "-" + std::to_string(newOrderTx->d_id));
+            TPCCTransaction::Ptr dAccess = std::make_shared<TPCCTransaction>(random, state);
+            dAccess->addReadRow(TPCC::Keys::district(TPCC::Table::DISTRICT_TAX, newOrderTx->w_id, newOrderTx->d_id));
+            dAccess->addUpdateRow(TPCC::Keys::district(TPCC::Table::DISTRICT_NEXT_O_ID, newOrderTx->w_id, newOrderTx->d_id));
             
 
             // 获取下一个订单号
-            uint64_t next_o_id = increment_order(newOrderTx->d_id - 1);
+            auto& district = state.district(newOrderTx->w_id, newOrderTx->d_id);
+            uint64_t next_o_id = district.next_o_id++;
             // coutConditional << "In NewOrderTransaction, w_id = " << newOrderTx->w_id
             //      << " d_id = " << newOrderTx->d_id 
             //      << " next_o_id = " << next_o_id 
@@ -241,38 +225,38 @@ class NewOrderTransaction : public TPCCTransaction
             // coutConditional << endl;
             
             // newOrder子事务
-            TPCCTransaction::Ptr noAccess = std::make_shared<TPCCTransaction>(random);
-            noAccess->addReadRow("NO-" + std::to_string(newOrderTx->w_id) + "-" + std::to_string(newOrderTx->d_id) + "-" + std::to_string(next_o_id));
+            TPCCTransaction::Ptr noAccess = std::make_shared<TPCCTransaction>(random, state);
+            noAccess->addReadRow(TPCC::Keys::order(TPCC::Table::NEW_ORDER, newOrderTx->w_id, newOrderTx->d_id, next_o_id));
             // noAccess->addUpdateRow("NO-" + std::to_string(newOrderTx->w_id) + "-" + std::to_string(newOrderTx->d_id) + "-" + std::to_string(next_o_id));
-            noAccess->addUpdateRow("NO-" + std::to_string(newOrderTx->w_id) + "-" + std::to_string(newOrderTx->d_id));
+            noAccess->addUpdateRow(TPCC::Keys::district(TPCC::Table::NEW_ORDER_WD, newOrderTx->w_id, newOrderTx->d_id));
             
             // order子事务
-            TPCCTransaction::Ptr oAccess = std::make_shared<TPCCTransaction>(random);
-            oAccess->addUpdateRow("O-" + std::to_string(newOrderTx->w_id) + "-" + std::to_string(newOrderTx->d_id) + "-" + std::to_string(next_o_id) + "-" + std::to_string(newOrderTx->c_id));
+            TPCCTransaction::Ptr oAccess = std::make_shared<TPCCTransaction>(random, state);
+            oAccess->addUpdateRow(TPCC::Keys::order(TPCC::Table::ORDER, newOrderTx->w_id, newOrderTx->d_id, next_o_id, newOrderTx->c_id));
             // oAccess->addReadRow("O-" + std::to_string(newOrderTx->w_id) + "-" + std::to_string(newOrderTx->d_id) + "-" + std::to_string(next_o_id) + "-" + std::to_string(newOrderTx->c_id));
             
             // items子事务
-            TPCCTransaction::Ptr itemsAccess = std::make_shared<TPCCTransaction>(random);
+            TPCCTransaction::Ptr itemsAccess = std::make_shared<TPCCTransaction>(random, state);
             itemsAccess->setExecutionTime(TPCC::ConsumptionType::HIGH);
             
             // /*
             for (auto i = 0; i < newOrderTx->o_ol_cnt; i++) {
 
-                ol_i_id_num[newOrderTx->orderLines[i].ol_i_id]++;
+                state.warehouse(newOrderTx->w_id).ol_i_id_num[newOrderTx->orderLines[i].ol_i_id]++;
 
                 // item子事务
-                TPCCTransaction::Ptr iAccess = std::make_shared<TPCCTransaction>(random);
-                iAccess->addReadRow("I-" + std::to_string(newOrderTx->orderLines[i].ol_i_id));
+                TPCCTransaction::Ptr iAccess = std::make_shared<TPCCTransaction>(random, state);
+                iAccess->addReadRow(TPCC::Keys::item(TPCC::Table::ITEM, 0, newOrderTx->orderLines[i].ol_i_id));
                 
                 // orderLine子事务
-                TPCCTransaction::Ptr olAccess = std::make_shared<TPCCTransaction>(random);
-                olAccess->addReadRow("OL-" + std::to_string(newOrderTx->w_id) + "-" + std::to_string(newOrderTx->d_id) + "-" + std::to_string(next_o_id) + "-" + std::to_string(i));
-                olAccess->addUpdateRow("OL-" + std::to_string(newOrderTx->w_id) + "-" + std::to_string(newOrderTx->d_id) + "-" + std::to_string(next_o_id) + "-" + std::to_string(i));
+                TPCCTransaction::Ptr olAccess = std::make_shared<TPCCTransaction>(random, state);
+                olAccess->addReadRow(TPCC::Keys::order(TPCC::Table::ORDER_LINE, newOrderTx->w_id, newOrderTx->d_id, next_o_id, i));
+                olAccess->addUpdateRow(TPCC::Keys::order(TPCC::Table::ORDER_LINE, newOrderTx->w_id, newOrderTx->d_id, next_o_id, i));
                 
                 // stock子事务
-                TPCCTransaction::Ptr sAccess = std::make_shared<TPCCTransaction>(random);
-                sAccess->addReadRow("S-" + std::to_string(newOrderTx->orderLines[i].ol_supply_w_id) + "-" + std::to_string(newOrderTx->orderLines[i].ol_i_id));
-                sAccess->addUpdateRow("S-" + std::to_string(newOrderTx->orderLines[i].ol_supply_w_id) + "-" + std::to_string(newOrderTx->orderLines[i].ol_i_id));
+                TPCCTransaction::Ptr sAccess = std::make_shared<TPCCTransaction>(random, state);
+                sAccess->addReadRow(TPCC::Keys::item(TPCC::Table::STOCK, newOrderTx->orderLines[i].ol_supply_w_id, newOrderTx->orderLines[i].ol_i_id));
+                sAccess->addUpdateRow(TPCC::Keys::item(TPCC::Table::STOCK, newOrderTx->orderLines[i].ol_supply_w_id, newOrderTx->orderLines[i].ol_i_id));
         
                 // item子事务添加依赖
                 iAccess->addChild(sAccess, loom::DependencyType::WEAK);
@@ -282,15 +266,14 @@ class NewOrderTransaction : public TPCCTransaction
                 //    判断是否超过20条：
                 //     若没超过20条，则直接添加
                 //     若超过20条，则删除最旧的一条 => 覆盖最旧的一条 
-                auto wd_key = std::to_string(newOrderTx->w_id) + "-" + std::to_string(newOrderTx->d_id);
-                if (wd_orderLineCounters[newOrderTx->w_id - 1][newOrderTx->d_id - 1] < 20) {
-                    wd_latestOrderLines[wd_key].push_back({next_o_id, newOrderTx->orderLines[i].ol_i_id, i});
+                if (district.orderLineCounter < 20) {
+                    district.latestOrderLines.push_back({next_o_id, newOrderTx->orderLines[i].ol_i_id, i});
                 } else {
-                    wd_latestOrderLines[wd_key][wd_orderLineCounters[newOrderTx->w_id - 1][newOrderTx->d_id - 1] % 20] = {next_o_id, newOrderTx->orderLines[i].ol_i_id, i};
+                    district.latestOrderLines[district.orderLineCounter % 20] = {next_o_id, newOrderTx->orderLines[i].ol_i_id, i};
                 }
-                // coutConditional << "In neworderTx, wd_orderLineCounters[" << newOrderTx->d_id << "] = " << wd_orderLineCounters[newOrderTx->w_id - 1][newOrderTx->d_id - 1] << endl;
+                // coutConditional << "In neworderTx, orderLineCounter[" << newOrderTx->d_id << "] = " << district.orderLineCounter << endl;
 
-                wd_orderLineCounters[newOrderTx->w_id - 1][newOrderTx->d_id - 1]++;
+                district.orderLineCounter++;
 
                 // items子事务添加依赖
                 itemsAccess->addChild(iAccess, loom::DependencyType::STRONG);
@@ -299,10 +282,10 @@ class NewOrderTransaction : public TPCCTransaction
 
 /*
             // orderLine子事务
-            TPCCTransaction::Ptr olAccess = std::make_shared<TPCCTransaction>(random);
+            TPCCTransaction::Ptr olAccess = std::make_shared<TPCCTransaction>(random, state);
             olAccess->setExecutionTime(TPCC::ConsumptionType::HIGH);
             // stock子事务
-            TPCCTransaction::Ptr sAccess = std::make_shared<TPCCTransaction>(random);
+            TPCCTransaction::Ptr sAccess = std::make_shared<TPCCTransaction>(random, state);
             sAccess->setExecutionTime(TPCC::ConsumptionType::HIGH);
 
             for (auto i = 0; i < newOrderTx->o_ol_cnt; i++) {
@@ -310,13 +293,13 @@ class NewOrderTransaction : public TPCCTransaction
                 // ol_i_id_num[newOrderTx->orderLines[i].ol_i_id]++;
 
                 // item子事务读写集
-                itemsAccess->addReadRow("I-" + std::to_string(newOrderTx->orderLines[i].ol_i_id));
+                itemsAccess->addReadRow(TPCC::Keys::item(TPCC::Table::ITEM, 0, newOrderTx->orderLines[i].ol_i_id));
                 
-                olAccess->addReadRow("OL-" + std::to_string(newOrderTx->w_id) + "-" + std::to_string(newOrderTx->d_id) + "-" + std::to_string(next_o_id) + "-" + std::to_string(i));
-                olAccess->addUpdateRow("OL-" + std::to_string(newOrderTx->w_id) + "-" + std::to_string(newOrderTx->d_id) + "-" + std::to_string(next_o_id) + "-" + std::to_string(i));
+                olAccess->addReadRow(TPCC::Keys::order(TPCC::Table::ORDER_LINE, newOrderTx->w_id, newOrderTx->d_id, next_o_id, i));
+                olAccess->addUpdateRow(TPCC::Keys::order(TPCC::Table::ORDER_LINE, newOrderTx->w_id, newOrderTx->d_id, next_o_id, i));
 
-                sAccess->addReadRow("S-" + std::to_string(newOrderTx->orderLines[i].ol_supply_w_id) + "-" + std::to_string(newOrderTx->orderLines[i].ol_i_id));
-                sAccess->addUpdateRow("S-" + std::to_string(newOrderTx->orderLines[i].ol_supply_w_id) + "-" + std::to_string(newOrderTx->orderLines[i].ol_i_id));
+                sAccess->addReadRow(TPCC::Keys::item(TPCC::Table::STOCK, newOrderTx->orderLines[i].ol_supply_w_id, newOrderTx->orderLines[i].ol_i_id));
+                sAccess->addUpdateRow(TPCC::Keys::item(TPCC::Table::STOCK, newOrderTx->orderLines[i].ol_supply_w_id, newOrderTx->orderLines[i].ol_i_id));
                 
                 auto wd_key = std::to_string(newOrderTx->w_id) + "-" + std::to_string(newOrderTx->d_id);
                 if (wd_orderLineCounters[newOrderTx->w_id - 1][newOrderTx->d_id - 1] < 20) {
@@ -339,8 +322,8 @@ class NewOrderTransaction : public TPCCTransaction
             dAccess->addChild(itemsAccess, loom::DependencyType::STRONG);
 
             // customer子事务
-            TPCCTransaction::Ptr cAccess = std::make_shared<TPCCTransaction>(random);
-            cAccess->addReadRow("Cdiscount-" + std::to_string(newOrderTx->w_id) + "-" + std::to_string(newOrderTx->d_id) + "-" + std::to_string(newOrderTx->c_id));
+            TPCCTransaction::Ptr cAccess = std::make_shared<TPCCTransaction>(random, state);
+            cAccess->addReadRow(TPCC::Keys::customer(TPCC::Table::CUSTOMER_DISCOUNT, newOrderTx->w_id, newOrderTx->d_id, newOrderTx->c_id));
             // cAccess->addReadRow("C-" + std::to_string(newOrderTx->w_id) + "-" + std::to_string(newOrderTx->d_id) + "-" + std::to_string(newOrderTx->c_id));
             
             // 根节点添加依赖
@@ -348,21 +331,11 @@ class NewOrderTransaction : public TPCCTransaction
             root->addChild(dAccess, loom::DependencyType::STRONG);
             root->addChild(cAccess, loom::DependencyType::STRONG);
 
-            // 更新wdc_latestOrder
-            string wdc_key = std::to_string(newOrderTx->w_id) + "-" + std::to_string(newOrderTx->d_id) + "-" + std::to_string(newOrderTx->c_id);
-            // coutConditional << "In NewOrderTransaction, before wdc_latestOrder[" << wdc_key << "] = {" 
-            //      << "o_id: " << wdc_latestOrder[wdc_key].o_id << ", " 
-            //      << "o_ol_cnt: " << wdc_latestOrder[wdc_key].o_ol_cnt << ", "
-            //      << "o_c_id: " << wdc_latestOrder[wdc_key].o_c_id << "}" << endl;
-            wdc_latestOrder[wdc_key] = {next_o_id, newOrderTx->o_ol_cnt, newOrderTx->c_id};
-            // coutConditional << "In NewOrderTransaction, now wdc_latestOrder[" << wdc_key << "] = {" 
-            //      << "o_id: " << wdc_latestOrder[wdc_key].o_id << ", " 
-            //      << "o_ol_cnt: " << wdc_latestOrder[wdc_key].o_ol_cnt << ", "
-            //      << "o_c_id: " << wdc_latestOrder[wdc_key].o_c_id << "}" << endl;
+            // 更新顾客最近的订单
+            district.latestOrder[newOrderTx->c_id] = {next_o_id, newOrderTx->o_ol_cnt, newOrderTx->c_id};
             
-            // 更新wd_oldestNewOrder
-            string wd_key = std::to_string(newOrderTx->w_id) + "-" + std::to_string(newOrderTx->d_id);
-            wd_oldestNewOrder[wd_key].push({next_o_id, newOrderTx->o_ol_cnt, newOrderTx->c_id});
+            // 更新地区未配送的订单
+            district.oldestNewOrder.push({next_o_id, newOrderTx->o_ol_cnt, newOrderTx->c_id});
 
             return root;
         }
@@ -386,13 +359,13 @@ class PaymentTransaction : public TPCCTransaction
     public:
         typedef std::shared_ptr<PaymentTransaction> Ptr;
         // PaymentTransaction() = default;
-        PaymentTransaction(Random& random) : TPCCTransaction(random) {};
+        PaymentTransaction(Random& random, TPCC::State& state = TPCC::State::shared()) : TPCCTransaction(random, state) {};
         ~PaymentTransaction() = default;
         
         // 构造Payment事务
         PaymentTransaction::Ptr makePayment() {
-            PaymentTransaction::Ptr paymentTx = std::make_shared<PaymentTransaction>(random);
-            paymentTx->w_id = random.uniform_dist(1, TPCC::N_WAREHOUSES);
+            PaymentTransaction::Ptr paymentTx = std::make_shared<PaymentTransaction>(random, state);
+            paymentTx->w_id = warehouseId();
             paymentTx->d_id = random.uniform_dist(1, TPCC::N_DISTRICTS);
             
             // 随机选择c_last或c_id
@@ -434,30 +407,30 @@ class PaymentTransaction : public TPCCTransaction
             */
 
             // 根事务
-            TPCCTransaction::Ptr root = std::make_shared<TPCCTransaction>(random);
+            TPCCTransaction::Ptr root = std::make_shared<TPCCTransaction>(random, state);
             root->setType(TPCC::TransactionType::PAYMENT);
             root->setExecutionTime(TPCC::ConsumptionType::LOW);
             
             // warehouse子事务
-            TPCCTransaction::Ptr wAccess = std::make_shared<TPCCTransaction>(random);
+            TPCCTransaction::Ptr wAccess = std::make_shared<TPCCTransaction>(random, state);
             // wAccess->addReadRow("Wytd-" + std::to_string(paymentTx->w_id));
             // wAccess->addUpdateRow("Wytd-" + std::to_string(paymentTx->w_id));
 
             // district子事务
-            TPCCTransaction::Ptr dAccess = std::make_shared<TPCCTransaction>(random);
-            dAccess->addReadRow("Dytd-" + std::to_string(paymentTx->w_id) + "-" + std::to_string(paymentTx->d_id));
-            dAccess->addUpdateRow("Dytd-" + std::to_string(paymentTx->w_id) + "-" + std::to_string(paymentTx->d_id));
+            TPCCTransaction::Ptr dAccess = std::make_shared<TPCCTransaction>(random, state);
+            dAccess->addReadRow(TPCC::Keys::district(TPCC::Table::DISTRICT_YTD, paymentTx->w_id, paymentTx->d_id));
+            dAccess->addUpdateRow(TPCC::Keys::district(TPCC::Table::DISTRICT_YTD, paymentTx->w_id, paymentTx->d_id));
 
             // history子事务
-            TPCCTransaction::Ptr hAccess = std::make_shared<TPCCTransaction>(random);
+            TPCCTransaction::Ptr hAccess = std::make_shared<TPCCTransaction>(random, state);
 
             // customer子事务
-            TPCCTransaction::Ptr cAccess = std::make_shared<TPCCTransaction>(random);
+            TPCCTransaction::Ptr cAccess = std::make_shared<TPCCTransaction>(random, state);
             if (paymentTx->c_id == -1) {
                 auto& c_ids = c_last_to_c_id.at(paymentTx->c_last);
                 
                 for (auto& c_id : c_ids) {
-                    cAccess->addReadRow("Cbalance-" + std::to_string(paymentTx->w_id) + "-" + std::to_string(paymentTx->d_id) + "-" + std::to_string(c_id));
+                    cAccess->addReadRow(TPCC::Keys::customer(TPCC::Table::CUSTOMER_BALANCE, paymentTx->w_id, paymentTx->d_id, c_id));
                 }
                 
                 paymentTx->c_id = c_ids[(c_ids.size() - 1) / 2];
@@ -468,16 +441,16 @@ class PaymentTransaction : public TPCCTransaction
                 cAccess->addChild(hAccess, loom::DependencyType::WEAK);
             } else {
                 // coutConditional << "already have paymentTx->c_id: " << paymentTx->c_id << endl;
-                cAccess->addReadRow("Cbalance-" + std::to_string(paymentTx->w_id) + "-" + std::to_string(paymentTx->d_id) + "-" + std::to_string(paymentTx->c_id));
+                cAccess->addReadRow(TPCC::Keys::customer(TPCC::Table::CUSTOMER_BALANCE, paymentTx->w_id, paymentTx->d_id, paymentTx->c_id));
                 // 否则history子事务独立
                 root->addChild(hAccess, loom::DependencyType::WEAK);
             }
             // coutConditional << endl;
 
             // cAccess->addUpdateRow("Cbalance-" + std::to_string(paymentTx->w_id) + "-" + std::to_string(paymentTx->d_id) + "-" + std::to_string(paymentTx->c_id));
-            cAccess->addUpdateRow("C-" + std::to_string(paymentTx->w_id) + "-" + std::to_string(paymentTx->d_id) + "-" + std::to_string(paymentTx->c_id));
+            cAccess->addUpdateRow(TPCC::Keys::customer(TPCC::Table::CUSTOMER, paymentTx->w_id, paymentTx->d_id, paymentTx->c_id));
             
-            hAccess->addUpdateRow("H-" + std::to_string(paymentTx->w_id) + "-" + std::to_string(paymentTx->d_id) + "-" + std::to_string(paymentTx->c_id));
+            hAccess->addUpdateRow(TPCC::Keys::customer(TPCC::Table::HISTORY, paymentTx->w_id, paymentTx->d_id, paymentTx->c_id));
 
             // 根节点添加依赖
             root->addChild(wAccess, loom::DependencyType::WEAK);
@@ -500,20 +473,19 @@ class OrderStatusTransaction : public TPCCTransaction
     public:
         typedef std::shared_ptr<OrderStatusTransaction> Ptr;
         // OrderStatusTransaction() = default;
-        OrderStatusTransaction(Random& random) : TPCCTransaction(random) {};
+        OrderStatusTransaction(Random& random, TPCC::State& state = TPCC::State::shared()) : TPCCTransaction(random, state) {};
         ~OrderStatusTransaction() = default;
         
         // 构造OrderStatus事务
         OrderStatusTransaction::Ptr makeOrderStatus() {
-            OrderStatusTransaction::Ptr orderStatusTx = std::make_shared<OrderStatusTransaction>(random);
-            string wdc_key;
+            OrderStatusTransaction::Ptr orderStatusTx = std::make_shared<OrderStatusTransaction>(random, state);
+            int32_t temp_c_id;
 
             do {
-                orderStatusTx->w_id = random.uniform_dist(1, TPCC::N_WAREHOUSES);
+                orderStatusTx->w_id = warehouseId();
                 orderStatusTx->d_id = random.uniform_dist(1, TPCC::N_DISTRICTS);
             
                 int y = random.uniform_dist(1, 100);
-                int32_t temp_c_id;
                 
                 if (y <= 60) {
                     // 保证c_last对应的c_id不为空
@@ -528,9 +500,7 @@ class OrderStatusTransaction : public TPCCTransaction
                     orderStatusTx->c_last = "";
                     temp_c_id = orderStatusTx->c_id;
                 }
-                
-                wdc_key = std::to_string(orderStatusTx->w_id) + "-" + std::to_string(orderStatusTx->d_id) + "-" + std::to_string(temp_c_id);
-            } while(wdc_latestOrder[wdc_key].o_id == 0);
+            } while(state.district(orderStatusTx->w_id, orderStatusTx->d_id).latestOrder.count(temp_c_id) == 0);
             
             return orderStatusTx;
         }
@@ -549,7 +519,7 @@ class OrderStatusTransaction : public TPCCTransaction
                 1. customer表: 读取c_balance, c_first, c_middle, c_last字段
                     1.1 利用c_w_id, c_d_id, c_id精确查询
                     1.2 利用c_w_id, c_d_id, c_last范围查询 => 转化为c_ids => 取第n/2(向上取整)个id
-                2. order表: 根据w_id, d_id, c_id查找最近的o_id, 读取o_id字段 => 查找wdc_latestOrder表
+                2. order表: 根据w_id, d_id, c_id查找最近的o_id, 读取o_id字段 => 查找地区的latestOrder
                 3. orderLine表: 根据w_id, d_id, o_id查找, 读取ol_i_id, ol_supply_w_id, ol_quantity, ol_amount等字段
                 需要额外维护的数据：(w_id-d_id-c_id, {o_id, o_ol_cnt})
             */
@@ -557,15 +527,15 @@ class OrderStatusTransaction : public TPCCTransaction
             // 根子事务：可能为customer子事务
             TPCCTransaction::Ptr root;
             // customer子事务
-            TPCCTransaction::Ptr cAccess = std::make_shared<TPCCTransaction>(random);
+            TPCCTransaction::Ptr cAccess = std::make_shared<TPCCTransaction>(random, state);
             // order子事务
-            TPCCTransaction::Ptr oAccess = std::make_shared<TPCCTransaction>(random);
+            TPCCTransaction::Ptr oAccess = std::make_shared<TPCCTransaction>(random, state);
             oAccess->setExecutionTime(TPCC::ConsumptionType::HIGH);
 
             if (orderStatusTx->c_id == -1) {
                 auto& c_ids = c_last_to_c_id.at(orderStatusTx->c_last);
                 for (auto& c_id : c_ids) {
-                    cAccess->addReadRow("C-" + std::to_string(orderStatusTx->w_id) + "-" + std::to_string(orderStatusTx->d_id) + "-" + std::to_string(c_id));
+                    cAccess->addReadRow(TPCC::Keys::customer(TPCC::Table::CUSTOMER, orderStatusTx->w_id, orderStatusTx->d_id, c_id));
                 }
 
                 orderStatusTx->c_id = c_ids[(c_ids.size() - 1) / 2];
@@ -579,25 +549,25 @@ class OrderStatusTransaction : public TPCCTransaction
                 root = cAccess;
             } else {
                 // coutConditional << "already have orderStatusTx->c_id: " << orderStatusTx->c_id << endl;
-                cAccess->addReadRow("C-" + std::to_string(orderStatusTx->w_id) + "-" + std::to_string(orderStatusTx->d_id) + "-" + std::to_string(orderStatusTx->c_id));
+                cAccess->addReadRow(TPCC::Keys::customer(TPCC::Table::CUSTOMER, orderStatusTx->w_id, orderStatusTx->d_id, orderStatusTx->c_id));
 
                 // 新建根子事务
-                root = std::make_shared<TPCCTransaction>(random);
+                root = std::make_shared<TPCCTransaction>(random, state);
                 root->setExecutionTime(TPCC::ConsumptionType::LOW);
                 root->addChild(cAccess, loom::DependencyType::WEAK);
                 root->addChild(oAccess, loom::DependencyType::WEAK);
             }
             
-            string wdc_key = std::to_string(orderStatusTx->w_id) + "-" + std::to_string(orderStatusTx->d_id) + "-" + std::to_string(orderStatusTx->c_id);
+            auto& district = state.district(orderStatusTx->w_id, orderStatusTx->d_id);
+            auto it = district.latestOrder.find(orderStatusTx->c_id);
             // 没有order则直接返回
-            if (wdc_latestOrder.count(wdc_key) == 0) {
-                // coutConditional << "\tWARNING: wdc_latestOrder[" << wdc_key << "] is empty..." << endl << endl;
+            if (it == district.latestOrder.end()) {
                 return root;
             }
 
             // 有则继续添加子事务和读写集
-            auto& latestOrder = wdc_latestOrder.at(wdc_key);
-            oAccess->addReadRow("O-" + wdc_key);
+            auto& latestOrder = it->second;
+            oAccess->addReadRow(TPCC::Keys::customer(TPCC::Table::ORDER_WDC, orderStatusTx->w_id, orderStatusTx->d_id, orderStatusTx->c_id));
             // coutConditional << "latestOrder[" << wdc_key << "] " << 
             //         ": o_id: " << latestOrder.o_id << 
             //         ", o_ol_cnt: " << latestOrder.o_ol_cnt << 
@@ -605,8 +575,8 @@ class OrderStatusTransaction : public TPCCTransaction
 
             for (int i = 0; i < latestOrder.o_ol_cnt; i++) {
                 // orderLine子事务
-                TPCCTransaction::Ptr olAccess = std::make_shared<TPCCTransaction>(random);
-                olAccess->addReadRow("OL-" + std::to_string(orderStatusTx->w_id) + "-" + std::to_string(orderStatusTx->d_id) + "-" + std::to_string(latestOrder.o_id));
+                TPCCTransaction::Ptr olAccess = std::make_shared<TPCCTransaction>(random, state);
+                olAccess->addReadRow(TPCC::Keys::order(TPCC::Table::ORDER_LINE_WDO, orderStatusTx->w_id, orderStatusTx->d_id, latestOrder.o_id));
                 
                 // order子事务添加依赖
                 oAccess->addChild(olAccess, loom::DependencyType::WEAK);
@@ -629,13 +599,13 @@ class DeliveryTransaction : public TPCCTransaction
     public:
         typedef std::shared_ptr<DeliveryTransaction> Ptr;
         // DeliveryTransaction() = default;
-        DeliveryTransaction(Random& random) : TPCCTransaction(random) {};
+        DeliveryTransaction(Random& random, TPCC::State& state = TPCC::State::shared()) : TPCCTransaction(random, state) {};
         ~DeliveryTransaction() = default;
         
         // 构造Delivery事务
         DeliveryTransaction::Ptr makeDelivery() {
-            DeliveryTransaction::Ptr deliveryTx = std::make_shared<DeliveryTransaction>(random);
-            deliveryTx->w_id = random.uniform_dist(1, TPCC::N_WAREHOUSES);
+            DeliveryTransaction::Ptr deliveryTx = std::make_shared<DeliveryTransaction>(random, state);
+            deliveryTx->w_id = warehouseId();
             deliveryTx->o_carrier_id = random.uniform_dist(1, TPCC::N_CARRIERS);
             deliveryTx->ol_delivery_d = std::time(0);
             return deliveryTx;
@@ -651,80 +621,73 @@ class DeliveryTransaction : public TPCCTransaction
                     ", ol_delivery_d = " << deliveryTx->ol_delivery_d << endl;
 
             /* 事务逻辑：对warehouse中每个district进行如下操作：(如果和前面的delivery事务有冲突，则需等待)
-                1. newOrder表: 根据w_id, d_id查找, 读取no_o_id字段最小的一条记录, 删除该记录 => 通过wd_oldestNewOrder表
+                1. newOrder表: 根据w_id, d_id查找, 读取no_o_id字段最小的一条记录, 删除该记录 => 通过地区的oldestNewOrder
                 2. order表: 根据w_id, d_id, o_id查找, 读取o_ol_cnt, o_c_id字段, 更新o_carrier_id字段
                 3. orderLine表: 根据w_id, d_id, o_id查找, 读取ol_amount字段, 更新ol_delivery_d字段 => 计算ol_amount总和
                 4. customer表: 根据w_id, d_id, o_c_id查找, 读取c_balance字段, 更新c_balance字段
                 需要额外维护的数据：(w_id-d_id, {o_id, o_c_id, o_ol_cnt})
             */
             // 根事务
-            TPCCTransaction::Ptr root = std::make_shared<TPCCTransaction>(random);
+            TPCCTransaction::Ptr root = std::make_shared<TPCCTransaction>(random, state);
             root->setType(TPCC::TransactionType::DELIVERY);
             root->setExecutionTime(TPCC::ConsumptionType::HIGH);
 
             for (int i = 1; i <= TPCC::N_DISTRICTS; i++) {
                 // newOrder子事务 + customer子事务
-                TPCCTransaction::Ptr no_cAccess = std::make_shared<TPCCTransaction>(random);
+                TPCCTransaction::Ptr no_cAccess = std::make_shared<TPCCTransaction>(random, state);
                 
-                // 获得oldestNewOrder并更新wd_oldestNewOrder
-                auto wd_key = std::to_string(deliveryTx->w_id) + "-" + std::to_string(i);
+                // 获得oldestNewOrder并更新地区未配送的订单
+                auto& newOrders = state.district(deliveryTx->w_id, i).oldestNewOrder;
                 // 若不存在了，则跳过
-                if (wd_oldestNewOrder.count(wd_key) == 0 || wd_oldestNewOrder.at(wd_key).empty()) {
+                if (newOrders.empty()) {
                     coutConditional << "\tWARNING: warehouse: " << deliveryTx->w_id << " distirct: " << i << " has no new order..." << endl;
                     if (i == 10) coutConditional << endl;
                     continue;
                 }
                 // 取出最旧的一条记录
-                const auto oldestNewOrder = wd_oldestNewOrder.at(wd_key).front();
+                const auto oldestNewOrder = newOrders.front();
 
-                // coutConditional << "wd_oldestNewOrder[" << wd_key << "] " << 
+                // coutConditional << "oldestNewOrder[" << i << "] " << 
                 //         ": o_id: " << oldestNewOrder.o_id << 
                 //         ", o_ol_cnt: " << oldestNewOrder.o_ol_cnt << 
                 //         ", o_c_id: " << oldestNewOrder.o_c_id << endl;
 
-                wd_oldestNewOrder.at(wd_key).pop();
-                // if (!wd_oldestNewOrder.at(wd_key).empty()) {
-                //     coutConditional << "new wd_oldestNewOrder[" << wd_key << "] " << 
-                //             ": o_id: " << wd_oldestNewOrder.at(wd_key).front().o_id << 
-                //             ", o_ol_cnt: " << wd_oldestNewOrder.at(wd_key).front().o_ol_cnt << 
-                //             ", o_c_id: " << wd_oldestNewOrder.at(wd_key).front().o_c_id << endl;
-                // }
-                // coutConditional << endl;
+                newOrders.pop();
 
 
                 // 添加newOrder子事务读写集
                 // no_cAccess->addReadRow("NO-" + wd_key);
-                no_cAccess->addUpdateRow("NO-" + wd_key + "-" + std::to_string(oldestNewOrder.o_id));
-                no_cAccess->addUpdateRow("NO-" + wd_key);
+                no_cAccess->addUpdateRow(TPCC::Keys::order(TPCC::Table::NEW_ORDER, deliveryTx->w_id, i, oldestNewOrder.o_id));
+                no_cAccess->addUpdateRow(TPCC::Keys::district(TPCC::Table::NEW_ORDER_WD, deliveryTx->w_id, i));
 
                 no_cAccess->setExecutionTime(TPCC::ConsumptionType::HIGH);
 
                 // order子事务
-                TPCCTransaction::Ptr oAccess = std::make_shared<TPCCTransaction>(random);
-                oAccess->addReadRow("O-" + wd_key + "-" + std::to_string(oldestNewOrder.o_id) + "-" + std::to_string(oldestNewOrder.o_c_id));
-                oAccess->addUpdateRow("O-" + wd_key + "-" + std::to_string(oldestNewOrder.o_id) + "-" + std::to_string(oldestNewOrder.o_c_id));
+                TPCCTransaction::Ptr oAccess = std::make_shared<TPCCTransaction>(random, state);
+                oAccess->addReadRow(TPCC::Keys::order(TPCC::Table::ORDER, deliveryTx->w_id, i, oldestNewOrder.o_id, oldestNewOrder.o_c_id));
+                oAccess->addUpdateRow(TPCC::Keys::order(TPCC::Table::ORDER, deliveryTx->w_id, i, oldestNewOrder.o_id, oldestNewOrder.o_c_id));
                 
                 // orderlines子事务
-                TPCCTransaction::Ptr olsAccess = std::make_shared<TPCCTransaction>(random);
+                TPCCTransaction::Ptr olsAccess = std::make_shared<TPCCTransaction>(random, state);
                 for (int j = 0; j < oldestNewOrder.o_ol_cnt; j++) {
                     // orderLine子事务
-                    TPCCTransaction::Ptr olAccess = std::make_shared<TPCCTransaction>(random);
-                    olAccess->addReadRow("OLdelivery-" + wd_key + "-" + std::to_string(oldestNewOrder.o_id) + "-" + std::to_string(j));
+                    TPCCTransaction::Ptr olAccess = std::make_shared<TPCCTransaction>(random, state);
+                    olAccess->addReadRow(TPCC::Keys::order(TPCC::Table::OL_DELIVERY, deliveryTx->w_id, i, oldestNewOrder.o_id, j));
                     // olAccess->addUpdateRow("OLdelivery-" + wd_key + "-" + std::to_string(oldestNewOrder.o_id) + "-" + std::to_string(j));
                     // orderlines子事务添加依赖
                     olsAccess->addChild(olAccess, loom::DependencyType::STRONG);
                 }
-                olsAccess->addUpdateRow("OLdelivery-" + wd_key);
+                olsAccess->addUpdateRow(TPCC::Keys::district(TPCC::Table::OL_DELIVERY_WD, deliveryTx->w_id, i));
                 
                 // no_cAccess添加依赖   
                 no_cAccess->addChild(oAccess, loom::DependencyType::STRONG);
                 no_cAccess->addChild(olsAccess, loom::DependencyType::STRONG);
 
                 // 添加customer子事务读写集
-                no_cAccess->addReadRow("C-" + wd_key + "-" + std::to_string(oldestNewOrder.o_c_id));
-                no_cAccess->addUpdateRow("Cbalance-" + wd_key + "-" + std::to_string(oldestNewOrder.o_c_id));
-                no_cAccess->addReadRow("Cdelivery-" + wd_key + "-" + std::to_string(oldestNewOrder.o_c_id));
-                no_cAccess->addUpdateRow("Cdelivery-" + wd_key + "-" + std::to_string(oldestNewOrder.o_c_id));
+                no_cAccess->addReadRow(TPCC::Keys::customer(TPCC::Table::CUSTOMER, deliveryTx->w_id, i, oldestNewOrder.o_c_id));
+                no_cAccess->addUpdateRow(TPCC::Keys::customer(TPCC::Table::CUSTOMER_BALANCE, deliveryTx->w_id, i, oldestNewOrder.o_c_id));
+                no_cAccess->addReadRow(TPCC::Keys::customer(TPCC::Table::CUSTOMER_DELIVERY, deliveryTx->w_id, i, oldestNewOrder.o_c_id));
+                no_cAccess->addUpdateRow(TPCC::Keys::customer(TPCC::Table::CUSTOMER_DELIVERY, deliveryTx->w_id, i, oldestNewOrder.o_c_id));
 
                 // root添加依赖
                 root->addChild(no_cAccess, loom::DependencyType::WEAK);
@@ -745,16 +708,16 @@ class StockLevelTransaction : public TPCCTransaction
     public:
         typedef std::shared_ptr<StockLevelTransaction> Ptr;
         // StockLevelTransaction() = default;
-        StockLevelTransaction(Random& random) : TPCCTransaction(random) {};
+        StockLevelTransaction(Random& random, TPCC::State& state = TPCC::State::shared()) : TPCCTransaction(random, state) {};
         ~StockLevelTransaction() = default;
         
         // 构造StockLevel事务
         StockLevelTransaction::Ptr makeStockLevel() {
-            StockLevelTransaction::Ptr stockLevelTx = std::make_shared<StockLevelTransaction>(random);
+            StockLevelTransaction::Ptr stockLevelTx = std::make_shared<StockLevelTransaction>(random, state);
             do {
-                stockLevelTx->w_id = random.uniform_dist(1, TPCC::N_WAREHOUSES);
+                stockLevelTx->w_id = warehouseId();
                 stockLevelTx->d_id = random.uniform_dist(1, TPCC::N_DISTRICTS);
-            } while (wd_latestOrderLines.count(std::to_string(stockLevelTx->w_id) + "-" + std::to_string(stockLevelTx->d_id)) == 0);
+            } while (state.district(stockLevelTx->w_id, stockLevelTx->d_id).latestOrderLines.empty());
             
             // stockLevelTx->d_id = random.uniform_dist(1, TPCC::N_DISTRICTS);
             stockLevelTx->threshold = random.uniform_dist(10, 20);
@@ -779,34 +742,33 @@ class StockLevelTransaction : public TPCCTransaction
 
             /* 嵌套事务实现 */
             // district子事务
-            TPCCTransaction::Ptr dAccess = std::make_shared<TPCCTransaction>(random);
+            TPCCTransaction::Ptr dAccess = std::make_shared<TPCCTransaction>(random, state);
             dAccess->setType(TPCC::TransactionType::STOCK_LEVEL);
-            dAccess->addReadRow("D-" + std::to_string(stockLevelTx->w_id) + "-" + std::to_string(stockLevelTx->d_id));
+            dAccess->addReadRow(TPCC::Keys::district(TPCC::Table::DISTRICT, stockLevelTx->w_id, stockLevelTx->d_id));
             // 获取d_next_o_id
-            uint64_t d_next_o_id = get_order(stockLevelTx->d_id - 1);
+            uint64_t d_next_o_id = get_order(stockLevelTx->w_id, stockLevelTx->d_id);
             // coutConditional << "In StockLevelTransaction, now next_o_id: " << d_next_o_id << endl;
 
             // orderLine子事务
-            TPCCTransaction::Ptr olAccess = std::make_shared<TPCCTransaction>(random);
-            auto wd_key = std::to_string(stockLevelTx->w_id) + "-" + std::to_string(stockLevelTx->d_id);
+            TPCCTransaction::Ptr olAccess = std::make_shared<TPCCTransaction>(random, state);
             // 获取最近的20条orderLine记录
-            if (wd_latestOrderLines.count(wd_key) == 0) {
+            const auto& latestOrderLines = state.district(stockLevelTx->w_id, stockLevelTx->d_id).latestOrderLines;
+            if (latestOrderLines.empty()) {
                 coutConditional << "\tERROR: distirct " << stockLevelTx->d_id << " has no orderLine..." << endl;
                 return nullptr;
             }
 
-            const auto latestOrderLines = wd_latestOrderLines.at(wd_key);            
             for (auto& orderLine : latestOrderLines) {
                 // coutConditional << "orderLine: o_id = " << orderLine.o_id << ", ol_i_id = " << orderLine.ol_i_id << endl;
 
                 // stock子事务
-                TPCCTransaction::Ptr sAccess = std::make_shared<TPCCTransaction>(random);
-                sAccess->addReadRow("Sqtys-" + std::to_string(stockLevelTx->w_id) + "-" + std::to_string(orderLine.ol_i_id));
+                TPCCTransaction::Ptr sAccess = std::make_shared<TPCCTransaction>(random, state);
+                sAccess->addReadRow(TPCC::Keys::item(TPCC::Table::STOCK_QTYS, stockLevelTx->w_id, orderLine.ol_i_id));
 
                 // orderLine子事务添加依赖
                 olAccess->addChild(sAccess, loom::DependencyType::WEAK);
             }
-            olAccess->addReadRow("OL-" + wd_key);
+            olAccess->addReadRow(TPCC::Keys::district(TPCC::Table::ORDER_LINE_WD, stockLevelTx->w_id, stockLevelTx->d_id));
             olAccess->setExecutionTime(TPCC::ConsumptionType::HIGH);
 
             // district子事务添加依赖
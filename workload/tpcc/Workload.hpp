@@ -2,73 +2,114 @@
 
 #include "Transaction.hpp"
 
-/* 负载类：生成已经转化为嵌套事务形式的五种TPC-C事务 */ 
+/* 负载类：生成已经转化为嵌套事务形式的五种TPC-C事务
+    1. 第 i 笔事务的类型与所属仓库只由 (seed, i) 决定, 可以并行抽取
+    2. 事务内容由所属仓库的随机流与状态分片生成, 同一仓库的事务按序号串行生成, 不同仓库之间互不影响
+    3. 因此同一种子生成的负载与生成线程数无关
+*/
 class Workload {
     public:
-        Workload() : random(reinterpret_cast<uint64_t>(this)), tx_random(reinterpret_cast<uint64_t>(this)){
-            // 重置静态变量的值
-            txGenerator = std::make_shared<TPCCTransaction>(tx_random);
-            txGenerator->resetStatic();
-            init();
-        }
-        
-        Workload(uint64_t seed) : random(seed), tx_random(seed) {
-            // 重置静态变量的值
-            txGenerator = std::make_shared<TPCCTransaction>(tx_random);
-            txGenerator->resetStatic();
-            txGenerator = std::make_shared<NewOrderTransaction>(tx_random);
-            txGenerator->makeTransaction();
+        /// @brief 第 index 笔事务的类型与所属仓库
+        struct Slot {
+            size_t index;
+            TPCC::TransactionType type;
+            uint64_t w_id;
         };
-        
+
+        Workload() : Workload(reinterpret_cast<uint64_t>(this)) {}
+
+        Workload(uint64_t seed) {set_seed(seed);}
+
         ~Workload() = default;
-        
+
+        // 生成的事务引用了负载内的随机数与状态, 不可拷贝
+        Workload(const Workload&) = delete;
+        Workload& operator=(const Workload&) = delete;
+
         // 随机生成封装好的五类事务
         TPCCTransaction::Ptr NextTransaction() {
+            return MakeTransaction(DrawSlot(m_next++));
+        }
+
+        /// @brief 预留接下来的 n 个事务序号, 返回第一个序号, 预留的序号由调用方自行抽取和生成
+        size_t Reserve(size_t n) {
+            auto first = m_next;
+            m_next += n;
+            return first;
+        }
+
+        /// @brief 抽取第 index 笔事务的类型与仓库, 只读, 可并发调用
+        Slot DrawSlot(size_t index) const {
+            loom::Random random(m_seed, index);
+            TPCC::TransactionType type;
             uint64_t option = random.uniform_dist(1, 100);
             if (option <= 45) {         // 生成由newOrder构成的负载
-                txGenerator = std::make_shared<NewOrderTransaction>(tx_random);
+                type = TPCC::TransactionType::NEW_ORDER;
             } else if (option <= 88) {  // 生成由payment构成的负载
-                txGenerator = std::make_shared<PaymentTransaction>(tx_random);
+                type = TPCC::TransactionType::PAYMENT;
             } else if (option <= 92) {  // 生成由orderStatus构成的负载
-                txGenerator = std::make_shared<OrderStatusTransaction>(tx_random);
+                type = TPCC::TransactionType::ORDER_STATUS;
             } else if (option <= 96) {  // 生成由delivery构成的负载
-                txGenerator = std::make_shared<DeliveryTransaction>(tx_random);
+                type = TPCC::TransactionType::DELIVERY;
             } else {                    // 生成由stockLevel构成的负载
-                txGenerator = std::make_shared<StockLevelTransaction>(tx_random);
-            }            
-            return txGenerator->makeTransaction();
-        }
-        
-        uint64_t get_seed() {
-            return random.get_seed();
+                type = TPCC::TransactionType::STOCK_LEVEL;
+            }
+            return {index, type, random.uniform_dist(1, TPCC::N_WAREHOUSES)};
         }
 
-        loom::Random get_tx_random() {
-            return tx_random;
+        /// @brief 在所属仓库上生成事务; 不同仓库可并发调用, 同一仓库需按序号依次调用
+        TPCCTransaction::Ptr MakeTransaction(const Slot& slot) {
+            auto& random = m_randoms[slot.w_id - 1];
+            TPCCTransaction::Ptr txGenerator;
+            switch (slot.type) {
+                case TPCC::TransactionType::NEW_ORDER:
+                    txGenerator = std::make_shared<NewOrderTransaction>(random, m_state); break;
+                case TPCC::TransactionType::PAYMENT:
+                    txGenerator = std::make_shared<PaymentTransaction>(random, m_state); break;
+                case TPCC::TransactionType::ORDER_STATUS:
+                    txGenerator = std::make_shared<OrderStatusTransaction>(random, m_state); break;
+                case TPCC::TransactionType::DELIVERY:
+                    txGenerator = std::make_shared<DeliveryTransaction>(random, m_state); break;
+                default:
+                    txGenerator = std::make_shared<StockLevelTransaction>(random, m_state); break;
+            }
+            txGenerator->setWarehouse(slot.w_id);
+            return txGenerator->makeTransaction();
         }
 
-        loom::Random get_random() {
-            return random;
+        uint64_t get_seed() {
+            return m_seed;
         }
 
         void set_seed(uint64_t seed) {
-            // 重置静态变量的值
-            txGenerator->resetStatic();
-            random.set_seed(seed);
-            tx_random.set_seed(seed);
-            // txGenerator = std::make_shared<NewOrderTransaction>(tx_random);
-            // txGenerator->makeTransaction();
+            m_seed = seed;
+            m_next = 0;
+            // 重置各仓库的状态分片与随机流
+            m_state.reset();
+            m_randoms.clear();
+            m_randoms.reserve(TPCC::N_WAREHOUSES);
+            for (uint64_t w_id = 1; w_id <= TPCC::N_WAREHOUSES; w_id++) {
+                m_randoms.emplace_back(seed, WAREHOUSE_STREAM + w_id);
+            }
             init();
         }
 
+        // 每个仓库先生成50笔NewOrder, 保证后续事务有可读的订单
         void init() {
-            txGenerator = std::make_shared<NewOrderTransaction>(tx_random);
-            for (int i = 0; i < 50; i++)
-                txGenerator->makeTransaction();
+            for (uint64_t w_id = 1; w_id <= TPCC::N_WAREHOUSES; w_id++) {
+                auto txGenerator = std::make_shared<NewOrderTransaction>(m_randoms[w_id - 1], m_state);
+                txGenerator->setWarehouse(w_id);
+                for (int i = 0; i < 50; i++)
+                    txGenerator->makeTransaction();
+            }
         }
 
     private:
-        loom::Random random;
-        loom::Random tx_random;
-        TPCCTransaction::Ptr txGenerator;
-};
\ No newline at end of file
+        // 仓库随机流的编号与事务序号的流编号错开
+        static constexpr uint64_t WAREHOUSE_STREAM = 1ULL << 63;
+
+        uint64_t m_seed;
+        size_t m_next = 0;                      // 下一个事务序号
+        TPCC::State m_state;                    // 按仓库分片的订单状态
+        std::vector<loom::Random> m_randoms;    // 各仓库的随机流
+};